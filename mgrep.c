@@ -0,0 +1,545 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mregexp.h"
+
+typedef enum {
+	OUTPUT_LINES,
+	OUTPUT_COUNT,
+	OUTPUT_ONLY_MATCHING,
+} OutputMode;
+
+typedef struct {
+	const char *pattern;
+	OutputMode mode;
+	bool line_numbers;
+	bool show_names;
+	/* anchors only match at the ends of the subject, so patterns
+	 * containing them are matched against every line on its own */
+	bool per_line;
+} Options;
+
+/* growing output of a single file */
+typedef struct {
+	char *data;
+	size_t len;
+	size_t cap;
+} Buffer;
+
+typedef struct {
+	char *path;
+	Buffer out;
+	bool done;
+	bool matched;
+	bool failed;
+} File;
+
+/* files to search, shared by all workers */
+typedef struct {
+	const Options *opts;
+	/* compiled pattern, shared by all workers */
+	MRegexp *re;
+	File *files;
+	size_t files_len;
+	size_t files_cap;
+	/* next file to search */
+	size_t next_search;
+	/* next file to print. output is printed in the order of files */
+	size_t next_print;
+	pthread_mutex_t lock;
+} Scan;
+
+static void *xrealloc(void *p, size_t size)
+{
+	p = realloc(p, size);
+
+	if (p == NULL) {
+		fputs("mgrep: out of memory\n", stderr);
+		exit(2);
+	}
+
+	return p;
+}
+
+static void buf_append(Buffer *b, const char *s, size_t len)
+{
+	if (b->len + len > b->cap) {
+		b->cap = b->cap * 2 > b->len + len ? b->cap * 2 : b->len + len;
+		b->data = (char *) xrealloc(b->data, b->cap);
+	}
+
+	memcpy(b->data + b->len, s, len);
+	b->len += len;
+}
+
+static void buf_append_num(Buffer *b, size_t n, char sep)
+{
+	char tmp[32];
+	const int len = snprintf(tmp, sizeof(tmp), "%zu%c", n, sep);
+
+	buf_append(b, tmp, (size_t) len);
+}
+
+/* whether pattern contains ^ or $ outside of a class */
+static bool has_anchors(const char *pattern)
+{
+	bool in_class = false;
+
+	for (const char *p = pattern; *p; ++p) {
+		if (*p == '\\' && p[1] != 0)
+			++p;
+		else if (in_class)
+			in_class = *p != ']';
+		else if (*p == '[')
+			in_class = true;
+		else if (*p == '^' || *p == '$')
+			return true;
+	}
+
+	return false;
+}
+
+/* offset of the first line break at or after pos, or len */
+static size_t line_end(const char *s, size_t len, size_t pos)
+{
+	const char *nl = (const char *) memchr(s + pos, '\n', len - pos);
+
+	return nl != NULL ? (size_t) (nl - s) : len;
+}
+
+/* offset of the beginning of the line containing pos. from is the
+ * beginning of an earlier line */
+static size_t line_begin(const char *s, size_t from, size_t pos)
+{
+	while (pos > from && s[pos - 1] != '\n')
+		--pos;
+
+	return pos;
+}
+
+static size_t count_lines(const char *s, size_t from, size_t to)
+{
+	size_t n = 0;
+	const char *nl;
+
+	while ((nl = (const char *) memchr(s + from, '\n', to - from))) {
+		from = (size_t) (nl - s) + 1;
+		n++;
+	}
+
+	return n;
+}
+
+/* find the first match in the first len bytes of s at or after start.
+ * captures aren't recorded, which leaves re untouched, so all workers
+ * can share it */
+static bool find(MRegexp *re, const char *s, size_t len, size_t start,
+		 MRegexpMatch *m)
+{
+	return mregexp_match_captures(re, s, len, start, m, NULL, 0);
+}
+
+static void print_prefix(const Options *opts, File *f, size_t line)
+{
+	if (opts->show_names) {
+		buf_append(&f->out, f->path, strlen(f->path));
+		buf_append(&f->out, ":", 1);
+	}
+
+	if (opts->line_numbers)
+		buf_append_num(&f->out, line, ':');
+}
+
+/* report line [begin, end) of s, whose first match is m */
+static void report_line(MRegexp *re, const Options *opts, File *f,
+			const char *s, size_t begin, size_t end,
+			MRegexpMatch m, size_t line)
+{
+	if (opts->mode == OUTPUT_LINES) {
+		print_prefix(opts, f, line);
+		buf_append(&f->out, s + begin, end - begin);
+		buf_append(&f->out, "\n", 1);
+		return;
+	}
+
+	if (opts->mode != OUTPUT_ONLY_MATCHING)
+		return;
+
+	for (;;) {
+		// like grep, empty matches print nothing
+		if (m.match_end != m.match_begin) {
+			print_prefix(opts, f, line);
+			buf_append(&f->out, s + m.match_begin,
+				   m.match_end - m.match_begin);
+			buf_append(&f->out, "\n", 1);
+		}
+
+		size_t next = m.match_end - begin;
+
+		if (m.match_end == m.match_begin)
+			next++;
+
+		if (next >= end - begin ||
+		    !find(re, s + begin, end - begin, next, &m))
+			return;
+
+		m.match_begin += begin;
+		m.match_end += begin;
+	}
+}
+
+/* search all lines of s. matches are searched for in the whole buffer,
+ * line boundaries are only looked up around them */
+static void search_buffer(MRegexp *re, const Options *opts, File *f,
+			  const char *s, size_t len)
+{
+	size_t pos = 0;
+	size_t line = 1;
+	size_t counted = 0;
+	size_t matches = 0;
+	MRegexpMatch m;
+
+	while (pos < len) {
+		size_t begin = pos;
+		size_t end = 0;
+
+		if (opts->per_line) {
+			end = line_end(s, len, pos);
+
+			if (!find(re, s + begin, end - begin, 0, &m)) {
+				pos = end + 1;
+				continue;
+			}
+
+			m.match_begin += begin;
+			m.match_end += begin;
+		} else {
+			if (!find(re, s, len, pos, &m))
+				break;
+
+			begin = line_begin(s, pos, m.match_begin);
+			end = line_end(s, len, m.match_begin);
+
+			// a match running over the end of its line may not
+			// have a counterpart inside of the line
+			if (m.match_end > end) {
+				if (!find(re, s + begin, end - begin, 0, &m)) {
+					pos = end + 1;
+					continue;
+				}
+
+				m.match_begin += begin;
+				m.match_end += begin;
+			}
+		}
+
+		if (opts->line_numbers) {
+			line += count_lines(s, counted, begin);
+			counted = begin;
+		}
+
+		report_line(re, opts, f, s, begin, end, m, line);
+		matches++;
+		pos = end + 1;
+	}
+
+	if (opts->mode == OUTPUT_COUNT) {
+		if (opts->show_names) {
+			buf_append(&f->out, f->path, strlen(f->path));
+			buf_append(&f->out, ":", 1);
+		}
+
+		buf_append_num(&f->out, matches, '\n');
+	}
+
+	f->matched = matches > 0;
+}
+
+static void search_stdin(MRegexp *re, const Options *opts, File *f)
+{
+	Buffer in = { NULL, 0, 0 };
+	char tmp[65536];
+	size_t n;
+
+	while ((n = fread(tmp, 1, sizeof(tmp), stdin)) > 0)
+		buf_append(&in, tmp, n);
+
+	search_buffer(re, opts, f, in.data, in.len);
+	free(in.data);
+}
+
+static void search_file(MRegexp *re, const Options *opts, File *f)
+{
+	if (strcmp(f->path, "-") == 0) {
+		search_stdin(re, opts, f);
+		return;
+	}
+
+	const int fd = open(f->path, O_RDONLY);
+	struct stat st;
+
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		fprintf(stderr, "mgrep: %s: %s\n", f->path, strerror(errno));
+		f->failed = true;
+
+		if (fd >= 0)
+			close(fd);
+
+		return;
+	}
+
+	const size_t len = (size_t) st.st_size;
+	const char *data = NULL;
+
+	if (len > 0) {
+		data = (const char *) mmap(NULL, len, PROT_READ, MAP_PRIVATE,
+					   fd, 0);
+
+		if (data == MAP_FAILED) {
+			fprintf(stderr, "mgrep: %s: %s\n", f->path,
+				strerror(errno));
+			f->failed = true;
+			close(fd);
+			return;
+		}
+
+		posix_madvise((void *) data, len, POSIX_MADV_SEQUENTIAL);
+	}
+
+	search_buffer(re, opts, f, data, len);
+
+	if (len > 0)
+		munmap((void *) data, len);
+
+	close(fd);
+}
+
+/* print the output of all files searched so far, in order.
+ * called with scan->lock held */
+static void flush_files(Scan *scan)
+{
+	while (scan->next_print < scan->files_len &&
+	       scan->files[scan->next_print].done) {
+		File *f = &scan->files[scan->next_print++];
+
+		fwrite(f->out.data, 1, f->out.len, stdout);
+		free(f->out.data);
+		f->out.data = NULL;
+	}
+}
+
+static void *worker(void *arg)
+{
+	Scan *scan = (Scan *) arg;
+
+	for (;;) {
+		pthread_mutex_lock(&scan->lock);
+
+		if (scan->next_search == scan->files_len) {
+			pthread_mutex_unlock(&scan->lock);
+			break;
+		}
+
+		File *f = &scan->files[scan->next_search++];
+		pthread_mutex_unlock(&scan->lock);
+
+		search_file(scan->re, scan->opts, f);
+
+		pthread_mutex_lock(&scan->lock);
+		f->done = true;
+		flush_files(scan);
+		pthread_mutex_unlock(&scan->lock);
+	}
+
+	return NULL;
+}
+
+static void add_file(Scan *scan, char *path)
+{
+	if (scan->files_len == scan->files_cap) {
+		scan->files_cap = scan->files_cap ? scan->files_cap * 2 : 64;
+		scan->files = (File *) xrealloc(scan->files, scan->files_cap *
+								     sizeof(File));
+	}
+
+	File *f = &scan->files[scan->files_len++];
+	memset(f, 0, sizeof(File));
+	f->path = path;
+}
+
+/* add path to the files to search, descending into directories.
+ * symbolic links are only followed if they were passed directly */
+static bool add_path(Scan *scan, const char *path, bool follow)
+{
+	struct stat st;
+
+	if ((follow ? stat(path, &st) : lstat(path, &st)) < 0) {
+		fprintf(stderr, "mgrep: %s: %s\n", path, strerror(errno));
+		return false;
+	}
+
+	if (S_ISREG(st.st_mode)) {
+		const size_t len = strlen(path) + 1;
+		add_file(scan, (char *) memcpy(xrealloc(NULL, len), path, len));
+		return true;
+	}
+
+	if (!S_ISDIR(st.st_mode))
+		return true;
+
+	DIR *dir = opendir(path);
+
+	if (dir == NULL) {
+		fprintf(stderr, "mgrep: %s: %s\n", path, strerror(errno));
+		return false;
+	}
+
+	bool ok = true;
+	const size_t path_len = strlen(path);
+	struct dirent *ent;
+
+	while ((ent = readdir(dir)) != NULL) {
+		if (strcmp(ent->d_name, ".") == 0 ||
+		    strcmp(ent->d_name, "..") == 0)
+			continue;
+
+		const size_t len = path_len + strlen(ent->d_name) + 2;
+		char *child = (char *) xrealloc(NULL, len);
+		const bool slash = path_len > 0 && path[path_len - 1] == '/';
+
+		snprintf(child, len, "%s%s%s", path, slash ? "" : "/",
+			 ent->d_name);
+		ok = add_path(scan, child, false) && ok;
+		free(child);
+	}
+
+	closedir(dir);
+	return ok;
+}
+
+static int usage(void)
+{
+	fputs("usage: mgrep [-c | -o] [-i] [-n] [-j threads] regex [path...]\n",
+	      stderr);
+	return 2;
+}
+
+/* usage: mgrep [-c | -o] [-i] [-n] [-j threads] regex [path...]
+ * prints lines of the files matching regex, or the amount of matching
+ * lines with -c, or only the matches with -o. -i ignores case and -n
+ * adds line numbers.
+ * directories are searched recursively and files are searched on
+ * threads in parallel, stdin is searched if no path is given. exits with
+ * 0 if a line matched, 1 if none did and 2 on errors */
+int main(int argc, char **argv)
+{
+	Options opts;
+	memset(&opts, 0, sizeof(Options));
+	MRegexpOptions compile_opts;
+	memset(&compile_opts, 0, sizeof(MRegexpOptions));
+
+	long threads = sysconf(_SC_NPROCESSORS_ONLN);
+	int opt;
+
+	while ((opt = getopt(argc, argv, "cinoj:")) != -1) {
+		switch (opt) {
+		case 'c':
+			opts.mode = OUTPUT_COUNT;
+			break;
+		case 'i':
+			compile_opts.icase = true;
+			break;
+		case 'n':
+			opts.line_numbers = true;
+			break;
+		case 'o':
+			opts.mode = OUTPUT_ONLY_MATCHING;
+			break;
+		case 'j':
+			threads = strtol(optarg, NULL, 10);
+			break;
+		default:
+			return usage();
+		}
+	}
+
+	if (optind == argc)
+		return usage();
+
+	opts.pattern = argv[optind++];
+	opts.per_line = has_anchors(opts.pattern);
+
+	MRegexp *re = mregexp_compile_opts(opts.pattern, &compile_opts);
+
+	if (re == NULL) {
+		fprintf(stderr,
+			"mgrep: Invalid regular expression: Compile failed with error %d\n",
+			mregexp_error());
+		return 2;
+	}
+
+	Scan scan;
+	memset(&scan, 0, sizeof(Scan));
+	scan.opts = &opts;
+	scan.re = re;
+	pthread_mutex_init(&scan.lock, NULL);
+
+	bool ok = true;
+
+	if (optind == argc)
+		add_file(&scan, (char *) memcpy(xrealloc(NULL, 2), "-", 2));
+
+	for (int i = optind; i < argc; ++i) {
+		struct stat st;
+
+		if (argc - optind > 1 ||
+		    (stat(argv[i], &st) == 0 && S_ISDIR(st.st_mode)))
+			opts.show_names = true;
+
+		ok = add_path(&scan, argv[i], true) && ok;
+	}
+
+	if (threads < 1)
+		threads = 1;
+
+	if ((size_t) threads > scan.files_len)
+		threads = scan.files_len > 0 ? (long) scan.files_len : 1;
+
+	pthread_t *workers = (pthread_t *) xrealloc(NULL, (size_t) threads *
+							      sizeof(pthread_t));
+
+	for (long i = 0; i < threads; ++i)
+		pthread_create(&workers[i], NULL, worker, &scan);
+
+	for (long i = 0; i < threads; ++i)
+		pthread_join(workers[i], NULL);
+
+	bool matched = false;
+
+	for (size_t i = 0; i < scan.files_len; ++i) {
+		matched = matched || scan.files[i].matched;
+		ok = ok && !scan.files[i].failed;
+		free(scan.files[i].path);
+	}
+
+	free(scan.files);
+	free(workers);
+	mregexp_free(re);
+	pthread_mutex_destroy(&scan.lock);
+
+	if (!ok)
+		return 2;
+
+	return matched ? 0 : 1;
+}
@@ -104,12 +104,1638 @@ static inline const char *utf8_next(const char *s)
 	return s + width;
 }
 
+/* encode c as utf8 into out, which must have room for 4 bytes.
+ * returns the amount of bytes written */
+static inline unsigned utf8_encode(uint32_t c, char *out)
+{
+	if (c < 0x80) {
+		out[0] = (char)c;
+		return 1;
+	} else if (c < 0x800) {
+		out[0] = (char)(0xc0 | (c >> 6));
+		out[1] = (char)(0x80 | (c & 63));
+		return 2;
+	} else if (c < 0x10000) {
+		out[0] = (char)(0xe0 | (c >> 12));
+		out[1] = (char)(0x80 | ((c >> 6) & 63));
+		out[2] = (char)(0x80 | (c & 63));
+		return 3;
+	} else {
+		out[0] = (char)(0xf0 | ((c >> 18) & 7));
+		out[1] = (char)(0x80 | ((c >> 12) & 63));
+		out[2] = (char)(0x80 | ((c >> 6) & 63));
+		out[3] = (char)(0x80 | (c & 63));
+		return 4;
+	}
+}
+
+/* decoded value of bytes which are not valid utf8. never equal
+ * to a character of a compiled expression */
+#define INVALID_CHAR UINT32_MAX
+
+/* smallest character which may be encoded with a given width */
+static const uint32_t utf8_min_values[] = {0, 0, 0x80, 0x800, 0x10000};
+
+/* subject of a single match call. nodes only see byte offsets into
+ * subject, so the subject doesn't need to be NUL terminated */
+typedef struct MatchContext {
+	const char *subject;
+	size_t len;
+	/* capture slots written by capture groups, indexed by group number.
+	 * groups numbered caps_len or higher aren't recorded */
+	MRegexpMatch *caps;
+	size_t caps_len;
+	/* if not NULL, a set bit for each node of nodes whose repetitions
+	 * end every match, which then only has to be found, not extended */
+	const uint64_t *tails;
+	const union RegexNode *nodes;
+	/* offset of subject in the whole subject if it is a part of it.
+	 * ^ only matches at the beginning of the whole subject */
+	size_t base;
+	/* amount of capture slots written so far, which tells whether
+	 * a failed attempt left any behind */
+	size_t cap_writes;
+	/* counters of this call, published by publish_stats */
+	MRegexpStats stats;
+} MatchContext;
+
+static inline void init_context(MatchContext *ctx, MRegexpMatch *caps,
+				size_t caps_len, const char *subject,
+				size_t len)
+{
+	memset(ctx, 0, sizeof(MatchContext));
+	ctx->subject = subject;
+	ctx->len = len;
+	ctx->caps = caps;
+	ctx->caps_len = caps_len;
+}
+
+/* decode character at offset cur of the subject and store the offset
+ * of the following character in next. invalid or truncated sequences
+ * decode to INVALID_CHAR and are one byte wide */
+static inline uint32_t subject_peek(const MatchContext *ctx, size_t cur,
+				    size_t *next)
+{
+	const uint8_t *s = (const uint8_t *)ctx->subject + cur;
+
+	if (s[0] < 128) {
+		*next = cur + 1;
+		return s[0];
+	}
+
+	const unsigned width = utf8_char_width(s[0]);
+	*next = cur + 1;
+
+	if (width == 0 || width > ctx->len - cur)
+		return INVALID_CHAR;
+
+	uint32_t ret = s[0] & utf8_peek_mods[width];
+
+	for (unsigned i = 1; i < width; ++i) {
+		if ((s[i] & (128 + 64)) != 128)
+			return INVALID_CHAR;
+
+		ret <<= 6;
+		ret += s[i] & 63;
+	}
+
+	// overlong sequences would decode to characters whose
+	// encoding differs from the bytes in the subject
+	if (ret < utf8_min_values[width])
+		return INVALID_CHAR;
+
+	*next = cur + width;
+	return ret;
+}
+
+/* get the offset a search continues from behind an empty match at pos.
+ * the end of the subject is its last position */
+static inline size_t skip_empty_match(const MatchContext *ctx, size_t pos)
+{
+	size_t next = pos + 1;
+
+	if (pos < ctx->len)
+		subject_peek(ctx, pos, &next);
+
+	return next;
+}
+
+/* get the first character boundary at or after offset target. pos
+ * must be a character boundary before target */
+static inline size_t subject_boundary(const MatchContext *ctx, size_t pos,
+				      size_t target)
+{
+	size_t ret = target;
+
+	// a byte which isn't a continuation byte is always a boundary
+	while (ret > pos && (ctx->subject[ret] & (128 + 64)) == 128)
+		ret--;
+
+	while (ret < target)
+		subject_peek(ctx, ret, &ret);
+
+	return ret;
+}
+
+/* simple case folding of unicode. characters which are equal ignoring
+ * case form an orbit of up to four of them, and each entry maps the
+ * characters lo to hi to the next member of their orbit by adding delta */
+typedef struct {
+	uint32_t lo, hi;
+	int32_t delta;
+} FoldRange;
+
+/* delta of ranges made of pairs of an upper and a lower case character */
+#define FOLD_ALTERNATE INT32_MIN
+
+/* the unicode tables are generated by unicode_tables.py from the files
+ * CaseFolding.txt, UnicodeData.txt and Scripts.txt of unicode 14.0 */
+static const FoldRange fold_ranges[] = {
+	{0x41, 0x5a, 32}, {0x61, 0x6a, -32}, {0x6b, 0x6b, 8383},
+	{0x6c, 0x72, -32}, {0x73, 0x73, 268}, {0x74, 0x7a, -32},
+	{0xb5, 0xb5, 743}, {0xc0, 0xd6, 32}, {0xd8, 0xde, 32},
+	{0xdf, 0xdf, 7615}, {0xe0, 0xe4, -32}, {0xe5, 0xe5, 8262},
+	{0xe6, 0xf6, -32}, {0xf8, 0xfe, -32}, {0xff, 0xff, 121},
+	{0x100, 0x12f, FOLD_ALTERNATE}, {0x132, 0x137, FOLD_ALTERNATE},
+	{0x139, 0x148, FOLD_ALTERNATE}, {0x14a, 0x177, FOLD_ALTERNATE},
+	{0x178, 0x178, -121}, {0x179, 0x17e, FOLD_ALTERNATE},
+	{0x17f, 0x17f, -300}, {0x180, 0x180, 195}, {0x181, 0x181, 210},
+	{0x182, 0x185, FOLD_ALTERNATE}, {0x186, 0x186, 206},
+	{0x187, 0x188, FOLD_ALTERNATE}, {0x189, 0x18a, 205},
+	{0x18b, 0x18c, FOLD_ALTERNATE}, {0x18e, 0x18e, 79},
+	{0x18f, 0x18f, 202}, {0x190, 0x190, 203},
+	{0x191, 0x192, FOLD_ALTERNATE}, {0x193, 0x193, 205},
+	{0x194, 0x194, 207}, {0x195, 0x195, 97}, {0x196, 0x196, 211},
+	{0x197, 0x197, 209}, {0x198, 0x199, FOLD_ALTERNATE},
+	{0x19a, 0x19a, 163}, {0x19c, 0x19c, 211}, {0x19d, 0x19d, 213},
+	{0x19e, 0x19e, 130}, {0x19f, 0x19f, 214},
+	{0x1a0, 0x1a5, FOLD_ALTERNATE}, {0x1a6, 0x1a6, 218},
+	{0x1a7, 0x1a8, FOLD_ALTERNATE}, {0x1a9, 0x1a9, 218},
+	{0x1ac, 0x1ad, FOLD_ALTERNATE}, {0x1ae, 0x1ae, 218},
+	{0x1af, 0x1b0, FOLD_ALTERNATE}, {0x1b1, 0x1b2, 217},
+	{0x1b3, 0x1b6, FOLD_ALTERNATE}, {0x1b7, 0x1b7, 219},
+	{0x1b8, 0x1b9, FOLD_ALTERNATE}, {0x1bc, 0x1bd, FOLD_ALTERNATE},
+	{0x1bf, 0x1bf, 56}, {0x1c4, 0x1c5, 1}, {0x1c6, 0x1c6, -2},
+	{0x1c7, 0x1c8, 1}, {0x1c9, 0x1c9, -2}, {0x1ca, 0x1cb, 1},
+	{0x1cc, 0x1cc, -2}, {0x1cd, 0x1dc, FOLD_ALTERNATE},
+	{0x1dd, 0x1dd, -79}, {0x1de, 0x1ef, FOLD_ALTERNATE}, {0x1f1, 0x1f2, 1},
+	{0x1f3, 0x1f3, -2}, {0x1f4, 0x1f5, FOLD_ALTERNATE},
+	{0x1f6, 0x1f6, -97}, {0x1f7, 0x1f7, -56},
+	{0x1f8, 0x21f, FOLD_ALTERNATE}, {0x220, 0x220, -130},
+	{0x222, 0x233, FOLD_ALTERNATE}, {0x23a, 0x23a, 10795},
+	{0x23b, 0x23c, FOLD_ALTERNATE}, {0x23d, 0x23d, -163},
+	{0x23e, 0x23e, 10792}, {0x23f, 0x240, 10815},
+	{0x241, 0x242, FOLD_ALTERNATE}, {0x243, 0x243, -195},
+	{0x244, 0x244, 69}, {0x245, 0x245, 71}, {0x246, 0x24f, FOLD_ALTERNATE},
+	{0x250, 0x250, 10783}, {0x251, 0x251, 10780}, {0x252, 0x252, 10782},
+	{0x253, 0x253, -210}, {0x254, 0x254, -206}, {0x256, 0x257, -205},
+	{0x259, 0x259, -202}, {0x25b, 0x25b, -203}, {0x25c, 0x25c, 42319},
+	{0x260, 0x260, -205}, {0x261, 0x261, 42315}, {0x263, 0x263, -207},
+	{0x265, 0x265, 42280}, {0x266, 0x266, 42308}, {0x268, 0x268, -209},
+	{0x269, 0x269, -211}, {0x26a, 0x26a, 42308}, {0x26b, 0x26b, 10743},
+	{0x26c, 0x26c, 42305}, {0x26f, 0x26f, -211}, {0x271, 0x271, 10749},
+	{0x272, 0x272, -213}, {0x275, 0x275, -214}, {0x27d, 0x27d, 10727},
+	{0x280, 0x280, -218}, {0x282, 0x282, 42307}, {0x283, 0x283, -218},
+	{0x287, 0x287, 42282}, {0x288, 0x288, -218}, {0x289, 0x289, -69},
+	{0x28a, 0x28b, -217}, {0x28c, 0x28c, -71}, {0x292, 0x292, -219},
+	{0x29d, 0x29d, 42261}, {0x29e, 0x29e, 42258}, {0x345, 0x345, 84},
+	{0x370, 0x373, FOLD_ALTERNATE}, {0x376, 0x377, FOLD_ALTERNATE},
+	{0x37b, 0x37d, 130}, {0x37f, 0x37f, 116}, {0x386, 0x386, 38},
+	{0x388, 0x38a, 37}, {0x38c, 0x38c, 64}, {0x38e, 0x38f, 63},
+	{0x391, 0x3a1, 32}, {0x3a3, 0x3a3, 31}, {0x3a4, 0x3ab, 32},
+	{0x3ac, 0x3ac, -38}, {0x3ad, 0x3af, -37}, {0x3b1, 0x3b1, -32},
+	{0x3b2, 0x3b2, 30}, {0x3b3, 0x3b4, -32}, {0x3b5, 0x3b5, 64},
+	{0x3b6, 0x3b7, -32}, {0x3b8, 0x3b8, 25}, {0x3b9, 0x3b9, 7173},
+	{0x3ba, 0x3ba, 54}, {0x3bb, 0x3bb, -32}, {0x3bc, 0x3bc, -775},
+	{0x3bd, 0x3bf, -32}, {0x3c0, 0x3c0, 22}, {0x3c1, 0x3c1, 48},
+	{0x3c2, 0x3c2, 1}, {0x3c3, 0x3c5, -32}, {0x3c6, 0x3c6, 15},
+	{0x3c7, 0x3c8, -32}, {0x3c9, 0x3c9, 7517}, {0x3ca, 0x3cb, -32},
+	{0x3cc, 0x3cc, -64}, {0x3cd, 0x3ce, -63}, {0x3cf, 0x3cf, 8},
+	{0x3d0, 0x3d0, -62}, {0x3d1, 0x3d1, 35}, {0x3d5, 0x3d5, -47},
+	{0x3d6, 0x3d6, -54}, {0x3d7, 0x3d7, -8},
+	{0x3d8, 0x3ef, FOLD_ALTERNATE}, {0x3f0, 0x3f0, -86},
+	{0x3f1, 0x3f1, -80}, {0x3f2, 0x3f2, 7}, {0x3f3, 0x3f3, -116},
+	{0x3f4, 0x3f4, -92}, {0x3f5, 0x3f5, -96},
+	{0x3f7, 0x3f8, FOLD_ALTERNATE}, {0x3f9, 0x3f9, -7},
+	{0x3fa, 0x3fb, FOLD_ALTERNATE}, {0x3fd, 0x3ff, -130},
+	{0x400, 0x40f, 80}, {0x410, 0x42f, 32}, {0x430, 0x431, -32},
+	{0x432, 0x432, 6222}, {0x433, 0x433, -32}, {0x434, 0x434, 6221},
+	{0x435, 0x43d, -32}, {0x43e, 0x43e, 6212}, {0x43f, 0x440, -32},
+	{0x441, 0x442, 6210}, {0x443, 0x449, -32}, {0x44a, 0x44a, 6204},
+	{0x44b, 0x44f, -32}, {0x450, 0x45f, -80},
+	{0x460, 0x461, FOLD_ALTERNATE}, {0x462, 0x462, 1},
+	{0x463, 0x463, 6180}, {0x464, 0x481, FOLD_ALTERNATE},
+	{0x48a, 0x4bf, FOLD_ALTERNATE}, {0x4c0, 0x4c0, 15},
+	{0x4c1, 0x4ce, FOLD_ALTERNATE}, {0x4cf, 0x4cf, -15},
+	{0x4d0, 0x52f, FOLD_ALTERNATE}, {0x531, 0x556, 48},
+	{0x561, 0x586, -48}, {0x10a0, 0x10c5, 7264}, {0x10c7, 0x10c7, 7264},
+	{0x10cd, 0x10cd, 7264}, {0x10d0, 0x10fa, 3008}, {0x10fd, 0x10ff, 3008},
+	{0x13a0, 0x13ef, 38864}, {0x13f0, 0x13f5, 8}, {0x13f8, 0x13fd, -8},
+	{0x1c80, 0x1c80, -6254}, {0x1c81, 0x1c81, -6253},
+	{0x1c82, 0x1c82, -6244}, {0x1c83, 0x1c83, -6242}, {0x1c84, 0x1c84, 1},
+	{0x1c85, 0x1c85, -6243}, {0x1c86, 0x1c86, -6236},
+	{0x1c87, 0x1c87, -6181}, {0x1c88, 0x1c88, 35266},
+	{0x1c90, 0x1cba, -3008}, {0x1cbd, 0x1cbf, -3008},
+	{0x1d79, 0x1d79, 35332}, {0x1d7d, 0x1d7d, 3814},
+	{0x1d8e, 0x1d8e, 35384}, {0x1e00, 0x1e5f, FOLD_ALTERNATE},
+	{0x1e60, 0x1e60, 1}, {0x1e61, 0x1e61, 58},
+	{0x1e62, 0x1e95, FOLD_ALTERNATE}, {0x1e9b, 0x1e9b, -59},
+	{0x1e9e, 0x1e9e, -7615}, {0x1ea0, 0x1eff, FOLD_ALTERNATE},
+	{0x1f00, 0x1f07, 8}, {0x1f08, 0x1f0f, -8}, {0x1f10, 0x1f15, 8},
+	{0x1f18, 0x1f1d, -8}, {0x1f20, 0x1f27, 8}, {0x1f28, 0x1f2f, -8},
+	{0x1f30, 0x1f37, 8}, {0x1f38, 0x1f3f, -8}, {0x1f40, 0x1f45, 8},
+	{0x1f48, 0x1f4d, -8}, {0x1f51, 0x1f51, 8}, {0x1f53, 0x1f53, 8},
+	{0x1f55, 0x1f55, 8}, {0x1f57, 0x1f57, 8}, {0x1f59, 0x1f59, -8},
+	{0x1f5b, 0x1f5b, -8}, {0x1f5d, 0x1f5d, -8}, {0x1f5f, 0x1f5f, -8},
+	{0x1f60, 0x1f67, 8}, {0x1f68, 0x1f6f, -8}, {0x1f70, 0x1f71, 74},
+	{0x1f72, 0x1f75, 86}, {0x1f76, 0x1f77, 100}, {0x1f78, 0x1f79, 128},
+	{0x1f7a, 0x1f7b, 112}, {0x1f7c, 0x1f7d, 126}, {0x1f80, 0x1f87, 8},
+	{0x1f88, 0x1f8f, -8}, {0x1f90, 0x1f97, 8}, {0x1f98, 0x1f9f, -8},
+	{0x1fa0, 0x1fa7, 8}, {0x1fa8, 0x1faf, -8}, {0x1fb0, 0x1fb1, 8},
+	{0x1fb3, 0x1fb3, 9}, {0x1fb8, 0x1fb9, -8}, {0x1fba, 0x1fbb, -74},
+	{0x1fbc, 0x1fbc, -9}, {0x1fbe, 0x1fbe, -7289}, {0x1fc3, 0x1fc3, 9},
+	{0x1fc8, 0x1fcb, -86}, {0x1fcc, 0x1fcc, -9}, {0x1fd0, 0x1fd1, 8},
+	{0x1fd8, 0x1fd9, -8}, {0x1fda, 0x1fdb, -100}, {0x1fe0, 0x1fe1, 8},
+	{0x1fe5, 0x1fe5, 7}, {0x1fe8, 0x1fe9, -8}, {0x1fea, 0x1feb, -112},
+	{0x1fec, 0x1fec, -7}, {0x1ff3, 0x1ff3, 9}, {0x1ff8, 0x1ff9, -128},
+	{0x1ffa, 0x1ffb, -126}, {0x1ffc, 0x1ffc, -9}, {0x2126, 0x2126, -7549},
+	{0x212a, 0x212a, -8415}, {0x212b, 0x212b, -8294}, {0x2132, 0x2132, 28},
+	{0x214e, 0x214e, -28}, {0x2160, 0x216f, 16}, {0x2170, 0x217f, -16},
+	{0x2183, 0x2184, FOLD_ALTERNATE}, {0x24b6, 0x24cf, 26},
+	{0x24d0, 0x24e9, -26}, {0x2c00, 0x2c2f, 48}, {0x2c30, 0x2c5f, -48},
+	{0x2c60, 0x2c61, FOLD_ALTERNATE}, {0x2c62, 0x2c62, -10743},
+	{0x2c63, 0x2c63, -3814}, {0x2c64, 0x2c64, -10727},
+	{0x2c65, 0x2c65, -10795}, {0x2c66, 0x2c66, -10792},
+	{0x2c67, 0x2c6c, FOLD_ALTERNATE}, {0x2c6d, 0x2c6d, -10780},
+	{0x2c6e, 0x2c6e, -10749}, {0x2c6f, 0x2c6f, -10783},
+	{0x2c70, 0x2c70, -10782}, {0x2c72, 0x2c73, FOLD_ALTERNATE},
+	{0x2c75, 0x2c76, FOLD_ALTERNATE}, {0x2c7e, 0x2c7f, -10815},
+	{0x2c80, 0x2ce3, FOLD_ALTERNATE}, {0x2ceb, 0x2cee, FOLD_ALTERNATE},
+	{0x2cf2, 0x2cf3, FOLD_ALTERNATE}, {0x2d00, 0x2d25, -7264},
+	{0x2d27, 0x2d27, -7264}, {0x2d2d, 0x2d2d, -7264},
+	{0xa640, 0xa649, FOLD_ALTERNATE}, {0xa64a, 0xa64a, 1},
+	{0xa64b, 0xa64b, -35267}, {0xa64c, 0xa66d, FOLD_ALTERNATE},
+	{0xa680, 0xa69b, FOLD_ALTERNATE}, {0xa722, 0xa72f, FOLD_ALTERNATE},
+	{0xa732, 0xa76f, FOLD_ALTERNATE}, {0xa779, 0xa77c, FOLD_ALTERNATE},
+	{0xa77d, 0xa77d, -35332}, {0xa77e, 0xa787, FOLD_ALTERNATE},
+	{0xa78b, 0xa78c, FOLD_ALTERNATE}, {0xa78d, 0xa78d, -42280},
+	{0xa790, 0xa793, FOLD_ALTERNATE}, {0xa794, 0xa794, 48},
+	{0xa796, 0xa7a9, FOLD_ALTERNATE}, {0xa7aa, 0xa7aa, -42308},
+	{0xa7ab, 0xa7ab, -42319}, {0xa7ac, 0xa7ac, -42315},
+	{0xa7ad, 0xa7ad, -42305}, {0xa7ae, 0xa7ae, -42308},
+	{0xa7b0, 0xa7b0, -42258}, {0xa7b1, 0xa7b1, -42282},
+	{0xa7b2, 0xa7b2, -42261}, {0xa7b3, 0xa7b3, 928},
+	{0xa7b4, 0xa7c3, FOLD_ALTERNATE}, {0xa7c4, 0xa7c4, -48},
+	{0xa7c5, 0xa7c5, -42307}, {0xa7c6, 0xa7c6, -35384},
+	{0xa7c7, 0xa7ca, FOLD_ALTERNATE}, {0xa7d0, 0xa7d1, FOLD_ALTERNATE},
+	{0xa7d6, 0xa7d9, FOLD_ALTERNATE}, {0xa7f5, 0xa7f6, FOLD_ALTERNATE},
+	{0xab53, 0xab53, -928}, {0xab70, 0xabbf, -38864}, {0xff21, 0xff3a, 32},
+	{0xff41, 0xff5a, -32}, {0x10400, 0x10427, 40}, {0x10428, 0x1044f, -40},
+	{0x104b0, 0x104d3, 40}, {0x104d8, 0x104fb, -40},
+	{0x10570, 0x1057a, 39}, {0x1057c, 0x1058a, 39}, {0x1058c, 0x10592, 39},
+	{0x10594, 0x10595, 39}, {0x10597, 0x105a1, -39},
+	{0x105a3, 0x105b1, -39}, {0x105b3, 0x105b9, -39},
+	{0x105bb, 0x105bc, -39}, {0x10c80, 0x10cb2, 64},
+	{0x10cc0, 0x10cf2, -64}, {0x118a0, 0x118bf, 32},
+	{0x118c0, 0x118df, -32}, {0x16e40, 0x16e5f, 32},
+	{0x16e60, 0x16e7f, -32}, {0x1e900, 0x1e921, 34},
+	{0x1e922, 0x1e943, -34},
+};
+
+/* get the next member of the case orbit of c, c itself if it has none */
+static uint32_t fold_next(uint32_t c)
+{
+	size_t lo = 0, hi = sizeof(fold_ranges) / sizeof(*fold_ranges);
+
+	while (lo < hi) {
+		const size_t mid = lo + (hi - lo) / 2;
+		const FoldRange *range = &fold_ranges[mid];
+
+		if (c < range->lo) {
+			hi = mid;
+		} else if (c > range->hi) {
+			lo = mid + 1;
+		} else if (range->delta == FOLD_ALTERNATE) {
+			return (c - range->lo) % 2 == 0 ? c + 1 : c - 1;
+		} else {
+			return (uint32_t)((int64_t)c + range->delta);
+		}
+	}
+
+	return c;
+}
+
+/* get the smallest member of the case orbit of c, which
+ * stands for all of them in folded expressions */
+static uint32_t fold_char(uint32_t c)
+{
+	uint32_t ret = c;
+
+	for (uint32_t o = fold_next(c); o != c; o = fold_next(o))
+		ret = o < ret ? o : ret;
+
+	return ret;
+}
+
+/* check if all members of the case orbit of c are ascii */
+static bool fold_is_ascii(uint32_t c)
+{
+	for (uint32_t o = fold_next(c); o != c; o = fold_next(o))
+		if (o >= 128)
+			return false;
+
+	return c < 128;
+}
+
+static inline uint8_t ascii_lower(uint8_t c)
+{
+	return (uint8_t)(c - 'A') < 26 ? c | 0x20 : c;
+}
+
+static inline uint8_t ascii_upper(uint8_t c)
+{
+	return (uint8_t)(c - 'a') < 26 ? c & ~0x20 : c;
+}
+
+/* compare len bytes of s ignoring the case of ascii letters
+ * against lower, which is in lower case */
+static inline bool fold_memeq(const char *s, const char *lower, size_t len)
+{
+	for (size_t i = 0; i < len; ++i)
+		if (ascii_lower((uint8_t)s[i]) != (uint8_t)lower[i])
+			return false;
+
+	return true;
+}
+
+/* general categories of unicode. sets of them have a bit per category */
+enum {
+	CAT_CC, CAT_CF, CAT_CN, CAT_CO, CAT_CS, CAT_LL, CAT_LM, CAT_LO,
+	CAT_LT, CAT_LU, CAT_MC, CAT_ME, CAT_MN, CAT_ND, CAT_NL, CAT_NO,
+	CAT_PC, CAT_PD, CAT_PE, CAT_PF, CAT_PI, CAT_PO, CAT_PS, CAT_SC,
+	CAT_SK, CAT_SM, CAT_SO, CAT_ZL, CAT_ZP, CAT_ZS, CATEGORIES_LEN,
+};
+
+#define CATEGORY(cat) ((uint32_t)1 << (cat))
+#define ALL_CATEGORIES (CATEGORY(CATEGORIES_LEN) - 1)
+
+/* categories of \w in unicode mode: letters, marks, decimal
+ * numbers and connector punctuation */
+#define WORD_CATEGORIES                                                  \
+	(CATEGORY(CAT_LL) | CATEGORY(CAT_LM) | CATEGORY(CAT_LO) |        \
+	 CATEGORY(CAT_LT) | CATEGORY(CAT_LU) | CATEGORY(CAT_MC) |        \
+	 CATEGORY(CAT_ME) | CATEGORY(CAT_MN) | CATEGORY(CAT_ND) |        \
+	 CATEGORY(CAT_PC))
+
+/* categories of \s in unicode mode, along with a few controls */
+#define SPACE_CATEGORIES                                                 \
+	(CATEGORY(CAT_ZL) | CATEGORY(CAT_ZP) | CATEGORY(CAT_ZS))
+
+static const char category_names[CATEGORIES_LEN][3] = {
+	"Cc", "Cf", "Cn", "Co", "Cs", "Ll", "Lm", "Lo", "Lt", "Lu",
+	"Mc", "Me", "Mn", "Nd", "Nl", "No", "Pc", "Pd", "Pe", "Pf",
+	"Pi", "Po", "Ps", "Sc", "Sk", "Sm", "So", "Zl", "Zp", "Zs",
+};
+
+/* value of a unicode property from first up to the first of the next run */
+typedef struct {
+	uint32_t first;
+	uint8_t value;
+} PropertyRun;
+
+/* general category of all characters as indices into category_names,
+ * from UnicodeData.txt of unicode 14.0. characters after the last run
+ * are unassigned */
+static const PropertyRun category_runs[] = {
+	{0x0, 0}, {0x20, 29}, {0x21, 21}, {0x24, 23}, {0x25, 21}, {0x28, 22},
+	{0x29, 18}, {0x2a, 21}, {0x2b, 25}, {0x2c, 21}, {0x2d, 17}, {0x2e, 21},
+	{0x30, 13}, {0x3a, 21}, {0x3c, 25}, {0x3f, 21}, {0x41, 9}, {0x5b, 22},
+	{0x5c, 21}, {0x5d, 18}, {0x5e, 24}, {0x5f, 16}, {0x60, 24}, {0x61, 5},
+	{0x7b, 22}, {0x7c, 25}, {0x7d, 18}, {0x7e, 25}, {0x7f, 0}, {0xa0, 29},
+	{0xa1, 21}, {0xa2, 23}, {0xa6, 26}, {0xa7, 21}, {0xa8, 24}, {0xa9, 26},
+	{0xaa, 7}, {0xab, 20}, {0xac, 25}, {0xad, 1}, {0xae, 26}, {0xaf, 24},
+	{0xb0, 26}, {0xb1, 25}, {0xb2, 15}, {0xb4, 24}, {0xb5, 5}, {0xb6, 21},
+	{0xb8, 24}, {0xb9, 15}, {0xba, 7}, {0xbb, 19}, {0xbc, 15}, {0xbf, 21},
+	{0xc0, 9}, {0xd7, 25}, {0xd8, 9}, {0xdf, 5}, {0xf7, 25}, {0xf8, 5},
+	{0x100, 9}, {0x101, 5}, {0x102, 9}, {0x103, 5}, {0x104, 9}, {0x105, 5},
+	{0x106, 9}, {0x107, 5}, {0x108, 9}, {0x109, 5}, {0x10a, 9}, {0x10b, 5},
+	{0x10c, 9}, {0x10d, 5}, {0x10e, 9}, {0x10f, 5}, {0x110, 9}, {0x111, 5},
+	{0x112, 9}, {0x113, 5}, {0x114, 9}, {0x115, 5}, {0x116, 9}, {0x117, 5},
+	{0x118, 9}, {0x119, 5}, {0x11a, 9}, {0x11b, 5}, {0x11c, 9}, {0x11d, 5},
+	{0x11e, 9}, {0x11f, 5}, {0x120, 9}, {0x121, 5}, {0x122, 9}, {0x123, 5},
+	{0x124, 9}, {0x125, 5}, {0x126, 9}, {0x127, 5}, {0x128, 9}, {0x129, 5},
+	{0x12a, 9}, {0x12b, 5}, {0x12c, 9}, {0x12d, 5}, {0x12e, 9}, {0x12f, 5},
+	{0x130, 9}, {0x131, 5}, {0x132, 9}, {0x133, 5}, {0x134, 9}, {0x135, 5},
+	{0x136, 9}, {0x137, 5}, {0x139, 9}, {0x13a, 5}, {0x13b, 9}, {0x13c, 5},
+	{0x13d, 9}, {0x13e, 5}, {0x13f, 9}, {0x140, 5}, {0x141, 9}, {0x142, 5},
+	{0x143, 9}, {0x144, 5}, {0x145, 9}, {0x146, 5}, {0x147, 9}, {0x148, 5},
+	{0x14a, 9}, {0x14b, 5}, {0x14c, 9}, {0x14d, 5}, {0x14e, 9}, {0x14f, 5},
+	{0x150, 9}, {0x151, 5}, {0x152, 9}, {0x153, 5}, {0x154, 9}, {0x155, 5},
+	{0x156, 9}, {0x157, 5}, {0x158, 9}, {0x159, 5}, {0x15a, 9}, {0x15b, 5},
+	{0x15c, 9}, {0x15d, 5}, {0x15e, 9}, {0x15f, 5}, {0x160, 9}, {0x161, 5},
+	{0x162, 9}, {0x163, 5}, {0x164, 9}, {0x165, 5}, {0x166, 9}, {0x167, 5},
+	{0x168, 9}, {0x169, 5}, {0x16a, 9}, {0x16b, 5}, {0x16c, 9}, {0x16d, 5},
+	{0x16e, 9}, {0x16f, 5}, {0x170, 9}, {0x171, 5}, {0x172, 9}, {0x173, 5},
+	{0x174, 9}, {0x175, 5}, {0x176, 9}, {0x177, 5}, {0x178, 9}, {0x17a, 5},
+	{0x17b, 9}, {0x17c, 5}, {0x17d, 9}, {0x17e, 5}, {0x181, 9}, {0x183, 5},
+	{0x184, 9}, {0x185, 5}, {0x186, 9}, {0x188, 5}, {0x189, 9}, {0x18c, 5},
+	{0x18e, 9}, {0x192, 5}, {0x193, 9}, {0x195, 5}, {0x196, 9}, {0x199, 5},
+	{0x19c, 9}, {0x19e, 5}, {0x19f, 9}, {0x1a1, 5}, {0x1a2, 9}, {0x1a3, 5},
+	{0x1a4, 9}, {0x1a5, 5}, {0x1a6, 9}, {0x1a8, 5}, {0x1a9, 9}, {0x1aa, 5},
+	{0x1ac, 9}, {0x1ad, 5}, {0x1ae, 9}, {0x1b0, 5}, {0x1b1, 9}, {0x1b4, 5},
+	{0x1b5, 9}, {0x1b6, 5}, {0x1b7, 9}, {0x1b9, 5}, {0x1bb, 7}, {0x1bc, 9},
+	{0x1bd, 5}, {0x1c0, 7}, {0x1c4, 9}, {0x1c5, 8}, {0x1c6, 5}, {0x1c7, 9},
+	{0x1c8, 8}, {0x1c9, 5}, {0x1ca, 9}, {0x1cb, 8}, {0x1cc, 5}, {0x1cd, 9},
+	{0x1ce, 5}, {0x1cf, 9}, {0x1d0, 5}, {0x1d1, 9}, {0x1d2, 5}, {0x1d3, 9},
+	{0x1d4, 5}, {0x1d5, 9}, {0x1d6, 5}, {0x1d7, 9}, {0x1d8, 5}, {0x1d9, 9},
+	{0x1da, 5}, {0x1db, 9}, {0x1dc, 5}, {0x1de, 9}, {0x1df, 5}, {0x1e0, 9},
+	{0x1e1, 5}, {0x1e2, 9}, {0x1e3, 5}, {0x1e4, 9}, {0x1e5, 5}, {0x1e6, 9},
+	{0x1e7, 5}, {0x1e8, 9}, {0x1e9, 5}, {0x1ea, 9}, {0x1eb, 5}, {0x1ec, 9},
+	{0x1ed, 5}, {0x1ee, 9}, {0x1ef, 5}, {0x1f1, 9}, {0x1f2, 8}, {0x1f3, 5},
+	{0x1f4, 9}, {0x1f5, 5}, {0x1f6, 9}, {0x1f9, 5}, {0x1fa, 9}, {0x1fb, 5},
+	{0x1fc, 9}, {0x1fd, 5}, {0x1fe, 9}, {0x1ff, 5}, {0x200, 9}, {0x201, 5},
+	{0x202, 9}, {0x203, 5}, {0x204, 9}, {0x205, 5}, {0x206, 9}, {0x207, 5},
+	{0x208, 9}, {0x209, 5}, {0x20a, 9}, {0x20b, 5}, {0x20c, 9}, {0x20d, 5},
+	{0x20e, 9}, {0x20f, 5}, {0x210, 9}, {0x211, 5}, {0x212, 9}, {0x213, 5},
+	{0x214, 9}, {0x215, 5}, {0x216, 9}, {0x217, 5}, {0x218, 9}, {0x219, 5},
+	{0x21a, 9}, {0x21b, 5}, {0x21c, 9}, {0x21d, 5}, {0x21e, 9}, {0x21f, 5},
+	{0x220, 9}, {0x221, 5}, {0x222, 9}, {0x223, 5}, {0x224, 9}, {0x225, 5},
+	{0x226, 9}, {0x227, 5}, {0x228, 9}, {0x229, 5}, {0x22a, 9}, {0x22b, 5},
+	{0x22c, 9}, {0x22d, 5}, {0x22e, 9}, {0x22f, 5}, {0x230, 9}, {0x231, 5},
+	{0x232, 9}, {0x233, 5}, {0x23a, 9}, {0x23c, 5}, {0x23d, 9}, {0x23f, 5},
+	{0x241, 9}, {0x242, 5}, {0x243, 9}, {0x247, 5}, {0x248, 9}, {0x249, 5},
+	{0x24a, 9}, {0x24b, 5}, {0x24c, 9}, {0x24d, 5}, {0x24e, 9}, {0x24f, 5},
+	{0x294, 7}, {0x295, 5}, {0x2b0, 6}, {0x2c2, 24}, {0x2c6, 6},
+	{0x2d2, 24}, {0x2e0, 6}, {0x2e5, 24}, {0x2ec, 6}, {0x2ed, 24},
+	{0x2ee, 6}, {0x2ef, 24}, {0x300, 12}, {0x370, 9}, {0x371, 5},
+	{0x372, 9}, {0x373, 5}, {0x374, 6}, {0x375, 24}, {0x376, 9},
+	{0x377, 5}, {0x378, 2}, {0x37a, 6}, {0x37b, 5}, {0x37e, 21},
+	{0x37f, 9}, {0x380, 2}, {0x384, 24}, {0x386, 9}, {0x387, 21},
+	{0x388, 9}, {0x38b, 2}, {0x38c, 9}, {0x38d, 2}, {0x38e, 9}, {0x390, 5},
+	{0x391, 9}, {0x3a2, 2}, {0x3a3, 9}, {0x3ac, 5}, {0x3cf, 9}, {0x3d0, 5},
+	{0x3d2, 9}, {0x3d5, 5}, {0x3d8, 9}, {0x3d9, 5}, {0x3da, 9}, {0x3db, 5},
+	{0x3dc, 9}, {0x3dd, 5}, {0x3de, 9}, {0x3df, 5}, {0x3e0, 9}, {0x3e1, 5},
+	{0x3e2, 9}, {0x3e3, 5}, {0x3e4, 9}, {0x3e5, 5}, {0x3e6, 9}, {0x3e7, 5},
+	{0x3e8, 9}, {0x3e9, 5}, {0x3ea, 9}, {0x3eb, 5}, {0x3ec, 9}, {0x3ed, 5},
+	{0x3ee, 9}, {0x3ef, 5}, {0x3f4, 9}, {0x3f5, 5}, {0x3f6, 25},
+	{0x3f7, 9}, {0x3f8, 5}, {0x3f9, 9}, {0x3fb, 5}, {0x3fd, 9}, {0x430, 5},
+	{0x460, 9}, {0x461, 5}, {0x462, 9}, {0x463, 5}, {0x464, 9}, {0x465, 5},
+	{0x466, 9}, {0x467, 5}, {0x468, 9}, {0x469, 5}, {0x46a, 9}, {0x46b, 5},
+	{0x46c, 9}, {0x46d, 5}, {0x46e, 9}, {0x46f, 5}, {0x470, 9}, {0x471, 5},
+	{0x472, 9}, {0x473, 5}, {0x474, 9}, {0x475, 5}, {0x476, 9}, {0x477, 5},
+	{0x478, 9}, {0x479, 5}, {0x47a, 9}, {0x47b, 5}, {0x47c, 9}, {0x47d, 5},
+	{0x47e, 9}, {0x47f, 5}, {0x480, 9}, {0x481, 5}, {0x482, 26},
+	{0x483, 12}, {0x488, 11}, {0x48a, 9}, {0x48b, 5}, {0x48c, 9},
+	{0x48d, 5}, {0x48e, 9}, {0x48f, 5}, {0x490, 9}, {0x491, 5}, {0x492, 9},
+	{0x493, 5}, {0x494, 9}, {0x495, 5}, {0x496, 9}, {0x497, 5}, {0x498, 9},
+	{0x499, 5}, {0x49a, 9}, {0x49b, 5}, {0x49c, 9}, {0x49d, 5}, {0x49e, 9},
+	{0x49f, 5}, {0x4a0, 9}, {0x4a1, 5}, {0x4a2, 9}, {0x4a3, 5}, {0x4a4, 9},
+	{0x4a5, 5}, {0x4a6, 9}, {0x4a7, 5}, {0x4a8, 9}, {0x4a9, 5}, {0x4aa, 9},
+	{0x4ab, 5}, {0x4ac, 9}, {0x4ad, 5}, {0x4ae, 9}, {0x4af, 5}, {0x4b0, 9},
+	{0x4b1, 5}, {0x4b2, 9}, {0x4b3, 5}, {0x4b4, 9}, {0x4b5, 5}, {0x4b6, 9},
+	{0x4b7, 5}, {0x4b8, 9}, {0x4b9, 5}, {0x4ba, 9}, {0x4bb, 5}, {0x4bc, 9},
+	{0x4bd, 5}, {0x4be, 9}, {0x4bf, 5}, {0x4c0, 9}, {0x4c2, 5}, {0x4c3, 9},
+	{0x4c4, 5}, {0x4c5, 9}, {0x4c6, 5}, {0x4c7, 9}, {0x4c8, 5}, {0x4c9, 9},
+	{0x4ca, 5}, {0x4cb, 9}, {0x4cc, 5}, {0x4cd, 9}, {0x4ce, 5}, {0x4d0, 9},
+	{0x4d1, 5}, {0x4d2, 9}, {0x4d3, 5}, {0x4d4, 9}, {0x4d5, 5}, {0x4d6, 9},
+	{0x4d7, 5}, {0x4d8, 9}, {0x4d9, 5}, {0x4da, 9}, {0x4db, 5}, {0x4dc, 9},
+	{0x4dd, 5}, {0x4de, 9}, {0x4df, 5}, {0x4e0, 9}, {0x4e1, 5}, {0x4e2, 9},
+	{0x4e3, 5}, {0x4e4, 9}, {0x4e5, 5}, {0x4e6, 9}, {0x4e7, 5}, {0x4e8, 9},
+	{0x4e9, 5}, {0x4ea, 9}, {0x4eb, 5}, {0x4ec, 9}, {0x4ed, 5}, {0x4ee, 9},
+	{0x4ef, 5}, {0x4f0, 9}, {0x4f1, 5}, {0x4f2, 9}, {0x4f3, 5}, {0x4f4, 9},
+	{0x4f5, 5}, {0x4f6, 9}, {0x4f7, 5}, {0x4f8, 9}, {0x4f9, 5}, {0x4fa, 9},
+	{0x4fb, 5}, {0x4fc, 9}, {0x4fd, 5}, {0x4fe, 9}, {0x4ff, 5}, {0x500, 9},
+	{0x501, 5}, {0x502, 9}, {0x503, 5}, {0x504, 9}, {0x505, 5}, {0x506, 9},
+	{0x507, 5}, {0x508, 9}, {0x509, 5}, {0x50a, 9}, {0x50b, 5}, {0x50c, 9},
+	{0x50d, 5}, {0x50e, 9}, {0x50f, 5}, {0x510, 9}, {0x511, 5}, {0x512, 9},
+	{0x513, 5}, {0x514, 9}, {0x515, 5}, {0x516, 9}, {0x517, 5}, {0x518, 9},
+	{0x519, 5}, {0x51a, 9}, {0x51b, 5}, {0x51c, 9}, {0x51d, 5}, {0x51e, 9},
+	{0x51f, 5}, {0x520, 9}, {0x521, 5}, {0x522, 9}, {0x523, 5}, {0x524, 9},
+	{0x525, 5}, {0x526, 9}, {0x527, 5}, {0x528, 9}, {0x529, 5}, {0x52a, 9},
+	{0x52b, 5}, {0x52c, 9}, {0x52d, 5}, {0x52e, 9}, {0x52f, 5}, {0x530, 2},
+	{0x531, 9}, {0x557, 2}, {0x559, 6}, {0x55a, 21}, {0x560, 5},
+	{0x589, 21}, {0x58a, 17}, {0x58b, 2}, {0x58d, 26}, {0x58f, 23},
+	{0x590, 2}, {0x591, 12}, {0x5be, 17}, {0x5bf, 12}, {0x5c0, 21},
+	{0x5c1, 12}, {0x5c3, 21}, {0x5c4, 12}, {0x5c6, 21}, {0x5c7, 12},
+	{0x5c8, 2}, {0x5d0, 7}, {0x5eb, 2}, {0x5ef, 7}, {0x5f3, 21},
+	{0x5f5, 2}, {0x600, 1}, {0x606, 25}, {0x609, 21}, {0x60b, 23},
+	{0x60c, 21}, {0x60e, 26}, {0x610, 12}, {0x61b, 21}, {0x61c, 1},
+	{0x61d, 21}, {0x620, 7}, {0x640, 6}, {0x641, 7}, {0x64b, 12},
+	{0x660, 13}, {0x66a, 21}, {0x66e, 7}, {0x670, 12}, {0x671, 7},
+	{0x6d4, 21}, {0x6d5, 7}, {0x6d6, 12}, {0x6dd, 1}, {0x6de, 26},
+	{0x6df, 12}, {0x6e5, 6}, {0x6e7, 12}, {0x6e9, 26}, {0x6ea, 12},
+	{0x6ee, 7}, {0x6f0, 13}, {0x6fa, 7}, {0x6fd, 26}, {0x6ff, 7},
+	{0x700, 21}, {0x70e, 2}, {0x70f, 1}, {0x710, 7}, {0x711, 12},
+	{0x712, 7}, {0x730, 12}, {0x74b, 2}, {0x74d, 7}, {0x7a6, 12},
+	{0x7b1, 7}, {0x7b2, 2}, {0x7c0, 13}, {0x7ca, 7}, {0x7eb, 12},
+	{0x7f4, 6}, {0x7f6, 26}, {0x7f7, 21}, {0x7fa, 6}, {0x7fb, 2},
+	{0x7fd, 12}, {0x7fe, 23}, {0x800, 7}, {0x816, 12}, {0x81a, 6},
+	{0x81b, 12}, {0x824, 6}, {0x825, 12}, {0x828, 6}, {0x829, 12},
+	{0x82e, 2}, {0x830, 21}, {0x83f, 2}, {0x840, 7}, {0x859, 12},
+	{0x85c, 2}, {0x85e, 21}, {0x85f, 2}, {0x860, 7}, {0x86b, 2},
+	{0x870, 7}, {0x888, 24}, {0x889, 7}, {0x88f, 2}, {0x890, 1},
+	{0x892, 2}, {0x898, 12}, {0x8a0, 7}, {0x8c9, 6}, {0x8ca, 12},
+	{0x8e2, 1}, {0x8e3, 12}, {0x903, 10}, {0x904, 7}, {0x93a, 12},
+	{0x93b, 10}, {0x93c, 12}, {0x93d, 7}, {0x93e, 10}, {0x941, 12},
+	{0x949, 10}, {0x94d, 12}, {0x94e, 10}, {0x950, 7}, {0x951, 12},
+	{0x958, 7}, {0x962, 12}, {0x964, 21}, {0x966, 13}, {0x970, 21},
+	{0x971, 6}, {0x972, 7}, {0x981, 12}, {0x982, 10}, {0x984, 2},
+	{0x985, 7}, {0x98d, 2}, {0x98f, 7}, {0x991, 2}, {0x993, 7}, {0x9a9, 2},
+	{0x9aa, 7}, {0x9b1, 2}, {0x9b2, 7}, {0x9b3, 2}, {0x9b6, 7}, {0x9ba, 2},
+	{0x9bc, 12}, {0x9bd, 7}, {0x9be, 10}, {0x9c1, 12}, {0x9c5, 2},
+	{0x9c7, 10}, {0x9c9, 2}, {0x9cb, 10}, {0x9cd, 12}, {0x9ce, 7},
+	{0x9cf, 2}, {0x9d7, 10}, {0x9d8, 2}, {0x9dc, 7}, {0x9de, 2},
+	{0x9df, 7}, {0x9e2, 12}, {0x9e4, 2}, {0x9e6, 13}, {0x9f0, 7},
+	{0x9f2, 23}, {0x9f4, 15}, {0x9fa, 26}, {0x9fb, 23}, {0x9fc, 7},
+	{0x9fd, 21}, {0x9fe, 12}, {0x9ff, 2}, {0xa01, 12}, {0xa03, 10},
+	{0xa04, 2}, {0xa05, 7}, {0xa0b, 2}, {0xa0f, 7}, {0xa11, 2}, {0xa13, 7},
+	{0xa29, 2}, {0xa2a, 7}, {0xa31, 2}, {0xa32, 7}, {0xa34, 2}, {0xa35, 7},
+	{0xa37, 2}, {0xa38, 7}, {0xa3a, 2}, {0xa3c, 12}, {0xa3d, 2},
+	{0xa3e, 10}, {0xa41, 12}, {0xa43, 2}, {0xa47, 12}, {0xa49, 2},
+	{0xa4b, 12}, {0xa4e, 2}, {0xa51, 12}, {0xa52, 2}, {0xa59, 7},
+	{0xa5d, 2}, {0xa5e, 7}, {0xa5f, 2}, {0xa66, 13}, {0xa70, 12},
+	{0xa72, 7}, {0xa75, 12}, {0xa76, 21}, {0xa77, 2}, {0xa81, 12},
+	{0xa83, 10}, {0xa84, 2}, {0xa85, 7}, {0xa8e, 2}, {0xa8f, 7},
+	{0xa92, 2}, {0xa93, 7}, {0xaa9, 2}, {0xaaa, 7}, {0xab1, 2}, {0xab2, 7},
+	{0xab4, 2}, {0xab5, 7}, {0xaba, 2}, {0xabc, 12}, {0xabd, 7},
+	{0xabe, 10}, {0xac1, 12}, {0xac6, 2}, {0xac7, 12}, {0xac9, 10},
+	{0xaca, 2}, {0xacb, 10}, {0xacd, 12}, {0xace, 2}, {0xad0, 7},
+	{0xad1, 2}, {0xae0, 7}, {0xae2, 12}, {0xae4, 2}, {0xae6, 13},
+	{0xaf0, 21}, {0xaf1, 23}, {0xaf2, 2}, {0xaf9, 7}, {0xafa, 12},
+	{0xb00, 2}, {0xb01, 12}, {0xb02, 10}, {0xb04, 2}, {0xb05, 7},
+	{0xb0d, 2}, {0xb0f, 7}, {0xb11, 2}, {0xb13, 7}, {0xb29, 2}, {0xb2a, 7},
+	{0xb31, 2}, {0xb32, 7}, {0xb34, 2}, {0xb35, 7}, {0xb3a, 2},
+	{0xb3c, 12}, {0xb3d, 7}, {0xb3e, 10}, {0xb3f, 12}, {0xb40, 10},
+	{0xb41, 12}, {0xb45, 2}, {0xb47, 10}, {0xb49, 2}, {0xb4b, 10},
+	{0xb4d, 12}, {0xb4e, 2}, {0xb55, 12}, {0xb57, 10}, {0xb58, 2},
+	{0xb5c, 7}, {0xb5e, 2}, {0xb5f, 7}, {0xb62, 12}, {0xb64, 2},
+	{0xb66, 13}, {0xb70, 26}, {0xb71, 7}, {0xb72, 15}, {0xb78, 2},
+	{0xb82, 12}, {0xb83, 7}, {0xb84, 2}, {0xb85, 7}, {0xb8b, 2},
+	{0xb8e, 7}, {0xb91, 2}, {0xb92, 7}, {0xb96, 2}, {0xb99, 7}, {0xb9b, 2},
+	{0xb9c, 7}, {0xb9d, 2}, {0xb9e, 7}, {0xba0, 2}, {0xba3, 7}, {0xba5, 2},
+	{0xba8, 7}, {0xbab, 2}, {0xbae, 7}, {0xbba, 2}, {0xbbe, 10},
+	{0xbc0, 12}, {0xbc1, 10}, {0xbc3, 2}, {0xbc6, 10}, {0xbc9, 2},
+	{0xbca, 10}, {0xbcd, 12}, {0xbce, 2}, {0xbd0, 7}, {0xbd1, 2},
+	{0xbd7, 10}, {0xbd8, 2}, {0xbe6, 13}, {0xbf0, 15}, {0xbf3, 26},
+	{0xbf9, 23}, {0xbfa, 26}, {0xbfb, 2}, {0xc00, 12}, {0xc01, 10},
+	{0xc04, 12}, {0xc05, 7}, {0xc0d, 2}, {0xc0e, 7}, {0xc11, 2},
+	{0xc12, 7}, {0xc29, 2}, {0xc2a, 7}, {0xc3a, 2}, {0xc3c, 12},
+	{0xc3d, 7}, {0xc3e, 12}, {0xc41, 10}, {0xc45, 2}, {0xc46, 12},
+	{0xc49, 2}, {0xc4a, 12}, {0xc4e, 2}, {0xc55, 12}, {0xc57, 2},
+	{0xc58, 7}, {0xc5b, 2}, {0xc5d, 7}, {0xc5e, 2}, {0xc60, 7},
+	{0xc62, 12}, {0xc64, 2}, {0xc66, 13}, {0xc70, 2}, {0xc77, 21},
+	{0xc78, 15}, {0xc7f, 26}, {0xc80, 7}, {0xc81, 12}, {0xc82, 10},
+	{0xc84, 21}, {0xc85, 7}, {0xc8d, 2}, {0xc8e, 7}, {0xc91, 2},
+	{0xc92, 7}, {0xca9, 2}, {0xcaa, 7}, {0xcb4, 2}, {0xcb5, 7}, {0xcba, 2},
+	{0xcbc, 12}, {0xcbd, 7}, {0xcbe, 10}, {0xcbf, 12}, {0xcc0, 10},
+	{0xcc5, 2}, {0xcc6, 12}, {0xcc7, 10}, {0xcc9, 2}, {0xcca, 10},
+	{0xccc, 12}, {0xcce, 2}, {0xcd5, 10}, {0xcd7, 2}, {0xcdd, 7},
+	{0xcdf, 2}, {0xce0, 7}, {0xce2, 12}, {0xce4, 2}, {0xce6, 13},
+	{0xcf0, 2}, {0xcf1, 7}, {0xcf3, 2}, {0xd00, 12}, {0xd02, 10},
+	{0xd04, 7}, {0xd0d, 2}, {0xd0e, 7}, {0xd11, 2}, {0xd12, 7},
+	{0xd3b, 12}, {0xd3d, 7}, {0xd3e, 10}, {0xd41, 12}, {0xd45, 2},
+	{0xd46, 10}, {0xd49, 2}, {0xd4a, 10}, {0xd4d, 12}, {0xd4e, 7},
+	{0xd4f, 26}, {0xd50, 2}, {0xd54, 7}, {0xd57, 10}, {0xd58, 15},
+	{0xd5f, 7}, {0xd62, 12}, {0xd64, 2}, {0xd66, 13}, {0xd70, 15},
+	{0xd79, 26}, {0xd7a, 7}, {0xd80, 2}, {0xd81, 12}, {0xd82, 10},
+	{0xd84, 2}, {0xd85, 7}, {0xd97, 2}, {0xd9a, 7}, {0xdb2, 2}, {0xdb3, 7},
+	{0xdbc, 2}, {0xdbd, 7}, {0xdbe, 2}, {0xdc0, 7}, {0xdc7, 2},
+	{0xdca, 12}, {0xdcb, 2}, {0xdcf, 10}, {0xdd2, 12}, {0xdd5, 2},
+	{0xdd6, 12}, {0xdd7, 2}, {0xdd8, 10}, {0xde0, 2}, {0xde6, 13},
+	{0xdf0, 2}, {0xdf2, 10}, {0xdf4, 21}, {0xdf5, 2}, {0xe01, 7},
+	{0xe31, 12}, {0xe32, 7}, {0xe34, 12}, {0xe3b, 2}, {0xe3f, 23},
+	{0xe40, 7}, {0xe46, 6}, {0xe47, 12}, {0xe4f, 21}, {0xe50, 13},
+	{0xe5a, 21}, {0xe5c, 2}, {0xe81, 7}, {0xe83, 2}, {0xe84, 7},
+	{0xe85, 2}, {0xe86, 7}, {0xe8b, 2}, {0xe8c, 7}, {0xea4, 2}, {0xea5, 7},
+	{0xea6, 2}, {0xea7, 7}, {0xeb1, 12}, {0xeb2, 7}, {0xeb4, 12},
+	{0xebd, 7}, {0xebe, 2}, {0xec0, 7}, {0xec5, 2}, {0xec6, 6}, {0xec7, 2},
+	{0xec8, 12}, {0xece, 2}, {0xed0, 13}, {0xeda, 2}, {0xedc, 7},
+	{0xee0, 2}, {0xf00, 7}, {0xf01, 26}, {0xf04, 21}, {0xf13, 26},
+	{0xf14, 21}, {0xf15, 26}, {0xf18, 12}, {0xf1a, 26}, {0xf20, 13},
+	{0xf2a, 15}, {0xf34, 26}, {0xf35, 12}, {0xf36, 26}, {0xf37, 12},
+	{0xf38, 26}, {0xf39, 12}, {0xf3a, 22}, {0xf3b, 18}, {0xf3c, 22},
+	{0xf3d, 18}, {0xf3e, 10}, {0xf40, 7}, {0xf48, 2}, {0xf49, 7},
+	{0xf6d, 2}, {0xf71, 12}, {0xf7f, 10}, {0xf80, 12}, {0xf85, 21},
+	{0xf86, 12}, {0xf88, 7}, {0xf8d, 12}, {0xf98, 2}, {0xf99, 12},
+	{0xfbd, 2}, {0xfbe, 26}, {0xfc6, 12}, {0xfc7, 26}, {0xfcd, 2},
+	{0xfce, 26}, {0xfd0, 21}, {0xfd5, 26}, {0xfd9, 21}, {0xfdb, 2},
+	{0x1000, 7}, {0x102b, 10}, {0x102d, 12}, {0x1031, 10}, {0x1032, 12},
+	{0x1038, 10}, {0x1039, 12}, {0x103b, 10}, {0x103d, 12}, {0x103f, 7},
+	{0x1040, 13}, {0x104a, 21}, {0x1050, 7}, {0x1056, 10}, {0x1058, 12},
+	{0x105a, 7}, {0x105e, 12}, {0x1061, 7}, {0x1062, 10}, {0x1065, 7},
+	{0x1067, 10}, {0x106e, 7}, {0x1071, 12}, {0x1075, 7}, {0x1082, 12},
+	{0x1083, 10}, {0x1085, 12}, {0x1087, 10}, {0x108d, 12}, {0x108e, 7},
+	{0x108f, 10}, {0x1090, 13}, {0x109a, 10}, {0x109d, 12}, {0x109e, 26},
+	{0x10a0, 9}, {0x10c6, 2}, {0x10c7, 9}, {0x10c8, 2}, {0x10cd, 9},
+	{0x10ce, 2}, {0x10d0, 5}, {0x10fb, 21}, {0x10fc, 6}, {0x10fd, 5},
+	{0x1100, 7}, {0x1249, 2}, {0x124a, 7}, {0x124e, 2}, {0x1250, 7},
+	{0x1257, 2}, {0x1258, 7}, {0x1259, 2}, {0x125a, 7}, {0x125e, 2},
+	{0x1260, 7}, {0x1289, 2}, {0x128a, 7}, {0x128e, 2}, {0x1290, 7},
+	{0x12b1, 2}, {0x12b2, 7}, {0x12b6, 2}, {0x12b8, 7}, {0x12bf, 2},
+	{0x12c0, 7}, {0x12c1, 2}, {0x12c2, 7}, {0x12c6, 2}, {0x12c8, 7},
+	{0x12d7, 2}, {0x12d8, 7}, {0x1311, 2}, {0x1312, 7}, {0x1316, 2},
+	{0x1318, 7}, {0x135b, 2}, {0x135d, 12}, {0x1360, 21}, {0x1369, 15},
+	{0x137d, 2}, {0x1380, 7}, {0x1390, 26}, {0x139a, 2}, {0x13a0, 9},
+	{0x13f6, 2}, {0x13f8, 5}, {0x13fe, 2}, {0x1400, 17}, {0x1401, 7},
+	{0x166d, 26}, {0x166e, 21}, {0x166f, 7}, {0x1680, 29}, {0x1681, 7},
+	{0x169b, 22}, {0x169c, 18}, {0x169d, 2}, {0x16a0, 7}, {0x16eb, 21},
+	{0x16ee, 14}, {0x16f1, 7}, {0x16f9, 2}, {0x1700, 7}, {0x1712, 12},
+	{0x1715, 10}, {0x1716, 2}, {0x171f, 7}, {0x1732, 12}, {0x1734, 10},
+	{0x1735, 21}, {0x1737, 2}, {0x1740, 7}, {0x1752, 12}, {0x1754, 2},
+	{0x1760, 7}, {0x176d, 2}, {0x176e, 7}, {0x1771, 2}, {0x1772, 12},
+	{0x1774, 2}, {0x1780, 7}, {0x17b4, 12}, {0x17b6, 10}, {0x17b7, 12},
+	{0x17be, 10}, {0x17c6, 12}, {0x17c7, 10}, {0x17c9, 12}, {0x17d4, 21},
+	{0x17d7, 6}, {0x17d8, 21}, {0x17db, 23}, {0x17dc, 7}, {0x17dd, 12},
+	{0x17de, 2}, {0x17e0, 13}, {0x17ea, 2}, {0x17f0, 15}, {0x17fa, 2},
+	{0x1800, 21}, {0x1806, 17}, {0x1807, 21}, {0x180b, 12}, {0x180e, 1},
+	{0x180f, 12}, {0x1810, 13}, {0x181a, 2}, {0x1820, 7}, {0x1843, 6},
+	{0x1844, 7}, {0x1879, 2}, {0x1880, 7}, {0x1885, 12}, {0x1887, 7},
+	{0x18a9, 12}, {0x18aa, 7}, {0x18ab, 2}, {0x18b0, 7}, {0x18f6, 2},
+	{0x1900, 7}, {0x191f, 2}, {0x1920, 12}, {0x1923, 10}, {0x1927, 12},
+	{0x1929, 10}, {0x192c, 2}, {0x1930, 10}, {0x1932, 12}, {0x1933, 10},
+	{0x1939, 12}, {0x193c, 2}, {0x1940, 26}, {0x1941, 2}, {0x1944, 21},
+	{0x1946, 13}, {0x1950, 7}, {0x196e, 2}, {0x1970, 7}, {0x1975, 2},
+	{0x1980, 7}, {0x19ac, 2}, {0x19b0, 7}, {0x19ca, 2}, {0x19d0, 13},
+	{0x19da, 15}, {0x19db, 2}, {0x19de, 26}, {0x1a00, 7}, {0x1a17, 12},
+	{0x1a19, 10}, {0x1a1b, 12}, {0x1a1c, 2}, {0x1a1e, 21}, {0x1a20, 7},
+	{0x1a55, 10}, {0x1a56, 12}, {0x1a57, 10}, {0x1a58, 12}, {0x1a5f, 2},
+	{0x1a60, 12}, {0x1a61, 10}, {0x1a62, 12}, {0x1a63, 10}, {0x1a65, 12},
+	{0x1a6d, 10}, {0x1a73, 12}, {0x1a7d, 2}, {0x1a7f, 12}, {0x1a80, 13},
+	{0x1a8a, 2}, {0x1a90, 13}, {0x1a9a, 2}, {0x1aa0, 21}, {0x1aa7, 6},
+	{0x1aa8, 21}, {0x1aae, 2}, {0x1ab0, 12}, {0x1abe, 11}, {0x1abf, 12},
+	{0x1acf, 2}, {0x1b00, 12}, {0x1b04, 10}, {0x1b05, 7}, {0x1b34, 12},
+	{0x1b35, 10}, {0x1b36, 12}, {0x1b3b, 10}, {0x1b3c, 12}, {0x1b3d, 10},
+	{0x1b42, 12}, {0x1b43, 10}, {0x1b45, 7}, {0x1b4d, 2}, {0x1b50, 13},
+	{0x1b5a, 21}, {0x1b61, 26}, {0x1b6b, 12}, {0x1b74, 26}, {0x1b7d, 21},
+	{0x1b7f, 2}, {0x1b80, 12}, {0x1b82, 10}, {0x1b83, 7}, {0x1ba1, 10},
+	{0x1ba2, 12}, {0x1ba6, 10}, {0x1ba8, 12}, {0x1baa, 10}, {0x1bab, 12},
+	{0x1bae, 7}, {0x1bb0, 13}, {0x1bba, 7}, {0x1be6, 12}, {0x1be7, 10},
+	{0x1be8, 12}, {0x1bea, 10}, {0x1bed, 12}, {0x1bee, 10}, {0x1bef, 12},
+	{0x1bf2, 10}, {0x1bf4, 2}, {0x1bfc, 21}, {0x1c00, 7}, {0x1c24, 10},
+	{0x1c2c, 12}, {0x1c34, 10}, {0x1c36, 12}, {0x1c38, 2}, {0x1c3b, 21},
+	{0x1c40, 13}, {0x1c4a, 2}, {0x1c4d, 7}, {0x1c50, 13}, {0x1c5a, 7},
+	{0x1c78, 6}, {0x1c7e, 21}, {0x1c80, 5}, {0x1c89, 2}, {0x1c90, 9},
+	{0x1cbb, 2}, {0x1cbd, 9}, {0x1cc0, 21}, {0x1cc8, 2}, {0x1cd0, 12},
+	{0x1cd3, 21}, {0x1cd4, 12}, {0x1ce1, 10}, {0x1ce2, 12}, {0x1ce9, 7},
+	{0x1ced, 12}, {0x1cee, 7}, {0x1cf4, 12}, {0x1cf5, 7}, {0x1cf7, 10},
+	{0x1cf8, 12}, {0x1cfa, 7}, {0x1cfb, 2}, {0x1d00, 5}, {0x1d2c, 6},
+	{0x1d6b, 5}, {0x1d78, 6}, {0x1d79, 5}, {0x1d9b, 6}, {0x1dc0, 12},
+	{0x1e00, 9}, {0x1e01, 5}, {0x1e02, 9}, {0x1e03, 5}, {0x1e04, 9},
+	{0x1e05, 5}, {0x1e06, 9}, {0x1e07, 5}, {0x1e08, 9}, {0x1e09, 5},
+	{0x1e0a, 9}, {0x1e0b, 5}, {0x1e0c, 9}, {0x1e0d, 5}, {0x1e0e, 9},
+	{0x1e0f, 5}, {0x1e10, 9}, {0x1e11, 5}, {0x1e12, 9}, {0x1e13, 5},
+	{0x1e14, 9}, {0x1e15, 5}, {0x1e16, 9}, {0x1e17, 5}, {0x1e18, 9},
+	{0x1e19, 5}, {0x1e1a, 9}, {0x1e1b, 5}, {0x1e1c, 9}, {0x1e1d, 5},
+	{0x1e1e, 9}, {0x1e1f, 5}, {0x1e20, 9}, {0x1e21, 5}, {0x1e22, 9},
+	{0x1e23, 5}, {0x1e24, 9}, {0x1e25, 5}, {0x1e26, 9}, {0x1e27, 5},
+	{0x1e28, 9}, {0x1e29, 5}, {0x1e2a, 9}, {0x1e2b, 5}, {0x1e2c, 9},
+	{0x1e2d, 5}, {0x1e2e, 9}, {0x1e2f, 5}, {0x1e30, 9}, {0x1e31, 5},
+	{0x1e32, 9}, {0x1e33, 5}, {0x1e34, 9}, {0x1e35, 5}, {0x1e36, 9},
+	{0x1e37, 5}, {0x1e38, 9}, {0x1e39, 5}, {0x1e3a, 9}, {0x1e3b, 5},
+	{0x1e3c, 9}, {0x1e3d, 5}, {0x1e3e, 9}, {0x1e3f, 5}, {0x1e40, 9},
+	{0x1e41, 5}, {0x1e42, 9}, {0x1e43, 5}, {0x1e44, 9}, {0x1e45, 5},
+	{0x1e46, 9}, {0x1e47, 5}, {0x1e48, 9}, {0x1e49, 5}, {0x1e4a, 9},
+	{0x1e4b, 5}, {0x1e4c, 9}, {0x1e4d, 5}, {0x1e4e, 9}, {0x1e4f, 5},
+	{0x1e50, 9}, {0x1e51, 5}, {0x1e52, 9}, {0x1e53, 5}, {0x1e54, 9},
+	{0x1e55, 5}, {0x1e56, 9}, {0x1e57, 5}, {0x1e58, 9}, {0x1e59, 5},
+	{0x1e5a, 9}, {0x1e5b, 5}, {0x1e5c, 9}, {0x1e5d, 5}, {0x1e5e, 9},
+	{0x1e5f, 5}, {0x1e60, 9}, {0x1e61, 5}, {0x1e62, 9}, {0x1e63, 5},
+	{0x1e64, 9}, {0x1e65, 5}, {0x1e66, 9}, {0x1e67, 5}, {0x1e68, 9},
+	{0x1e69, 5}, {0x1e6a, 9}, {0x1e6b, 5}, {0x1e6c, 9}, {0x1e6d, 5},
+	{0x1e6e, 9}, {0x1e6f, 5}, {0x1e70, 9}, {0x1e71, 5}, {0x1e72, 9},
+	{0x1e73, 5}, {0x1e74, 9}, {0x1e75, 5}, {0x1e76, 9}, {0x1e77, 5},
+	{0x1e78, 9}, {0x1e79, 5}, {0x1e7a, 9}, {0x1e7b, 5}, {0x1e7c, 9},
+	{0x1e7d, 5}, {0x1e7e, 9}, {0x1e7f, 5}, {0x1e80, 9}, {0x1e81, 5},
+	{0x1e82, 9}, {0x1e83, 5}, {0x1e84, 9}, {0x1e85, 5}, {0x1e86, 9},
+	{0x1e87, 5}, {0x1e88, 9}, {0x1e89, 5}, {0x1e8a, 9}, {0x1e8b, 5},
+	{0x1e8c, 9}, {0x1e8d, 5}, {0x1e8e, 9}, {0x1e8f, 5}, {0x1e90, 9},
+	{0x1e91, 5}, {0x1e92, 9}, {0x1e93, 5}, {0x1e94, 9}, {0x1e95, 5},
+	{0x1e9e, 9}, {0x1e9f, 5}, {0x1ea0, 9}, {0x1ea1, 5}, {0x1ea2, 9},
+	{0x1ea3, 5}, {0x1ea4, 9}, {0x1ea5, 5}, {0x1ea6, 9}, {0x1ea7, 5},
+	{0x1ea8, 9}, {0x1ea9, 5}, {0x1eaa, 9}, {0x1eab, 5}, {0x1eac, 9},
+	{0x1ead, 5}, {0x1eae, 9}, {0x1eaf, 5}, {0x1eb0, 9}, {0x1eb1, 5},
+	{0x1eb2, 9}, {0x1eb3, 5}, {0x1eb4, 9}, {0x1eb5, 5}, {0x1eb6, 9},
+	{0x1eb7, 5}, {0x1eb8, 9}, {0x1eb9, 5}, {0x1eba, 9}, {0x1ebb, 5},
+	{0x1ebc, 9}, {0x1ebd, 5}, {0x1ebe, 9}, {0x1ebf, 5}, {0x1ec0, 9},
+	{0x1ec1, 5}, {0x1ec2, 9}, {0x1ec3, 5}, {0x1ec4, 9}, {0x1ec5, 5},
+	{0x1ec6, 9}, {0x1ec7, 5}, {0x1ec8, 9}, {0x1ec9, 5}, {0x1eca, 9},
+	{0x1ecb, 5}, {0x1ecc, 9}, {0x1ecd, 5}, {0x1ece, 9}, {0x1ecf, 5},
+	{0x1ed0, 9}, {0x1ed1, 5}, {0x1ed2, 9}, {0x1ed3, 5}, {0x1ed4, 9},
+	{0x1ed5, 5}, {0x1ed6, 9}, {0x1ed7, 5}, {0x1ed8, 9}, {0x1ed9, 5},
+	{0x1eda, 9}, {0x1edb, 5}, {0x1edc, 9}, {0x1edd, 5}, {0x1ede, 9},
+	{0x1edf, 5}, {0x1ee0, 9}, {0x1ee1, 5}, {0x1ee2, 9}, {0x1ee3, 5},
+	{0x1ee4, 9}, {0x1ee5, 5}, {0x1ee6, 9}, {0x1ee7, 5}, {0x1ee8, 9},
+	{0x1ee9, 5}, {0x1eea, 9}, {0x1eeb, 5}, {0x1eec, 9}, {0x1eed, 5},
+	{0x1eee, 9}, {0x1eef, 5}, {0x1ef0, 9}, {0x1ef1, 5}, {0x1ef2, 9},
+	{0x1ef3, 5}, {0x1ef4, 9}, {0x1ef5, 5}, {0x1ef6, 9}, {0x1ef7, 5},
+	{0x1ef8, 9}, {0x1ef9, 5}, {0x1efa, 9}, {0x1efb, 5}, {0x1efc, 9},
+	{0x1efd, 5}, {0x1efe, 9}, {0x1eff, 5}, {0x1f08, 9}, {0x1f10, 5},
+	{0x1f16, 2}, {0x1f18, 9}, {0x1f1e, 2}, {0x1f20, 5}, {0x1f28, 9},
+	{0x1f30, 5}, {0x1f38, 9}, {0x1f40, 5}, {0x1f46, 2}, {0x1f48, 9},
+	{0x1f4e, 2}, {0x1f50, 5}, {0x1f58, 2}, {0x1f59, 9}, {0x1f5a, 2},
+	{0x1f5b, 9}, {0x1f5c, 2}, {0x1f5d, 9}, {0x1f5e, 2}, {0x1f5f, 9},
+	{0x1f60, 5}, {0x1f68, 9}, {0x1f70, 5}, {0x1f7e, 2}, {0x1f80, 5},
+	{0x1f88, 8}, {0x1f90, 5}, {0x1f98, 8}, {0x1fa0, 5}, {0x1fa8, 8},
+	{0x1fb0, 5}, {0x1fb5, 2}, {0x1fb6, 5}, {0x1fb8, 9}, {0x1fbc, 8},
+	{0x1fbd, 24}, {0x1fbe, 5}, {0x1fbf, 24}, {0x1fc2, 5}, {0x1fc5, 2},
+	{0x1fc6, 5}, {0x1fc8, 9}, {0x1fcc, 8}, {0x1fcd, 24}, {0x1fd0, 5},
+	{0x1fd4, 2}, {0x1fd6, 5}, {0x1fd8, 9}, {0x1fdc, 2}, {0x1fdd, 24},
+	{0x1fe0, 5}, {0x1fe8, 9}, {0x1fed, 24}, {0x1ff0, 2}, {0x1ff2, 5},
+	{0x1ff5, 2}, {0x1ff6, 5}, {0x1ff8, 9}, {0x1ffc, 8}, {0x1ffd, 24},
+	{0x1fff, 2}, {0x2000, 29}, {0x200b, 1}, {0x2010, 17}, {0x2016, 21},
+	{0x2018, 20}, {0x2019, 19}, {0x201a, 22}, {0x201b, 20}, {0x201d, 19},
+	{0x201e, 22}, {0x201f, 20}, {0x2020, 21}, {0x2028, 27}, {0x2029, 28},
+	{0x202a, 1}, {0x202f, 29}, {0x2030, 21}, {0x2039, 20}, {0x203a, 19},
+	{0x203b, 21}, {0x203f, 16}, {0x2041, 21}, {0x2044, 25}, {0x2045, 22},
+	{0x2046, 18}, {0x2047, 21}, {0x2052, 25}, {0x2053, 21}, {0x2054, 16},
+	{0x2055, 21}, {0x205f, 29}, {0x2060, 1}, {0x2065, 2}, {0x2066, 1},
+	{0x2070, 15}, {0x2071, 6}, {0x2072, 2}, {0x2074, 15}, {0x207a, 25},
+	{0x207d, 22}, {0x207e, 18}, {0x207f, 6}, {0x2080, 15}, {0x208a, 25},
+	{0x208d, 22}, {0x208e, 18}, {0x208f, 2}, {0x2090, 6}, {0x209d, 2},
+	{0x20a0, 23}, {0x20c1, 2}, {0x20d0, 12}, {0x20dd, 11}, {0x20e1, 12},
+	{0x20e2, 11}, {0x20e5, 12}, {0x20f1, 2}, {0x2100, 26}, {0x2102, 9},
+	{0x2103, 26}, {0x2107, 9}, {0x2108, 26}, {0x210a, 5}, {0x210b, 9},
+	{0x210e, 5}, {0x2110, 9}, {0x2113, 5}, {0x2114, 26}, {0x2115, 9},
+	{0x2116, 26}, {0x2118, 25}, {0x2119, 9}, {0x211e, 26}, {0x2124, 9},
+	{0x2125, 26}, {0x2126, 9}, {0x2127, 26}, {0x2128, 9}, {0x2129, 26},
+	{0x212a, 9}, {0x212e, 26}, {0x212f, 5}, {0x2130, 9}, {0x2134, 5},
+	{0x2135, 7}, {0x2139, 5}, {0x213a, 26}, {0x213c, 5}, {0x213e, 9},
+	{0x2140, 25}, {0x2145, 9}, {0x2146, 5}, {0x214a, 26}, {0x214b, 25},
+	{0x214c, 26}, {0x214e, 5}, {0x214f, 26}, {0x2150, 15}, {0x2160, 14},
+	{0x2183, 9}, {0x2184, 5}, {0x2185, 14}, {0x2189, 15}, {0x218a, 26},
+	{0x218c, 2}, {0x2190, 25}, {0x2195, 26}, {0x219a, 25}, {0x219c, 26},
+	{0x21a0, 25}, {0x21a1, 26}, {0x21a3, 25}, {0x21a4, 26}, {0x21a6, 25},
+	{0x21a7, 26}, {0x21ae, 25}, {0x21af, 26}, {0x21ce, 25}, {0x21d0, 26},
+	{0x21d2, 25}, {0x21d3, 26}, {0x21d4, 25}, {0x21d5, 26}, {0x21f4, 25},
+	{0x2300, 26}, {0x2308, 22}, {0x2309, 18}, {0x230a, 22}, {0x230b, 18},
+	{0x230c, 26}, {0x2320, 25}, {0x2322, 26}, {0x2329, 22}, {0x232a, 18},
+	{0x232b, 26}, {0x237c, 25}, {0x237d, 26}, {0x239b, 25}, {0x23b4, 26},
+	{0x23dc, 25}, {0x23e2, 26}, {0x2427, 2}, {0x2440, 26}, {0x244b, 2},
+	{0x2460, 15}, {0x249c, 26}, {0x24ea, 15}, {0x2500, 26}, {0x25b7, 25},
+	{0x25b8, 26}, {0x25c1, 25}, {0x25c2, 26}, {0x25f8, 25}, {0x2600, 26},
+	{0x266f, 25}, {0x2670, 26}, {0x2768, 22}, {0x2769, 18}, {0x276a, 22},
+	{0x276b, 18}, {0x276c, 22}, {0x276d, 18}, {0x276e, 22}, {0x276f, 18},
+	{0x2770, 22}, {0x2771, 18}, {0x2772, 22}, {0x2773, 18}, {0x2774, 22},
+	{0x2775, 18}, {0x2776, 15}, {0x2794, 26}, {0x27c0, 25}, {0x27c5, 22},
+	{0x27c6, 18}, {0x27c7, 25}, {0x27e6, 22}, {0x27e7, 18}, {0x27e8, 22},
+	{0x27e9, 18}, {0x27ea, 22}, {0x27eb, 18}, {0x27ec, 22}, {0x27ed, 18},
+	{0x27ee, 22}, {0x27ef, 18}, {0x27f0, 25}, {0x2800, 26}, {0x2900, 25},
+	{0x2983, 22}, {0x2984, 18}, {0x2985, 22}, {0x2986, 18}, {0x2987, 22},
+	{0x2988, 18}, {0x2989, 22}, {0x298a, 18}, {0x298b, 22}, {0x298c, 18},
+	{0x298d, 22}, {0x298e, 18}, {0x298f, 22}, {0x2990, 18}, {0x2991, 22},
+	{0x2992, 18}, {0x2993, 22}, {0x2994, 18}, {0x2995, 22}, {0x2996, 18},
+	{0x2997, 22}, {0x2998, 18}, {0x2999, 25}, {0x29d8, 22}, {0x29d9, 18},
+	{0x29da, 22}, {0x29db, 18}, {0x29dc, 25}, {0x29fc, 22}, {0x29fd, 18},
+	{0x29fe, 25}, {0x2b00, 26}, {0x2b30, 25}, {0x2b45, 26}, {0x2b47, 25},
+	{0x2b4d, 26}, {0x2b74, 2}, {0x2b76, 26}, {0x2b96, 2}, {0x2b97, 26},
+	{0x2c00, 9}, {0x2c30, 5}, {0x2c60, 9}, {0x2c61, 5}, {0x2c62, 9},
+	{0x2c65, 5}, {0x2c67, 9}, {0x2c68, 5}, {0x2c69, 9}, {0x2c6a, 5},
+	{0x2c6b, 9}, {0x2c6c, 5}, {0x2c6d, 9}, {0x2c71, 5}, {0x2c72, 9},
+	{0x2c73, 5}, {0x2c75, 9}, {0x2c76, 5}, {0x2c7c, 6}, {0x2c7e, 9},
+	{0x2c81, 5}, {0x2c82, 9}, {0x2c83, 5}, {0x2c84, 9}, {0x2c85, 5},
+	{0x2c86, 9}, {0x2c87, 5}, {0x2c88, 9}, {0x2c89, 5}, {0x2c8a, 9},
+	{0x2c8b, 5}, {0x2c8c, 9}, {0x2c8d, 5}, {0x2c8e, 9}, {0x2c8f, 5},
+	{0x2c90, 9}, {0x2c91, 5}, {0x2c92, 9}, {0x2c93, 5}, {0x2c94, 9},
+	{0x2c95, 5}, {0x2c96, 9}, {0x2c97, 5}, {0x2c98, 9}, {0x2c99, 5},
+	{0x2c9a, 9}, {0x2c9b, 5}, {0x2c9c, 9}, {0x2c9d, 5}, {0x2c9e, 9},
+	{0x2c9f, 5}, {0x2ca0, 9}, {0x2ca1, 5}, {0x2ca2, 9}, {0x2ca3, 5},
+	{0x2ca4, 9}, {0x2ca5, 5}, {0x2ca6, 9}, {0x2ca7, 5}, {0x2ca8, 9},
+	{0x2ca9, 5}, {0x2caa, 9}, {0x2cab, 5}, {0x2cac, 9}, {0x2cad, 5},
+	{0x2cae, 9}, {0x2caf, 5}, {0x2cb0, 9}, {0x2cb1, 5}, {0x2cb2, 9},
+	{0x2cb3, 5}, {0x2cb4, 9}, {0x2cb5, 5}, {0x2cb6, 9}, {0x2cb7, 5},
+	{0x2cb8, 9}, {0x2cb9, 5}, {0x2cba, 9}, {0x2cbb, 5}, {0x2cbc, 9},
+	{0x2cbd, 5}, {0x2cbe, 9}, {0x2cbf, 5}, {0x2cc0, 9}, {0x2cc1, 5},
+	{0x2cc2, 9}, {0x2cc3, 5}, {0x2cc4, 9}, {0x2cc5, 5}, {0x2cc6, 9},
+	{0x2cc7, 5}, {0x2cc8, 9}, {0x2cc9, 5}, {0x2cca, 9}, {0x2ccb, 5},
+	{0x2ccc, 9}, {0x2ccd, 5}, {0x2cce, 9}, {0x2ccf, 5}, {0x2cd0, 9},
+	{0x2cd1, 5}, {0x2cd2, 9}, {0x2cd3, 5}, {0x2cd4, 9}, {0x2cd5, 5},
+	{0x2cd6, 9}, {0x2cd7, 5}, {0x2cd8, 9}, {0x2cd9, 5}, {0x2cda, 9},
+	{0x2cdb, 5}, {0x2cdc, 9}, {0x2cdd, 5}, {0x2cde, 9}, {0x2cdf, 5},
+	{0x2ce0, 9}, {0x2ce1, 5}, {0x2ce2, 9}, {0x2ce3, 5}, {0x2ce5, 26},
+	{0x2ceb, 9}, {0x2cec, 5}, {0x2ced, 9}, {0x2cee, 5}, {0x2cef, 12},
+	{0x2cf2, 9}, {0x2cf3, 5}, {0x2cf4, 2}, {0x2cf9, 21}, {0x2cfd, 15},
+	{0x2cfe, 21}, {0x2d00, 5}, {0x2d26, 2}, {0x2d27, 5}, {0x2d28, 2},
+	{0x2d2d, 5}, {0x2d2e, 2}, {0x2d30, 7}, {0x2d68, 2}, {0x2d6f, 6},
+	{0x2d70, 21}, {0x2d71, 2}, {0x2d7f, 12}, {0x2d80, 7}, {0x2d97, 2},
+	{0x2da0, 7}, {0x2da7, 2}, {0x2da8, 7}, {0x2daf, 2}, {0x2db0, 7},
+	{0x2db7, 2}, {0x2db8, 7}, {0x2dbf, 2}, {0x2dc0, 7}, {0x2dc7, 2},
+	{0x2dc8, 7}, {0x2dcf, 2}, {0x2dd0, 7}, {0x2dd7, 2}, {0x2dd8, 7},
+	{0x2ddf, 2}, {0x2de0, 12}, {0x2e00, 21}, {0x2e02, 20}, {0x2e03, 19},
+	{0x2e04, 20}, {0x2e05, 19}, {0x2e06, 21}, {0x2e09, 20}, {0x2e0a, 19},
+	{0x2e0b, 21}, {0x2e0c, 20}, {0x2e0d, 19}, {0x2e0e, 21}, {0x2e17, 17},
+	{0x2e18, 21}, {0x2e1a, 17}, {0x2e1b, 21}, {0x2e1c, 20}, {0x2e1d, 19},
+	{0x2e1e, 21}, {0x2e20, 20}, {0x2e21, 19}, {0x2e22, 22}, {0x2e23, 18},
+	{0x2e24, 22}, {0x2e25, 18}, {0x2e26, 22}, {0x2e27, 18}, {0x2e28, 22},
+	{0x2e29, 18}, {0x2e2a, 21}, {0x2e2f, 6}, {0x2e30, 21}, {0x2e3a, 17},
+	{0x2e3c, 21}, {0x2e40, 17}, {0x2e41, 21}, {0x2e42, 22}, {0x2e43, 21},
+	{0x2e50, 26}, {0x2e52, 21}, {0x2e55, 22}, {0x2e56, 18}, {0x2e57, 22},
+	{0x2e58, 18}, {0x2e59, 22}, {0x2e5a, 18}, {0x2e5b, 22}, {0x2e5c, 18},
+	{0x2e5d, 17}, {0x2e5e, 2}, {0x2e80, 26}, {0x2e9a, 2}, {0x2e9b, 26},
+	{0x2ef4, 2}, {0x2f00, 26}, {0x2fd6, 2}, {0x2ff0, 26}, {0x2ffc, 2},
+	{0x3000, 29}, {0x3001, 21}, {0x3004, 26}, {0x3005, 6}, {0x3006, 7},
+	{0x3007, 14}, {0x3008, 22}, {0x3009, 18}, {0x300a, 22}, {0x300b, 18},
+	{0x300c, 22}, {0x300d, 18}, {0x300e, 22}, {0x300f, 18}, {0x3010, 22},
+	{0x3011, 18}, {0x3012, 26}, {0x3014, 22}, {0x3015, 18}, {0x3016, 22},
+	{0x3017, 18}, {0x3018, 22}, {0x3019, 18}, {0x301a, 22}, {0x301b, 18},
+	{0x301c, 17}, {0x301d, 22}, {0x301e, 18}, {0x3020, 26}, {0x3021, 14},
+	{0x302a, 12}, {0x302e, 10}, {0x3030, 17}, {0x3031, 6}, {0x3036, 26},
+	{0x3038, 14}, {0x303b, 6}, {0x303c, 7}, {0x303d, 21}, {0x303e, 26},
+	{0x3040, 2}, {0x3041, 7}, {0x3097, 2}, {0x3099, 12}, {0x309b, 24},
+	{0x309d, 6}, {0x309f, 7}, {0x30a0, 17}, {0x30a1, 7}, {0x30fb, 21},
+	{0x30fc, 6}, {0x30ff, 7}, {0x3100, 2}, {0x3105, 7}, {0x3130, 2},
+	{0x3131, 7}, {0x318f, 2}, {0x3190, 26}, {0x3192, 15}, {0x3196, 26},
+	{0x31a0, 7}, {0x31c0, 26}, {0x31e4, 2}, {0x31f0, 7}, {0x3200, 26},
+	{0x321f, 2}, {0x3220, 15}, {0x322a, 26}, {0x3248, 15}, {0x3250, 26},
+	{0x3251, 15}, {0x3260, 26}, {0x3280, 15}, {0x328a, 26}, {0x32b1, 15},
+	{0x32c0, 26}, {0x3400, 7}, {0x4dc0, 26}, {0x4e00, 7}, {0xa015, 6},
+	{0xa016, 7}, {0xa48d, 2}, {0xa490, 26}, {0xa4c7, 2}, {0xa4d0, 7},
+	{0xa4f8, 6}, {0xa4fe, 21}, {0xa500, 7}, {0xa60c, 6}, {0xa60d, 21},
+	{0xa610, 7}, {0xa620, 13}, {0xa62a, 7}, {0xa62c, 2}, {0xa640, 9},
+	{0xa641, 5}, {0xa642, 9}, {0xa643, 5}, {0xa644, 9}, {0xa645, 5},
+	{0xa646, 9}, {0xa647, 5}, {0xa648, 9}, {0xa649, 5}, {0xa64a, 9},
+	{0xa64b, 5}, {0xa64c, 9}, {0xa64d, 5}, {0xa64e, 9}, {0xa64f, 5},
+	{0xa650, 9}, {0xa651, 5}, {0xa652, 9}, {0xa653, 5}, {0xa654, 9},
+	{0xa655, 5}, {0xa656, 9}, {0xa657, 5}, {0xa658, 9}, {0xa659, 5},
+	{0xa65a, 9}, {0xa65b, 5}, {0xa65c, 9}, {0xa65d, 5}, {0xa65e, 9},
+	{0xa65f, 5}, {0xa660, 9}, {0xa661, 5}, {0xa662, 9}, {0xa663, 5},
+	{0xa664, 9}, {0xa665, 5}, {0xa666, 9}, {0xa667, 5}, {0xa668, 9},
+	{0xa669, 5}, {0xa66a, 9}, {0xa66b, 5}, {0xa66c, 9}, {0xa66d, 5},
+	{0xa66e, 7}, {0xa66f, 12}, {0xa670, 11}, {0xa673, 21}, {0xa674, 12},
+	{0xa67e, 21}, {0xa67f, 6}, {0xa680, 9}, {0xa681, 5}, {0xa682, 9},
+	{0xa683, 5}, {0xa684, 9}, {0xa685, 5}, {0xa686, 9}, {0xa687, 5},
+	{0xa688, 9}, {0xa689, 5}, {0xa68a, 9}, {0xa68b, 5}, {0xa68c, 9},
+	{0xa68d, 5}, {0xa68e, 9}, {0xa68f, 5}, {0xa690, 9}, {0xa691, 5},
+	{0xa692, 9}, {0xa693, 5}, {0xa694, 9}, {0xa695, 5}, {0xa696, 9},
+	{0xa697, 5}, {0xa698, 9}, {0xa699, 5}, {0xa69a, 9}, {0xa69b, 5},
+	{0xa69c, 6}, {0xa69e, 12}, {0xa6a0, 7}, {0xa6e6, 14}, {0xa6f0, 12},
+	{0xa6f2, 21}, {0xa6f8, 2}, {0xa700, 24}, {0xa717, 6}, {0xa720, 24},
+	{0xa722, 9}, {0xa723, 5}, {0xa724, 9}, {0xa725, 5}, {0xa726, 9},
+	{0xa727, 5}, {0xa728, 9}, {0xa729, 5}, {0xa72a, 9}, {0xa72b, 5},
+	{0xa72c, 9}, {0xa72d, 5}, {0xa72e, 9}, {0xa72f, 5}, {0xa732, 9},
+	{0xa733, 5}, {0xa734, 9}, {0xa735, 5}, {0xa736, 9}, {0xa737, 5},
+	{0xa738, 9}, {0xa739, 5}, {0xa73a, 9}, {0xa73b, 5}, {0xa73c, 9},
+	{0xa73d, 5}, {0xa73e, 9}, {0xa73f, 5}, {0xa740, 9}, {0xa741, 5},
+	{0xa742, 9}, {0xa743, 5}, {0xa744, 9}, {0xa745, 5}, {0xa746, 9},
+	{0xa747, 5}, {0xa748, 9}, {0xa749, 5}, {0xa74a, 9}, {0xa74b, 5},
+	{0xa74c, 9}, {0xa74d, 5}, {0xa74e, 9}, {0xa74f, 5}, {0xa750, 9},
+	{0xa751, 5}, {0xa752, 9}, {0xa753, 5}, {0xa754, 9}, {0xa755, 5},
+	{0xa756, 9}, {0xa757, 5}, {0xa758, 9}, {0xa759, 5}, {0xa75a, 9},
+	{0xa75b, 5}, {0xa75c, 9}, {0xa75d, 5}, {0xa75e, 9}, {0xa75f, 5},
+	{0xa760, 9}, {0xa761, 5}, {0xa762, 9}, {0xa763, 5}, {0xa764, 9},
+	{0xa765, 5}, {0xa766, 9}, {0xa767, 5}, {0xa768, 9}, {0xa769, 5},
+	{0xa76a, 9}, {0xa76b, 5}, {0xa76c, 9}, {0xa76d, 5}, {0xa76e, 9},
+	{0xa76f, 5}, {0xa770, 6}, {0xa771, 5}, {0xa779, 9}, {0xa77a, 5},
+	{0xa77b, 9}, {0xa77c, 5}, {0xa77d, 9}, {0xa77f, 5}, {0xa780, 9},
+	{0xa781, 5}, {0xa782, 9}, {0xa783, 5}, {0xa784, 9}, {0xa785, 5},
+	{0xa786, 9}, {0xa787, 5}, {0xa788, 6}, {0xa789, 24}, {0xa78b, 9},
+	{0xa78c, 5}, {0xa78d, 9}, {0xa78e, 5}, {0xa78f, 7}, {0xa790, 9},
+	{0xa791, 5}, {0xa792, 9}, {0xa793, 5}, {0xa796, 9}, {0xa797, 5},
+	{0xa798, 9}, {0xa799, 5}, {0xa79a, 9}, {0xa79b, 5}, {0xa79c, 9},
+	{0xa79d, 5}, {0xa79e, 9}, {0xa79f, 5}, {0xa7a0, 9}, {0xa7a1, 5},
+	{0xa7a2, 9}, {0xa7a3, 5}, {0xa7a4, 9}, {0xa7a5, 5}, {0xa7a6, 9},
+	{0xa7a7, 5}, {0xa7a8, 9}, {0xa7a9, 5}, {0xa7aa, 9}, {0xa7af, 5},
+	{0xa7b0, 9}, {0xa7b5, 5}, {0xa7b6, 9}, {0xa7b7, 5}, {0xa7b8, 9},
+	{0xa7b9, 5}, {0xa7ba, 9}, {0xa7bb, 5}, {0xa7bc, 9}, {0xa7bd, 5},
+	{0xa7be, 9}, {0xa7bf, 5}, {0xa7c0, 9}, {0xa7c1, 5}, {0xa7c2, 9},
+	{0xa7c3, 5}, {0xa7c4, 9}, {0xa7c8, 5}, {0xa7c9, 9}, {0xa7ca, 5},
+	{0xa7cb, 2}, {0xa7d0, 9}, {0xa7d1, 5}, {0xa7d2, 2}, {0xa7d3, 5},
+	{0xa7d4, 2}, {0xa7d5, 5}, {0xa7d6, 9}, {0xa7d7, 5}, {0xa7d8, 9},
+	{0xa7d9, 5}, {0xa7da, 2}, {0xa7f2, 6}, {0xa7f5, 9}, {0xa7f6, 5},
+	{0xa7f7, 7}, {0xa7f8, 6}, {0xa7fa, 5}, {0xa7fb, 7}, {0xa802, 12},
+	{0xa803, 7}, {0xa806, 12}, {0xa807, 7}, {0xa80b, 12}, {0xa80c, 7},
+	{0xa823, 10}, {0xa825, 12}, {0xa827, 10}, {0xa828, 26}, {0xa82c, 12},
+	{0xa82d, 2}, {0xa830, 15}, {0xa836, 26}, {0xa838, 23}, {0xa839, 26},
+	{0xa83a, 2}, {0xa840, 7}, {0xa874, 21}, {0xa878, 2}, {0xa880, 10},
+	{0xa882, 7}, {0xa8b4, 10}, {0xa8c4, 12}, {0xa8c6, 2}, {0xa8ce, 21},
+	{0xa8d0, 13}, {0xa8da, 2}, {0xa8e0, 12}, {0xa8f2, 7}, {0xa8f8, 21},
+	{0xa8fb, 7}, {0xa8fc, 21}, {0xa8fd, 7}, {0xa8ff, 12}, {0xa900, 13},
+	{0xa90a, 7}, {0xa926, 12}, {0xa92e, 21}, {0xa930, 7}, {0xa947, 12},
+	{0xa952, 10}, {0xa954, 2}, {0xa95f, 21}, {0xa960, 7}, {0xa97d, 2},
+	{0xa980, 12}, {0xa983, 10}, {0xa984, 7}, {0xa9b3, 12}, {0xa9b4, 10},
+	{0xa9b6, 12}, {0xa9ba, 10}, {0xa9bc, 12}, {0xa9be, 10}, {0xa9c1, 21},
+	{0xa9ce, 2}, {0xa9cf, 6}, {0xa9d0, 13}, {0xa9da, 2}, {0xa9de, 21},
+	{0xa9e0, 7}, {0xa9e5, 12}, {0xa9e6, 6}, {0xa9e7, 7}, {0xa9f0, 13},
+	{0xa9fa, 7}, {0xa9ff, 2}, {0xaa00, 7}, {0xaa29, 12}, {0xaa2f, 10},
+	{0xaa31, 12}, {0xaa33, 10}, {0xaa35, 12}, {0xaa37, 2}, {0xaa40, 7},
+	{0xaa43, 12}, {0xaa44, 7}, {0xaa4c, 12}, {0xaa4d, 10}, {0xaa4e, 2},
+	{0xaa50, 13}, {0xaa5a, 2}, {0xaa5c, 21}, {0xaa60, 7}, {0xaa70, 6},
+	{0xaa71, 7}, {0xaa77, 26}, {0xaa7a, 7}, {0xaa7b, 10}, {0xaa7c, 12},
+	{0xaa7d, 10}, {0xaa7e, 7}, {0xaab0, 12}, {0xaab1, 7}, {0xaab2, 12},
+	{0xaab5, 7}, {0xaab7, 12}, {0xaab9, 7}, {0xaabe, 12}, {0xaac0, 7},
+	{0xaac1, 12}, {0xaac2, 7}, {0xaac3, 2}, {0xaadb, 7}, {0xaadd, 6},
+	{0xaade, 21}, {0xaae0, 7}, {0xaaeb, 10}, {0xaaec, 12}, {0xaaee, 10},
+	{0xaaf0, 21}, {0xaaf2, 7}, {0xaaf3, 6}, {0xaaf5, 10}, {0xaaf6, 12},
+	{0xaaf7, 2}, {0xab01, 7}, {0xab07, 2}, {0xab09, 7}, {0xab0f, 2},
+	{0xab11, 7}, {0xab17, 2}, {0xab20, 7}, {0xab27, 2}, {0xab28, 7},
+	{0xab2f, 2}, {0xab30, 5}, {0xab5b, 24}, {0xab5c, 6}, {0xab60, 5},
+	{0xab69, 6}, {0xab6a, 24}, {0xab6c, 2}, {0xab70, 5}, {0xabc0, 7},
+	{0xabe3, 10}, {0xabe5, 12}, {0xabe6, 10}, {0xabe8, 12}, {0xabe9, 10},
+	{0xabeb, 21}, {0xabec, 10}, {0xabed, 12}, {0xabee, 2}, {0xabf0, 13},
+	{0xabfa, 2}, {0xac00, 7}, {0xd7a4, 2}, {0xd7b0, 7}, {0xd7c7, 2},
+	{0xd7cb, 7}, {0xd7fc, 2}, {0xd800, 4}, {0xe000, 3}, {0xf900, 7},
+	{0xfa6e, 2}, {0xfa70, 7}, {0xfada, 2}, {0xfb00, 5}, {0xfb07, 2},
+	{0xfb13, 5}, {0xfb18, 2}, {0xfb1d, 7}, {0xfb1e, 12}, {0xfb1f, 7},
+	{0xfb29, 25}, {0xfb2a, 7}, {0xfb37, 2}, {0xfb38, 7}, {0xfb3d, 2},
+	{0xfb3e, 7}, {0xfb3f, 2}, {0xfb40, 7}, {0xfb42, 2}, {0xfb43, 7},
+	{0xfb45, 2}, {0xfb46, 7}, {0xfbb2, 24}, {0xfbc3, 2}, {0xfbd3, 7},
+	{0xfd3e, 18}, {0xfd3f, 22}, {0xfd40, 26}, {0xfd50, 7}, {0xfd90, 2},
+	{0xfd92, 7}, {0xfdc8, 2}, {0xfdcf, 26}, {0xfdd0, 2}, {0xfdf0, 7},
+	{0xfdfc, 23}, {0xfdfd, 26}, {0xfe00, 12}, {0xfe10, 21}, {0xfe17, 22},
+	{0xfe18, 18}, {0xfe19, 21}, {0xfe1a, 2}, {0xfe20, 12}, {0xfe30, 21},
+	{0xfe31, 17}, {0xfe33, 16}, {0xfe35, 22}, {0xfe36, 18}, {0xfe37, 22},
+	{0xfe38, 18}, {0xfe39, 22}, {0xfe3a, 18}, {0xfe3b, 22}, {0xfe3c, 18},
+	{0xfe3d, 22}, {0xfe3e, 18}, {0xfe3f, 22}, {0xfe40, 18}, {0xfe41, 22},
+	{0xfe42, 18}, {0xfe43, 22}, {0xfe44, 18}, {0xfe45, 21}, {0xfe47, 22},
+	{0xfe48, 18}, {0xfe49, 21}, {0xfe4d, 16}, {0xfe50, 21}, {0xfe53, 2},
+	{0xfe54, 21}, {0xfe58, 17}, {0xfe59, 22}, {0xfe5a, 18}, {0xfe5b, 22},
+	{0xfe5c, 18}, {0xfe5d, 22}, {0xfe5e, 18}, {0xfe5f, 21}, {0xfe62, 25},
+	{0xfe63, 17}, {0xfe64, 25}, {0xfe67, 2}, {0xfe68, 21}, {0xfe69, 23},
+	{0xfe6a, 21}, {0xfe6c, 2}, {0xfe70, 7}, {0xfe75, 2}, {0xfe76, 7},
+	{0xfefd, 2}, {0xfeff, 1}, {0xff00, 2}, {0xff01, 21}, {0xff04, 23},
+	{0xff05, 21}, {0xff08, 22}, {0xff09, 18}, {0xff0a, 21}, {0xff0b, 25},
+	{0xff0c, 21}, {0xff0d, 17}, {0xff0e, 21}, {0xff10, 13}, {0xff1a, 21},
+	{0xff1c, 25}, {0xff1f, 21}, {0xff21, 9}, {0xff3b, 22}, {0xff3c, 21},
+	{0xff3d, 18}, {0xff3e, 24}, {0xff3f, 16}, {0xff40, 24}, {0xff41, 5},
+	{0xff5b, 22}, {0xff5c, 25}, {0xff5d, 18}, {0xff5e, 25}, {0xff5f, 22},
+	{0xff60, 18}, {0xff61, 21}, {0xff62, 22}, {0xff63, 18}, {0xff64, 21},
+	{0xff66, 7}, {0xff70, 6}, {0xff71, 7}, {0xff9e, 6}, {0xffa0, 7},
+	{0xffbf, 2}, {0xffc2, 7}, {0xffc8, 2}, {0xffca, 7}, {0xffd0, 2},
+	{0xffd2, 7}, {0xffd8, 2}, {0xffda, 7}, {0xffdd, 2}, {0xffe0, 23},
+	{0xffe2, 25}, {0xffe3, 24}, {0xffe4, 26}, {0xffe5, 23}, {0xffe7, 2},
+	{0xffe8, 26}, {0xffe9, 25}, {0xffed, 26}, {0xffef, 2}, {0xfff9, 1},
+	{0xfffc, 26}, {0xfffe, 2}, {0x10000, 7}, {0x1000c, 2}, {0x1000d, 7},
+	{0x10027, 2}, {0x10028, 7}, {0x1003b, 2}, {0x1003c, 7}, {0x1003e, 2},
+	{0x1003f, 7}, {0x1004e, 2}, {0x10050, 7}, {0x1005e, 2}, {0x10080, 7},
+	{0x100fb, 2}, {0x10100, 21}, {0x10103, 2}, {0x10107, 15}, {0x10134, 2},
+	{0x10137, 26}, {0x10140, 14}, {0x10175, 15}, {0x10179, 26},
+	{0x1018a, 15}, {0x1018c, 26}, {0x1018f, 2}, {0x10190, 26},
+	{0x1019d, 2}, {0x101a0, 26}, {0x101a1, 2}, {0x101d0, 26},
+	{0x101fd, 12}, {0x101fe, 2}, {0x10280, 7}, {0x1029d, 2}, {0x102a0, 7},
+	{0x102d1, 2}, {0x102e0, 12}, {0x102e1, 15}, {0x102fc, 2}, {0x10300, 7},
+	{0x10320, 15}, {0x10324, 2}, {0x1032d, 7}, {0x10341, 14}, {0x10342, 7},
+	{0x1034a, 14}, {0x1034b, 2}, {0x10350, 7}, {0x10376, 12}, {0x1037b, 2},
+	{0x10380, 7}, {0x1039e, 2}, {0x1039f, 21}, {0x103a0, 7}, {0x103c4, 2},
+	{0x103c8, 7}, {0x103d0, 21}, {0x103d1, 14}, {0x103d6, 2}, {0x10400, 9},
+	{0x10428, 5}, {0x10450, 7}, {0x1049e, 2}, {0x104a0, 13}, {0x104aa, 2},
+	{0x104b0, 9}, {0x104d4, 2}, {0x104d8, 5}, {0x104fc, 2}, {0x10500, 7},
+	{0x10528, 2}, {0x10530, 7}, {0x10564, 2}, {0x1056f, 21}, {0x10570, 9},
+	{0x1057b, 2}, {0x1057c, 9}, {0x1058b, 2}, {0x1058c, 9}, {0x10593, 2},
+	{0x10594, 9}, {0x10596, 2}, {0x10597, 5}, {0x105a2, 2}, {0x105a3, 5},
+	{0x105b2, 2}, {0x105b3, 5}, {0x105ba, 2}, {0x105bb, 5}, {0x105bd, 2},
+	{0x10600, 7}, {0x10737, 2}, {0x10740, 7}, {0x10756, 2}, {0x10760, 7},
+	{0x10768, 2}, {0x10780, 6}, {0x10786, 2}, {0x10787, 6}, {0x107b1, 2},
+	{0x107b2, 6}, {0x107bb, 2}, {0x10800, 7}, {0x10806, 2}, {0x10808, 7},
+	{0x10809, 2}, {0x1080a, 7}, {0x10836, 2}, {0x10837, 7}, {0x10839, 2},
+	{0x1083c, 7}, {0x1083d, 2}, {0x1083f, 7}, {0x10856, 2}, {0x10857, 21},
+	{0x10858, 15}, {0x10860, 7}, {0x10877, 26}, {0x10879, 15},
+	{0x10880, 7}, {0x1089f, 2}, {0x108a7, 15}, {0x108b0, 2}, {0x108e0, 7},
+	{0x108f3, 2}, {0x108f4, 7}, {0x108f6, 2}, {0x108fb, 15}, {0x10900, 7},
+	{0x10916, 15}, {0x1091c, 2}, {0x1091f, 21}, {0x10920, 7}, {0x1093a, 2},
+	{0x1093f, 21}, {0x10940, 2}, {0x10980, 7}, {0x109b8, 2}, {0x109bc, 15},
+	{0x109be, 7}, {0x109c0, 15}, {0x109d0, 2}, {0x109d2, 15}, {0x10a00, 7},
+	{0x10a01, 12}, {0x10a04, 2}, {0x10a05, 12}, {0x10a07, 2},
+	{0x10a0c, 12}, {0x10a10, 7}, {0x10a14, 2}, {0x10a15, 7}, {0x10a18, 2},
+	{0x10a19, 7}, {0x10a36, 2}, {0x10a38, 12}, {0x10a3b, 2}, {0x10a3f, 12},
+	{0x10a40, 15}, {0x10a49, 2}, {0x10a50, 21}, {0x10a59, 2}, {0x10a60, 7},
+	{0x10a7d, 15}, {0x10a7f, 21}, {0x10a80, 7}, {0x10a9d, 15},
+	{0x10aa0, 2}, {0x10ac0, 7}, {0x10ac8, 26}, {0x10ac9, 7}, {0x10ae5, 12},
+	{0x10ae7, 2}, {0x10aeb, 15}, {0x10af0, 21}, {0x10af7, 2}, {0x10b00, 7},
+	{0x10b36, 2}, {0x10b39, 21}, {0x10b40, 7}, {0x10b56, 2}, {0x10b58, 15},
+	{0x10b60, 7}, {0x10b73, 2}, {0x10b78, 15}, {0x10b80, 7}, {0x10b92, 2},
+	{0x10b99, 21}, {0x10b9d, 2}, {0x10ba9, 15}, {0x10bb0, 2}, {0x10c00, 7},
+	{0x10c49, 2}, {0x10c80, 9}, {0x10cb3, 2}, {0x10cc0, 5}, {0x10cf3, 2},
+	{0x10cfa, 15}, {0x10d00, 7}, {0x10d24, 12}, {0x10d28, 2},
+	{0x10d30, 13}, {0x10d3a, 2}, {0x10e60, 15}, {0x10e7f, 2}, {0x10e80, 7},
+	{0x10eaa, 2}, {0x10eab, 12}, {0x10ead, 17}, {0x10eae, 2}, {0x10eb0, 7},
+	{0x10eb2, 2}, {0x10f00, 7}, {0x10f1d, 15}, {0x10f27, 7}, {0x10f28, 2},
+	{0x10f30, 7}, {0x10f46, 12}, {0x10f51, 15}, {0x10f55, 21},
+	{0x10f5a, 2}, {0x10f70, 7}, {0x10f82, 12}, {0x10f86, 21}, {0x10f8a, 2},
+	{0x10fb0, 7}, {0x10fc5, 15}, {0x10fcc, 2}, {0x10fe0, 7}, {0x10ff7, 2},
+	{0x11000, 10}, {0x11001, 12}, {0x11002, 10}, {0x11003, 7},
+	{0x11038, 12}, {0x11047, 21}, {0x1104e, 2}, {0x11052, 15},
+	{0x11066, 13}, {0x11070, 12}, {0x11071, 7}, {0x11073, 12},
+	{0x11075, 7}, {0x11076, 2}, {0x1107f, 12}, {0x11082, 10}, {0x11083, 7},
+	{0x110b0, 10}, {0x110b3, 12}, {0x110b7, 10}, {0x110b9, 12},
+	{0x110bb, 21}, {0x110bd, 1}, {0x110be, 21}, {0x110c2, 12},
+	{0x110c3, 2}, {0x110cd, 1}, {0x110ce, 2}, {0x110d0, 7}, {0x110e9, 2},
+	{0x110f0, 13}, {0x110fa, 2}, {0x11100, 12}, {0x11103, 7},
+	{0x11127, 12}, {0x1112c, 10}, {0x1112d, 12}, {0x11135, 2},
+	{0x11136, 13}, {0x11140, 21}, {0x11144, 7}, {0x11145, 10},
+	{0x11147, 7}, {0x11148, 2}, {0x11150, 7}, {0x11173, 12}, {0x11174, 21},
+	{0x11176, 7}, {0x11177, 2}, {0x11180, 12}, {0x11182, 10}, {0x11183, 7},
+	{0x111b3, 10}, {0x111b6, 12}, {0x111bf, 10}, {0x111c1, 7},
+	{0x111c5, 21}, {0x111c9, 12}, {0x111cd, 21}, {0x111ce, 10},
+	{0x111cf, 12}, {0x111d0, 13}, {0x111da, 7}, {0x111db, 21},
+	{0x111dc, 7}, {0x111dd, 21}, {0x111e0, 2}, {0x111e1, 15}, {0x111f5, 2},
+	{0x11200, 7}, {0x11212, 2}, {0x11213, 7}, {0x1122c, 10}, {0x1122f, 12},
+	{0x11232, 10}, {0x11234, 12}, {0x11235, 10}, {0x11236, 12},
+	{0x11238, 21}, {0x1123e, 12}, {0x1123f, 2}, {0x11280, 7}, {0x11287, 2},
+	{0x11288, 7}, {0x11289, 2}, {0x1128a, 7}, {0x1128e, 2}, {0x1128f, 7},
+	{0x1129e, 2}, {0x1129f, 7}, {0x112a9, 21}, {0x112aa, 2}, {0x112b0, 7},
+	{0x112df, 12}, {0x112e0, 10}, {0x112e3, 12}, {0x112eb, 2},
+	{0x112f0, 13}, {0x112fa, 2}, {0x11300, 12}, {0x11302, 10},
+	{0x11304, 2}, {0x11305, 7}, {0x1130d, 2}, {0x1130f, 7}, {0x11311, 2},
+	{0x11313, 7}, {0x11329, 2}, {0x1132a, 7}, {0x11331, 2}, {0x11332, 7},
+	{0x11334, 2}, {0x11335, 7}, {0x1133a, 2}, {0x1133b, 12}, {0x1133d, 7},
+	{0x1133e, 10}, {0x11340, 12}, {0x11341, 10}, {0x11345, 2},
+	{0x11347, 10}, {0x11349, 2}, {0x1134b, 10}, {0x1134e, 2}, {0x11350, 7},
+	{0x11351, 2}, {0x11357, 10}, {0x11358, 2}, {0x1135d, 7}, {0x11362, 10},
+	{0x11364, 2}, {0x11366, 12}, {0x1136d, 2}, {0x11370, 12}, {0x11375, 2},
+	{0x11400, 7}, {0x11435, 10}, {0x11438, 12}, {0x11440, 10},
+	{0x11442, 12}, {0x11445, 10}, {0x11446, 12}, {0x11447, 7},
+	{0x1144b, 21}, {0x11450, 13}, {0x1145a, 21}, {0x1145c, 2},
+	{0x1145d, 21}, {0x1145e, 12}, {0x1145f, 7}, {0x11462, 2}, {0x11480, 7},
+	{0x114b0, 10}, {0x114b3, 12}, {0x114b9, 10}, {0x114ba, 12},
+	{0x114bb, 10}, {0x114bf, 12}, {0x114c1, 10}, {0x114c2, 12},
+	{0x114c4, 7}, {0x114c6, 21}, {0x114c7, 7}, {0x114c8, 2}, {0x114d0, 13},
+	{0x114da, 2}, {0x11580, 7}, {0x115af, 10}, {0x115b2, 12}, {0x115b6, 2},
+	{0x115b8, 10}, {0x115bc, 12}, {0x115be, 10}, {0x115bf, 12},
+	{0x115c1, 21}, {0x115d8, 7}, {0x115dc, 12}, {0x115de, 2}, {0x11600, 7},
+	{0x11630, 10}, {0x11633, 12}, {0x1163b, 10}, {0x1163d, 12},
+	{0x1163e, 10}, {0x1163f, 12}, {0x11641, 21}, {0x11644, 7},
+	{0x11645, 2}, {0x11650, 13}, {0x1165a, 2}, {0x11660, 21}, {0x1166d, 2},
+	{0x11680, 7}, {0x116ab, 12}, {0x116ac, 10}, {0x116ad, 12},
+	{0x116ae, 10}, {0x116b0, 12}, {0x116b6, 10}, {0x116b7, 12},
+	{0x116b8, 7}, {0x116b9, 21}, {0x116ba, 2}, {0x116c0, 13}, {0x116ca, 2},
+	{0x11700, 7}, {0x1171b, 2}, {0x1171d, 12}, {0x11720, 10},
+	{0x11722, 12}, {0x11726, 10}, {0x11727, 12}, {0x1172c, 2},
+	{0x11730, 13}, {0x1173a, 15}, {0x1173c, 21}, {0x1173f, 26},
+	{0x11740, 7}, {0x11747, 2}, {0x11800, 7}, {0x1182c, 10}, {0x1182f, 12},
+	{0x11838, 10}, {0x11839, 12}, {0x1183b, 21}, {0x1183c, 2},
+	{0x118a0, 9}, {0x118c0, 5}, {0x118e0, 13}, {0x118ea, 15}, {0x118f3, 2},
+	{0x118ff, 7}, {0x11907, 2}, {0x11909, 7}, {0x1190a, 2}, {0x1190c, 7},
+	{0x11914, 2}, {0x11915, 7}, {0x11917, 2}, {0x11918, 7}, {0x11930, 10},
+	{0x11936, 2}, {0x11937, 10}, {0x11939, 2}, {0x1193b, 12},
+	{0x1193d, 10}, {0x1193e, 12}, {0x1193f, 7}, {0x11940, 10},
+	{0x11941, 7}, {0x11942, 10}, {0x11943, 12}, {0x11944, 21},
+	{0x11947, 2}, {0x11950, 13}, {0x1195a, 2}, {0x119a0, 7}, {0x119a8, 2},
+	{0x119aa, 7}, {0x119d1, 10}, {0x119d4, 12}, {0x119d8, 2},
+	{0x119da, 12}, {0x119dc, 10}, {0x119e0, 12}, {0x119e1, 7},
+	{0x119e2, 21}, {0x119e3, 7}, {0x119e4, 10}, {0x119e5, 2}, {0x11a00, 7},
+	{0x11a01, 12}, {0x11a0b, 7}, {0x11a33, 12}, {0x11a39, 10},
+	{0x11a3a, 7}, {0x11a3b, 12}, {0x11a3f, 21}, {0x11a47, 12},
+	{0x11a48, 2}, {0x11a50, 7}, {0x11a51, 12}, {0x11a57, 10},
+	{0x11a59, 12}, {0x11a5c, 7}, {0x11a8a, 12}, {0x11a97, 10},
+	{0x11a98, 12}, {0x11a9a, 21}, {0x11a9d, 7}, {0x11a9e, 21},
+	{0x11aa3, 2}, {0x11ab0, 7}, {0x11af9, 2}, {0x11c00, 7}, {0x11c09, 2},
+	{0x11c0a, 7}, {0x11c2f, 10}, {0x11c30, 12}, {0x11c37, 2},
+	{0x11c38, 12}, {0x11c3e, 10}, {0x11c3f, 12}, {0x11c40, 7},
+	{0x11c41, 21}, {0x11c46, 2}, {0x11c50, 13}, {0x11c5a, 15},
+	{0x11c6d, 2}, {0x11c70, 21}, {0x11c72, 7}, {0x11c90, 2}, {0x11c92, 12},
+	{0x11ca8, 2}, {0x11ca9, 10}, {0x11caa, 12}, {0x11cb1, 10},
+	{0x11cb2, 12}, {0x11cb4, 10}, {0x11cb5, 12}, {0x11cb7, 2},
+	{0x11d00, 7}, {0x11d07, 2}, {0x11d08, 7}, {0x11d0a, 2}, {0x11d0b, 7},
+	{0x11d31, 12}, {0x11d37, 2}, {0x11d3a, 12}, {0x11d3b, 2},
+	{0x11d3c, 12}, {0x11d3e, 2}, {0x11d3f, 12}, {0x11d46, 7},
+	{0x11d47, 12}, {0x11d48, 2}, {0x11d50, 13}, {0x11d5a, 2}, {0x11d60, 7},
+	{0x11d66, 2}, {0x11d67, 7}, {0x11d69, 2}, {0x11d6a, 7}, {0x11d8a, 10},
+	{0x11d8f, 2}, {0x11d90, 12}, {0x11d92, 2}, {0x11d93, 10},
+	{0x11d95, 12}, {0x11d96, 10}, {0x11d97, 12}, {0x11d98, 7},
+	{0x11d99, 2}, {0x11da0, 13}, {0x11daa, 2}, {0x11ee0, 7}, {0x11ef3, 12},
+	{0x11ef5, 10}, {0x11ef7, 21}, {0x11ef9, 2}, {0x11fb0, 7}, {0x11fb1, 2},
+	{0x11fc0, 15}, {0x11fd5, 26}, {0x11fdd, 23}, {0x11fe1, 26},
+	{0x11ff2, 2}, {0x11fff, 21}, {0x12000, 7}, {0x1239a, 2}, {0x12400, 14},
+	{0x1246f, 2}, {0x12470, 21}, {0x12475, 2}, {0x12480, 7}, {0x12544, 2},
+	{0x12f90, 7}, {0x12ff1, 21}, {0x12ff3, 2}, {0x13000, 7}, {0x1342f, 2},
+	{0x13430, 1}, {0x13439, 2}, {0x14400, 7}, {0x14647, 2}, {0x16800, 7},
+	{0x16a39, 2}, {0x16a40, 7}, {0x16a5f, 2}, {0x16a60, 13}, {0x16a6a, 2},
+	{0x16a6e, 21}, {0x16a70, 7}, {0x16abf, 2}, {0x16ac0, 13}, {0x16aca, 2},
+	{0x16ad0, 7}, {0x16aee, 2}, {0x16af0, 12}, {0x16af5, 21}, {0x16af6, 2},
+	{0x16b00, 7}, {0x16b30, 12}, {0x16b37, 21}, {0x16b3c, 26},
+	{0x16b40, 6}, {0x16b44, 21}, {0x16b45, 26}, {0x16b46, 2},
+	{0x16b50, 13}, {0x16b5a, 2}, {0x16b5b, 15}, {0x16b62, 2}, {0x16b63, 7},
+	{0x16b78, 2}, {0x16b7d, 7}, {0x16b90, 2}, {0x16e40, 9}, {0x16e60, 5},
+	{0x16e80, 15}, {0x16e97, 21}, {0x16e9b, 2}, {0x16f00, 7}, {0x16f4b, 2},
+	{0x16f4f, 12}, {0x16f50, 7}, {0x16f51, 10}, {0x16f88, 2},
+	{0x16f8f, 12}, {0x16f93, 6}, {0x16fa0, 2}, {0x16fe0, 6}, {0x16fe2, 21},
+	{0x16fe3, 6}, {0x16fe4, 12}, {0x16fe5, 2}, {0x16ff0, 10}, {0x16ff2, 2},
+	{0x17000, 7}, {0x187f8, 2}, {0x18800, 7}, {0x18cd6, 2}, {0x18d00, 7},
+	{0x18d09, 2}, {0x1aff0, 6}, {0x1aff4, 2}, {0x1aff5, 6}, {0x1affc, 2},
+	{0x1affd, 6}, {0x1afff, 2}, {0x1b000, 7}, {0x1b123, 2}, {0x1b150, 7},
+	{0x1b153, 2}, {0x1b164, 7}, {0x1b168, 2}, {0x1b170, 7}, {0x1b2fc, 2},
+	{0x1bc00, 7}, {0x1bc6b, 2}, {0x1bc70, 7}, {0x1bc7d, 2}, {0x1bc80, 7},
+	{0x1bc89, 2}, {0x1bc90, 7}, {0x1bc9a, 2}, {0x1bc9c, 26}, {0x1bc9d, 12},
+	{0x1bc9f, 21}, {0x1bca0, 1}, {0x1bca4, 2}, {0x1cf00, 12}, {0x1cf2e, 2},
+	{0x1cf30, 12}, {0x1cf47, 2}, {0x1cf50, 26}, {0x1cfc4, 2},
+	{0x1d000, 26}, {0x1d0f6, 2}, {0x1d100, 26}, {0x1d127, 2},
+	{0x1d129, 26}, {0x1d165, 10}, {0x1d167, 12}, {0x1d16a, 26},
+	{0x1d16d, 10}, {0x1d173, 1}, {0x1d17b, 12}, {0x1d183, 26},
+	{0x1d185, 12}, {0x1d18c, 26}, {0x1d1aa, 12}, {0x1d1ae, 26},
+	{0x1d1eb, 2}, {0x1d200, 26}, {0x1d242, 12}, {0x1d245, 26},
+	{0x1d246, 2}, {0x1d2e0, 15}, {0x1d2f4, 2}, {0x1d300, 26}, {0x1d357, 2},
+	{0x1d360, 15}, {0x1d379, 2}, {0x1d400, 9}, {0x1d41a, 5}, {0x1d434, 9},
+	{0x1d44e, 5}, {0x1d455, 2}, {0x1d456, 5}, {0x1d468, 9}, {0x1d482, 5},
+	{0x1d49c, 9}, {0x1d49d, 2}, {0x1d49e, 9}, {0x1d4a0, 2}, {0x1d4a2, 9},
+	{0x1d4a3, 2}, {0x1d4a5, 9}, {0x1d4a7, 2}, {0x1d4a9, 9}, {0x1d4ad, 2},
+	{0x1d4ae, 9}, {0x1d4b6, 5}, {0x1d4ba, 2}, {0x1d4bb, 5}, {0x1d4bc, 2},
+	{0x1d4bd, 5}, {0x1d4c4, 2}, {0x1d4c5, 5}, {0x1d4d0, 9}, {0x1d4ea, 5},
+	{0x1d504, 9}, {0x1d506, 2}, {0x1d507, 9}, {0x1d50b, 2}, {0x1d50d, 9},
+	{0x1d515, 2}, {0x1d516, 9}, {0x1d51d, 2}, {0x1d51e, 5}, {0x1d538, 9},
+	{0x1d53a, 2}, {0x1d53b, 9}, {0x1d53f, 2}, {0x1d540, 9}, {0x1d545, 2},
+	{0x1d546, 9}, {0x1d547, 2}, {0x1d54a, 9}, {0x1d551, 2}, {0x1d552, 5},
+	{0x1d56c, 9}, {0x1d586, 5}, {0x1d5a0, 9}, {0x1d5ba, 5}, {0x1d5d4, 9},
+	{0x1d5ee, 5}, {0x1d608, 9}, {0x1d622, 5}, {0x1d63c, 9}, {0x1d656, 5},
+	{0x1d670, 9}, {0x1d68a, 5}, {0x1d6a6, 2}, {0x1d6a8, 9}, {0x1d6c1, 25},
+	{0x1d6c2, 5}, {0x1d6db, 25}, {0x1d6dc, 5}, {0x1d6e2, 9}, {0x1d6fb, 25},
+	{0x1d6fc, 5}, {0x1d715, 25}, {0x1d716, 5}, {0x1d71c, 9}, {0x1d735, 25},
+	{0x1d736, 5}, {0x1d74f, 25}, {0x1d750, 5}, {0x1d756, 9}, {0x1d76f, 25},
+	{0x1d770, 5}, {0x1d789, 25}, {0x1d78a, 5}, {0x1d790, 9}, {0x1d7a9, 25},
+	{0x1d7aa, 5}, {0x1d7c3, 25}, {0x1d7c4, 5}, {0x1d7ca, 9}, {0x1d7cb, 5},
+	{0x1d7cc, 2}, {0x1d7ce, 13}, {0x1d800, 26}, {0x1da00, 12},
+	{0x1da37, 26}, {0x1da3b, 12}, {0x1da6d, 26}, {0x1da75, 12},
+	{0x1da76, 26}, {0x1da84, 12}, {0x1da85, 26}, {0x1da87, 21},
+	{0x1da8c, 2}, {0x1da9b, 12}, {0x1daa0, 2}, {0x1daa1, 12}, {0x1dab0, 2},
+	{0x1df00, 5}, {0x1df0a, 7}, {0x1df0b, 5}, {0x1df1f, 2}, {0x1e000, 12},
+	{0x1e007, 2}, {0x1e008, 12}, {0x1e019, 2}, {0x1e01b, 12}, {0x1e022, 2},
+	{0x1e023, 12}, {0x1e025, 2}, {0x1e026, 12}, {0x1e02b, 2}, {0x1e100, 7},
+	{0x1e12d, 2}, {0x1e130, 12}, {0x1e137, 6}, {0x1e13e, 2}, {0x1e140, 13},
+	{0x1e14a, 2}, {0x1e14e, 7}, {0x1e14f, 26}, {0x1e150, 2}, {0x1e290, 7},
+	{0x1e2ae, 12}, {0x1e2af, 2}, {0x1e2c0, 7}, {0x1e2ec, 12},
+	{0x1e2f0, 13}, {0x1e2fa, 2}, {0x1e2ff, 23}, {0x1e300, 2}, {0x1e7e0, 7},
+	{0x1e7e7, 2}, {0x1e7e8, 7}, {0x1e7ec, 2}, {0x1e7ed, 7}, {0x1e7ef, 2},
+	{0x1e7f0, 7}, {0x1e7ff, 2}, {0x1e800, 7}, {0x1e8c5, 2}, {0x1e8c7, 15},
+	{0x1e8d0, 12}, {0x1e8d7, 2}, {0x1e900, 9}, {0x1e922, 5}, {0x1e944, 12},
+	{0x1e94b, 6}, {0x1e94c, 2}, {0x1e950, 13}, {0x1e95a, 2}, {0x1e95e, 21},
+	{0x1e960, 2}, {0x1ec71, 15}, {0x1ecac, 26}, {0x1ecad, 15},
+	{0x1ecb0, 23}, {0x1ecb1, 15}, {0x1ecb5, 2}, {0x1ed01, 15},
+	{0x1ed2e, 26}, {0x1ed2f, 15}, {0x1ed3e, 2}, {0x1ee00, 7}, {0x1ee04, 2},
+	{0x1ee05, 7}, {0x1ee20, 2}, {0x1ee21, 7}, {0x1ee23, 2}, {0x1ee24, 7},
+	{0x1ee25, 2}, {0x1ee27, 7}, {0x1ee28, 2}, {0x1ee29, 7}, {0x1ee33, 2},
+	{0x1ee34, 7}, {0x1ee38, 2}, {0x1ee39, 7}, {0x1ee3a, 2}, {0x1ee3b, 7},
+	{0x1ee3c, 2}, {0x1ee42, 7}, {0x1ee43, 2}, {0x1ee47, 7}, {0x1ee48, 2},
+	{0x1ee49, 7}, {0x1ee4a, 2}, {0x1ee4b, 7}, {0x1ee4c, 2}, {0x1ee4d, 7},
+	{0x1ee50, 2}, {0x1ee51, 7}, {0x1ee53, 2}, {0x1ee54, 7}, {0x1ee55, 2},
+	{0x1ee57, 7}, {0x1ee58, 2}, {0x1ee59, 7}, {0x1ee5a, 2}, {0x1ee5b, 7},
+	{0x1ee5c, 2}, {0x1ee5d, 7}, {0x1ee5e, 2}, {0x1ee5f, 7}, {0x1ee60, 2},
+	{0x1ee61, 7}, {0x1ee63, 2}, {0x1ee64, 7}, {0x1ee65, 2}, {0x1ee67, 7},
+	{0x1ee6b, 2}, {0x1ee6c, 7}, {0x1ee73, 2}, {0x1ee74, 7}, {0x1ee78, 2},
+	{0x1ee79, 7}, {0x1ee7d, 2}, {0x1ee7e, 7}, {0x1ee7f, 2}, {0x1ee80, 7},
+	{0x1ee8a, 2}, {0x1ee8b, 7}, {0x1ee9c, 2}, {0x1eea1, 7}, {0x1eea4, 2},
+	{0x1eea5, 7}, {0x1eeaa, 2}, {0x1eeab, 7}, {0x1eebc, 2}, {0x1eef0, 25},
+	{0x1eef2, 2}, {0x1f000, 26}, {0x1f02c, 2}, {0x1f030, 26}, {0x1f094, 2},
+	{0x1f0a0, 26}, {0x1f0af, 2}, {0x1f0b1, 26}, {0x1f0c0, 2},
+	{0x1f0c1, 26}, {0x1f0d0, 2}, {0x1f0d1, 26}, {0x1f0f6, 2},
+	{0x1f100, 15}, {0x1f10d, 26}, {0x1f1ae, 2}, {0x1f1e6, 26},
+	{0x1f203, 2}, {0x1f210, 26}, {0x1f23c, 2}, {0x1f240, 26}, {0x1f249, 2},
+	{0x1f250, 26}, {0x1f252, 2}, {0x1f260, 26}, {0x1f266, 2},
+	{0x1f300, 26}, {0x1f3fb, 24}, {0x1f400, 26}, {0x1f6d8, 2},
+	{0x1f6dd, 26}, {0x1f6ed, 2}, {0x1f6f0, 26}, {0x1f6fd, 2},
+	{0x1f700, 26}, {0x1f774, 2}, {0x1f780, 26}, {0x1f7d9, 2},
+	{0x1f7e0, 26}, {0x1f7ec, 2}, {0x1f7f0, 26}, {0x1f7f1, 2},
+	{0x1f800, 26}, {0x1f80c, 2}, {0x1f810, 26}, {0x1f848, 2},
+	{0x1f850, 26}, {0x1f85a, 2}, {0x1f860, 26}, {0x1f888, 2},
+	{0x1f890, 26}, {0x1f8ae, 2}, {0x1f8b0, 26}, {0x1f8b2, 2},
+	{0x1f900, 26}, {0x1fa54, 2}, {0x1fa60, 26}, {0x1fa6e, 2},
+	{0x1fa70, 26}, {0x1fa75, 2}, {0x1fa78, 26}, {0x1fa7d, 2},
+	{0x1fa80, 26}, {0x1fa87, 2}, {0x1fa90, 26}, {0x1faad, 2},
+	{0x1fab0, 26}, {0x1fabb, 2}, {0x1fac0, 26}, {0x1fac6, 2},
+	{0x1fad0, 26}, {0x1fada, 2}, {0x1fae0, 26}, {0x1fae8, 2},
+	{0x1faf0, 26}, {0x1faf7, 2}, {0x1fb00, 26}, {0x1fb93, 2},
+	{0x1fb94, 26}, {0x1fbcb, 2}, {0x1fbf0, 13}, {0x1fbfa, 2}, {0x20000, 7},
+	{0x2a6e0, 2}, {0x2a700, 7}, {0x2b739, 2}, {0x2b740, 7}, {0x2b81e, 2},
+	{0x2b820, 7}, {0x2cea2, 2}, {0x2ceb0, 7}, {0x2ebe1, 2}, {0x2f800, 7},
+	{0x2fa1e, 2}, {0x30000, 7}, {0x3134b, 2}, {0xe0001, 1}, {0xe0002, 2},
+	{0xe0020, 1}, {0xe0080, 2}, {0xe0100, 12}, {0xe01f0, 2}, {0xf0000, 3},
+	{0xffffe, 2}, {0x100000, 3}, {0x10fffe, 2},
+};
+
+/* names of the scripts in Scripts.txt of unicode 14.0 */
+static const char *const script_names[] = {
+	"Unknown", "Adlam", "Ahom", "Anatolian_Hieroglyphs", "Arabic",
+	"Armenian", "Avestan", "Balinese", "Bamum", "Bassa_Vah", "Batak",
+	"Bengali", "Bhaiksuki", "Bopomofo", "Brahmi", "Braille", "Buginese",
+	"Buhid", "Canadian_Aboriginal", "Carian", "Caucasian_Albanian",
+	"Chakma", "Cham", "Cherokee", "Chorasmian", "Common", "Coptic",
+	"Cuneiform", "Cypriot", "Cypro_Minoan", "Cyrillic", "Deseret",
+	"Devanagari", "Dives_Akuru", "Dogra", "Duployan",
+	"Egyptian_Hieroglyphs", "Elbasan", "Elymaic", "Ethiopic", "Georgian",
+	"Glagolitic", "Gothic", "Grantha", "Greek", "Gujarati",
+	"Gunjala_Gondi", "Gurmukhi", "Han", "Hangul", "Hanifi_Rohingya",
+	"Hanunoo", "Hatran", "Hebrew", "Hiragana", "Imperial_Aramaic",
+	"Inherited", "Inscriptional_Pahlavi", "Inscriptional_Parthian",
+	"Javanese", "Kaithi", "Kannada", "Katakana", "Kayah_Li", "Kharoshthi",
+	"Khitan_Small_Script", "Khmer", "Khojki", "Khudawadi", "Lao", "Latin",
+	"Lepcha", "Limbu", "Linear_A", "Linear_B", "Lisu", "Lycian", "Lydian",
+	"Mahajani", "Makasar", "Malayalam", "Mandaic", "Manichaean", "Marchen",
+	"Masaram_Gondi", "Medefaidrin", "Meetei_Mayek", "Mende_Kikakui",
+	"Meroitic_Cursive", "Meroitic_Hieroglyphs", "Miao", "Modi",
+	"Mongolian", "Mro", "Multani", "Myanmar", "Nabataean", "Nandinagari",
+	"New_Tai_Lue", "Newa", "Nko", "Nushu", "Nyiakeng_Puachue_Hmong",
+	"Ogham", "Ol_Chiki", "Old_Hungarian", "Old_Italic",
+	"Old_North_Arabian", "Old_Permic", "Old_Persian", "Old_Sogdian",
+	"Old_South_Arabian", "Old_Turkic", "Old_Uyghur", "Oriya", "Osage",
+	"Osmanya", "Pahawh_Hmong", "Palmyrene", "Pau_Cin_Hau", "Phags_Pa",
+	"Phoenician", "Psalter_Pahlavi", "Rejang", "Runic", "Samaritan",
+	"Saurashtra", "Sharada", "Shavian", "Siddham", "SignWriting",
+	"Sinhala", "Sogdian", "Sora_Sompeng", "Soyombo", "Sundanese",
+	"Syloti_Nagri", "Syriac", "Tagalog", "Tagbanwa", "Tai_Le", "Tai_Tham",
+	"Tai_Viet", "Takri", "Tamil", "Tangsa", "Tangut", "Telugu", "Thaana",
+	"Thai", "Tibetan", "Tifinagh", "Tirhuta", "Toto", "Ugaritic", "Vai",
+	"Vithkuqi", "Wancho", "Warang_Citi", "Yezidi", "Yi",
+	"Zanabazar_Square",
+};
+
+/* script of all characters as indices into script_names, from
+ * Scripts.txt of unicode 14.0. the first script is the one of
+ * unassigned characters */
+static const PropertyRun script_runs[] = {
+	{0x0, 25}, {0x41, 70}, {0x5b, 25}, {0x61, 70}, {0x7b, 25}, {0xaa, 70},
+	{0xab, 25}, {0xba, 70}, {0xbb, 25}, {0xc0, 70}, {0xd7, 25}, {0xd8, 70},
+	{0xf7, 25}, {0xf8, 70}, {0x2b9, 25}, {0x2e0, 70}, {0x2e5, 25},
+	{0x2ea, 13}, {0x2ec, 25}, {0x300, 56}, {0x370, 44}, {0x374, 25},
+	{0x375, 44}, {0x378, 0}, {0x37a, 44}, {0x37e, 25}, {0x37f, 44},
+	{0x380, 0}, {0x384, 44}, {0x385, 25}, {0x386, 44}, {0x387, 25},
+	{0x388, 44}, {0x38b, 0}, {0x38c, 44}, {0x38d, 0}, {0x38e, 44},
+	{0x3a2, 0}, {0x3a3, 44}, {0x3e2, 26}, {0x3f0, 44}, {0x400, 30},
+	{0x485, 56}, {0x487, 30}, {0x530, 0}, {0x531, 5}, {0x557, 0},
+	{0x559, 5}, {0x58b, 0}, {0x58d, 5}, {0x590, 0}, {0x591, 53},
+	{0x5c8, 0}, {0x5d0, 53}, {0x5eb, 0}, {0x5ef, 53}, {0x5f5, 0},
+	{0x600, 4}, {0x605, 25}, {0x606, 4}, {0x60c, 25}, {0x60d, 4},
+	{0x61b, 25}, {0x61c, 4}, {0x61f, 25}, {0x620, 4}, {0x640, 25},
+	{0x641, 4}, {0x64b, 56}, {0x656, 4}, {0x670, 56}, {0x671, 4},
+	{0x6dd, 25}, {0x6de, 4}, {0x700, 137}, {0x70e, 0}, {0x70f, 137},
+	{0x74b, 0}, {0x74d, 137}, {0x750, 4}, {0x780, 148}, {0x7b2, 0},
+	{0x7c0, 100}, {0x7fb, 0}, {0x7fd, 100}, {0x800, 125}, {0x82e, 0},
+	{0x830, 125}, {0x83f, 0}, {0x840, 81}, {0x85c, 0}, {0x85e, 81},
+	{0x85f, 0}, {0x860, 137}, {0x86b, 0}, {0x870, 4}, {0x88f, 0},
+	{0x890, 4}, {0x892, 0}, {0x898, 4}, {0x8e2, 25}, {0x8e3, 4},
+	{0x900, 32}, {0x951, 56}, {0x955, 32}, {0x964, 25}, {0x966, 32},
+	{0x980, 11}, {0x984, 0}, {0x985, 11}, {0x98d, 0}, {0x98f, 11},
+	{0x991, 0}, {0x993, 11}, {0x9a9, 0}, {0x9aa, 11}, {0x9b1, 0},
+	{0x9b2, 11}, {0x9b3, 0}, {0x9b6, 11}, {0x9ba, 0}, {0x9bc, 11},
+	{0x9c5, 0}, {0x9c7, 11}, {0x9c9, 0}, {0x9cb, 11}, {0x9cf, 0},
+	{0x9d7, 11}, {0x9d8, 0}, {0x9dc, 11}, {0x9de, 0}, {0x9df, 11},
+	{0x9e4, 0}, {0x9e6, 11}, {0x9ff, 0}, {0xa01, 47}, {0xa04, 0},
+	{0xa05, 47}, {0xa0b, 0}, {0xa0f, 47}, {0xa11, 0}, {0xa13, 47},
+	{0xa29, 0}, {0xa2a, 47}, {0xa31, 0}, {0xa32, 47}, {0xa34, 0},
+	{0xa35, 47}, {0xa37, 0}, {0xa38, 47}, {0xa3a, 0}, {0xa3c, 47},
+	{0xa3d, 0}, {0xa3e, 47}, {0xa43, 0}, {0xa47, 47}, {0xa49, 0},
+	{0xa4b, 47}, {0xa4e, 0}, {0xa51, 47}, {0xa52, 0}, {0xa59, 47},
+	{0xa5d, 0}, {0xa5e, 47}, {0xa5f, 0}, {0xa66, 47}, {0xa77, 0},
+	{0xa81, 45}, {0xa84, 0}, {0xa85, 45}, {0xa8e, 0}, {0xa8f, 45},
+	{0xa92, 0}, {0xa93, 45}, {0xaa9, 0}, {0xaaa, 45}, {0xab1, 0},
+	{0xab2, 45}, {0xab4, 0}, {0xab5, 45}, {0xaba, 0}, {0xabc, 45},
+	{0xac6, 0}, {0xac7, 45}, {0xaca, 0}, {0xacb, 45}, {0xace, 0},
+	{0xad0, 45}, {0xad1, 0}, {0xae0, 45}, {0xae4, 0}, {0xae6, 45},
+	{0xaf2, 0}, {0xaf9, 45}, {0xb00, 0}, {0xb01, 114}, {0xb04, 0},
+	{0xb05, 114}, {0xb0d, 0}, {0xb0f, 114}, {0xb11, 0}, {0xb13, 114},
+	{0xb29, 0}, {0xb2a, 114}, {0xb31, 0}, {0xb32, 114}, {0xb34, 0},
+	{0xb35, 114}, {0xb3a, 0}, {0xb3c, 114}, {0xb45, 0}, {0xb47, 114},
+	{0xb49, 0}, {0xb4b, 114}, {0xb4e, 0}, {0xb55, 114}, {0xb58, 0},
+	{0xb5c, 114}, {0xb5e, 0}, {0xb5f, 114}, {0xb64, 0}, {0xb66, 114},
+	{0xb78, 0}, {0xb82, 144}, {0xb84, 0}, {0xb85, 144}, {0xb8b, 0},
+	{0xb8e, 144}, {0xb91, 0}, {0xb92, 144}, {0xb96, 0}, {0xb99, 144},
+	{0xb9b, 0}, {0xb9c, 144}, {0xb9d, 0}, {0xb9e, 144}, {0xba0, 0},
+	{0xba3, 144}, {0xba5, 0}, {0xba8, 144}, {0xbab, 0}, {0xbae, 144},
+	{0xbba, 0}, {0xbbe, 144}, {0xbc3, 0}, {0xbc6, 144}, {0xbc9, 0},
+	{0xbca, 144}, {0xbce, 0}, {0xbd0, 144}, {0xbd1, 0}, {0xbd7, 144},
+	{0xbd8, 0}, {0xbe6, 144}, {0xbfb, 0}, {0xc00, 147}, {0xc0d, 0},
+	{0xc0e, 147}, {0xc11, 0}, {0xc12, 147}, {0xc29, 0}, {0xc2a, 147},
+	{0xc3a, 0}, {0xc3c, 147}, {0xc45, 0}, {0xc46, 147}, {0xc49, 0},
+	{0xc4a, 147}, {0xc4e, 0}, {0xc55, 147}, {0xc57, 0}, {0xc58, 147},
+	{0xc5b, 0}, {0xc5d, 147}, {0xc5e, 0}, {0xc60, 147}, {0xc64, 0},
+	{0xc66, 147}, {0xc70, 0}, {0xc77, 147}, {0xc80, 61}, {0xc8d, 0},
+	{0xc8e, 61}, {0xc91, 0}, {0xc92, 61}, {0xca9, 0}, {0xcaa, 61},
+	{0xcb4, 0}, {0xcb5, 61}, {0xcba, 0}, {0xcbc, 61}, {0xcc5, 0},
+	{0xcc6, 61}, {0xcc9, 0}, {0xcca, 61}, {0xcce, 0}, {0xcd5, 61},
+	{0xcd7, 0}, {0xcdd, 61}, {0xcdf, 0}, {0xce0, 61}, {0xce4, 0},
+	{0xce6, 61}, {0xcf0, 0}, {0xcf1, 61}, {0xcf3, 0}, {0xd00, 80},
+	{0xd0d, 0}, {0xd0e, 80}, {0xd11, 0}, {0xd12, 80}, {0xd45, 0},
+	{0xd46, 80}, {0xd49, 0}, {0xd4a, 80}, {0xd50, 0}, {0xd54, 80},
+	{0xd64, 0}, {0xd66, 80}, {0xd80, 0}, {0xd81, 131}, {0xd84, 0},
+	{0xd85, 131}, {0xd97, 0}, {0xd9a, 131}, {0xdb2, 0}, {0xdb3, 131},
+	{0xdbc, 0}, {0xdbd, 131}, {0xdbe, 0}, {0xdc0, 131}, {0xdc7, 0},
+	{0xdca, 131}, {0xdcb, 0}, {0xdcf, 131}, {0xdd5, 0}, {0xdd6, 131},
+	{0xdd7, 0}, {0xdd8, 131}, {0xde0, 0}, {0xde6, 131}, {0xdf0, 0},
+	{0xdf2, 131}, {0xdf5, 0}, {0xe01, 149}, {0xe3b, 0}, {0xe3f, 25},
+	{0xe40, 149}, {0xe5c, 0}, {0xe81, 69}, {0xe83, 0}, {0xe84, 69},
+	{0xe85, 0}, {0xe86, 69}, {0xe8b, 0}, {0xe8c, 69}, {0xea4, 0},
+	{0xea5, 69}, {0xea6, 0}, {0xea7, 69}, {0xebe, 0}, {0xec0, 69},
+	{0xec5, 0}, {0xec6, 69}, {0xec7, 0}, {0xec8, 69}, {0xece, 0},
+	{0xed0, 69}, {0xeda, 0}, {0xedc, 69}, {0xee0, 0}, {0xf00, 150},
+	{0xf48, 0}, {0xf49, 150}, {0xf6d, 0}, {0xf71, 150}, {0xf98, 0},
+	{0xf99, 150}, {0xfbd, 0}, {0xfbe, 150}, {0xfcd, 0}, {0xfce, 150},
+	{0xfd5, 25}, {0xfd9, 150}, {0xfdb, 0}, {0x1000, 95}, {0x10a0, 40},
+	{0x10c6, 0}, {0x10c7, 40}, {0x10c8, 0}, {0x10cd, 40}, {0x10ce, 0},
+	{0x10d0, 40}, {0x10fb, 25}, {0x10fc, 40}, {0x1100, 49}, {0x1200, 39},
+	{0x1249, 0}, {0x124a, 39}, {0x124e, 0}, {0x1250, 39}, {0x1257, 0},
+	{0x1258, 39}, {0x1259, 0}, {0x125a, 39}, {0x125e, 0}, {0x1260, 39},
+	{0x1289, 0}, {0x128a, 39}, {0x128e, 0}, {0x1290, 39}, {0x12b1, 0},
+	{0x12b2, 39}, {0x12b6, 0}, {0x12b8, 39}, {0x12bf, 0}, {0x12c0, 39},
+	{0x12c1, 0}, {0x12c2, 39}, {0x12c6, 0}, {0x12c8, 39}, {0x12d7, 0},
+	{0x12d8, 39}, {0x1311, 0}, {0x1312, 39}, {0x1316, 0}, {0x1318, 39},
+	{0x135b, 0}, {0x135d, 39}, {0x137d, 0}, {0x1380, 39}, {0x139a, 0},
+	{0x13a0, 23}, {0x13f6, 0}, {0x13f8, 23}, {0x13fe, 0}, {0x1400, 18},
+	{0x1680, 103}, {0x169d, 0}, {0x16a0, 124}, {0x16eb, 25}, {0x16ee, 124},
+	{0x16f9, 0}, {0x1700, 138}, {0x1716, 0}, {0x171f, 138}, {0x1720, 51},
+	{0x1735, 25}, {0x1737, 0}, {0x1740, 17}, {0x1754, 0}, {0x1760, 139},
+	{0x176d, 0}, {0x176e, 139}, {0x1771, 0}, {0x1772, 139}, {0x1774, 0},
+	{0x1780, 66}, {0x17de, 0}, {0x17e0, 66}, {0x17ea, 0}, {0x17f0, 66},
+	{0x17fa, 0}, {0x1800, 92}, {0x1802, 25}, {0x1804, 92}, {0x1805, 25},
+	{0x1806, 92}, {0x181a, 0}, {0x1820, 92}, {0x1879, 0}, {0x1880, 92},
+	{0x18ab, 0}, {0x18b0, 18}, {0x18f6, 0}, {0x1900, 72}, {0x191f, 0},
+	{0x1920, 72}, {0x192c, 0}, {0x1930, 72}, {0x193c, 0}, {0x1940, 72},
+	{0x1941, 0}, {0x1944, 72}, {0x1950, 140}, {0x196e, 0}, {0x1970, 140},
+	{0x1975, 0}, {0x1980, 98}, {0x19ac, 0}, {0x19b0, 98}, {0x19ca, 0},
+	{0x19d0, 98}, {0x19db, 0}, {0x19de, 98}, {0x19e0, 66}, {0x1a00, 16},
+	{0x1a1c, 0}, {0x1a1e, 16}, {0x1a20, 141}, {0x1a5f, 0}, {0x1a60, 141},
+	{0x1a7d, 0}, {0x1a7f, 141}, {0x1a8a, 0}, {0x1a90, 141}, {0x1a9a, 0},
+	{0x1aa0, 141}, {0x1aae, 0}, {0x1ab0, 56}, {0x1acf, 0}, {0x1b00, 7},
+	{0x1b4d, 0}, {0x1b50, 7}, {0x1b7f, 0}, {0x1b80, 135}, {0x1bc0, 10},
+	{0x1bf4, 0}, {0x1bfc, 10}, {0x1c00, 71}, {0x1c38, 0}, {0x1c3b, 71},
+	{0x1c4a, 0}, {0x1c4d, 71}, {0x1c50, 104}, {0x1c80, 30}, {0x1c89, 0},
+	{0x1c90, 40}, {0x1cbb, 0}, {0x1cbd, 40}, {0x1cc0, 135}, {0x1cc8, 0},
+	{0x1cd0, 56}, {0x1cd3, 25}, {0x1cd4, 56}, {0x1ce1, 25}, {0x1ce2, 56},
+	{0x1ce9, 25}, {0x1ced, 56}, {0x1cee, 25}, {0x1cf4, 56}, {0x1cf5, 25},
+	{0x1cf8, 56}, {0x1cfa, 25}, {0x1cfb, 0}, {0x1d00, 70}, {0x1d26, 44},
+	{0x1d2b, 30}, {0x1d2c, 70}, {0x1d5d, 44}, {0x1d62, 70}, {0x1d66, 44},
+	{0x1d6b, 70}, {0x1d78, 30}, {0x1d79, 70}, {0x1dbf, 44}, {0x1dc0, 56},
+	{0x1e00, 70}, {0x1f00, 44}, {0x1f16, 0}, {0x1f18, 44}, {0x1f1e, 0},
+	{0x1f20, 44}, {0x1f46, 0}, {0x1f48, 44}, {0x1f4e, 0}, {0x1f50, 44},
+	{0x1f58, 0}, {0x1f59, 44}, {0x1f5a, 0}, {0x1f5b, 44}, {0x1f5c, 0},
+	{0x1f5d, 44}, {0x1f5e, 0}, {0x1f5f, 44}, {0x1f7e, 0}, {0x1f80, 44},
+	{0x1fb5, 0}, {0x1fb6, 44}, {0x1fc5, 0}, {0x1fc6, 44}, {0x1fd4, 0},
+	{0x1fd6, 44}, {0x1fdc, 0}, {0x1fdd, 44}, {0x1ff0, 0}, {0x1ff2, 44},
+	{0x1ff5, 0}, {0x1ff6, 44}, {0x1fff, 0}, {0x2000, 25}, {0x200c, 56},
+	{0x200e, 25}, {0x2065, 0}, {0x2066, 25}, {0x2071, 70}, {0x2072, 0},
+	{0x2074, 25}, {0x207f, 70}, {0x2080, 25}, {0x208f, 0}, {0x2090, 70},
+	{0x209d, 0}, {0x20a0, 25}, {0x20c1, 0}, {0x20d0, 56}, {0x20f1, 0},
+	{0x2100, 25}, {0x2126, 44}, {0x2127, 25}, {0x212a, 70}, {0x212c, 25},
+	{0x2132, 70}, {0x2133, 25}, {0x214e, 70}, {0x214f, 25}, {0x2160, 70},
+	{0x2189, 25}, {0x218c, 0}, {0x2190, 25}, {0x2427, 0}, {0x2440, 25},
+	{0x244b, 0}, {0x2460, 25}, {0x2800, 15}, {0x2900, 25}, {0x2b74, 0},
+	{0x2b76, 25}, {0x2b96, 0}, {0x2b97, 25}, {0x2c00, 41}, {0x2c60, 70},
+	{0x2c80, 26}, {0x2cf4, 0}, {0x2cf9, 26}, {0x2d00, 40}, {0x2d26, 0},
+	{0x2d27, 40}, {0x2d28, 0}, {0x2d2d, 40}, {0x2d2e, 0}, {0x2d30, 151},
+	{0x2d68, 0}, {0x2d6f, 151}, {0x2d71, 0}, {0x2d7f, 151}, {0x2d80, 39},
+	{0x2d97, 0}, {0x2da0, 39}, {0x2da7, 0}, {0x2da8, 39}, {0x2daf, 0},
+	{0x2db0, 39}, {0x2db7, 0}, {0x2db8, 39}, {0x2dbf, 0}, {0x2dc0, 39},
+	{0x2dc7, 0}, {0x2dc8, 39}, {0x2dcf, 0}, {0x2dd0, 39}, {0x2dd7, 0},
+	{0x2dd8, 39}, {0x2ddf, 0}, {0x2de0, 30}, {0x2e00, 25}, {0x2e5e, 0},
+	{0x2e80, 48}, {0x2e9a, 0}, {0x2e9b, 48}, {0x2ef4, 0}, {0x2f00, 48},
+	{0x2fd6, 0}, {0x2ff0, 25}, {0x2ffc, 0}, {0x3000, 25}, {0x3005, 48},
+	{0x3006, 25}, {0x3007, 48}, {0x3008, 25}, {0x3021, 48}, {0x302a, 56},
+	{0x302e, 49}, {0x3030, 25}, {0x3038, 48}, {0x303c, 25}, {0x3040, 0},
+	{0x3041, 54}, {0x3097, 0}, {0x3099, 56}, {0x309b, 25}, {0x309d, 54},
+	{0x30a0, 25}, {0x30a1, 62}, {0x30fb, 25}, {0x30fd, 62}, {0x3100, 0},
+	{0x3105, 13}, {0x3130, 0}, {0x3131, 49}, {0x318f, 0}, {0x3190, 25},
+	{0x31a0, 13}, {0x31c0, 25}, {0x31e4, 0}, {0x31f0, 62}, {0x3200, 49},
+	{0x321f, 0}, {0x3220, 25}, {0x3260, 49}, {0x327f, 25}, {0x32d0, 62},
+	{0x32ff, 25}, {0x3300, 62}, {0x3358, 25}, {0x3400, 48}, {0x4dc0, 25},
+	{0x4e00, 48}, {0xa000, 160}, {0xa48d, 0}, {0xa490, 160}, {0xa4c7, 0},
+	{0xa4d0, 75}, {0xa500, 155}, {0xa62c, 0}, {0xa640, 30}, {0xa6a0, 8},
+	{0xa6f8, 0}, {0xa700, 25}, {0xa722, 70}, {0xa788, 25}, {0xa78b, 70},
+	{0xa7cb, 0}, {0xa7d0, 70}, {0xa7d2, 0}, {0xa7d3, 70}, {0xa7d4, 0},
+	{0xa7d5, 70}, {0xa7da, 0}, {0xa7f2, 70}, {0xa800, 136}, {0xa82d, 0},
+	{0xa830, 25}, {0xa83a, 0}, {0xa840, 120}, {0xa878, 0}, {0xa880, 126},
+	{0xa8c6, 0}, {0xa8ce, 126}, {0xa8da, 0}, {0xa8e0, 32}, {0xa900, 63},
+	{0xa92e, 25}, {0xa92f, 63}, {0xa930, 123}, {0xa954, 0}, {0xa95f, 123},
+	{0xa960, 49}, {0xa97d, 0}, {0xa980, 59}, {0xa9ce, 0}, {0xa9cf, 25},
+	{0xa9d0, 59}, {0xa9da, 0}, {0xa9de, 59}, {0xa9e0, 95}, {0xa9ff, 0},
+	{0xaa00, 22}, {0xaa37, 0}, {0xaa40, 22}, {0xaa4e, 0}, {0xaa50, 22},
+	{0xaa5a, 0}, {0xaa5c, 22}, {0xaa60, 95}, {0xaa80, 142}, {0xaac3, 0},
+	{0xaadb, 142}, {0xaae0, 86}, {0xaaf7, 0}, {0xab01, 39}, {0xab07, 0},
+	{0xab09, 39}, {0xab0f, 0}, {0xab11, 39}, {0xab17, 0}, {0xab20, 39},
+	{0xab27, 0}, {0xab28, 39}, {0xab2f, 0}, {0xab30, 70}, {0xab5b, 25},
+	{0xab5c, 70}, {0xab65, 44}, {0xab66, 70}, {0xab6a, 25}, {0xab6c, 0},
+	{0xab70, 23}, {0xabc0, 86}, {0xabee, 0}, {0xabf0, 86}, {0xabfa, 0},
+	{0xac00, 49}, {0xd7a4, 0}, {0xd7b0, 49}, {0xd7c7, 0}, {0xd7cb, 49},
+	{0xd7fc, 0}, {0xf900, 48}, {0xfa6e, 0}, {0xfa70, 48}, {0xfada, 0},
+	{0xfb00, 70}, {0xfb07, 0}, {0xfb13, 5}, {0xfb18, 0}, {0xfb1d, 53},
+	{0xfb37, 0}, {0xfb38, 53}, {0xfb3d, 0}, {0xfb3e, 53}, {0xfb3f, 0},
+	{0xfb40, 53}, {0xfb42, 0}, {0xfb43, 53}, {0xfb45, 0}, {0xfb46, 53},
+	{0xfb50, 4}, {0xfbc3, 0}, {0xfbd3, 4}, {0xfd3e, 25}, {0xfd40, 4},
+	{0xfd90, 0}, {0xfd92, 4}, {0xfdc8, 0}, {0xfdcf, 4}, {0xfdd0, 0},
+	{0xfdf0, 4}, {0xfe00, 56}, {0xfe10, 25}, {0xfe1a, 0}, {0xfe20, 56},
+	{0xfe2e, 30}, {0xfe30, 25}, {0xfe53, 0}, {0xfe54, 25}, {0xfe67, 0},
+	{0xfe68, 25}, {0xfe6c, 0}, {0xfe70, 4}, {0xfe75, 0}, {0xfe76, 4},
+	{0xfefd, 0}, {0xfeff, 25}, {0xff00, 0}, {0xff01, 25}, {0xff21, 70},
+	{0xff3b, 25}, {0xff41, 70}, {0xff5b, 25}, {0xff66, 62}, {0xff70, 25},
+	{0xff71, 62}, {0xff9e, 25}, {0xffa0, 49}, {0xffbf, 0}, {0xffc2, 49},
+	{0xffc8, 0}, {0xffca, 49}, {0xffd0, 0}, {0xffd2, 49}, {0xffd8, 0},
+	{0xffda, 49}, {0xffdd, 0}, {0xffe0, 25}, {0xffe7, 0}, {0xffe8, 25},
+	{0xffef, 0}, {0xfff9, 25}, {0xfffe, 0}, {0x10000, 74}, {0x1000c, 0},
+	{0x1000d, 74}, {0x10027, 0}, {0x10028, 74}, {0x1003b, 0},
+	{0x1003c, 74}, {0x1003e, 0}, {0x1003f, 74}, {0x1004e, 0},
+	{0x10050, 74}, {0x1005e, 0}, {0x10080, 74}, {0x100fb, 0},
+	{0x10100, 25}, {0x10103, 0}, {0x10107, 25}, {0x10134, 0},
+	{0x10137, 25}, {0x10140, 44}, {0x1018f, 0}, {0x10190, 25},
+	{0x1019d, 0}, {0x101a0, 44}, {0x101a1, 0}, {0x101d0, 25},
+	{0x101fd, 56}, {0x101fe, 0}, {0x10280, 76}, {0x1029d, 0},
+	{0x102a0, 19}, {0x102d1, 0}, {0x102e0, 56}, {0x102e1, 25},
+	{0x102fc, 0}, {0x10300, 106}, {0x10324, 0}, {0x1032d, 106},
+	{0x10330, 42}, {0x1034b, 0}, {0x10350, 108}, {0x1037b, 0},
+	{0x10380, 154}, {0x1039e, 0}, {0x1039f, 154}, {0x103a0, 109},
+	{0x103c4, 0}, {0x103c8, 109}, {0x103d6, 0}, {0x10400, 31},
+	{0x10450, 128}, {0x10480, 116}, {0x1049e, 0}, {0x104a0, 116},
+	{0x104aa, 0}, {0x104b0, 115}, {0x104d4, 0}, {0x104d8, 115},
+	{0x104fc, 0}, {0x10500, 37}, {0x10528, 0}, {0x10530, 20}, {0x10564, 0},
+	{0x1056f, 20}, {0x10570, 156}, {0x1057b, 0}, {0x1057c, 156},
+	{0x1058b, 0}, {0x1058c, 156}, {0x10593, 0}, {0x10594, 156},
+	{0x10596, 0}, {0x10597, 156}, {0x105a2, 0}, {0x105a3, 156},
+	{0x105b2, 0}, {0x105b3, 156}, {0x105ba, 0}, {0x105bb, 156},
+	{0x105bd, 0}, {0x10600, 73}, {0x10737, 0}, {0x10740, 73}, {0x10756, 0},
+	{0x10760, 73}, {0x10768, 0}, {0x10780, 70}, {0x10786, 0},
+	{0x10787, 70}, {0x107b1, 0}, {0x107b2, 70}, {0x107bb, 0},
+	{0x10800, 28}, {0x10806, 0}, {0x10808, 28}, {0x10809, 0},
+	{0x1080a, 28}, {0x10836, 0}, {0x10837, 28}, {0x10839, 0},
+	{0x1083c, 28}, {0x1083d, 0}, {0x1083f, 28}, {0x10840, 55},
+	{0x10856, 0}, {0x10857, 55}, {0x10860, 118}, {0x10880, 96},
+	{0x1089f, 0}, {0x108a7, 96}, {0x108b0, 0}, {0x108e0, 52}, {0x108f3, 0},
+	{0x108f4, 52}, {0x108f6, 0}, {0x108fb, 52}, {0x10900, 121},
+	{0x1091c, 0}, {0x1091f, 121}, {0x10920, 77}, {0x1093a, 0},
+	{0x1093f, 77}, {0x10940, 0}, {0x10980, 89}, {0x109a0, 88},
+	{0x109b8, 0}, {0x109bc, 88}, {0x109d0, 0}, {0x109d2, 88},
+	{0x10a00, 64}, {0x10a04, 0}, {0x10a05, 64}, {0x10a07, 0},
+	{0x10a0c, 64}, {0x10a14, 0}, {0x10a15, 64}, {0x10a18, 0},
+	{0x10a19, 64}, {0x10a36, 0}, {0x10a38, 64}, {0x10a3b, 0},
+	{0x10a3f, 64}, {0x10a49, 0}, {0x10a50, 64}, {0x10a59, 0},
+	{0x10a60, 111}, {0x10a80, 107}, {0x10aa0, 0}, {0x10ac0, 82},
+	{0x10ae7, 0}, {0x10aeb, 82}, {0x10af7, 0}, {0x10b00, 6}, {0x10b36, 0},
+	{0x10b39, 6}, {0x10b40, 58}, {0x10b56, 0}, {0x10b58, 58},
+	{0x10b60, 57}, {0x10b73, 0}, {0x10b78, 57}, {0x10b80, 122},
+	{0x10b92, 0}, {0x10b99, 122}, {0x10b9d, 0}, {0x10ba9, 122},
+	{0x10bb0, 0}, {0x10c00, 112}, {0x10c49, 0}, {0x10c80, 105},
+	{0x10cb3, 0}, {0x10cc0, 105}, {0x10cf3, 0}, {0x10cfa, 105},
+	{0x10d00, 50}, {0x10d28, 0}, {0x10d30, 50}, {0x10d3a, 0}, {0x10e60, 4},
+	{0x10e7f, 0}, {0x10e80, 159}, {0x10eaa, 0}, {0x10eab, 159},
+	{0x10eae, 0}, {0x10eb0, 159}, {0x10eb2, 0}, {0x10f00, 110},
+	{0x10f28, 0}, {0x10f30, 132}, {0x10f5a, 0}, {0x10f70, 113},
+	{0x10f8a, 0}, {0x10fb0, 24}, {0x10fcc, 0}, {0x10fe0, 38}, {0x10ff7, 0},
+	{0x11000, 14}, {0x1104e, 0}, {0x11052, 14}, {0x11076, 0},
+	{0x1107f, 14}, {0x11080, 60}, {0x110c3, 0}, {0x110cd, 60},
+	{0x110ce, 0}, {0x110d0, 133}, {0x110e9, 0}, {0x110f0, 133},
+	{0x110fa, 0}, {0x11100, 21}, {0x11135, 0}, {0x11136, 21}, {0x11148, 0},
+	{0x11150, 78}, {0x11177, 0}, {0x11180, 127}, {0x111e0, 0},
+	{0x111e1, 131}, {0x111f5, 0}, {0x11200, 67}, {0x11212, 0},
+	{0x11213, 67}, {0x1123f, 0}, {0x11280, 94}, {0x11287, 0},
+	{0x11288, 94}, {0x11289, 0}, {0x1128a, 94}, {0x1128e, 0},
+	{0x1128f, 94}, {0x1129e, 0}, {0x1129f, 94}, {0x112aa, 0},
+	{0x112b0, 68}, {0x112eb, 0}, {0x112f0, 68}, {0x112fa, 0},
+	{0x11300, 43}, {0x11304, 0}, {0x11305, 43}, {0x1130d, 0},
+	{0x1130f, 43}, {0x11311, 0}, {0x11313, 43}, {0x11329, 0},
+	{0x1132a, 43}, {0x11331, 0}, {0x11332, 43}, {0x11334, 0},
+	{0x11335, 43}, {0x1133a, 0}, {0x1133b, 56}, {0x1133c, 43},
+	{0x11345, 0}, {0x11347, 43}, {0x11349, 0}, {0x1134b, 43}, {0x1134e, 0},
+	{0x11350, 43}, {0x11351, 0}, {0x11357, 43}, {0x11358, 0},
+	{0x1135d, 43}, {0x11364, 0}, {0x11366, 43}, {0x1136d, 0},
+	{0x11370, 43}, {0x11375, 0}, {0x11400, 99}, {0x1145c, 0},
+	{0x1145d, 99}, {0x11462, 0}, {0x11480, 152}, {0x114c8, 0},
+	{0x114d0, 152}, {0x114da, 0}, {0x11580, 129}, {0x115b6, 0},
+	{0x115b8, 129}, {0x115de, 0}, {0x11600, 91}, {0x11645, 0},
+	{0x11650, 91}, {0x1165a, 0}, {0x11660, 92}, {0x1166d, 0},
+	{0x11680, 143}, {0x116ba, 0}, {0x116c0, 143}, {0x116ca, 0},
+	{0x11700, 2}, {0x1171b, 0}, {0x1171d, 2}, {0x1172c, 0}, {0x11730, 2},
+	{0x11747, 0}, {0x11800, 34}, {0x1183c, 0}, {0x118a0, 158},
+	{0x118f3, 0}, {0x118ff, 158}, {0x11900, 33}, {0x11907, 0},
+	{0x11909, 33}, {0x1190a, 0}, {0x1190c, 33}, {0x11914, 0},
+	{0x11915, 33}, {0x11917, 0}, {0x11918, 33}, {0x11936, 0},
+	{0x11937, 33}, {0x11939, 0}, {0x1193b, 33}, {0x11947, 0},
+	{0x11950, 33}, {0x1195a, 0}, {0x119a0, 97}, {0x119a8, 0},
+	{0x119aa, 97}, {0x119d8, 0}, {0x119da, 97}, {0x119e5, 0},
+	{0x11a00, 161}, {0x11a48, 0}, {0x11a50, 134}, {0x11aa3, 0},
+	{0x11ab0, 18}, {0x11ac0, 119}, {0x11af9, 0}, {0x11c00, 12},
+	{0x11c09, 0}, {0x11c0a, 12}, {0x11c37, 0}, {0x11c38, 12}, {0x11c46, 0},
+	{0x11c50, 12}, {0x11c6d, 0}, {0x11c70, 83}, {0x11c90, 0},
+	{0x11c92, 83}, {0x11ca8, 0}, {0x11ca9, 83}, {0x11cb7, 0},
+	{0x11d00, 84}, {0x11d07, 0}, {0x11d08, 84}, {0x11d0a, 0},
+	{0x11d0b, 84}, {0x11d37, 0}, {0x11d3a, 84}, {0x11d3b, 0},
+	{0x11d3c, 84}, {0x11d3e, 0}, {0x11d3f, 84}, {0x11d48, 0},
+	{0x11d50, 84}, {0x11d5a, 0}, {0x11d60, 46}, {0x11d66, 0},
+	{0x11d67, 46}, {0x11d69, 0}, {0x11d6a, 46}, {0x11d8f, 0},
+	{0x11d90, 46}, {0x11d92, 0}, {0x11d93, 46}, {0x11d99, 0},
+	{0x11da0, 46}, {0x11daa, 0}, {0x11ee0, 79}, {0x11ef9, 0},
+	{0x11fb0, 75}, {0x11fb1, 0}, {0x11fc0, 144}, {0x11ff2, 0},
+	{0x11fff, 144}, {0x12000, 27}, {0x1239a, 0}, {0x12400, 27},
+	{0x1246f, 0}, {0x12470, 27}, {0x12475, 0}, {0x12480, 27}, {0x12544, 0},
+	{0x12f90, 29}, {0x12ff3, 0}, {0x13000, 36}, {0x1342f, 0},
+	{0x13430, 36}, {0x13439, 0}, {0x14400, 3}, {0x14647, 0}, {0x16800, 8},
+	{0x16a39, 0}, {0x16a40, 93}, {0x16a5f, 0}, {0x16a60, 93}, {0x16a6a, 0},
+	{0x16a6e, 93}, {0x16a70, 145}, {0x16abf, 0}, {0x16ac0, 145},
+	{0x16aca, 0}, {0x16ad0, 9}, {0x16aee, 0}, {0x16af0, 9}, {0x16af6, 0},
+	{0x16b00, 117}, {0x16b46, 0}, {0x16b50, 117}, {0x16b5a, 0},
+	{0x16b5b, 117}, {0x16b62, 0}, {0x16b63, 117}, {0x16b78, 0},
+	{0x16b7d, 117}, {0x16b90, 0}, {0x16e40, 85}, {0x16e9b, 0},
+	{0x16f00, 90}, {0x16f4b, 0}, {0x16f4f, 90}, {0x16f88, 0},
+	{0x16f8f, 90}, {0x16fa0, 0}, {0x16fe0, 146}, {0x16fe1, 101},
+	{0x16fe2, 48}, {0x16fe4, 65}, {0x16fe5, 0}, {0x16ff0, 48},
+	{0x16ff2, 0}, {0x17000, 146}, {0x187f8, 0}, {0x18800, 146},
+	{0x18b00, 65}, {0x18cd6, 0}, {0x18d00, 146}, {0x18d09, 0},
+	{0x1aff0, 62}, {0x1aff4, 0}, {0x1aff5, 62}, {0x1affc, 0},
+	{0x1affd, 62}, {0x1afff, 0}, {0x1b000, 62}, {0x1b001, 54},
+	{0x1b120, 62}, {0x1b123, 0}, {0x1b150, 54}, {0x1b153, 0},
+	{0x1b164, 62}, {0x1b168, 0}, {0x1b170, 101}, {0x1b2fc, 0},
+	{0x1bc00, 35}, {0x1bc6b, 0}, {0x1bc70, 35}, {0x1bc7d, 0},
+	{0x1bc80, 35}, {0x1bc89, 0}, {0x1bc90, 35}, {0x1bc9a, 0},
+	{0x1bc9c, 35}, {0x1bca0, 25}, {0x1bca4, 0}, {0x1cf00, 56},
+	{0x1cf2e, 0}, {0x1cf30, 56}, {0x1cf47, 0}, {0x1cf50, 25}, {0x1cfc4, 0},
+	{0x1d000, 25}, {0x1d0f6, 0}, {0x1d100, 25}, {0x1d127, 0},
+	{0x1d129, 25}, {0x1d167, 56}, {0x1d16a, 25}, {0x1d17b, 56},
+	{0x1d183, 25}, {0x1d185, 56}, {0x1d18c, 25}, {0x1d1aa, 56},
+	{0x1d1ae, 25}, {0x1d1eb, 0}, {0x1d200, 44}, {0x1d246, 0},
+	{0x1d2e0, 25}, {0x1d2f4, 0}, {0x1d300, 25}, {0x1d357, 0},
+	{0x1d360, 25}, {0x1d379, 0}, {0x1d400, 25}, {0x1d455, 0},
+	{0x1d456, 25}, {0x1d49d, 0}, {0x1d49e, 25}, {0x1d4a0, 0},
+	{0x1d4a2, 25}, {0x1d4a3, 0}, {0x1d4a5, 25}, {0x1d4a7, 0},
+	{0x1d4a9, 25}, {0x1d4ad, 0}, {0x1d4ae, 25}, {0x1d4ba, 0},
+	{0x1d4bb, 25}, {0x1d4bc, 0}, {0x1d4bd, 25}, {0x1d4c4, 0},
+	{0x1d4c5, 25}, {0x1d506, 0}, {0x1d507, 25}, {0x1d50b, 0},
+	{0x1d50d, 25}, {0x1d515, 0}, {0x1d516, 25}, {0x1d51d, 0},
+	{0x1d51e, 25}, {0x1d53a, 0}, {0x1d53b, 25}, {0x1d53f, 0},
+	{0x1d540, 25}, {0x1d545, 0}, {0x1d546, 25}, {0x1d547, 0},
+	{0x1d54a, 25}, {0x1d551, 0}, {0x1d552, 25}, {0x1d6a6, 0},
+	{0x1d6a8, 25}, {0x1d7cc, 0}, {0x1d7ce, 25}, {0x1d800, 130},
+	{0x1da8c, 0}, {0x1da9b, 130}, {0x1daa0, 0}, {0x1daa1, 130},
+	{0x1dab0, 0}, {0x1df00, 70}, {0x1df1f, 0}, {0x1e000, 41}, {0x1e007, 0},
+	{0x1e008, 41}, {0x1e019, 0}, {0x1e01b, 41}, {0x1e022, 0},
+	{0x1e023, 41}, {0x1e025, 0}, {0x1e026, 41}, {0x1e02b, 0},
+	{0x1e100, 102}, {0x1e12d, 0}, {0x1e130, 102}, {0x1e13e, 0},
+	{0x1e140, 102}, {0x1e14a, 0}, {0x1e14e, 102}, {0x1e150, 0},
+	{0x1e290, 153}, {0x1e2af, 0}, {0x1e2c0, 157}, {0x1e2fa, 0},
+	{0x1e2ff, 157}, {0x1e300, 0}, {0x1e7e0, 39}, {0x1e7e7, 0},
+	{0x1e7e8, 39}, {0x1e7ec, 0}, {0x1e7ed, 39}, {0x1e7ef, 0},
+	{0x1e7f0, 39}, {0x1e7ff, 0}, {0x1e800, 87}, {0x1e8c5, 0},
+	{0x1e8c7, 87}, {0x1e8d7, 0}, {0x1e900, 1}, {0x1e94c, 0}, {0x1e950, 1},
+	{0x1e95a, 0}, {0x1e95e, 1}, {0x1e960, 0}, {0x1ec71, 25}, {0x1ecb5, 0},
+	{0x1ed01, 25}, {0x1ed3e, 0}, {0x1ee00, 4}, {0x1ee04, 0}, {0x1ee05, 4},
+	{0x1ee20, 0}, {0x1ee21, 4}, {0x1ee23, 0}, {0x1ee24, 4}, {0x1ee25, 0},
+	{0x1ee27, 4}, {0x1ee28, 0}, {0x1ee29, 4}, {0x1ee33, 0}, {0x1ee34, 4},
+	{0x1ee38, 0}, {0x1ee39, 4}, {0x1ee3a, 0}, {0x1ee3b, 4}, {0x1ee3c, 0},
+	{0x1ee42, 4}, {0x1ee43, 0}, {0x1ee47, 4}, {0x1ee48, 0}, {0x1ee49, 4},
+	{0x1ee4a, 0}, {0x1ee4b, 4}, {0x1ee4c, 0}, {0x1ee4d, 4}, {0x1ee50, 0},
+	{0x1ee51, 4}, {0x1ee53, 0}, {0x1ee54, 4}, {0x1ee55, 0}, {0x1ee57, 4},
+	{0x1ee58, 0}, {0x1ee59, 4}, {0x1ee5a, 0}, {0x1ee5b, 4}, {0x1ee5c, 0},
+	{0x1ee5d, 4}, {0x1ee5e, 0}, {0x1ee5f, 4}, {0x1ee60, 0}, {0x1ee61, 4},
+	{0x1ee63, 0}, {0x1ee64, 4}, {0x1ee65, 0}, {0x1ee67, 4}, {0x1ee6b, 0},
+	{0x1ee6c, 4}, {0x1ee73, 0}, {0x1ee74, 4}, {0x1ee78, 0}, {0x1ee79, 4},
+	{0x1ee7d, 0}, {0x1ee7e, 4}, {0x1ee7f, 0}, {0x1ee80, 4}, {0x1ee8a, 0},
+	{0x1ee8b, 4}, {0x1ee9c, 0}, {0x1eea1, 4}, {0x1eea4, 0}, {0x1eea5, 4},
+	{0x1eeaa, 0}, {0x1eeab, 4}, {0x1eebc, 0}, {0x1eef0, 4}, {0x1eef2, 0},
+	{0x1f000, 25}, {0x1f02c, 0}, {0x1f030, 25}, {0x1f094, 0},
+	{0x1f0a0, 25}, {0x1f0af, 0}, {0x1f0b1, 25}, {0x1f0c0, 0},
+	{0x1f0c1, 25}, {0x1f0d0, 0}, {0x1f0d1, 25}, {0x1f0f6, 0},
+	{0x1f100, 25}, {0x1f1ae, 0}, {0x1f1e6, 25}, {0x1f200, 54},
+	{0x1f201, 25}, {0x1f203, 0}, {0x1f210, 25}, {0x1f23c, 0},
+	{0x1f240, 25}, {0x1f249, 0}, {0x1f250, 25}, {0x1f252, 0},
+	{0x1f260, 25}, {0x1f266, 0}, {0x1f300, 25}, {0x1f6d8, 0},
+	{0x1f6dd, 25}, {0x1f6ed, 0}, {0x1f6f0, 25}, {0x1f6fd, 0},
+	{0x1f700, 25}, {0x1f774, 0}, {0x1f780, 25}, {0x1f7d9, 0},
+	{0x1f7e0, 25}, {0x1f7ec, 0}, {0x1f7f0, 25}, {0x1f7f1, 0},
+	{0x1f800, 25}, {0x1f80c, 0}, {0x1f810, 25}, {0x1f848, 0},
+	{0x1f850, 25}, {0x1f85a, 0}, {0x1f860, 25}, {0x1f888, 0},
+	{0x1f890, 25}, {0x1f8ae, 0}, {0x1f8b0, 25}, {0x1f8b2, 0},
+	{0x1f900, 25}, {0x1fa54, 0}, {0x1fa60, 25}, {0x1fa6e, 0},
+	{0x1fa70, 25}, {0x1fa75, 0}, {0x1fa78, 25}, {0x1fa7d, 0},
+	{0x1fa80, 25}, {0x1fa87, 0}, {0x1fa90, 25}, {0x1faad, 0},
+	{0x1fab0, 25}, {0x1fabb, 0}, {0x1fac0, 25}, {0x1fac6, 0},
+	{0x1fad0, 25}, {0x1fada, 0}, {0x1fae0, 25}, {0x1fae8, 0},
+	{0x1faf0, 25}, {0x1faf7, 0}, {0x1fb00, 25}, {0x1fb93, 0},
+	{0x1fb94, 25}, {0x1fbcb, 0}, {0x1fbf0, 25}, {0x1fbfa, 0},
+	{0x20000, 48}, {0x2a6e0, 0}, {0x2a700, 48}, {0x2b739, 0},
+	{0x2b740, 48}, {0x2b81e, 0}, {0x2b820, 48}, {0x2cea2, 0},
+	{0x2ceb0, 48}, {0x2ebe1, 0}, {0x2f800, 48}, {0x2fa1e, 0},
+	{0x30000, 48}, {0x3134b, 0}, {0xe0001, 25}, {0xe0002, 0},
+	{0xe0020, 25}, {0xe0080, 0}, {0xe0100, 56}, {0xe01f0, 0},
+};
+
+/* get the value of a property of c from its runs */
+static uint8_t property_value(const PropertyRun *runs, size_t len,
+			      uint32_t c)
+{
+	size_t lo = 0, hi = len;
+
+	// runs begin at 0, so the run of c is the last one beginning at
+	// or before it
+	while (hi - lo > 1) {
+		const size_t mid = lo + (hi - lo) / 2;
+
+		if (runs[mid].first <= c)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	return runs[lo].value;
+}
+
+static inline unsigned category_of(uint32_t c)
+{
+	return property_value(category_runs,
+			      sizeof(category_runs) / sizeof(*category_runs), c);
+}
+
+static inline unsigned script_of(uint32_t c)
+{
+	return property_value(script_runs,
+			      sizeof(script_runs) / sizeof(*script_runs), c);
+}
+
 union RegexNode;
 
 /* function pointer type used to evaluate if a regex node
- * matched a given string */
-typedef bool (*MatchFunc)(union RegexNode *node, const char *orig,
-			  const char *cur, const char **next);
+ * matched a subject at offset cur */
+typedef bool (*MatchFunc)(union RegexNode *node, MatchContext *ctx,
+			  size_t cur, size_t *next);
 
 typedef struct GenericNode {
 	union RegexNode *prev;
@@ -128,318 +1754,713 @@ typedef struct {
 	size_t min, max;
 } QuantNode;
 
+/* kinds of CharRanges */
+enum {
+	/* characters first to last */
+	PROPERTY_NONE,
+	/* characters of the set of general categories in first */
+	PROPERTY_CATEGORIES,
+	/* characters of the script first */
+	PROPERTY_SCRIPT,
+	/* characters of all scripts but first */
+	PROPERTY_OTHER_SCRIPTS,
+};
+
+/* member of a class. while compiling, the ranges of a class are stored
+ * in the nodes following it. afterwards they are moved into a table of
+ * all ranges, so they don't take up the space of a whole node */
 typedef struct {
-	GenericNode generic;
 	uint32_t first, last;
-} RangeNode;
+	uint8_t property;
+} CharRange;
 
 typedef struct {
 	GenericNode generic;
-	RangeNode *ranges;
+	/* NULL while compiling */
+	const CharRange *ranges;
+	/* set of ascii characters matched by the class, negation applied.
+	 * built after compiling, NULL until then */
+	const uint64_t *ascii;
+	uint32_t ranges_len;
 	bool negate;
+	/* other cases of the characters in ranges are members as well */
+	bool fold;
 } ClassNode;
 
 typedef struct {
 	GenericNode generic;
 	union RegexNode *subexp;
-	MRegexpMatch cap;
+	/* number of the group, index of its capture slot */
+	size_t slot;
+	/* 1 + number of the last group inside of it */
+	size_t slots_end;
 } CapNode;
 
 typedef struct {
 	GenericNode generic;
 	union RegexNode *left;
 	union RegexNode *right;
+	/* capture slots of the groups in all alternatives */
+	uint32_t slots_begin, slots_end;
 } OrNode;
 
+/* run of characters merged by the optimizer. runs compared ignoring
+ * case are stored in lower case */
+typedef struct {
+	GenericNode generic;
+	const char *str;
+	size_t len;
+} StringNode;
+
 typedef union RegexNode {
 	GenericNode generic;
 	CharNode chr;
 	QuantNode quant;
 	ClassNode cls;
-	RangeNode range;
+	CharRange range;
 	CapNode cap;
 	OrNode orn;
+	StringNode str;
 } RegexNode;
 
-static bool is_match(RegexNode *node, const char *orig, const char *cur,
-		     const char **next)
+/* match a chain of nodes. iterates over the chain, so the call stack
+ * only grows with the nesting of groups and quantifiers */
+static bool is_match(RegexNode *node, MatchContext *ctx, size_t cur,
+		     size_t *next)
 {
-	if (node == NULL) {
-		*next = cur;
-		return true;
-	} else {
-		return ((node->generic.match)(node, orig, cur, next)) &&
-		       is_match(node->generic.next, orig, *next, next);
+	for (; node != NULL; node = node->generic.next) {
+		ctx->stats.node_visits++;
+
+		if (!(node->generic.match)(node, ctx, cur, &cur)) {
+			ctx->stats.backtracks++;
+			return false;
+		}
+	}
+
+	*next = cur;
+	return true;
+}
+
+/* mark capture slots begin up to end as not taking part in the match */
+static inline void clear_captures(MatchContext *ctx, size_t begin,
+				  size_t end)
+{
+	if (end > ctx->caps_len)
+		end = ctx->caps_len;
+
+	if (begin < end)
+		memset(ctx->caps + begin, 0xff,
+		       (end - begin) * sizeof(MRegexpMatch));
+}
+
+static bool char_is_match(RegexNode *node, MatchContext *ctx, size_t cur,
+			  size_t *next)
+{
+	if (cur >= ctx->len) {
+		return false;
 	}
+
+	return node->chr.chr == subject_peek(ctx, cur, next);
 }
 
-static bool char_is_match(RegexNode *node, const char *orig, const char *cur,
-			  const char **next)
+/* character compared ignoring case. chr is the smallest member of its
+ * orbit, which is the upper case letter for ascii ones */
+static bool char_fold_is_match(RegexNode *node, MatchContext *ctx,
+			       size_t cur, size_t *next)
 {
-	if (*cur == 0) {
+	if (cur >= ctx->len)
 		return false;
+
+	const uint8_t c = (uint8_t)ctx->subject[cur];
+
+	if (c < 128) {
+		*next = cur + 1;
+		return ascii_upper(c) == node->chr.chr;
 	}
 
-	*next = utf8_next(cur);
-	return node->chr.chr == utf8_peek(cur);
+	return fold_char(subject_peek(ctx, cur, next)) == node->chr.chr;
 }
 
-static bool start_is_match(RegexNode *node, const char *orig, const char *cur,
-			   const char **next)
+static bool start_is_match(RegexNode *node, MatchContext *ctx, size_t cur,
+			   size_t *next)
 {
 	*next = cur;
 	return true;
 }
 
-static bool anchor_begin_is_match(RegexNode *node, const char *orig,
-				  const char *cur, const char **next)
+static bool anchor_begin_is_match(RegexNode *node, MatchContext *ctx,
+				  size_t cur, size_t *next)
 {
 	*next = cur;
-	return strlen(orig) == strlen(cur);
+	return cur == 0 && ctx->base == 0;
 }
 
-static bool anchor_end_is_match(RegexNode *node, const char *orig,
-				const char *cur, const char **next)
+static bool anchor_end_is_match(RegexNode *node, MatchContext *ctx,
+				size_t cur, size_t *next)
 {
 	*next = cur;
-	return strlen(cur) == 0;
+	return cur == ctx->len;
 }
 
-static bool any_is_match(RegexNode *node, const char *orig, const char *cur,
-			 const char **next)
+static bool any_is_match(RegexNode *node, MatchContext *ctx, size_t cur,
+			 size_t *next)
 {
-	if (*cur) {
-		*next = utf8_next(cur);
+	if (cur < ctx->len) {
+		subject_peek(ctx, cur, next);
 		return true;
 	}
 
 	return false;
 }
 
-static bool quant_is_match(RegexNode *node, const char *orig, const char *cur,
-			   const char **next)
+/* upper bound of repetitions of the quantifier node. loops are
+ * possessive, so a loop at the end of a match succeeds as soon as
+ * it reached its minimum */
+static inline size_t quant_limit(const RegexNode *node,
+				 const MatchContext *ctx)
+{
+	if (ctx->tails != NULL) {
+		const size_t i = (size_t)(node - ctx->nodes);
+
+		if ((ctx->tails[i >> 6] >> (i & 63)) & 1)
+			return node->quant.min;
+	}
+
+	return node->quant.max;
+}
+
+static bool cap_is_match(RegexNode *node, MatchContext *ctx, size_t cur,
+			 size_t *next);
+
+/* most capture slots of a loop saved on the call stack per iteration */
+#define SAVED_CAPTURES 8
+
+/* quant_is_match for loops over a group which is recorded. groups in a
+ * loop report their spans in its last iteration, so their slots are
+ * cleared before an iteration and restored if it fails */
+static bool quant_captures_is_match(RegexNode *node, MatchContext *ctx,
+				    size_t cur, size_t *next)
 {
 	QuantNode *quant = (QuantNode *)node;
-	size_t matches = 0;
+	const CapNode *cap = &quant->subexp->cap;
+	const size_t begin = cap->slot;
+	const size_t end =
+		cap->slots_end < ctx->caps_len ? cap->slots_end : ctx->caps_len;
+	const size_t max = quant_limit(node, ctx);
+	const bool save = end - begin <= SAVED_CAPTURES;
+	MRegexpMatch saved[SAVED_CAPTURES];
+	size_t matches = 0, last = cur;
+
+	while (matches < max) {
+		const size_t writes = ctx->cap_writes;
+
+		// the slots haven't taken part in the match before the
+		// first iteration
+		if (matches > 0) {
+			if (save)
+				memcpy(saved, ctx->caps + begin,
+				       (end - begin) * sizeof(MRegexpMatch));
+
+			clear_captures(ctx, begin, end);
+		}
 
-	while (is_match(quant->subexp, orig, cur, next)) {
-		matches++;
-		cur = *next;
+		if (!is_match(quant->subexp, ctx, cur, next)) {
+			if (matches > 0 && save) {
+				memcpy(ctx->caps + begin, saved,
+				       (end - begin) * sizeof(MRegexpMatch));
+			} else if (matches > 0) {
+				// too many slots to save. repeating the last
+				// iteration records the same spans again
+				clear_captures(ctx, begin, end);
+				is_match(quant->subexp, ctx, last, next);
+			} else if (ctx->cap_writes != writes) {
+				clear_captures(ctx, begin, end);
+			}
+
+			break;
+		}
 
-		if (matches >= quant->max)
+		if (*next == cur) {
+			if (matches < quant->min)
+				matches = quant->min;
 			break;
+		}
+
+		matches++;
+		last = cur;
+		cur = *next;
 	}
 
 	*next = cur;
 	return matches >= quant->min;
 }
 
-static bool class_is_match(RegexNode *node, const char *orig, const char *cur,
-			   const char **next)
+static bool quant_is_match(RegexNode *node, MatchContext *ctx, size_t cur,
+			   size_t *next)
 {
-	ClassNode *cls = (ClassNode *)node;
+	QuantNode *quant = (QuantNode *)node;
 
-	if (*cur == 0)
-		return false;
+	if (quant->subexp->generic.match == cap_is_match &&
+	    quant->subexp->cap.slot < ctx->caps_len)
+		return quant_captures_is_match(node, ctx, cur, next);
 
-	const uint32_t chr = utf8_peek(cur);
-	*next = utf8_next(cur);
+	const size_t max = quant_limit(node, ctx);
+	size_t matches = 0;
 
-	bool found = false;
-	for (RangeNode *range = cls->ranges; range != NULL;
-	     range = (RangeNode *)range->generic.next) {
-		if (chr >= range->first && chr <= range->last) {
-			found = true;
+	while (matches < max &&
+	       is_match(quant->subexp, ctx, cur, next)) {
+		// an empty iteration would repeat forever, so
+		// it may as well satisfy all required ones
+		if (*next == cur) {
+			if (matches < quant->min)
+				matches = quant->min;
 			break;
 		}
+
+		matches++;
+		cur = *next;
 	}
 
-	if (cls->negate)
-		found = !found;
+	*next = cur;
+	return matches >= quant->min;
+}
 
-	return found;
+static inline bool class_contains_ascii(const ClassNode *cls, uint8_t chr)
+{
+	return (cls->ascii[chr >> 6] >> (chr & 63)) & 1;
 }
 
-static bool cap_is_match(RegexNode *node, const char *orig, const char *cur,
-			 const char **next)
+static inline bool range_contains(const CharRange *range, uint32_t chr)
 {
-	CapNode *cap = (CapNode *)node;
+	switch (range->property) {
+	case PROPERTY_NONE:
+		return chr >= range->first && chr <= range->last;
+	case PROPERTY_CATEGORIES:
+		return (range->first >> category_of(chr)) & 1;
+	case PROPERTY_SCRIPT:
+		return script_of(chr) == range->first;
+	default:
+		return script_of(chr) != range->first;
+	}
+}
 
-	if (is_match(cap->subexp, orig, cur, next)) {
-		cap->cap.match_begin = cur - orig;
-		cap->cap.match_end = (*next) - orig;
-		return true;
+static inline bool ranges_contain(const ClassNode *cls, uint32_t chr)
+{
+	for (uint32_t i = 0; i < cls->ranges_len; ++i) {
+		if (range_contains(&cls->ranges[i], chr))
+			return true;
 	}
 
 	return false;
 }
 
-static bool or_is_match(RegexNode *node, const char *orig, const char *cur,
-	const char **next)
+static inline bool class_contains(const ClassNode *cls, uint32_t chr)
 {
-	OrNode *orn = (OrNode *)node;
+	if (chr < 128 && cls->ascii != NULL)
+		return class_contains_ascii(cls, (uint8_t)chr);
 
-	if (orn->generic.next != NULL) {
-		orn->right = orn->generic.next;
-		orn->generic.next = NULL;
-	}
+	bool found = ranges_contain(cls, chr);
 
-	if (is_match(orn->left, orig, cur, next) && orn->left != NULL) {
-		return true;
+	if (cls->fold) {
+		for (uint32_t o = fold_next(chr); !found && o != chr;
+		     o = fold_next(o))
+			found = ranges_contain(cls, o);
 	}
 
-	return is_match(orn->right, orig, cur, next) && orn->right != NULL;
+	return found != cls->negate;
 }
 
-/* Global error value with callback address */
-struct {
-	MRegexpError err;
-	const char *s;
-	jmp_buf buf;
-} CompileException;
-
-/* set global error value to the default value */
-static inline void clear_compile_exception(void)
+static bool class_is_match(RegexNode *node, MatchContext *ctx, size_t cur,
+			   size_t *next)
 {
-	CompileException.err = MREGEXP_OK;
-	CompileException.s = NULL;
+	if (cur >= ctx->len)
+		return false;
+
+	return class_contains(&node->cls, subject_peek(ctx, cur, next));
 }
 
-/* set global error value and jump back to the exception handler */
-static void throw_compile_exception(MRegexpError err, const char *s)
+static bool string_is_match(RegexNode *node, MatchContext *ctx, size_t cur,
+			    size_t *next)
 {
-	CompileException.err = err;
-	CompileException.s = s;
-	longjmp(CompileException.buf, 1);
+	const StringNode *str = &node->str;
+
+	if (ctx->len - cur < str->len ||
+	    memcmp(ctx->subject + cur, str->str, str->len) != 0)
+		return false;
+
+	*next = cur + str->len;
+	return true;
 }
 
-static size_t calc_compiled_escaped_len(const char *s, const char **leftover)
+static bool string_fold_is_match(RegexNode *node, MatchContext *ctx,
+				 size_t cur, size_t *next)
 {
-	if (*s == 0)
-		throw_compile_exception(MREGEXP_UNEXPECTED_EOL, s);
+	const StringNode *str = &node->str;
 
-	const uint32_t chr = utf8_peek(s);
-	*leftover = utf8_next(s);
+	if (ctx->len - cur < str->len ||
+	    !fold_memeq(ctx->subject + cur, str->str, str->len))
+		return false;
 
-	switch (chr) {
-	case 's':
-		return 5;
+	*next = cur + str->len;
+	return true;
+}
 
-	case 'S':
-		return 5;
+/* quantifier over a single character */
+static bool quant_char_is_match(RegexNode *node, MatchContext *ctx,
+				size_t cur, size_t *next)
+{
+	const QuantNode *quant = &node->quant;
+	const uint32_t chr = quant->subexp->chr.chr;
+	const size_t max = quant_limit(node, ctx);
+	size_t matches = 0;
 
-	case 'd':
-		return 2;
+	if (quant->subexp->generic.match == char_fold_is_match) {
+		const uint8_t *s = (const uint8_t *)ctx->subject;
+		size_t tmp = 0;
 
-	case 'D':
-		return 2;
+		while (matches < max && cur < ctx->len) {
+			if (s[cur] < 128) {
+				if (ascii_upper(s[cur]) != chr)
+					break;
 
-	case 'w':
-		return 5;
+				cur++;
+			} else if (fold_char(subject_peek(ctx, cur, &tmp)) ==
+				   chr) {
+				cur = tmp;
+			} else {
+				break;
+			}
 
-	case 'W':
-		return 5;
+			matches++;
+		}
+	} else if (chr < 128) {
+		const char *s = ctx->subject;
 
-	default:
-		return 1;
+		while (matches < max && cur < ctx->len &&
+		       (uint8_t)s[cur] == chr) {
+			cur++;
+			matches++;
+		}
+	} else {
+		size_t tmp = 0;
+
+		while (matches < max && cur < ctx->len &&
+		       subject_peek(ctx, cur, &tmp) == chr) {
+			cur = tmp;
+			matches++;
+		}
 	}
+
+	*next = cur;
+	return matches >= quant->min;
 }
 
-static const size_t calc_compiled_class_len(const char *s,
-					    const char **leftover)
+/* quantifier over a single character class */
+static bool quant_class_is_match(RegexNode *node, MatchContext *ctx,
+				 size_t cur, size_t *next)
 {
-	if (*s == '^')
-		s++;
+	const QuantNode *quant = &node->quant;
+	const ClassNode *cls = &quant->subexp->cls;
+	const uint8_t *s = (const uint8_t *)ctx->subject;
+	const size_t max = quant_limit(node, ctx);
+	size_t matches = 0, tmp = 0;
+
+	while (matches < max && cur < ctx->len) {
+		// ascii characters don't need to be decoded
+		if (s[cur] < 128) {
+			if (!class_contains_ascii(cls, s[cur]))
+				break;
+
+			cur++;
+		} else if (class_contains(cls, subject_peek(ctx, cur, &tmp))) {
+			cur = tmp;
+		} else {
+			break;
+		}
 
-	size_t ret = 1;
+		matches++;
+	}
 
-	while (*s && *s != ']') {
-		uint32_t chr = utf8_peek(s);
-		s = utf8_next(s);
-		if (chr == '\\') {
-			s = utf8_next(s);
-		}
+	*next = cur;
+	return matches >= quant->min;
+}
 
-		if (*s == '-' && s[1] != ']') {
-			s++;
-			chr = utf8_peek(s);
-			s = utf8_next(s);
+/* quantifier over . */
+static bool quant_any_is_match(RegexNode *node, MatchContext *ctx,
+			       size_t cur, size_t *next)
+{
+	const QuantNode *quant = &node->quant;
+	const size_t max = quant_limit(node, ctx);
+	size_t matches = 0;
 
-			if (chr == '\\')
-				s = utf8_next(s);
-		}
+	// without an upper bound only the minimum has to be counted
+	const size_t limit = max == __SIZE_MAX__ ? quant->min : max;
 
-		ret++;
-	}
+	while (matches < limit && cur < ctx->len) {
+		if ((uint8_t)ctx->subject[cur] < 128)
+			cur++;
+		else
+			subject_peek(ctx, cur, &cur);
 
-	if (*s == ']') {
-		s++;
-		*leftover = s;
-	} else {
-		throw_compile_exception(MREGEXP_INVALID_COMPLEX_CLASS, s);
+		matches++;
 	}
 
-	return ret;
+	if (max == __SIZE_MAX__)
+		cur = ctx->len;
+
+	*next = cur;
+	return matches >= quant->min;
 }
 
-/* get required amount of memory in amount of nodes
- * to compile regular expressions */
-static const size_t calc_compiled_len(const char *s)
+static inline bool is_quant(MatchFunc match)
 {
-	if (*s == 0) {
-		return 1;
-	} else {
-		const uint32_t chr = utf8_peek(s);
-		size_t ret = 0;
-		s = utf8_next(s);
+	return match == quant_is_match || match == quant_char_is_match ||
+	       match == quant_class_is_match || match == quant_any_is_match;
+}
 
-		switch (chr) {
-		case '{': {
-			const char *end = strstr(s, "}");
+static bool cap_is_match(RegexNode *node, MatchContext *ctx, size_t cur,
+			 size_t *next)
+{
+	CapNode *cap = (CapNode *)node;
 
-			if (end == NULL)
-				throw_compile_exception(
-					MREGEXP_INVALID_COMPLEX_QUANT, s);
+	if (!is_match(cap->subexp, ctx, cur, next))
+		return false;
 
-			s = end + 1;
-			ret = 1;
-			break;
-		}
+	if (cap->slot < ctx->caps_len) {
+		ctx->caps[cap->slot].match_begin = cur;
+		ctx->caps[cap->slot].match_end = *next;
+		ctx->cap_writes++;
+	}
 
-		case '\\':
-			ret = calc_compiled_escaped_len(s, &s);
-			break;
+	return true;
+}
 
-		case '[':
-			ret = calc_compiled_class_len(s, &s);
-			break;
+static bool or_is_match(RegexNode *node, MatchContext *ctx, size_t cur,
+			size_t *next);
 
-		default:
-			ret = 1;
-			break;
-		}
+/* get the OrNode holding the alternatives after the left branch of orn.
+ * returns NULL if the right branch of orn is its last alternative */
+static inline RegexNode *or_rest(RegexNode *orn)
+{
+	RegexNode *right = orn->orn.right;
+
+	// OrNodes always end their chain, so a right branch
+	// starting with one holds nothing but alternatives
+	if (right != NULL && right->generic.match == or_is_match)
+		return right;
+
+	return NULL;
+}
+
+static bool or_is_match(RegexNode *node, MatchContext *ctx, size_t cur,
+			size_t *next)
+{
+	// empty alternatives are NULL and never match
+	for (; node != NULL; node = or_rest(node)) {
+		const size_t writes = ctx->cap_writes;
+
+		if (node->orn.left != NULL &&
+		    is_match(node->orn.left, ctx, cur, next))
+			return true;
+
+		// groups of an alternation haven't taken part in the match
+		// when it is entered, so a failed alternative only leaves
+		// behind slots which have to be cleared again
+		if (ctx->cap_writes != writes)
+			clear_captures(ctx, node->orn.slots_begin,
+				       node->orn.slots_end);
+
+		if (or_rest(node) == NULL)
+			return node->orn.right != NULL &&
+			       is_match(node->orn.right, ctx, cur, next);
+	}
+
+	return false;
+}
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__) || defined(__clang__)
+#define THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL
+#endif
+
+/* Error value with callback address, one per thread */
+static THREAD_LOCAL struct {
+	MRegexpError err;
+	const char *s;
+	jmp_buf buf;
+} CompileException;
+
+/* set global error value to the default value */
+static inline void clear_compile_exception(void)
+{
+	CompileException.err = MREGEXP_OK;
+	CompileException.s = NULL;
+}
+
+/* set global error value and jump back to the exception handler */
+static void throw_compile_exception(MRegexpError err, const char *s)
+{
+	CompileException.err = err;
+	CompileException.s = s;
+	longjmp(CompileException.buf, 1);
+}
+
+/* amount of nodes compile_next_escaped needs for the escape of chr */
+static size_t escaped_len(uint32_t chr)
+{
+	switch (chr) {
+	case 's':
+	case 'S':
+	case 'w':
+	case 'W':
+		return 5;
+
+	case 'd':
+	case 'D':
+	case 'p':
+	case 'P':
+		return 2;
+
+	default:
+		return 1;
+	}
+}
+
+/* get an upper bound of the amount of nodes needed to compile s in a
+ * single pass. every character adds at most one node, except for escaped
+ * builtin classes. the amount of '(' bounds the nesting depth of groups */
+static size_t calc_compiled_len(const char *s, size_t *groups)
+{
+	size_t ret = 0;
+	*groups = 0;
+
+	while (*s) {
+		const uint32_t chr = utf8_peek(s);
+		s = utf8_next(s);
 
-		return ret + calc_compiled_len(s);
+		if (chr == '\\' && *s) {
+			ret += escaped_len(utf8_peek(s));
+			s = utf8_next(s);
+		} else {
+			*groups += chr == '(';
+			ret++;
+		}
 	}
+
+	return ret;
+}
+
+/* state of a group while it is compiled */
+typedef struct {
+	/* CapNode of the group. NULL for the whole expression */
+	RegexNode *cap;
+	/* first, last and second to last node of the current alternative */
+	RegexNode *head, *tail, *before_tail;
+	/* OrNodes holding the finished alternatives of the group */
+	RegexNode *first_or, *last_or;
+	/* levels of groups and quantifiers inside of the deepest node of
+	 * the group and of the last node of the current alternative */
+	size_t depth, tail_depth;
+} ParseFrame;
+
+/* most levels groups and quantifiers may be nested. matching and the
+ * optimizer recurse once per level */
+#define MAX_DEPTH 1000
+
+/* set the nesting depth of the last node of the current alternative */
+static void nest_tail(ParseFrame *frame, size_t depth, const char *re)
+{
+	if (depth > MAX_DEPTH)
+		throw_compile_exception(MREGEXP_NESTING_TOO_DEEP, re);
+
+	frame->tail_depth = depth;
+	if (depth > frame->depth)
+		frame->depth = depth;
 }
 
-static void append_quant(RegexNode **prev, RegexNode *cur, size_t min,
+static void append_node(ParseFrame *frame, RegexNode *cur)
+{
+	cur->generic.next = NULL;
+	cur->generic.prev = frame->tail;
+
+	if (frame->tail == NULL)
+		frame->head = cur;
+	else
+		frame->tail->generic.next = cur;
+
+	frame->before_tail = frame->tail;
+	frame->tail = cur;
+	frame->tail_depth = 0;
+}
+
+/* replace the last node of the current alternative
+ * with a quantifier over it */
+static void append_quant(ParseFrame *frame, RegexNode *cur, size_t min,
 			 size_t max, const char *re)
 {
+	RegexNode *subexp = frame->tail;
+
+	if (subexp == NULL)
+		throw_compile_exception(MREGEXP_EARLY_QUANTIFIER, re);
+
+	nest_tail(frame, frame->tail_depth + 1, re);
+
 	cur->generic.match = quant_is_match;
 	cur->generic.next = NULL;
-	cur->generic.prev = NULL;
+	cur->generic.prev = frame->before_tail;
 
 	cur->quant.max = max;
 	cur->quant.min = min;
-	cur->quant.subexp = *prev;
+	cur->quant.subexp = subexp;
+	subexp->generic.prev = NULL;
 
-	*prev = (*prev)->generic.prev;
-	if (*prev == NULL)
-		throw_compile_exception(MREGEXP_EARLY_QUANTIFIER, re);
+	if (frame->before_tail == NULL)
+		frame->head = cur;
+	else
+		frame->before_tail->generic.next = cur;
+
+	frame->tail = cur;
+}
 
-	cur->quant.subexp->generic.next = NULL;
-	cur->quant.subexp->generic.prev = NULL;
+/* finish the current alternative of a group. OrNodes of a group form a
+ * list through their right branches, which is linked back with prev */
+static void append_or(ParseFrame *frame, RegexNode *cur)
+{
+	cur->generic.match = or_is_match;
+	cur->generic.next = NULL;
+	cur->generic.prev = frame->last_or;
+	cur->orn.left = frame->head;
+	cur->orn.right = NULL;
+
+	if (frame->last_or == NULL)
+		frame->first_or = cur;
+	else
+		frame->last_or->orn.right = cur;
+
+	frame->last_or = cur;
+	frame->head = frame->tail = frame->before_tail = NULL;
+}
+
+/* finish the last alternative of a group holding the capture
+ * slots begin up to end and get its first node */
+static RegexNode *end_group(ParseFrame *frame, size_t begin, size_t end)
+{
+	if (frame->first_or == NULL)
+		return frame->head;
+
+	for (RegexNode *orn = frame->first_or; orn != NULL;
+	     orn = orn->orn.right) {
+		orn->orn.slots_begin = (uint32_t)begin;
+		orn->orn.slots_end = (uint32_t)end;
+	}
+
+	frame->last_or->orn.right = frame->head;
+	return frame->first_or;
 }
 
 static inline bool is_digit(uint32_t c)
@@ -447,20 +2468,21 @@ static inline bool is_digit(uint32_t c)
 	return c >= '0' && c <= '9';
 }
 
+/* parse a decimal number. throws if it doesn't fit into a size_t */
 static inline size_t parse_digit(const char *s, const char **leftover)
 {
 	size_t ret = 0;
 
-	while (*s) {
-		uint32_t chr = utf8_peek(s);
+	while (is_digit((uint8_t)*s)) {
+		const size_t digit = (size_t)(*s - '0');
 
-		if (is_digit(chr)) {
-			ret *= 10;
-			ret += chr - '0';
-			s = utf8_next(s);
-		} else {
-			break;
-		}
+		// __SIZE_MAX__ itself means unbounded
+		if (ret > (__SIZE_MAX__ - 1 - digit) / 10)
+			throw_compile_exception(MREGEXP_INVALID_COMPLEX_QUANT,
+						s);
+
+		ret = ret * 10 + digit;
+		s++;
 	}
 
 	*leftover = s;
@@ -468,7 +2490,7 @@ static inline size_t parse_digit(const char *s, const char **leftover)
 }
 
 /* parse complex quantifier of format {m,n} 
- * valid formats: {,} {m,} {,n} {m} {m,n} */
+ * valid formats: {,} {m,} {,n} {m} {m,n} with m <= n */
 static void parse_complex_quant(const char *re, const char **leftover,
 				size_t *min_p, size_t *max_p)
 {
@@ -497,7 +2519,7 @@ static void parse_complex_quant(const char *re, const char **leftover,
 	}
 
 	tmp = utf8_peek(re);
-	if (tmp == '}') {
+	if (tmp == '}' && min <= max) {
 		*leftover = re + 1;
 		*min_p = min;
 		*max_p = max;
@@ -512,30 +2534,24 @@ static void parse_complex_quant(const char *re, const char **leftover,
 static RegexNode *append_class(RegexNode *cur, bool negate, size_t n, ...)
 {
 	cur->cls.negate = negate;
-	cur->cls.ranges = (RangeNode *)(n ? cur + 1 : NULL);
+	cur->cls.ranges = NULL;
+	cur->cls.ranges_len = (uint32_t)n;
+	cur->cls.ascii = NULL;
 	cur->generic.match = class_is_match;
 	cur->generic.next = NULL;
 	cur->generic.prev = NULL;
 
 	va_list ap;
 	va_start(ap, n);
-	RegexNode *prev = NULL;
 	cur = cur + 1;
 
 	for (size_t i = 0; i < n; ++i) {
 		const uint32_t first = va_arg(ap, uint32_t);
 		const uint32_t last = va_arg(ap, uint32_t);
 
-		cur->generic.next = NULL;
-		cur->generic.prev = prev;
-
-		if (prev)
-			prev->generic.next = cur;
-
 		cur->range.first = first;
 		cur->range.last = last;
-
-		prev = cur;
+		cur->range.property = PROPERTY_NONE;
 		cur = cur + 1;
 	}
 
@@ -544,9 +2560,106 @@ static RegexNode *append_class(RegexNode *cur, bool negate, size_t n, ...)
 	return cur;
 }
 
+/* parse the unicode property of \p or \P at re into range. it is either
+ * a single letter or a general category or script in braces. a letter
+ * stands for all categories beginning with it, LC and L& for cased
+ * letters */
+static void parse_property(const char *re, const char **leftover,
+			   CharRange *range, bool negate)
+{
+	const char *name = re;
+	size_t len = 1;
+
+	if (*re == 0)
+		throw_compile_exception(MREGEXP_UNEXPECTED_EOL, re);
+
+	if (*re == '{') {
+		const char *end = strchr(re, '}');
+
+		if (end == NULL)
+			throw_compile_exception(MREGEXP_INVALID_PROPERTY, re);
+
+		name = re + 1;
+		len = end - name;
+		*leftover = end + 1;
+	} else {
+		*leftover = re + 1;
+	}
+
+	const bool cased = len == 2 && name[0] == 'L' &&
+			   (name[1] == 'C' || name[1] == '&');
+	uint32_t categories = 0;
+
+	for (unsigned i = 0; i < CATEGORIES_LEN; ++i) {
+		const char *cat = category_names[i];
+
+		if ((len == 1 && name[0] == cat[0]) ||
+		    (len == 2 && memcmp(name, cat, 2) == 0) ||
+		    (cased && (i == CAT_LL || i == CAT_LT || i == CAT_LU)))
+			categories |= CATEGORY(i);
+	}
+
+	range->first = range->last = 0;
+
+	if (categories != 0) {
+		range->property = PROPERTY_CATEGORIES;
+		range->first = negate ? ~categories & ALL_CATEGORIES
+				      : categories;
+		return;
+	}
+
+	for (size_t i = 0; i < sizeof(script_names) / sizeof(*script_names);
+	     ++i) {
+		if (strlen(script_names[i]) == len &&
+		    memcmp(script_names[i], name, len) == 0) {
+			range->property =
+				negate ? PROPERTY_OTHER_SCRIPTS : PROPERTY_SCRIPT;
+			range->first = (uint32_t)i;
+			return;
+		}
+	}
+
+	throw_compile_exception(MREGEXP_INVALID_PROPERTY, name);
+}
+
+/* append the class of \d, \s or \w or of their negations in unicode
+ * mode. returns pointer to next */
+static RegexNode *append_unicode_class(RegexNode *cur, uint32_t chr)
+{
+	const bool negate = chr == 'D' || chr == 'S' || chr == 'W';
+	RegexNode *ret = NULL;
+	uint32_t categories = 0;
+
+	switch (chr) {
+	case 'd':
+	case 'D':
+		ret = append_class(cur, negate, 1, 0, 0);
+		categories = CATEGORY(CAT_ND);
+		break;
+
+	case 's':
+	case 'S':
+		ret = append_class(cur, negate, 3, '\t', '\r', 0x85, 0x85, 0, 0);
+		categories = SPACE_CATEGORIES;
+		break;
+
+	default:
+		// join controls are part of words as well
+		ret = append_class(cur, negate, 2, 0x200c, 0x200d, 0, 0);
+		categories = WORD_CATEGORIES;
+		break;
+	}
+
+	// the categories are the last range
+	CharRange *range = &(ret - 1)->range;
+	range->property = PROPERTY_CATEGORIES;
+	range->first = categories;
+	return ret;
+}
+
 /** compile escaped characters. return pointer to the next free node. */
 static RegexNode *compile_next_escaped(const char *re, const char **leftover,
-				       RegexNode *cur)
+				       RegexNode *cur, bool unicode)
 {
 	if (*re == 0)
 		throw_compile_exception(MREGEXP_UNEXPECTED_EOL, re);
@@ -555,6 +2668,10 @@ static RegexNode *compile_next_escaped(const char *re, const char **leftover,
 	*leftover = utf8_next(re);
 	RegexNode *ret = cur + 1;
 
+	if (unicode && (chr == 'd' || chr == 'D' || chr == 's' || chr == 'S' ||
+			chr == 'w' || chr == 'W'))
+		return append_unicode_class(cur, chr);
+
 	switch (chr) {
 	case 'n':
 		cur->chr.chr = '\n';
@@ -599,6 +2716,12 @@ static RegexNode *compile_next_escaped(const char *re, const char **leftover,
 		ret = append_class(cur, true, 1, '0', '9');
 		break;
 
+	case 'p':
+	case 'P':
+		ret = append_class(cur, false, 1, 0, 0);
+		parse_property(*leftover, leftover, &cur[1].range, chr == 'P');
+		break;
+
 	default:
 		cur->chr.chr = chr;
 		cur->generic.match = char_is_match;
@@ -624,12 +2747,15 @@ static RegexNode *compile_next_complex_class(const char *re,
 	}
 
 	cur->cls.ranges = NULL;
+	cur->cls.ranges_len = 0;
+	cur->cls.ascii = NULL;
 
+	RegexNode *const cls = cur;
 	cur = cur + 1;
-	RegexNode *prev = NULL;
 
 	while (*re && *re != ']') {
 		uint32_t first = 0, last = 0;
+		bool escaped = false;
 
 		first = utf8_peek(re);
 		re = utf8_next(re);
@@ -640,9 +2766,16 @@ static RegexNode *compile_next_complex_class(const char *re,
 
 			first = utf8_peek(re);
 			re = utf8_next(re);
+			escaped = true;
 		}
 
-		if (*re == '-' && re[1] != ']' && re[1]) {
+		cur->range.property = PROPERTY_NONE;
+
+		if (escaped && (first == 'p' || first == 'P')) {
+			parse_property(re, &re, &cur->range, first == 'P');
+			first = cur->range.first;
+			last = cur->range.last;
+		} else if (*re == '-' && re[1] != ']' && re[1]) {
 			re++;
 			last = utf8_peek(re);
 			re = utf8_next(re);
@@ -662,16 +2795,7 @@ static RegexNode *compile_next_complex_class(const char *re,
 
 		cur->range.first = first;
 		cur->range.last = last;
-		cur->generic.prev = prev;
-		cur->generic.next = NULL;
-
-		if (prev == NULL) {
-			(cur - 1)->cls.ranges = (RangeNode *)cur;
-		} else {
-			prev->generic.next = cur;
-		}
-
-		prev = cur;
+		cls->cls.ranges_len++;
 		cur++;
 	}
 
@@ -684,338 +2808,5220 @@ static RegexNode *compile_next_complex_class(const char *re,
 	}
 }
 
-static const char *find_closing_par(const char *s)
+static void *default_allocate(size_t size, void *user)
 {
-	size_t level = 1;
-
-	for (; *s && level != 0; ++s) {
-		if (*s == '\\')
-			s++;
-		else if (*s == '(')
-			level++;
-		else if (*s == ')')
-			level--;
-	}
-
-	if (level == 0)
-		return s;
-	else
-		return NULL;
+	return malloc(size);
 }
 
-static RegexNode *compile(const char *re, const char *end, RegexNode *nodes);
-
-static RegexNode *compile_next_cap(const char *re, const char **leftover,
-				   RegexNode *cur)
+static void *default_reallocate(void *ptr, size_t old_size, size_t new_size,
+				void *user)
 {
-	cur->cap.cap.match_begin = 0;
-	cur->cap.cap.match_end = 0;
-	cur->cap.subexp = cur + 1;
-	cur->generic.next = NULL;
-	cur->generic.prev = NULL;
-	cur->generic.match = cap_is_match;
+	return realloc(ptr, new_size);
+}
 
-	const char *end = find_closing_par(re);
+static void default_deallocate(void *ptr, size_t size, void *user)
+{
+	free(ptr);
+}
 
-	if (end == NULL)
-		throw_compile_exception(MREGEXP_UNCLOSED_SUBEXPRESSION, re);
+static const MRegexpAllocator default_allocator = {
+	default_allocate,
+	default_reallocate,
+	default_deallocate,
+	NULL,
+};
 
-	*leftover = end;
-	return compile(re, end - 1, cur + 1);
+static inline void *mem_alloc(const MRegexpAllocator *alloc, size_t size)
+{
+	return alloc->allocate(size, alloc->user);
 }
 
-static RegexNode *insert_or(RegexNode *cur, RegexNode **prev) {
-	cur->generic.match = or_is_match;
-	cur->generic.next = NULL;
-	cur->generic.prev = NULL;
-
-	// Find last start node
-	RegexNode *begin = *prev;
+static inline void *mem_realloc(const MRegexpAllocator *alloc, void *ptr,
+				size_t old_size, size_t new_size)
+{
+	return alloc->reallocate(ptr, old_size, new_size, alloc->user);
+}
 
-	while (begin->generic.match != start_is_match) {
-		begin = begin->generic.prev;
-	}
+static inline void mem_free(const MRegexpAllocator *alloc, void *ptr,
+			    size_t size)
+{
+	if (ptr != NULL)
+		alloc->deallocate(ptr, size, alloc->user);
+}
 
-	cur->orn.left = begin->generic.next;
-	*prev = begin;
+/* alignment of every allocation handed out by an arena */
+typedef union {
+	long double ld;
+	long long ll;
+	void *ptr;
+	void (*fn)(void);
+} ArenaAlign;
+
+typedef struct ArenaBlock {
+	struct ArenaBlock *prev;
+	size_t size;
+	size_t used;
+	ArenaAlign data[];
+} ArenaBlock;
+
+struct MRegexpArena {
+	MRegexpAllocator alloc;
+	MRegexpAllocator parent;
+	ArenaBlock *block;
+	size_t block_size;
+	/* most recent allocation, which may grow or shrink in place */
+	void *last;
+};
 
-	return cur + 1;
+static inline size_t arena_round(size_t size)
+{
+	return (size + sizeof(ArenaAlign) - 1) / sizeof(ArenaAlign) *
+	       sizeof(ArenaAlign);
 }
 
-/* compile next node. returns address of next available node.
- * returns NULL if re is empty */
-static RegexNode *compile_next(const char *re, const char **leftover,
-			       RegexNode *prev, RegexNode *cur)
+static ArenaBlock *arena_new_block(MRegexpArena *arena, size_t min_size)
 {
-	if (*re == 0)
+	const size_t size =
+		min_size > arena->block_size ? min_size : arena->block_size;
+	ArenaBlock *block = (ArenaBlock *)mem_alloc(
+		&arena->parent, sizeof(ArenaBlock) + size);
+
+	if (block == NULL)
 		return NULL;
 
-	const uint32_t chr = utf8_peek(re);
-	re = utf8_next(re);
-	RegexNode *next = cur + 1;
+	block->prev = arena->block;
+	block->size = size;
+	block->used = 0;
+	arena->block = block;
 
-	switch (chr) {
-	case '^':
-		cur->generic.match = anchor_begin_is_match;
-		break;
+	return block;
+}
 
-	case '$':
-		cur->generic.match = anchor_end_is_match;
-		break;
+static void *arena_allocate(size_t size, void *user)
+{
+	MRegexpArena *arena = (MRegexpArena *)user;
+	ArenaBlock *block = arena->block;
+	size = arena_round(size);
 
-	case '.':
-		cur->generic.match = any_is_match;
-		break;
+	if (block == NULL || block->size - block->used < size) {
+		block = arena_new_block(arena, size);
 
-	case '*':
-		append_quant(&prev, cur, 0, __SIZE_MAX__, re);
-		break;
+		if (block == NULL)
+			return NULL;
+	}
 
-	case '+':
-		append_quant(&prev, cur, 1, __SIZE_MAX__, re);
-		break;
+	void *ret = (char *)block->data + block->used;
+	block->used += size;
+	arena->last = ret;
 
-	case '?':
-		append_quant(&prev, cur, 0, 1, re);
-		break;
+	return ret;
+}
 
-	case '{': {
-		size_t min = 0, max = __SIZE_MAX__;
-		const char *leftover = NULL;
-		parse_complex_quant(re, &leftover, &min, &max);
+static void *arena_reallocate(void *ptr, size_t old_size, size_t new_size,
+			      void *user)
+{
+	MRegexpArena *arena = (MRegexpArena *)user;
+	ArenaBlock *block = arena->block;
 
-		append_quant(&prev, cur, min, max, re);
-		re = leftover;
-		break;
+	if (ptr != NULL && ptr == arena->last) {
+		const size_t offset = (char *)ptr - (char *)block->data;
+
+		if (block->size - offset >= arena_round(new_size)) {
+			block->used = offset + arena_round(new_size);
+			return ptr;
+		}
 	}
 
-	case '[':
-		next = compile_next_complex_class(re, &re, cur);
-		break;
+	void *ret = arena_allocate(new_size, user);
 
-	case '(':
-		next = compile_next_cap(re, &re, cur);
-		break;
+	if (ret != NULL && ptr != NULL)
+		memcpy(ret, ptr, old_size < new_size ? old_size : new_size);
 
-	case '\\':
-		next = compile_next_escaped(re, &re, cur);
-		break;
+	return ret;
+}
 
-	case '|':
-		next = insert_or(cur, &prev);
-		break;
+static void arena_deallocate(void *ptr, size_t size, void *user)
+{
+	MRegexpArena *arena = (MRegexpArena *)user;
 
-	default:
-		cur->chr.chr = chr;
-		cur->generic.match = char_is_match;
-		break;
+	if (ptr == arena->last) {
+		arena->block->used = (char *)ptr - (char *)arena->block->data;
+		arena->last = NULL;
 	}
-
-	cur->generic.next = NULL;
-	cur->generic.prev = prev;
-	prev->generic.next = cur;
-	*leftover = re;
-
-	return next;
 }
 
-/* compile raw regular expression into a linked list of nodes. return leftover nodes */
-static RegexNode *compile(const char *re, const char *end, RegexNode *nodes)
+MRegexpArena *mregexp_arena_new(size_t block_size,
+				const MRegexpAllocator *parent)
 {
-	RegexNode *prev = nodes;
-	RegexNode *cur = nodes + 1;
+	if (parent == NULL)
+		parent = &default_allocator;
 
-	prev->generic.next = NULL;
-	prev->generic.prev = NULL;
-	prev->generic.match = start_is_match;
+	MRegexpArena *arena =
+		(MRegexpArena *)mem_alloc(parent, sizeof(MRegexpArena));
 
-	while (cur != NULL && re != NULL && re < end) {
-		const char *next = NULL;
-		RegexNode *next_node = compile_next(re, &next, prev, cur);
-
-		prev = cur;
-		cur = next_node;
-		re = next;
+	if (arena == NULL) {
+		CompileException.err = MREGEXP_FAILED_ALLOC;
+		return NULL;
 	}
 
-	return cur;
+	arena->alloc.allocate = arena_allocate;
+	arena->alloc.reallocate = arena_reallocate;
+	arena->alloc.deallocate = arena_deallocate;
+	arena->alloc.user = arena;
+	arena->parent = *parent;
+	arena->block = NULL;
+	// blocks hold whole units of alignment, so rounded
+	// allocations never end past one
+	arena->block_size = arena_round(block_size ? block_size : 4096);
+	arena->last = NULL;
+
+	return arena;
 }
 
-struct MRegexp {
-	RegexNode *nodes;
-};
-
-MRegexp *mregexp_compile(const char *re)
+const MRegexpAllocator *mregexp_arena_allocator(MRegexpArena *arena)
 {
-	clear_compile_exception();
-	if (re == NULL) {
+	if (arena == NULL) {
 		CompileException.err = MREGEXP_INVALID_PARAMS;
 		return NULL;
 	}
 
-	if (!utf8_valid(re)) {
-		CompileException.err = MREGEXP_INVALID_UTF8;
-		CompileException.s = NULL;
-		return NULL;
+	return &arena->alloc;
+}
+
+void mregexp_arena_reset(MRegexpArena *arena)
+{
+	if (arena == NULL) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return;
 	}
 
-	MRegexp *ret = (MRegexp *)calloc(1, sizeof(MRegexp));
+	ArenaBlock *block = arena->block;
 
-	if (ret == NULL) {
-		CompileException.err = MREGEXP_FAILED_ALLOC;
-		CompileException.s = NULL;
-		return NULL;
+	if (block == NULL)
+		return;
+
+	// keep the newest block around for reuse
+	while (block->prev != NULL) {
+		ArenaBlock *prev = block->prev;
+		block->prev = prev->prev;
+		mem_free(&arena->parent, prev, sizeof(ArenaBlock) + prev->size);
 	}
 
-	RegexNode *nodes = NULL;
+	block->used = 0;
+	arena->last = NULL;
+}
+
+void mregexp_arena_free(MRegexpArena *arena)
+{
+	if (arena == NULL) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return;
+	}
+
+	while (arena->block != NULL) {
+		ArenaBlock *block = arena->block;
+		arena->block = block->prev;
+		mem_free(&arena->parent, block,
+			 sizeof(ArenaBlock) + block->size);
+	}
+
+	MRegexpAllocator parent = arena->parent;
+	mem_free(&parent, arena, sizeof(MRegexpArena));
+}
+
+/* maximum amount of literals collected from alternations */
+#define MAX_PREFIXES 64
+
+/* maximum length of a single literal collected from an alternation */
+#define MAX_PREFIX_LEN 16
+
+/* candidate positions for a match, computed from the compiled program */
+typedef struct {
+	/* zero for bytes no match may begin with. if prefixes_len is not
+	 * zero, 1 + index of the first prefix beginning with that byte */
+	uint8_t first_bytes[256];
+	size_t first_bytes_len;
+	/* the only byte a match may begin with if first_bytes_len is 1 */
+	uint8_t first_byte;
+	/* sorted literals one of which every match begins with */
+	size_t prefixes_len;
+	uint16_t prefix_offsets[MAX_PREFIXES + 1];
+	/* only the prefix_offsets[prefixes_len] bytes in use are allocated */
+	char prefix_data[];
+} Prefilter;
+
+/* size of a Prefilter with room for all prefixes */
+#define PREFILTER_MAX_SIZE (sizeof(Prefilter) + MAX_PREFIXES * MAX_PREFIX_LEN)
+
+/* eagerly built dfa telling whether a subject contains a match */
+typedef struct {
+	/* byte class of each byte */
+	uint8_t classes[256];
+	uint32_t classes_len;
+	uint32_t states_len;
+	/* state a subject begins in */
+	uint32_t start;
+	/* next state of state s on byte class c at table[s + c]. states are
+	 * multiplied by classes_len, so the dead state is 0 and the one
+	 * which accepts whatever follows is classes_len */
+	const uint32_t *table;
+	/* bit per state, set if a subject ending in it matches */
+	const uint64_t *eoi;
+	/* single allocation holding table and eoi */
+	void *mem;
+	size_t mem_size;
+} Dfa;
+
+struct MRegexp {
+	MRegexpAllocator alloc;
+	RegexNode *nodes;
+	size_t nodes_len;
+	/* first node to be evaluated. may be NULL */
+	RegexNode *program;
+
+	/* storage of StringNodes */
+	char *strings;
+	size_t strings_len, strings_used;
+
+	/* counters published by matching calls if stats_enabled */
+	MRegexpStats stats;
+	bool stats_enabled;
+
+	/* characters are compared ignoring case */
+	bool icase;
+	/* builtin classes cover all of unicode */
+	bool unicode;
+	/* matches may only begin at offset 0 */
+	bool anchored;
+	/* program begins with a loop over a character or class
+	 * which has to repeat at least once */
+	bool head_loop;
+	/* NULL if any position may begin a match */
+	Prefilter *prefilter;
+	size_t prefilter_size;
+
+	/* utf8 encoded literal which is part of every match. in lower
+	 * case and searched for ignoring case if icase is set */
+	char *literal;
+	size_t literal_len;
+	/* maximum byte offset of literal inside of a match.
+	 * __SIZE_MAX__ if unbounded */
+	size_t literal_dist;
+
+	/* ranges of all classes */
+	CharRange *ranges;
+	size_t ranges_len;
+
+	/* ascii bitmaps of all classes, two words each */
+	uint64_t *class_bits;
+	size_t classes_len;
+
+	/* loops ending every match, one bit per node */
+	uint64_t *tails;
+	size_t tails_len;
+
+	/* class of each byte. bytes of a class are matched alike by
+	 * every node, so tables indexed by bytes only need one entry
+	 * per class */
+	uint8_t byte_classes[256];
+	size_t byte_classes_len;
+
+	/* NULL unless requested and supported by the program */
+	Dfa *dfa;
+	/* hash of the pattern, which serialized dfas are checked against */
+	uint64_t pattern_hash;
+
+	/* capture slots, numbered in the order of the opening parentheses */
+	MRegexpMatch *caps;
+	size_t caps_len;
+
+	/* stack of open groups while compiling, NULL afterwards */
+	ParseFrame *frames;
+	size_t frames_len;
+};
+
+/* compile raw regular expression into the nodes of regex in a single
+ * pass. open groups are kept on an explicit stack, so neither the length
+ * nor the nesting depth of re is limited by the call stack. returns the
+ * first node of the program */
+static RegexNode *compile(MRegexp *regex, const char *re)
+{
+	RegexNode *cur = regex->nodes;
+	ParseFrame *frame = regex->frames;
+	memset(frame, 0, sizeof(ParseFrame));
+
+	while (*re) {
+		const char *token = re;
+		const uint32_t chr = utf8_peek(re);
+		re = utf8_next(re);
+		RegexNode *next = cur + 1;
+
+		switch (chr) {
+		case '^':
+			cur->generic.match = anchor_begin_is_match;
+			break;
+
+		case '$':
+			cur->generic.match = anchor_end_is_match;
+			break;
+
+		case '.':
+			cur->generic.match = any_is_match;
+			break;
+
+		case '*':
+			append_quant(frame, cur, 0, __SIZE_MAX__, token);
+			cur = next;
+			continue;
+
+		case '+':
+			append_quant(frame, cur, 1, __SIZE_MAX__, token);
+			cur = next;
+			continue;
+
+		case '?':
+			append_quant(frame, cur, 0, 1, token);
+			cur = next;
+			continue;
+
+		case '{': {
+			size_t min = 0, max = __SIZE_MAX__;
+			parse_complex_quant(re, &re, &min, &max);
+			append_quant(frame, cur, min, max, token);
+			cur = next;
+			continue;
+		}
+
+		case '[':
+			next = compile_next_complex_class(re, &re, cur);
+			break;
+
+		case '\\':
+			next = compile_next_escaped(re, &re, cur, regex->unicode);
+			break;
+
+		case '(':
+			cur->generic.match = cap_is_match;
+			cur->cap.subexp = NULL;
+			cur->cap.slot = regex->caps_len++;
+			cur->cap.slots_end = regex->caps_len;
+			append_node(frame, cur);
+
+			frame++;
+			memset(frame, 0, sizeof(ParseFrame));
+			frame->cap = cur;
+			cur = next;
+			continue;
+
+		case ')':
+			if (frame->cap != NULL) {
+				CapNode *cap = &frame->cap->cap;
+				cap->slots_end = regex->caps_len;
+				cap->subexp =
+					end_group(frame, cap->slot + 1,
+						  regex->caps_len);
+				frame--;
+				nest_tail(frame, frame[1].depth + 1, token);
+				continue;
+			}
+
+			// parentheses without a group are literal characters
+			cur->chr.chr = chr;
+			cur->generic.match = char_is_match;
+			break;
+
+		case '|':
+			append_or(frame, cur);
+			cur = next;
+			continue;
+
+		default:
+			cur->chr.chr = chr;
+			cur->generic.match = char_is_match;
+			break;
+		}
+
+		append_node(frame, cur);
+		cur = next;
+	}
+
+	if (frame->cap != NULL)
+		throw_compile_exception(MREGEXP_UNCLOSED_SUBEXPRESSION, re);
+
+	return end_group(frame, 0, regex->caps_len);
+}
+
+/* make the cased characters and all classes of re match regardless of
+ * case, before their bitmaps are built */
+static void fold_case(MRegexp *re)
+{
+	for (size_t i = 0; i < re->nodes_len; ++i) {
+		RegexNode *node = &re->nodes[i];
+
+		if (node->generic.match == char_is_match &&
+		    fold_next(node->chr.chr) != node->chr.chr) {
+			node->generic.match = char_fold_is_match;
+			node->chr.chr = fold_char(node->chr.chr);
+		} else if (node->generic.match == class_is_match) {
+			node->cls.fold = true;
+		}
+	}
+}
+
+/* move the ranges of all classes of re from the nodes following
+ * them into a table of their own */
+static void pack_ranges(MRegexp *re)
+{
+	for (size_t i = 0; i < re->nodes_len; ++i)
+		if (re->nodes[i].generic.match == class_is_match)
+			re->ranges_len += re->nodes[i].cls.ranges_len;
+
+	if (re->ranges_len == 0)
+		return;
+
+	re->ranges = (CharRange *)mem_alloc(
+		&re->alloc, re->ranges_len * sizeof(CharRange));
+
+	if (re->ranges == NULL)
+		throw_compile_exception(MREGEXP_FAILED_ALLOC, NULL);
+
+	CharRange *ranges = re->ranges;
+
+	for (size_t i = 0; i < re->nodes_len; ++i) {
+		ClassNode *cls = &re->nodes[i].cls;
+
+		if (cls->generic.match != class_is_match)
+			continue;
+
+		for (uint32_t j = 0; j < cls->ranges_len; ++j)
+			ranges[j] = re->nodes[i + 1 + j].range;
+
+		cls->ranges = ranges;
+		ranges += cls->ranges_len;
+	}
+}
+
+/* build the ascii bitmaps of all classes of re */
+static void index_classes(MRegexp *re)
+{
+	for (size_t i = 0; i < re->nodes_len; ++i)
+		re->classes_len += re->nodes[i].generic.match == class_is_match;
+
+	if (re->classes_len == 0)
+		return;
+
+	re->class_bits = (uint64_t *)mem_alloc(
+		&re->alloc, re->classes_len * 2 * sizeof(uint64_t));
+
+	if (re->class_bits == NULL)
+		throw_compile_exception(MREGEXP_FAILED_ALLOC, NULL);
+
+	memset(re->class_bits, 0, re->classes_len * 2 * sizeof(uint64_t));
+	uint64_t *bits = re->class_bits;
+
+	for (size_t i = 0; i < re->nodes_len; ++i) {
+		ClassNode *cls = &re->nodes[i].cls;
+
+		if (cls->generic.match != class_is_match)
+			continue;
+
+		for (unsigned c = 0; c < 128; ++c) {
+			const uint64_t bit = (uint64_t)class_contains(cls, c);
+			bits[c >> 6] |= bit << (c & 63);
+		}
+
+		cls->ascii = bits;
+		bits += 2;
+	}
+}
+
+/* allocate the capture slots of re, which the groups were
+ * numbered into while compiling */
+static void alloc_captures(MRegexp *re)
+{
+	if (re->caps_len == 0)
+		return;
+
+	const size_t size = re->caps_len * sizeof(MRegexpMatch);
+	re->caps = (MRegexpMatch *)mem_alloc(&re->alloc, size);
+
+	if (re->caps == NULL)
+		throw_compile_exception(MREGEXP_FAILED_ALLOC, NULL);
+
+	memset(re->caps, 0, size);
+}
+
+
+static inline size_t saturating_add(size_t a, size_t b)
+{
+	return a > __SIZE_MAX__ - b ? __SIZE_MAX__ : a + b;
+}
+
+static size_t chain_max_width(RegexNode *node);
+
+/* get maximum amount of bytes a node may match.
+ * returns __SIZE_MAX__ if unbounded */
+static size_t node_max_width(RegexNode *node)
+{
+	const MatchFunc match = node->generic.match;
+
+	if (match == char_is_match) {
+		char buf[4];
+		return utf8_encode(node->chr.chr, buf);
+	} else if (match == char_fold_is_match) {
+		char buf[4];
+		const uint32_t chr = node->chr.chr;
+		size_t ret = utf8_encode(chr, buf);
+
+		for (uint32_t o = fold_next(chr); o != chr; o = fold_next(o)) {
+			const size_t width = utf8_encode(o, buf);
+			ret = width > ret ? width : ret;
+		}
+
+		return ret;
+	} else if (match == class_is_match || match == any_is_match) {
+		return 4;
+	} else if (match == string_is_match || match == string_fold_is_match) {
+		return node->str.len;
+	} else if (is_quant(match)) {
+		const size_t width = chain_max_width(node->quant.subexp);
+
+		if (width == 0)
+			return 0;
+		else if (node->quant.max > __SIZE_MAX__ / width)
+			return __SIZE_MAX__;
+		else
+			return width * node->quant.max;
+	} else if (match == cap_is_match) {
+		return chain_max_width(node->cap.subexp);
+	} else if (match == or_is_match) {
+		size_t ret = 0;
+
+		for (; node != NULL; node = or_rest(node)) {
+			const size_t left = chain_max_width(node->orn.left);
+			ret = left > ret ? left : ret;
+
+			if (or_rest(node) == NULL) {
+				const size_t right =
+					chain_max_width(node->orn.right);
+				ret = right > ret ? right : ret;
+			}
+		}
+
+		return ret;
+	} else {
+		return 0;
+	}
+}
+
+static size_t chain_max_width(RegexNode *node)
+{
+	size_t ret = 0;
+
+	for (; node != NULL; node = node->generic.next)
+		ret = saturating_add(ret, node_max_width(node));
+
+	return ret;
+}
+
+/* state of the search for a required literal */
+typedef struct {
+	char *run;
+	size_t run_len, run_dist;
+	char *best;
+	size_t best_len, best_dist;
+	/* maximum distance between the beginning of
+	 * a match and the current node */
+	size_t dist;
+} LiteralScan;
+
+static void end_literal_run(LiteralScan *scan)
+{
+	// literals with a known distance allow skipping ahead,
+	// so they are preferred over longer ones
+	const bool bounded = scan->run_dist != __SIZE_MAX__;
+	const bool best_bounded = scan->best_dist != __SIZE_MAX__;
+
+	if (scan->run_len > 0 &&
+	    ((bounded && !best_bounded) ||
+	     (bounded == best_bounded && scan->run_len > scan->best_len))) {
+		memcpy(scan->best, scan->run, scan->run_len);
+		scan->best_len = scan->run_len;
+		scan->best_dist = scan->run_dist;
+	}
+
+	scan->run_len = 0;
+}
+
+/* find runs of characters which every match of a chain has to contain */
+static void scan_literal_chain(RegexNode *node, LiteralScan *scan)
+{
+	for (; node != NULL; node = node->generic.next) {
+		const MatchFunc match = node->generic.match;
+
+		if (match == char_is_match) {
+			if (scan->run_len == 0)
+				scan->run_dist = scan->dist;
+
+			const unsigned width = utf8_encode(
+				node->chr.chr, scan->run + scan->run_len);
+			scan->run_len += width;
+			scan->dist = saturating_add(scan->dist, width);
+		} else if (match == char_fold_is_match &&
+			   fold_is_ascii(node->chr.chr)) {
+			// letters whose cases are both ascii are searched
+			// for in lower case
+			if (scan->run_len == 0)
+				scan->run_dist = scan->dist;
+
+			scan->run[scan->run_len++] =
+				(char)ascii_lower((uint8_t)node->chr.chr);
+			scan->dist = saturating_add(scan->dist, 1);
+		} else if (match == cap_is_match) {
+			scan_literal_chain(node->cap.subexp, scan);
+		} else if (match == start_is_match ||
+			   match == anchor_begin_is_match ||
+			   match == anchor_end_is_match) {
+			// zero width nodes don't interrupt a run
+		} else {
+			end_literal_run(scan);
+			scan->dist =
+				saturating_add(scan->dist, node_max_width(node));
+		}
+	}
+}
+
+/* store longest literal every match has to contain in re */
+static void find_required_literal(MRegexp *re)
+{
+	const size_t buf_len = re->nodes_len * 4;
+	LiteralScan scan = {NULL, 0, 0, NULL, 0, __SIZE_MAX__, 0};
+
+	scan.run = (char *)mem_alloc(&re->alloc, buf_len);
+	scan.best = (char *)mem_alloc(&re->alloc, buf_len);
+
+	if (scan.run == NULL || scan.best == NULL) {
+		mem_free(&re->alloc, scan.run, buf_len);
+		mem_free(&re->alloc, scan.best, buf_len);
+		throw_compile_exception(MREGEXP_FAILED_ALLOC, NULL);
+	}
+
+	scan_literal_chain(re->program, &scan);
+	end_literal_run(&scan);
+	mem_free(&re->alloc, scan.run, buf_len);
+
+	if (scan.best_len == 0) {
+		mem_free(&re->alloc, scan.best, buf_len);
+		return;
+	}
+
+	re->literal = (char *)mem_realloc(&re->alloc, scan.best, buf_len,
+					  scan.best_len);
+
+	if (re->literal == NULL) {
+		mem_free(&re->alloc, scan.best, buf_len);
+		throw_compile_exception(MREGEXP_FAILED_ALLOC, NULL);
+	}
+
+	re->literal_len = scan.best_len;
+	re->literal_dist = scan.best_dist;
+}
+
+static inline void add_first_byte(Prefilter *pf, uint8_t c)
+{
+	pf->first_bytes_len += !pf->first_bytes[c];
+	pf->first_bytes[c] = 1;
+}
+
+/* check if a range of cls is a unicode property */
+static bool has_property(const ClassNode *cls)
+{
+	for (uint32_t i = 0; i < cls->ranges_len; ++i)
+		if (cls->ranges[i].property != PROPERTY_NONE)
+			return true;
+
+	return false;
+}
+
+/* add all bytes which may begin the encoding of
+ * a character in the range first to last */
+static void add_first_byte_range(Prefilter *pf, uint32_t first,
+				 uint32_t last)
+{
+	char buf[4];
+
+	for (uint32_t c = first; c <= last && c < 128; ++c)
+		add_first_byte(pf, (uint8_t)c);
+
+	if (last < 128)
+		return;
+
+	if (first < 128)
+		first = 128;
+
+	// utf8 preserves the order of characters, so lead bytes
+	// of a range are a range as well
+	utf8_encode(first, buf);
+	const uint8_t lead_first = (uint8_t)buf[0];
+	utf8_encode(last, buf);
+	const uint8_t lead_last = (uint8_t)buf[0];
+
+	for (unsigned c = lead_first; c <= lead_last; ++c)
+		add_first_byte(pf, (uint8_t)c);
+}
+
+static bool chain_first_bytes(RegexNode *node, Prefilter *pf);
+
+/* add possible first bytes of a node to pf.
+ * returns true if the node may match without consuming anything */
+static bool node_first_bytes(RegexNode *node, Prefilter *pf)
+{
+	const MatchFunc match = node->generic.match;
+
+	if (match == char_is_match) {
+		char buf[4];
+		utf8_encode(node->chr.chr, buf);
+		add_first_byte(pf, (uint8_t)buf[0]);
+		return false;
+	} else if (match == char_fold_is_match) {
+		char buf[4];
+		const uint32_t chr = node->chr.chr;
+		utf8_encode(chr, buf);
+		add_first_byte(pf, (uint8_t)buf[0]);
+
+		for (uint32_t o = fold_next(chr); o != chr; o = fold_next(o)) {
+			utf8_encode(o, buf);
+			add_first_byte(pf, (uint8_t)buf[0]);
+		}
+
+		return false;
+	} else if (match == class_is_match && !node->cls.negate &&
+		   (node->cls.fold || has_property(&node->cls))) {
+		// other cases of non-ascii members and members of
+		// properties may begin with any byte
+		for (unsigned c = 0; c < 256; ++c)
+			if (c >= 128 || class_contains_ascii(&node->cls, c))
+				add_first_byte(pf, (uint8_t)c);
+		return false;
+	} else if (match == class_is_match && !node->cls.negate) {
+		for (uint32_t i = 0; i < node->cls.ranges_len; ++i)
+			add_first_byte_range(pf, node->cls.ranges[i].first,
+					     node->cls.ranges[i].last);
+		return false;
+	} else if (match == class_is_match || match == any_is_match) {
+		// invalid utf8 is matched as well
+		for (unsigned c = 0; c < 256; ++c)
+			add_first_byte(pf, (uint8_t)c);
+		return false;
+	} else if (match == quant_is_match) {
+		return chain_first_bytes(node->quant.subexp, pf) ||
+		       node->quant.min == 0;
+	} else if (match == cap_is_match) {
+		return chain_first_bytes(node->cap.subexp, pf);
+	} else if (match == or_is_match) {
+		// empty alternatives never match
+		bool ret = false;
+
+		for (; node != NULL; node = or_rest(node)) {
+			if (node->orn.left != NULL)
+				ret |= chain_first_bytes(node->orn.left, pf);
+
+			if (or_rest(node) == NULL && node->orn.right != NULL)
+				ret |= chain_first_bytes(node->orn.right, pf);
+		}
+
+		return ret;
+	} else {
+		return true;
+	}
+}
+
+static bool chain_first_bytes(RegexNode *node, Prefilter *pf)
+{
+	for (; node != NULL; node = node->generic.next)
+		if (!node_first_bytes(node, pf))
+			return false;
+
+	return true;
+}
+
+/* skip zero width nodes and enter capture groups at the
+ * beginning of a chain */
+static RegexNode *chain_head(RegexNode *node)
+{
+	while (node != NULL) {
+		if (node->generic.match == start_is_match)
+			node = node->generic.next;
+		else if (node->generic.match == cap_is_match)
+			node = node->cap.subexp;
+		else
+			break;
+	}
+
+	return node;
+}
+
+/* add the literal every match of chain begins with to pf. returns
+ * false if there is no such literal or there are too many of them */
+static bool collect_prefixes(RegexNode *node, Prefilter *pf)
+{
+	node = chain_head(node);
+
+	if (node != NULL && node->generic.match == or_is_match) {
+		for (; node != NULL; node = or_rest(node)) {
+			if (node->orn.left == NULL ||
+			    !collect_prefixes(node->orn.left, pf))
+				return false;
+
+			if (or_rest(node) == NULL)
+				return node->orn.right != NULL &&
+				       collect_prefixes(node->orn.right, pf);
+		}
+	}
+
+	if (pf->prefixes_len == MAX_PREFIXES)
+		return false;
+
+	char *const begin =
+		pf->prefix_data + pf->prefix_offsets[pf->prefixes_len];
+	size_t len = 0;
+
+	for (; node != NULL && node->generic.match == char_is_match &&
+	       len + 4 <= MAX_PREFIX_LEN;
+	     node = chain_head(node->generic.next))
+		len += utf8_encode(node->chr.chr, begin + len);
+
+	if (len == 0)
+		return false;
+
+	pf->prefixes_len++;
+	pf->prefix_offsets[pf->prefixes_len] =
+		(uint16_t)(pf->prefix_offsets[pf->prefixes_len - 1] + len);
+	return true;
+}
+
+/* sort prefixes by their first byte and index them in first_bytes */
+static void index_prefixes(Prefilter *pf)
+{
+	char data[MAX_PREFIXES * MAX_PREFIX_LEN];
+	uint16_t offsets[MAX_PREFIXES + 1];
+	size_t n = 0;
+
+	memcpy(data, pf->prefix_data, pf->prefix_offsets[pf->prefixes_len]);
+	memcpy(offsets, pf->prefix_offsets, sizeof(offsets));
+	memset(pf->first_bytes, 0, sizeof(pf->first_bytes));
+	pf->first_bytes_len = 0;
+
+	for (unsigned c = 0; c < 256; ++c) {
+		for (size_t i = 0; i < pf->prefixes_len; ++i) {
+			if ((uint8_t)data[offsets[i]] != c)
+				continue;
+
+			const size_t len = offsets[i + 1] - offsets[i];
+
+			if (!pf->first_bytes[c])
+				pf->first_bytes[c] = (uint8_t)(n + 1);
+
+			memcpy(pf->prefix_data + pf->prefix_offsets[n],
+			       data + offsets[i], len);
+			pf->prefix_offsets[n + 1] =
+				(uint16_t)(pf->prefix_offsets[n] + len);
+			n++;
+		}
+
+		pf->first_bytes_len += pf->first_bytes[c] != 0;
+	}
+}
+
+/* decide where matches of re may begin */
+static void find_start_positions(MRegexp *re)
+{
+	RegexNode *first = re->program;
+
+	if (first != NULL && first->generic.match == anchor_begin_is_match) {
+		re->anchored = true;
+		return;
+	}
+
+	Prefilter *pf = (Prefilter *)mem_alloc(&re->alloc, PREFILTER_MAX_SIZE);
+
+	if (pf == NULL)
+		throw_compile_exception(MREGEXP_FAILED_ALLOC, NULL);
+
+	memset(pf, 0, PREFILTER_MAX_SIZE);
+	re->prefilter = pf;
+	re->prefilter_size = PREFILTER_MAX_SIZE;
+
+	if (chain_first_bytes(re->program, pf) || pf->first_bytes_len == 256) {
+		// a prefilter wouldn't skip anything
+		re->prefilter = NULL;
+		re->prefilter_size = 0;
+		mem_free(&re->alloc, pf, PREFILTER_MAX_SIZE);
+		return;
+	}
+
+	if (collect_prefixes(re->program, pf) && pf->prefixes_len > 1)
+		index_prefixes(pf);
+	else
+		pf->prefixes_len = 0;
+
+	for (unsigned c = 0; c < 256; ++c)
+		if (pf->first_bytes[c])
+			pf->first_byte = (uint8_t)c;
+
+	// give back the room of the prefixes not found
+	const size_t size =
+		sizeof(Prefilter) + pf->prefix_offsets[pf->prefixes_len];
+	pf = (Prefilter *)mem_realloc(&re->alloc, pf, PREFILTER_MAX_SIZE,
+				      size);
+
+	if (pf == NULL)
+		throw_compile_exception(MREGEXP_FAILED_ALLOC, NULL);
+
+	re->prefilter = pf;
+	re->prefilter_size = size;
+}
+
+/* factor characters shared by the first two alternatives out of an
+ * OrNode. the alternatives after the first one must be factored already */
+static void factor_or(RegexNode *orn)
+{
+	for (;;) {
+		RegexNode *next_or = or_rest(orn);
+		RegexNode *left = orn->orn.left;
+		RegexNode *right =
+			next_or != NULL ? next_or->orn.left : orn->orn.right;
+
+		if (left == NULL || right == NULL ||
+		    (left->generic.match != char_is_match &&
+		     left->generic.match != char_fold_is_match) ||
+		    right->generic.match != left->generic.match ||
+		    left->chr.chr != right->chr.chr)
+			return;
+
+		const MatchFunc match = left->generic.match;
+		const uint32_t chr = left->chr.chr;
+		RegexNode *left_rest = left->generic.next;
+		RegexNode *right_rest = right->generic.next;
+
+		if (next_or != NULL) {
+			// turn c x|c y|z into c(x|y)|z, reusing the
+			// OrNode of the second alternative for x|y
+			orn->orn.right = next_or->orn.right;
+
+			if (left_rest == NULL) {
+				// c always wins over c y
+				continue;
+			}
+
+			if (right_rest == NULL) {
+				right->generic.match = start_is_match;
+				right->generic.next = NULL;
+				right_rest = right;
+			}
+
+			next_or->generic.next = NULL;
+			next_or->orn.left = left_rest;
+			next_or->orn.right = right_rest;
+			left->generic.next = next_or;
+			factor_or(next_or);
+			continue;
+		}
+
+		// orn becomes the shared character, which keeps every
+		// pointer to it intact
+		const uint32_t slots_begin = orn->orn.slots_begin;
+		const uint32_t slots_end = orn->orn.slots_end;
+		orn->generic.match = match;
+		orn->chr.chr = chr;
+
+		if (left_rest == NULL) {
+			// the left branch always wins after the
+			// shared character
+			orn->generic.next = NULL;
+			return;
+		}
+
+		if (right_rest == NULL) {
+			// reuse the left character for an empty branch,
+			// which other than a NULL branch always matches
+			left->generic.match = start_is_match;
+			left->generic.next = NULL;
+			right_rest = left;
+		}
+
+		right->generic.match = or_is_match;
+		right->generic.next = NULL;
+		right->orn.left = left_rest;
+		right->orn.right = right_rest;
+		right->orn.slots_begin = slots_begin;
+		right->orn.slots_end = slots_end;
+
+		orn->generic.next = right;
+		orn = right;
+	}
+}
+
+static void factor_chain(RegexNode *node);
+
+/* factor common prefixes out of the alternatives of orn */
+static void factor_alternatives(RegexNode *orn)
+{
+	RegexNode *last = orn;
+
+	for (RegexNode *alt = orn; alt != NULL; alt = or_rest(alt)) {
+		factor_chain(alt->orn.left);
+
+		if (or_rest(alt) == NULL) {
+			factor_chain(alt->orn.right);
+			last = alt;
+		}
+	}
+
+	// go back from the last pair of alternatives, so the right
+	// branch of every OrNode is factored before the node itself
+	while (last != NULL) {
+		RegexNode *prev = last->generic.prev;
+		factor_or(last);
+		last = prev;
+	}
+}
+
+/* factor common prefixes out of alternatives */
+static void factor_chain(RegexNode *node)
+{
+	for (; node != NULL; node = node->generic.next) {
+		const MatchFunc match = node->generic.match;
+
+		if (match == quant_is_match) {
+			factor_chain(node->quant.subexp);
+		} else if (match == cap_is_match) {
+			factor_chain(node->cap.subexp);
+		} else if (match == or_is_match) {
+			// an OrNode ends its chain. factoring may append
+			// nodes to it, which are already factored
+			factor_alternatives(node);
+			return;
+		}
+	}
+}
+
+/* check if node is a character which may be merged into a string. of
+ * the ones compared ignoring case only those whose cases are all ascii
+ * letters are, since strings are compared bytewise */
+static inline bool is_string_char(const RegexNode *node)
+{
+	return node->generic.match == char_is_match ||
+	       (node->generic.match == char_fold_is_match &&
+		fold_is_ascii(node->chr.chr));
+}
+
+/* store the bytes of a character of a string in out and set *fold if
+ * it is compared ignoring case. returns the amount of bytes stored */
+static unsigned encode_string_char(const RegexNode *node, char *out,
+				   bool *fold)
+{
+	if (node->generic.match == char_fold_is_match) {
+		*fold = true;
+		out[0] = (char)ascii_lower((uint8_t)node->chr.chr);
+		return 1;
+	}
+
+	return utf8_encode(node->chr.chr, out);
+}
+
+/* merge runs of characters into StringNodes and replace quantifiers over
+ * single characters and classes with loops */
+static void merge_chain(MRegexp *re, RegexNode *node)
+{
+	for (; node != NULL; node = node->generic.next) {
+		const MatchFunc match = node->generic.match;
+
+		if (match == quant_is_match) {
+			RegexNode *sub = node->quant.subexp;
+			merge_chain(re, sub);
+
+			if (sub->generic.next != NULL)
+				continue;
+			else if (sub->generic.match == char_is_match ||
+				 sub->generic.match == char_fold_is_match)
+				node->generic.match = quant_char_is_match;
+			else if (sub->generic.match == class_is_match)
+				node->generic.match = quant_class_is_match;
+			else if (sub->generic.match == any_is_match)
+				node->generic.match = quant_any_is_match;
+		} else if (match == cap_is_match) {
+			merge_chain(re, node->cap.subexp);
+		} else if (match == or_is_match) {
+			for (RegexNode *alt = node; alt != NULL;
+			     alt = or_rest(alt)) {
+				merge_chain(re, alt->orn.left);
+
+				if (or_rest(alt) == NULL)
+					merge_chain(re, alt->orn.right);
+			}
+		} else if (is_string_char(node) && node->generic.next != NULL &&
+			   is_string_char(node->generic.next)) {
+			char *str = re->strings + re->strings_used;
+			size_t len = 0;
+			bool fold = false;
+			RegexNode *last = node;
+
+			len += encode_string_char(node, str, &fold);
+
+			while (last->generic.next != NULL &&
+			       is_string_char(last->generic.next)) {
+				last = last->generic.next;
+				len += encode_string_char(last, str + len, &fold);
+			}
+
+			node->generic.match =
+				fold ? string_fold_is_match : string_is_match;
+			node->generic.next = last->generic.next;
+			node->str.str = str;
+			node->str.len = len;
+			re->strings_used += len;
+		}
+	}
+}
+
+/* rewrite the compiled program into an equivalent one with fewer
+ * nodes. pattern_len bounds the size of all merged strings */
+static void optimize(MRegexp *re, size_t pattern_len)
+{
+	factor_chain(re->program);
+
+	if (pattern_len > 0) {
+		re->strings = (char *)mem_alloc(&re->alloc, pattern_len);
+
+		if (re->strings == NULL)
+			throw_compile_exception(MREGEXP_FAILED_ALLOC, NULL);
+
+		re->strings_len = pattern_len;
+
+		merge_chain(re, re->program);
+	}
+
+	const RegexNode *head = re->program;
+	re->head_loop = head != NULL &&
+			(head->generic.match == quant_char_is_match ||
+			 head->generic.match == quant_class_is_match) &&
+			head->quant.min > 0;
+}
+
+/* hash of the members of a class */
+static uint64_t hash_class(const ClassNode *cls)
+{
+	uint64_t h = 14695981039346656037ULL;
+
+	h = (h ^ (uint64_t)(cls->negate | cls->fold << 1)) * 1099511628211ULL;
+
+	for (uint32_t i = 0; i < cls->ranges_len; ++i) {
+		const CharRange *range = &cls->ranges[i];
+		h = (h ^ range->first) * 1099511628211ULL;
+		h = (h ^ range->last) * 1099511628211ULL;
+		h = (h ^ range->property) * 1099511628211ULL;
+	}
+
+	return h;
+}
+
+/* check if two classes have the same members */
+static bool same_class(const ClassNode *a, const ClassNode *b)
+{
+	if (a->negate != b->negate || a->fold != b->fold ||
+	    a->ranges_len != b->ranges_len)
+		return false;
+
+	for (uint32_t i = 0; i < a->ranges_len; ++i) {
+		const CharRange *x = &a->ranges[i], *y = &b->ranges[i];
+
+		if (x->first != y->first || x->last != y->last ||
+		    x->property != y->property)
+			return false;
+	}
+
+	return true;
+}
+
+/* get the copy of node in nodes, the compacted nodes of re. map holds
+ * the index of the copy of each old node, __SIZE_MAX__ if there is none */
+static inline RegexNode *relocate(const MRegexp *re, const size_t *map,
+				  RegexNode *nodes, RegexNode *node)
+{
+	if (node == NULL || map[node - re->nodes] == __SIZE_MAX__)
+		return NULL;
+
+	return &nodes[map[node - re->nodes]];
+}
+
+/* move the nodes of the program of re into an array without the ones
+ * left behind by compiling and optimizing, let equal classes share their
+ * ranges and bitmaps and store merged strings without slack. indices of
+ * nodes change, so this has to happen before they are indexed */
+static void compact(MRegexp *re)
+{
+	const MRegexpAllocator *alloc = &re->alloc;
+	const size_t old_len = re->nodes_len;
+
+	if (re->program == NULL)
+		return;
+
+	size_t *map = (size_t *)mem_alloc(alloc, old_len * sizeof(size_t));
+	RegexNode **stack =
+		(RegexNode **)mem_alloc(alloc, old_len * sizeof(RegexNode *));
+
+	if (map == NULL || stack == NULL) {
+		mem_free(alloc, map, old_len * sizeof(size_t));
+		mem_free(alloc, stack, old_len * sizeof(RegexNode *));
+		throw_compile_exception(MREGEXP_FAILED_ALLOC, NULL);
+	}
+
+	// mark the nodes reachable from the program. every node is linked
+	// to from a single other one, so each is pushed at most once
+	for (size_t i = 0; i < old_len; ++i)
+		map[i] = __SIZE_MAX__;
+
+	size_t top = 0;
+	map[re->program - re->nodes] = 0;
+	stack[top++] = re->program;
+
+	while (top > 0) {
+		RegexNode *node = stack[--top];
+		const MatchFunc match = node->generic.match;
+		RegexNode *links[3] = {node->generic.next, NULL, NULL};
+
+		if (is_quant(match)) {
+			links[1] = node->quant.subexp;
+		} else if (match == cap_is_match) {
+			links[1] = node->cap.subexp;
+		} else if (match == or_is_match) {
+			links[1] = node->orn.left;
+			links[2] = node->orn.right;
+		}
+
+		for (size_t i = 0; i < 3; ++i) {
+			if (links[i] != NULL &&
+			    map[links[i] - re->nodes] == __SIZE_MAX__) {
+				map[links[i] - re->nodes] = 0;
+				stack[top++] = links[i];
+			}
+		}
+	}
+
+	mem_free(alloc, stack, old_len * sizeof(RegexNode *));
+
+	// copies keep the order of the nodes
+	size_t len = 0, classes = 0, strings_len = 0;
+
+	for (size_t i = 0; i < old_len; ++i) {
+		if (map[i] == __SIZE_MAX__)
+			continue;
+
+		const MatchFunc match = re->nodes[i].generic.match;
+		classes += match == class_is_match;
+
+		if (match == string_is_match || match == string_fold_is_match)
+			strings_len += re->nodes[i].str.len;
+
+		map[i] = len++;
+	}
+
+	size_t table_len = 1;
+
+	while (table_len < 2 * classes)
+		table_len *= 2;
+
+	RegexNode *nodes =
+		(RegexNode *)mem_alloc(alloc, len * sizeof(RegexNode));
+	size_t *table = (size_t *)mem_alloc(alloc, table_len * sizeof(size_t));
+	char *strings = NULL;
+
+	if (strings_len > 0)
+		strings = (char *)mem_alloc(alloc, strings_len);
+
+	if (nodes == NULL || (strings == NULL && strings_len > 0) ||
+	    table == NULL) {
+		mem_free(alloc, map, old_len * sizeof(size_t));
+		mem_free(alloc, nodes, len * sizeof(RegexNode));
+		mem_free(alloc, strings, strings_len);
+		mem_free(alloc, table, table_len * sizeof(size_t));
+		throw_compile_exception(MREGEXP_FAILED_ALLOC, NULL);
+	}
+
+	strings_len = 0;
+
+	for (size_t i = 0; i < old_len; ++i) {
+		if (map[i] == __SIZE_MAX__)
+			continue;
+
+		RegexNode *node = &nodes[map[i]];
+		*node = re->nodes[i];
+
+		const MatchFunc match = node->generic.match;
+		node->generic.next =
+			relocate(re, map, nodes, node->generic.next);
+		node->generic.prev =
+			relocate(re, map, nodes, node->generic.prev);
+
+		if (is_quant(match)) {
+			node->quant.subexp =
+				relocate(re, map, nodes, node->quant.subexp);
+		} else if (match == cap_is_match) {
+			node->cap.subexp =
+				relocate(re, map, nodes, node->cap.subexp);
+		} else if (match == or_is_match) {
+			node->orn.left =
+				relocate(re, map, nodes, node->orn.left);
+			node->orn.right =
+				relocate(re, map, nodes, node->orn.right);
+		} else if (match == string_is_match ||
+			   match == string_fold_is_match) {
+			memcpy(strings + strings_len, node->str.str,
+			       node->str.len);
+			node->str.str = strings + strings_len;
+			strings_len += node->str.len;
+		}
+	}
+
+	re->program = relocate(re, map, nodes, re->program);
+	mem_free(alloc, map, old_len * sizeof(size_t));
+	mem_free(alloc, re->nodes, old_len * sizeof(RegexNode));
+	mem_free(alloc, re->strings, re->strings_len);
+	re->nodes = nodes;
+	re->nodes_len = len;
+	re->strings = strings;
+	re->strings_len = re->strings_used = strings_len;
+
+	// find the first class with the same members as each class. those
+	// come first, so a class is the first one of its kind if it finds
+	// itself. the table holds 1 + the indices of the first ones
+	size_t unique = 0, ranges_len = 0;
+	memset(table, 0, table_len * sizeof(size_t));
+
+	for (size_t i = 0; i < len; ++i) {
+		ClassNode *cls = &nodes[i].cls;
+
+		if (cls->generic.match != class_is_match)
+			continue;
+
+		size_t slot = (size_t)hash_class(cls) & (table_len - 1);
+
+		while (table[slot] != 0 &&
+		       !same_class(&nodes[table[slot] - 1].cls, cls))
+			slot = (slot + 1) & (table_len - 1);
+
+		if (table[slot] == 0) {
+			table[slot] = i + 1;
+			unique++;
+			ranges_len += cls->ranges_len;
+		}
+	}
+
+	CharRange *ranges = NULL;
+	uint64_t *bits = NULL;
+
+	if (ranges_len > 0)
+		ranges = (CharRange *)mem_alloc(alloc,
+						ranges_len * sizeof(CharRange));
+
+	if (unique > 0)
+		bits = (uint64_t *)mem_alloc(alloc,
+					     unique * 2 * sizeof(uint64_t));
+
+	if ((ranges == NULL && ranges_len > 0) ||
+	    (bits == NULL && unique > 0)) {
+		mem_free(alloc, table, table_len * sizeof(size_t));
+		mem_free(alloc, ranges, ranges_len * sizeof(CharRange));
+		mem_free(alloc, bits, unique * 2 * sizeof(uint64_t));
+		throw_compile_exception(MREGEXP_FAILED_ALLOC, NULL);
+	}
+
+	CharRange *next_range = ranges;
+	uint64_t *next_bits = bits;
+
+	for (size_t i = 0; i < len; ++i) {
+		ClassNode *cls = &nodes[i].cls;
+
+		if (cls->generic.match != class_is_match)
+			continue;
+
+		size_t slot = (size_t)hash_class(cls) & (table_len - 1);
+
+		while (!same_class(&nodes[table[slot] - 1].cls, cls))
+			slot = (slot + 1) & (table_len - 1);
+
+		const ClassNode *first = &nodes[table[slot] - 1].cls;
+
+		if (first != cls) {
+			// the first one was moved already
+			cls->ranges = first->ranges;
+			cls->ascii = first->ascii;
+			continue;
+		}
+
+		if (cls->ranges_len > 0)
+			memcpy(next_range, cls->ranges,
+			       cls->ranges_len * sizeof(CharRange));
+
+		memcpy(next_bits, cls->ascii, 2 * sizeof(uint64_t));
+		cls->ranges = cls->ranges_len > 0 ? next_range : NULL;
+		cls->ascii = next_bits;
+		next_range += cls->ranges_len;
+		next_bits += 2;
+	}
+
+	mem_free(alloc, table, table_len * sizeof(size_t));
+	mem_free(alloc, re->ranges, re->ranges_len * sizeof(CharRange));
+	mem_free(alloc, re->class_bits, re->classes_len * 2 * sizeof(uint64_t));
+	re->ranges = ranges;
+	re->ranges_len = ranges_len;
+	re->class_bits = bits;
+	re->classes_len = unique;
+}
+
+/* mark the loops of chain which end every match of it */
+static void mark_tails(MRegexp *re, RegexNode *node)
+{
+	while (node != NULL) {
+		while (node->generic.next != NULL)
+			node = node->generic.next;
+
+		const MatchFunc match = node->generic.match;
+
+		if (match == cap_is_match) {
+			node = node->cap.subexp;
+		} else if (match == or_is_match) {
+			// the chains of all alternatives end the match
+			for (; or_rest(node) != NULL; node = or_rest(node))
+				mark_tails(re, node->orn.left);
+
+			mark_tails(re, node->orn.left);
+			node = node->orn.right;
+		} else {
+			if (is_quant(match)) {
+				const size_t i = (size_t)(node - re->nodes);
+				re->tails[i >> 6] |= (uint64_t)1 << (i & 63);
+			}
+
+			return;
+		}
+	}
+}
+
+/* find the loops which don't have to be extended by mregexp_is_match */
+static void index_tails(MRegexp *re)
+{
+	if (re->nodes_len == 0)
+		return;
+
+	re->tails_len = (re->nodes_len + 63) / 64;
+	re->tails = (uint64_t *)mem_alloc(&re->alloc,
+					  re->tails_len * sizeof(uint64_t));
+
+	if (re->tails == NULL)
+		throw_compile_exception(MREGEXP_FAILED_ALLOC, NULL);
+
+	memset(re->tails, 0, re->tails_len * sizeof(uint64_t));
+	mark_tails(re, re->program);
+}
+
+/* split the classes of bytes, of which there are *len, so that none of
+ * them holds bytes both inside and outside of the set members */
+static void refine_byte_classes(uint8_t *classes, size_t *len,
+				const uint64_t *members)
+{
+	int16_t ids[512];
+	size_t next = 0;
+	memset(ids, 0xff, sizeof(ids));
+
+	for (unsigned c = 0; c < 256; ++c) {
+		const unsigned key = classes[c] * 2 + ((members[c >> 6] >> (c & 63)) & 1);
+
+		if (ids[key] < 0)
+			ids[key] = (int16_t)next++;
+
+		classes[c] = (uint8_t)ids[key];
+	}
+
+	*len = next;
+}
+
+static void refine_byte_range(uint8_t *classes, size_t *len, uint8_t first,
+			      uint8_t last)
+{
+	uint64_t members[4] = {0, 0, 0, 0};
+
+	for (unsigned c = first; c <= last; ++c)
+		members[c >> 6] |= (uint64_t)1 << (c & 63);
+
+	refine_byte_classes(classes, len, members);
+}
+
+/* split byte classes by the bytes of the utf8 encodings of the characters
+ * first to last. the range is cut into pieces whose encodings have the
+ * same width and differ only in a suffix of full continuation bytes, so
+ * each piece is a sequence of byte ranges */
+static void refine_utf8_range(uint8_t *classes, size_t *len, uint32_t first,
+			      uint32_t last)
+{
+	// every cut leaves at most one piece per continuation level
+	// on each side, so a few slots are enough
+	uint32_t stack[32][2];
+	size_t stack_len = 0;
+
+	stack[stack_len][0] = first;
+	stack[stack_len++][1] = last;
+
+	while (stack_len > 0) {
+		stack_len--;
+		uint32_t lo = stack[stack_len][0], hi = stack[stack_len][1];
+		bool cut = false;
+
+		// pieces may not span different widths
+		static const uint32_t width_ends[] = {0x7f, 0x7ff, 0xffff};
+
+		for (unsigned i = 0; i < 3 && !cut; ++i) {
+			if (lo <= width_ends[i] && hi > width_ends[i]) {
+				stack[stack_len][0] = width_ends[i] + 1;
+				stack[stack_len++][1] = hi;
+				stack[stack_len][0] = lo;
+				stack[stack_len++][1] = width_ends[i];
+				cut = true;
+			}
+		}
+
+		// nor partial ranges of continuation bytes in front of
+		// differing bytes
+		for (unsigned i = 1; i < 4 && !cut; ++i) {
+			const uint32_t mask = ((uint32_t)1 << (6 * i)) - 1;
+
+			if ((lo & ~mask) == (hi & ~mask))
+				continue;
+
+			if ((lo & mask) != 0) {
+				stack[stack_len][0] = (lo | mask) + 1;
+				stack[stack_len++][1] = hi;
+				stack[stack_len][0] = lo;
+				stack[stack_len++][1] = lo | mask;
+				cut = true;
+			} else if ((hi & mask) != mask) {
+				stack[stack_len][0] = hi & ~mask;
+				stack[stack_len++][1] = hi;
+				stack[stack_len][0] = lo;
+				stack[stack_len++][1] = (hi & ~mask) - 1;
+				cut = true;
+			}
+		}
+
+		if (cut)
+			continue;
+
+		char lo_bytes[4], hi_bytes[4];
+		const unsigned width = utf8_encode(lo, lo_bytes);
+		utf8_encode(hi, hi_bytes);
+
+		for (unsigned i = 0; i < width; ++i)
+			refine_byte_range(classes, len, (uint8_t)lo_bytes[i],
+					  (uint8_t)hi_bytes[i]);
+	}
+}
+
+/* refine classes by each byte of the encoding of chr */
+static void refine_char_bytes(uint8_t *classes, size_t *len, uint32_t chr)
+{
+	char bytes[4];
+	const unsigned width = utf8_encode(chr, bytes);
+
+	for (unsigned i = 0; i < width; ++i)
+		refine_byte_range(classes, len, (uint8_t)bytes[i],
+				  (uint8_t)bytes[i]);
+}
+
+/* kinds of bytes the decoder of subjects tells apart: continuation bytes
+ * completing overlong or too large sequences, leads of overlong sequences,
+ * leads of two to four bytes wide sequences and invalid bytes */
+static const uint8_t decoder_byte_ranges[][2] = {
+	{0x80, 0x8f}, {0x90, 0x9f}, {0xa0, 0xbf}, {0xc0, 0xc1}, {0xc2, 0xdf},
+	{0xe0, 0xe0}, {0xe1, 0xef}, {0xf0, 0xf0}, {0xf1, 0xf7}, {0xf8, 0xff},
+};
+
+/* compute classes of bytes which no node of re tells apart */
+static void index_bytes(MRegexp *re)
+{
+	uint8_t *classes = re->byte_classes;
+	size_t len = 1;
+	memset(classes, 0, sizeof(re->byte_classes));
+
+	for (size_t i = 0; i < sizeof(decoder_byte_ranges) /
+				       sizeof(*decoder_byte_ranges);
+	     ++i)
+		refine_byte_range(classes, &len, decoder_byte_ranges[i][0],
+				  decoder_byte_ranges[i][1]);
+
+	for (size_t i = 0; i < re->nodes_len; ++i) {
+		const RegexNode *node = &re->nodes[i];
+		const MatchFunc match = node->generic.match;
+
+		if (match == char_is_match) {
+			refine_char_bytes(classes, &len, node->chr.chr);
+		} else if (match == char_fold_is_match) {
+			const uint32_t chr = node->chr.chr;
+			refine_char_bytes(classes, &len, chr);
+
+			for (uint32_t o = fold_next(chr); o != chr;
+			     o = fold_next(o))
+				refine_char_bytes(classes, &len, o);
+		} else if (match == string_is_match) {
+			for (size_t j = 0; j < node->str.len; ++j)
+				refine_byte_range(classes, &len,
+						  (uint8_t)node->str.str[j],
+						  (uint8_t)node->str.str[j]);
+		} else if (match == string_fold_is_match) {
+			for (size_t j = 0; j < node->str.len; ++j) {
+				const uint8_t c = (uint8_t)node->str.str[j];
+				const uint8_t upper = ascii_upper(c);
+				uint64_t members[4] = {0, 0, 0, 0};
+
+				members[c >> 6] |= (uint64_t)1 << (c & 63);
+				members[upper >> 6] |= (uint64_t)1
+						       << (upper & 63);
+				refine_byte_classes(classes, &len, members);
+			}
+		} else if (match == class_is_match) {
+			const uint64_t ascii[4] = {node->cls.ascii[0],
+						   node->cls.ascii[1], 0, 0};
+			refine_byte_classes(classes, &len, ascii);
+
+			if (node->cls.fold) {
+				// the only non-ascii cases of ascii letters
+				refine_char_bytes(classes, &len, 0x212a);
+				refine_char_bytes(classes, &len, 0x17f);
+			}
+
+			for (uint32_t r = 0; r < node->cls.ranges_len; ++r) {
+				const CharRange *range = &node->cls.ranges[r];
+
+				if (range->property == PROPERTY_NONE &&
+				    (range->last < 128 || range->last < range->first))
+					continue;
+
+				if (range->property == PROPERTY_NONE &&
+				    !node->cls.fold) {
+					refine_utf8_range(classes, &len,
+							  range->first < 128
+								  ? 128
+								  : range->first,
+							  range->last);
+					continue;
+				}
+
+				// members of properties and other cases of
+				// non-ascii members may be encoded with any bytes
+				for (unsigned c = 128; c < 256; ++c)
+					refine_byte_range(classes, &len, (uint8_t)c,
+							  (uint8_t)c);
+				break;
+			}
+		}
+	}
+
+	re->byte_classes_len = len;
+}
+
+/* maximum amount of states of a dfa if the options don't limit it */
+#define DFA_DEFAULT_MAX_STATES 4096
+
+/* maximum amount of positions inside of the program the states of a
+ * dfa are made of. bounded loops take one per repetition */
+#define DFA_MAX_CONFIGS 4096
+
+/* event of a non-ascii or invalid character. ascii characters
+ * are events of their own */
+#define DFA_OTHER 128
+
+/* kinds of the elements a program is translated into for the dfa */
+enum {
+	DFA_ACCEPT,
+	DFA_SET,
+	DFA_BYTES,
+	DFA_END,
+	DFA_SPLIT,
+};
+
+/* element of the program as seen by the dfa builder. elements
+ * refer to each other by index, element 0 accepts */
+typedef struct {
+	uint8_t kind;
+	/* DFA_SET: loop over min to max characters of a set. non-ascii
+	 * and invalid characters are members if other is set */
+	bool other;
+	uint64_t ascii[2];
+	size_t min, max;
+	/* DFA_BYTES: ascii string, in lower case and compared
+	 * ignoring case if fold is set */
+	const char *bytes;
+	size_t len;
+	bool fold;
+	/* DFA_SPLIT: alternatives, left is preferred */
+	size_t left, right;
+	size_t next;
+	/* first configuration of the element. a configuration is a
+	 * position inside of it, like the amount of repetitions so far */
+	size_t base;
+	/* the rest of the program from this element on matches without
+	 * consuming anything, anywhere or at the end of the subject */
+	bool done, done_at_end;
+} DfaElem;
+
+/* states of the utf8 decoder, named after the width of the
+ * sequence and the amount of its bytes seen so far */
+enum {
+	DEC_NONE,
+	DEC_2_1,
+	DEC_3_1_E0,
+	DEC_3_1,
+	DEC_3_2,
+	DEC_4_1_F0,
+	DEC_4_1,
+	DEC_4_2,
+	DEC_4_3,
+};
+
+/* lowest continuation byte accepted in each decoder state. the first
+ * ones after E0 and F0 exclude overlong sequences */
+static const uint8_t dec_lowest[] = {0, 0x80, 0xa0, 0x80, 0x80,
+				     0x90, 0x80, 0x80, 0x80};
+/* decoder state after another continuation byte. DEC_NONE once
+ * the sequence is complete */
+static const uint8_t dec_follow[] = {DEC_NONE, DEC_NONE, DEC_3_2,
+				     DEC_3_2,  DEC_NONE, DEC_4_2,
+				     DEC_4_2,  DEC_4_3,	 DEC_NONE};
+/* bytes seen of the pending sequence */
+static const uint8_t dec_pending[] = {0, 1, 1, 1, 2, 1, 1, 2, 3};
+
+/* state of the subset construction */
+typedef struct {
+	uint8_t dec;
+	/* matches may still begin here. always false if the
+	 * expression isn't anchored */
+	bool fresh;
+} DfaStateInfo;
+
+typedef struct {
+	const MRegexpAllocator *alloc;
+	size_t max_states;
+
+	DfaElem *elems;
+	size_t elems_len, elems_cap;
+	/* nodes of the chains being translated */
+	RegexNode **stack;
+	size_t stack_len, stack_cap;
+	bool unsupported;
+	size_t root;
+	bool anchored;
+
+	/* element of each configuration */
+	size_t *config_elems;
+	size_t configs_len;
+	/* words of a set of configurations */
+	size_t words;
+	/* an accepting configuration was reached by the last event */
+	bool accept;
+
+	uint8_t classes[256];
+	size_t classes_len;
+	uint8_t class_bytes[256];
+
+	/* configurations of each state, words per state */
+	uint64_t *sets;
+	size_t sets_cap;
+	DfaStateInfo *infos;
+	size_t infos_cap;
+	/* transitions, classes_len per state */
+	uint32_t *trans;
+	size_t trans_cap;
+	size_t states_len;
+	/* open addressing table of state numbers plus one */
+	uint32_t *hash;
+	size_t hash_cap;
+
+	/* scratch sets */
+	uint64_t *cur, *out;
+} DfaBuilder;
+
+/* grow the array at *ptr of size elements to hold at least need */
+static bool dfa_reserve(DfaBuilder *b, void **ptr, size_t *cap, size_t need,
+			size_t size)
+{
+	if (need <= *cap)
+		return true;
+
+	size_t cap2 = *cap > 0 ? *cap : 16;
+	while (cap2 < need)
+		cap2 *= 2;
+
+	if (cap2 > __SIZE_MAX__ / size)
+		return false;
+
+	void *ret = *ptr == NULL
+			    ? mem_alloc(b->alloc, cap2 * size)
+			    : mem_realloc(b->alloc, *ptr, *cap * size,
+					  cap2 * size);
+
+	if (ret == NULL)
+		return false;
+
+	*ptr = ret;
+	*cap = cap2;
+	return true;
+}
+
+static size_t dfa_add_elem(DfaBuilder *b, const DfaElem *e)
+{
+	if (!dfa_reserve(b, (void **)&b->elems, &b->elems_cap,
+			 b->elems_len + 1, sizeof(DfaElem))) {
+		b->unsupported = true;
+		return 0;
+	}
+
+	b->elems[b->elems_len] = *e;
+	return b->elems_len++;
+}
+
+/* element which never matches */
+static size_t dfa_fail(DfaBuilder *b)
+{
+	DfaElem e;
+	memset(&e, 0, sizeof(DfaElem));
+	e.kind = DFA_SET;
+	e.min = e.max = 1;
+
+	return dfa_add_elem(b, &e);
+}
+
+/* store the characters matched by node in e. only classes treating all
+ * non-ascii characters alike are supported */
+static bool dfa_set_of(const RegexNode *node, DfaElem *e)
+{
+	const MatchFunc match = node->generic.match;
+
+	if (match == char_is_match && node->chr.chr < 128) {
+		e->ascii[node->chr.chr >> 6] |= (uint64_t)1
+						<< (node->chr.chr & 63);
+		return true;
+	} else if (match == char_fold_is_match &&
+		   fold_is_ascii(node->chr.chr)) {
+		const uint32_t chr = node->chr.chr;
+		uint32_t c = chr;
+
+		do {
+			e->ascii[c >> 6] |= (uint64_t)1 << (c & 63);
+			c = fold_next(c);
+		} while (c != chr);
+
+		return true;
+	} else if (match == any_is_match) {
+		e->ascii[0] = e->ascii[1] = UINT64_MAX;
+		e->other = true;
+		return true;
+	} else if (match == class_is_match && node->cls.ascii != NULL) {
+		for (uint32_t i = 0; i < node->cls.ranges_len; ++i) {
+			const CharRange *range = &node->cls.ranges[i];
+
+			if (range->last >= 128 ||
+			    range->property != PROPERTY_NONE)
+				return false;
+		}
+
+		// k and s have a non-ascii case, which is
+		// a member if they are in the ranges
+		if (node->cls.fold &&
+		    (class_contains_ascii(&node->cls, 'k') != node->cls.negate ||
+		     class_contains_ascii(&node->cls, 's') != node->cls.negate))
+			return false;
+
+		e->ascii[0] = node->cls.ascii[0];
+		e->ascii[1] = node->cls.ascii[1];
+		e->other = node->cls.negate;
+		return true;
+	}
+
+	return false;
+}
+
+static size_t dfa_chain(DfaBuilder *b, RegexNode *node, size_t cont);
+
+/* translate alternation orn followed by cont */
+static size_t dfa_or(DfaBuilder *b, RegexNode *orn, size_t cont)
+{
+	// alternatives are atomic, so whether one of them matches only
+	// says whether the whole expression matches if nothing follows
+	if (cont != 0) {
+		b->unsupported = true;
+		return 0;
+	}
+
+	size_t ret = __SIZE_MAX__, last = __SIZE_MAX__;
+
+	for (RegexNode *alt = orn; alt != NULL; alt = or_rest(alt)) {
+		RegexNode *chains[2] = {alt->orn.left,
+					or_rest(alt) == NULL ? alt->orn.right
+							     : NULL};
+
+		for (unsigned i = 0; i < 2; ++i) {
+			// empty alternatives never match
+			if (chains[i] == NULL)
+				continue;
+
+			DfaElem e;
+			memset(&e, 0, sizeof(DfaElem));
+			e.kind = DFA_SPLIT;
+			e.left = dfa_chain(b, chains[i], cont);
+
+			const size_t split = dfa_add_elem(b, &e);
+
+			if (b->unsupported)
+				return 0;
+
+			if (last == __SIZE_MAX__)
+				ret = split;
+			else
+				b->elems[last].right = split;
+
+			last = split;
+		}
+	}
+
+	const size_t fail = dfa_fail(b);
+
+	if (last == __SIZE_MAX__)
+		return fail;
+
+	b->elems[last].right = fail;
+	return ret;
+}
+
+/* translate a single node followed by cont */
+static size_t dfa_node(DfaBuilder *b, RegexNode *node, size_t cont)
+{
+	const MatchFunc match = node->generic.match;
+	DfaElem e;
+	memset(&e, 0, sizeof(DfaElem));
+	e.next = cont;
+	e.min = e.max = 1;
+
+	if (match == start_is_match) {
+		return cont;
+	} else if (match == cap_is_match) {
+		return dfa_chain(b, node->cap.subexp, cont);
+	} else if (match == or_is_match) {
+		return dfa_or(b, node, cont);
+	} else if (match == anchor_end_is_match) {
+		e.kind = DFA_END;
+	} else if (match == string_is_match || match == string_fold_is_match) {
+		for (size_t i = 0; i < node->str.len; ++i)
+			if ((uint8_t)node->str.str[i] >= 128)
+				b->unsupported = true;
+
+		e.kind = DFA_BYTES;
+		e.bytes = node->str.str;
+		e.len = node->str.len;
+		e.fold = match == string_fold_is_match;
+	} else {
+		const RegexNode *sub = node;
+
+		if (is_quant(match) && match != quant_is_match) {
+			sub = node->quant.subexp;
+			e.min = node->quant.min;
+			e.max = node->quant.max;
+		}
+
+		if (!dfa_set_of(sub, &e))
+			b->unsupported = true;
+
+		e.kind = DFA_SET;
+	}
+
+	if (b->unsupported)
+		return 0;
+
+	return dfa_add_elem(b, &e);
+}
+
+/* translate chain followed by element cont. returns its first element */
+static size_t dfa_chain(DfaBuilder *b, RegexNode *node, size_t cont)
+{
+	const size_t base = b->stack_len;
+
+	for (; node != NULL; node = node->generic.next) {
+		if (!dfa_reserve(b, (void **)&b->stack, &b->stack_cap,
+				 b->stack_len + 1, sizeof(RegexNode *))) {
+			b->unsupported = true;
+			return 0;
+		}
+
+		b->stack[b->stack_len++] = node;
+	}
+
+	// elements point forward, so the chain is translated from its end
+	while (b->stack_len > base && !b->unsupported)
+		cont = dfa_node(b, b->stack[--b->stack_len], cont);
+
+	b->stack_len = base;
+	return cont;
+}
+
+/* compute done flags and number the configurations of all elements */
+static bool dfa_index_elems(DfaBuilder *b)
+{
+	DfaElem *elems = b->elems;
+
+	// alternations refer to later elements, so repeat until stable
+	for (bool changed = true; changed;) {
+		changed = false;
+
+		for (size_t i = 0; i < b->elems_len; ++i) {
+			DfaElem *e = &elems[i];
+			bool done = false, done_at_end = false;
+
+			if (e->kind == DFA_ACCEPT) {
+				done = done_at_end = true;
+			} else if (e->kind == DFA_SET && e->min == 0) {
+				done = elems[e->next].done;
+				done_at_end = elems[e->next].done_at_end;
+			} else if (e->kind == DFA_END) {
+				done_at_end = elems[e->next].done_at_end;
+			} else if (e->kind == DFA_SPLIT) {
+				done = elems[e->left].done ||
+				       elems[e->right].done;
+				done_at_end = elems[e->left].done_at_end ||
+					      elems[e->right].done_at_end;
+			}
+
+			changed |= done != e->done ||
+				   done_at_end != e->done_at_end;
+			e->done = done;
+			e->done_at_end = done_at_end;
+		}
+	}
+
+	for (size_t i = 0; i < b->elems_len; ++i) {
+		DfaElem *e = &elems[i];
+		size_t n = 0;
+
+		if (e->kind == DFA_SET)
+			n = e->max == __SIZE_MAX__ ? e->min + 1 : e->max;
+		else if (e->kind == DFA_BYTES)
+			n = e->len;
+		else if (e->kind == DFA_END)
+			n = 1;
+
+		if (n > DFA_MAX_CONFIGS - b->configs_len)
+			return false;
+
+		e->base = b->configs_len;
+		b->configs_len += n;
+	}
+
+	b->config_elems = (size_t *)mem_alloc(
+		b->alloc, (b->configs_len + 1) * sizeof(size_t));
+
+	if (b->config_elems == NULL)
+		return false;
+
+	for (size_t i = 0; i < b->elems_len; ++i) {
+		const DfaElem *e = &elems[i];
+		const size_t end = i + 1 < b->elems_len ? elems[i + 1].base
+							 : b->configs_len;
+
+		for (size_t c = e->base; c < end; ++c)
+			b->config_elems[c] = i;
+	}
+
+	b->words = b->configs_len / 64 + 1;
+	return true;
+}
+
+/* index of the lowest set bit of x, which must not be zero */
+static inline size_t lowest_bit(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return (size_t)__builtin_ctzll(x);
+#else
+	size_t ret = 0;
+
+	while (!(x & 1)) {
+		x >>= 1;
+		ret++;
+	}
+
+	return ret;
+#endif
+}
+
+static inline void dfa_add_config(DfaBuilder *b, uint64_t *set, size_t c)
+{
+	set[c >> 6] |= (uint64_t)1 << (c & 63);
+}
+
+static inline bool dfa_set_contains(const DfaElem *e, unsigned event)
+{
+	if (event == DFA_OTHER)
+		return e->other;
+
+	return (e->ascii[event >> 6] >> (event & 63)) & 1;
+}
+
+/* add the configurations of entering element i to set */
+static void dfa_closure(DfaBuilder *b, size_t i, uint64_t *set)
+{
+	for (;;) {
+		const DfaElem *e = &b->elems[i];
+
+		if (e->done) {
+			b->accept = true;
+			return;
+		}
+
+		if (e->kind == DFA_SPLIT) {
+			dfa_closure(b, e->left, set);
+			i = e->right;
+		} else if (e->kind == DFA_SET && e->max == 0) {
+			i = e->next;
+		} else {
+			dfa_add_config(b, set, e->base);
+			return;
+		}
+	}
+}
+
+/* feed event to element i after count characters of it matched and add
+ * the resulting configurations to set */
+static void dfa_feed(DfaBuilder *b, size_t i, size_t count, unsigned event,
+		     uint64_t *set)
+{
+	for (;;) {
+		const DfaElem *e = &b->elems[i];
+
+		if (e->done) {
+			b->accept = true;
+			return;
+		}
+
+		switch (e->kind) {
+		case DFA_SPLIT:
+			dfa_feed(b, e->left, 0, event, set);
+			i = e->right;
+			continue;
+		case DFA_BYTES:
+			if ((e->fold ? ascii_lower((uint8_t)event) : event) !=
+			    (uint8_t)e->bytes[count])
+				return;
+
+			if (count + 1 == e->len)
+				dfa_closure(b, e->next, set);
+			else
+				dfa_add_config(b, set, e->base + count + 1);
+
+			return;
+		case DFA_SET:
+			if (e->max == 0) {
+				i = e->next;
+				continue;
+			}
+
+			if (dfa_set_contains(e, event)) {
+				count++;
+
+				if (count == e->max) {
+					dfa_closure(b, e->next, set);
+					return;
+				}
+
+				// unbounded loops only count to their minimum
+				if (e->max == __SIZE_MAX__ && count > e->min)
+					count = e->min;
+
+				dfa_add_config(b, set, e->base + count);
+
+				if (count >= e->min && b->elems[e->next].done)
+					b->accept = true;
+
+				return;
+			}
+
+			// loops are possessive, so they only end at
+			// characters they don't match
+			if (count < e->min)
+				return;
+
+			i = e->next;
+			count = 0;
+			continue;
+		default:
+			return;
+		}
+	}
+}
+
+/* step all configurations of in over event into out. matches may
+ * begin at the event if inject is set */
+static void dfa_event(DfaBuilder *b, const uint64_t *in, bool inject,
+		      unsigned event, uint64_t *out)
+{
+	memset(out, 0, b->words * sizeof(uint64_t));
+
+	if (inject)
+		dfa_feed(b, b->root, 0, event, out);
+
+	for (size_t w = 0; w < b->words; ++w) {
+		for (uint64_t bits = in[w]; bits != 0; bits &= bits - 1) {
+			const size_t c = w * 64 + lowest_bit(bits);
+			const size_t i = b->config_elems[c];
+
+			dfa_feed(b, i, c - b->elems[i].base, event, out);
+		}
+	}
+}
+
+/* feed byte c to the decoder in state *dec. stores the events it
+ * completes in events and returns their amount */
+static unsigned dfa_decode(uint8_t *dec, uint8_t c, unsigned *events)
+{
+	unsigned n = 0;
+
+	if (*dec != DEC_NONE) {
+		if (c >= dec_lowest[*dec] && c <= 0xbf) {
+			*dec = dec_follow[*dec];
+
+			if (*dec == DEC_NONE)
+				events[n++] = DFA_OTHER;
+
+			return n;
+		}
+
+		// each byte of a broken sequence is an invalid character
+		// of its own and c begins the next one
+		for (unsigned i = 0; i < dec_pending[*dec]; ++i)
+			events[n++] = DFA_OTHER;
+
+		*dec = DEC_NONE;
+	}
+
+	if (c < 128)
+		events[n++] = c;
+	else if (c >= 0xc2 && c <= 0xdf)
+		*dec = DEC_2_1;
+	else if (c == 0xe0)
+		*dec = DEC_3_1_E0;
+	else if (c >= 0xe1 && c <= 0xef)
+		*dec = DEC_3_1;
+	else if (c == 0xf0)
+		*dec = DEC_4_1_F0;
+	else if (c >= 0xf1 && c <= 0xf7)
+		*dec = DEC_4_1;
+	else
+		events[n++] = DFA_OTHER;
+
+	return n;
+}
+
+static uint64_t dfa_hash_state(const DfaBuilder *b, DfaStateInfo info,
+			       const uint64_t *set)
+{
+	uint64_t h = 14695981039346656037ULL;
+	h = (h ^ info.dec) * 1099511628211ULL;
+	h = (h ^ info.fresh) * 1099511628211ULL;
+
+	for (size_t w = 0; w < b->words; ++w)
+		h = (h ^ set[w]) * 1099511628211ULL;
+
+	return h ^ (h >> 29);
+}
+
+/* insert every state of b into a hash table of hash_cap slots */
+static bool dfa_rehash(DfaBuilder *b, size_t hash_cap)
+{
+	uint32_t *hash = (uint32_t *)mem_alloc(b->alloc,
+					       hash_cap * sizeof(uint32_t));
+
+	if (hash == NULL)
+		return false;
+
+	memset(hash, 0, hash_cap * sizeof(uint32_t));
+
+	// the dead and the accepting state are never looked up
+	for (size_t s = 2; s < b->states_len; ++s) {
+		size_t h = (size_t)dfa_hash_state(b, b->infos[s],
+						  b->sets + s * b->words);
+
+		while (hash[h & (hash_cap - 1)] != 0)
+			h++;
+
+		hash[h & (hash_cap - 1)] = (uint32_t)(s + 1);
+	}
+
+	mem_free(b->alloc, b->hash, b->hash_cap * sizeof(uint32_t));
+	b->hash = hash;
+	b->hash_cap = hash_cap;
+	return true;
+}
+
+static bool dfa_append_state(DfaBuilder *b, DfaStateInfo info,
+			     const uint64_t *set)
+{
+	const size_t s = b->states_len;
+
+	if (s >= b->max_states ||
+	    !dfa_reserve(b, (void **)&b->sets, &b->sets_cap,
+			 (s + 1) * b->words, sizeof(uint64_t)) ||
+	    !dfa_reserve(b, (void **)&b->infos, &b->infos_cap, s + 1,
+			 sizeof(DfaStateInfo)) ||
+	    !dfa_reserve(b, (void **)&b->trans, &b->trans_cap,
+			 (s + 1) * b->classes_len, sizeof(uint32_t)))
+		return false;
+
+	memcpy(b->sets + s * b->words, set, b->words * sizeof(uint64_t));
+	b->infos[s] = info;
+	b->states_len++;
+	return true;
+}
+
+/* get the number of the state made of info and set, adding it if it's
+ * new. returns UINT32_MAX if there are too many states */
+static uint32_t dfa_state(DfaBuilder *b, DfaStateInfo info,
+			  const uint64_t *set)
+{
+	if (b->states_len * 2 >= b->hash_cap &&
+	    !dfa_rehash(b, b->hash_cap > 0 ? b->hash_cap * 2 : 64))
+		return UINT32_MAX;
+
+	size_t h = (size_t)dfa_hash_state(b, info, set);
+
+	for (;; h++) {
+		const uint32_t slot = b->hash[h & (b->hash_cap - 1)];
+
+		if (slot == 0)
+			break;
+
+		const DfaStateInfo other = b->infos[slot - 1];
+
+		if (other.dec == info.dec && other.fresh == info.fresh &&
+		    memcmp(b->sets + (slot - 1) * b->words, set,
+			   b->words * sizeof(uint64_t)) == 0)
+			return slot - 1;
+	}
+
+	if (!dfa_append_state(b, info, set))
+		return UINT32_MAX;
+
+	b->hash[h & (b->hash_cap - 1)] = (uint32_t)b->states_len;
+	return (uint32_t)(b->states_len - 1);
+}
+
+/* get the state state s moves to on byte c */
+static uint32_t dfa_step(DfaBuilder *b, size_t s, uint8_t c)
+{
+	DfaStateInfo info = b->infos[s];
+	unsigned events[4];
+	const unsigned n = dfa_decode(&info.dec, c, events);
+
+	memcpy(b->cur, b->sets + s * b->words, b->words * sizeof(uint64_t));
+	b->accept = false;
+
+	for (unsigned i = 0; i < n; ++i) {
+		dfa_event(b, b->cur, !b->anchored || info.fresh, events[i],
+			  b->out);
+		info.fresh = false;
+
+		if (b->accept)
+			return 1;
+
+		uint64_t *tmp = b->cur;
+		b->cur = b->out;
+		b->out = tmp;
+	}
+
+	if (b->anchored && !info.fresh) {
+		bool empty = true;
+
+		for (size_t w = 0; w < b->words; ++w)
+			empty &= b->cur[w] == 0;
+
+		if (empty)
+			return 0;
+	}
+
+	return dfa_state(b, info, b->cur);
+}
+
+/* check whether a subject ending in state s matches */
+static bool dfa_accepts_at_end(DfaBuilder *b, size_t s)
+{
+	if (s < 2)
+		return s == 1;
+
+	DfaStateInfo info = b->infos[s];
+	memcpy(b->cur, b->sets + s * b->words, b->words * sizeof(uint64_t));
+	b->accept = false;
+
+	// the bytes of a truncated sequence are invalid characters
+	for (unsigned i = 0; i < dec_pending[info.dec]; ++i) {
+		dfa_event(b, b->cur, !b->anchored || info.fresh, DFA_OTHER,
+			  b->out);
+		info.fresh = false;
+
+		if (b->accept)
+			return true;
+
+		uint64_t *tmp = b->cur;
+		b->cur = b->out;
+		b->out = tmp;
+	}
+
+	// an empty match may begin at the end itself
+	if ((!b->anchored || info.fresh) && b->elems[b->root].done_at_end)
+		return true;
+
+	for (size_t w = 0; w < b->words; ++w) {
+		for (uint64_t bits = b->cur[w]; bits != 0; bits &= bits - 1) {
+			const size_t c = w * 64 + lowest_bit(bits);
+			const DfaElem *e = &b->elems[b->config_elems[c]];
+
+			if ((e->kind == DFA_SET && c - e->base >= e->min) ||
+			    e->kind == DFA_END) {
+				if (b->elems[e->next].done_at_end)
+					return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+/* take the byte classes of re, whose program the elements of b are
+ * made of, so no two bytes of a class lead to different states */
+static void dfa_index_bytes(DfaBuilder *b, const MRegexp *re)
+{
+	memcpy(b->classes, re->byte_classes, sizeof(b->classes));
+	b->classes_len = re->byte_classes_len;
+
+	for (unsigned c = 256; c-- > 0;)
+		b->class_bytes[b->classes[c]] = (uint8_t)c;
+}
+
+/* merge equivalent states of b with hopcroft's algorithm and store the
+ * result in dfa. eoi holds a bit per state of b */
+static bool dfa_minimize(DfaBuilder *b, const uint64_t *eoi, Dfa *dfa)
+{
+	const size_t n = b->states_len, k = b->classes_len;
+	const MRegexpAllocator *alloc = b->alloc;
+	bool ret = false;
+
+	// predecessors of state t on class c are
+	// preds[pred_starts[c * (n + 1) + t]...]
+	size_t *pred_starts = (size_t *)mem_alloc(
+		alloc, (k * (n + 1) + 1) * sizeof(size_t));
+	uint32_t *preds = (uint32_t *)mem_alloc(alloc,
+						n * k * sizeof(uint32_t));
+	// refinable partition: states of block x are
+	// elements[firsts[x]...ends[x]], the first marks[x] of them marked
+	uint32_t *elements = (uint32_t *)mem_alloc(alloc,
+						   n * sizeof(uint32_t));
+	uint32_t *locs = (uint32_t *)mem_alloc(alloc, n * sizeof(uint32_t));
+	uint32_t *blocks = (uint32_t *)mem_alloc(alloc, n * sizeof(uint32_t));
+	uint32_t *firsts = (uint32_t *)mem_alloc(alloc, n * sizeof(uint32_t));
+	uint32_t *ends = (uint32_t *)mem_alloc(alloc, n * sizeof(uint32_t));
+	uint32_t *marks = (uint32_t *)mem_alloc(alloc, n * sizeof(uint32_t));
+	uint32_t *pending = (uint32_t *)mem_alloc(alloc,
+						  n * sizeof(uint32_t));
+	uint32_t *touched = (uint32_t *)mem_alloc(alloc,
+						  n * sizeof(uint32_t));
+	uint32_t *splitter = (uint32_t *)mem_alloc(alloc,
+						   n * sizeof(uint32_t));
+	bool *queued = (bool *)mem_alloc(alloc, n * sizeof(bool));
+	uint32_t *ids = (uint32_t *)mem_alloc(alloc, n * sizeof(uint32_t));
+
+	if (pred_starts == NULL || preds == NULL || elements == NULL ||
+	    locs == NULL || blocks == NULL || firsts == NULL || ends == NULL ||
+	    marks == NULL || pending == NULL || touched == NULL ||
+	    splitter == NULL || queued == NULL || ids == NULL)
+		goto out;
+
+	memset(pred_starts, 0, (k * (n + 1) + 1) * sizeof(size_t));
+
+	for (size_t s = 0; s < n; ++s)
+		for (size_t c = 0; c < k; ++c)
+			pred_starts[c * (n + 1) + b->trans[s * k + c] + 1]++;
+
+	for (size_t i = 1; i <= k * (n + 1); ++i)
+		pred_starts[i] += pred_starts[i - 1];
+
+	for (size_t s = 0; s < n; ++s)
+		for (size_t c = 0; c < k; ++c)
+			preds[pred_starts[c * (n + 1) + b->trans[s * k + c]]++] =
+				(uint32_t)s;
+
+	// filling shifted the starts by one slot
+	for (size_t i = k * (n + 1); i > 0; --i)
+		pred_starts[i] = pred_starts[i - 1];
+
+	pred_starts[0] = 0;
+
+	// initial partition by acceptance at the end of the subject
+	size_t blocks_len = 0, pending_len = 0, pos = 0;
+
+	for (unsigned accepting = 0; accepting < 2; ++accepting) {
+		const size_t first = pos;
+
+		for (size_t s = 0; s < n; ++s) {
+			if (((eoi[s >> 6] >> (s & 63)) & 1) != accepting)
+				continue;
+
+			elements[pos] = (uint32_t)s;
+			locs[s] = (uint32_t)pos++;
+			blocks[s] = (uint32_t)blocks_len;
+		}
+
+		if (pos == first)
+			continue;
+
+		firsts[blocks_len] = (uint32_t)first;
+		ends[blocks_len] = (uint32_t)pos;
+		marks[blocks_len] = 0;
+		queued[blocks_len] = true;
+		pending[pending_len++] = (uint32_t)blocks_len++;
+	}
+
+	while (pending_len > 0) {
+		const uint32_t x = pending[--pending_len];
+		const size_t splitter_len = ends[x] - firsts[x];
+		queued[x] = false;
+		memcpy(splitter, elements + firsts[x],
+		       splitter_len * sizeof(uint32_t));
+
+		for (size_t c = 0; c < k; ++c) {
+			size_t touched_len = 0;
+
+			for (size_t i = 0; i < splitter_len; ++i) {
+				const size_t t = splitter[i];
+				const size_t *range = pred_starts + c * (n + 1) + t;
+
+				for (size_t j = range[0]; j < range[1]; ++j) {
+					const uint32_t s = preds[j];
+					const uint32_t y = blocks[s];
+					const uint32_t to = firsts[y] + marks[y];
+					const uint32_t other = elements[to];
+
+					if (locs[s] < to)
+						continue;
+
+					elements[locs[s]] = other;
+					locs[other] = locs[s];
+					elements[to] = s;
+					locs[s] = to;
+
+					if (marks[y]++ == 0)
+						touched[touched_len++] = y;
+				}
+			}
+
+			for (size_t i = 0; i < touched_len; ++i) {
+				const uint32_t y = touched[i];
+				const uint32_t marked = marks[y];
+				marks[y] = 0;
+
+				if (marked == ends[y] - firsts[y])
+					continue;
+
+				// the marked states become a block of their own
+				const uint32_t z = (uint32_t)blocks_len++;
+				firsts[z] = firsts[y];
+				ends[z] = firsts[y] + marked;
+				marks[z] = 0;
+				firsts[y] += marked;
+
+				for (uint32_t j = firsts[z]; j < ends[z]; ++j)
+					blocks[elements[j]] = z;
+
+				if (queued[y] ||
+				    ends[z] - firsts[z] < ends[y] - firsts[y]) {
+					queued[z] = true;
+					pending[pending_len++] = z;
+				} else {
+					queued[y] = true;
+					pending[pending_len++] = y;
+					queued[z] = false;
+				}
+			}
+		}
+	}
+
+	// number blocks in the order of their first state, which makes
+	// the dead state 0 and the accepting one 1
+	memset(ids, 0xff, n * sizeof(uint32_t));
+	size_t ids_len = 0;
+
+	for (size_t s = 0; s < n; ++s)
+		if (ids[blocks[s]] == UINT32_MAX)
+			ids[blocks[s]] = (uint32_t)ids_len++;
+
+	if (ids[blocks[0]] != 0 || ids[blocks[1]] != 1 ||
+	    ids_len * k > UINT32_MAX)
+		goto out;
+
+	const size_t table_size = (ids_len * k * sizeof(uint32_t) + 7) & ~(size_t)7;
+	const size_t eoi_size = (ids_len + 63) / 64 * sizeof(uint64_t);
+	dfa->mem_size = table_size + eoi_size + 63;
+	dfa->mem = mem_alloc(alloc, dfa->mem_size);
+
+	if (dfa->mem == NULL)
+		goto out;
+
+	// align the table to a cache line
+	uint32_t *table = (uint32_t *)(((uintptr_t)dfa->mem + 63) & ~(uintptr_t)63);
+	uint64_t *dfa_eoi = (uint64_t *)((char *)table + table_size);
+	memset(dfa_eoi, 0, eoi_size);
+
+	for (size_t s = 0; s < n; ++s) {
+		const size_t id = ids[blocks[s]];
+
+		for (size_t c = 0; c < k; ++c)
+			table[id * k + c] =
+				(uint32_t)(ids[blocks[b->trans[s * k + c]]] * k);
+
+		dfa_eoi[id >> 6] |= ((eoi[s >> 6] >> (s & 63)) & 1) << (id & 63);
+	}
+
+	memcpy(dfa->classes, b->classes, sizeof(dfa->classes));
+	dfa->classes_len = (uint32_t)k;
+	dfa->states_len = (uint32_t)ids_len;
+	dfa->start = (uint32_t)(ids[blocks[2]] * k);
+	dfa->table = table;
+	dfa->eoi = dfa_eoi;
+	ret = true;
+
+out:
+	mem_free(alloc, pred_starts, (k * (n + 1) + 1) * sizeof(size_t));
+	mem_free(alloc, preds, n * k * sizeof(uint32_t));
+	mem_free(alloc, elements, n * sizeof(uint32_t));
+	mem_free(alloc, locs, n * sizeof(uint32_t));
+	mem_free(alloc, blocks, n * sizeof(uint32_t));
+	mem_free(alloc, firsts, n * sizeof(uint32_t));
+	mem_free(alloc, ends, n * sizeof(uint32_t));
+	mem_free(alloc, marks, n * sizeof(uint32_t));
+	mem_free(alloc, pending, n * sizeof(uint32_t));
+	mem_free(alloc, touched, n * sizeof(uint32_t));
+	mem_free(alloc, splitter, n * sizeof(uint32_t));
+	mem_free(alloc, queued, n * sizeof(bool));
+	mem_free(alloc, ids, n * sizeof(uint32_t));
+	return ret;
+}
+
+/* run the subset construction over the elements of b and minimize the
+ * result into dfa */
+static bool dfa_construct(DfaBuilder *b, Dfa *dfa)
+{
+	const size_t set_size = b->words * sizeof(uint64_t);
+	b->cur = (uint64_t *)mem_alloc(b->alloc, set_size);
+	b->out = (uint64_t *)mem_alloc(b->alloc, set_size);
+
+	if (b->cur == NULL || b->out == NULL)
+		return false;
+
+	memset(b->cur, 0, set_size);
+	DfaStateInfo info = {DEC_NONE, false};
+
+	// the dead and the accepting state never change
+	for (unsigned s = 0; s < 2; ++s) {
+		if (!dfa_append_state(b, info, b->cur))
+			return false;
+
+		for (size_t c = 0; c < b->classes_len; ++c)
+			b->trans[s * b->classes_len + c] = s;
+	}
+
+	info.fresh = b->anchored;
+
+	if (dfa_state(b, info, b->cur) != 2)
+		return false;
+
+	for (size_t s = 2; s < b->states_len; ++s) {
+		for (size_t c = 0; c < b->classes_len; ++c) {
+			const uint32_t t = dfa_step(b, s, b->class_bytes[c]);
+
+			if (t == UINT32_MAX)
+				return false;
+
+			b->trans[s * b->classes_len + c] = t;
+		}
+	}
+
+	const size_t eoi_size = (b->states_len + 63) / 64 * sizeof(uint64_t);
+	uint64_t *eoi = (uint64_t *)mem_alloc(b->alloc, eoi_size);
+
+	if (eoi == NULL)
+		return false;
+
+	memset(eoi, 0, eoi_size);
+
+	for (size_t s = 0; s < b->states_len; ++s)
+		eoi[s >> 6] |= (uint64_t)dfa_accepts_at_end(b, s) << (s & 63);
+
+	const bool ret = dfa_minimize(b, eoi, dfa);
+	mem_free(b->alloc, eoi, eoi_size);
+
+	return ret;
+}
+
+static void dfa_builder_free(DfaBuilder *b)
+{
+	const MRegexpAllocator *alloc = b->alloc;
+	const size_t set_size = b->words * sizeof(uint64_t);
+
+	mem_free(alloc, b->elems, b->elems_cap * sizeof(DfaElem));
+	mem_free(alloc, b->stack, b->stack_cap * sizeof(RegexNode *));
+	mem_free(alloc, b->config_elems,
+		 (b->configs_len + 1) * sizeof(size_t));
+	mem_free(alloc, b->sets, b->sets_cap * sizeof(uint64_t));
+	mem_free(alloc, b->infos, b->infos_cap * sizeof(DfaStateInfo));
+	mem_free(alloc, b->trans, b->trans_cap * sizeof(uint32_t));
+	mem_free(alloc, b->hash, b->hash_cap * sizeof(uint32_t));
+	mem_free(alloc, b->cur, set_size);
+	mem_free(alloc, b->out, set_size);
+}
+
+static void free_dfa(const MRegexpAllocator *alloc, Dfa *dfa)
+{
+	if (dfa == NULL)
+		return;
+
+	mem_free(alloc, dfa->mem, dfa->mem_size);
+	mem_free(alloc, dfa, sizeof(Dfa));
+}
+
+/* build a dfa for the program of re if it is supported and small enough.
+ * a dfa only tells whether a subject contains a match, so alternations
+ * are supported at the end of the program only and loops over groups
+ * not at all. failing to build one isn't an error, matching then uses
+ * the program alone */
+static void build_dfa(MRegexp *re, size_t max_states)
+{
+	DfaBuilder b;
+	memset(&b, 0, sizeof(DfaBuilder));
+	b.alloc = &re->alloc;
+	b.max_states = max_states > 0 ? max_states : DFA_DEFAULT_MAX_STATES;
+
+	// state numbers times the amount of byte classes fit in 32 bits
+	if (b.max_states > UINT32_MAX / 256)
+		b.max_states = UINT32_MAX / 256;
+
+	RegexNode *program = re->program;
+	b.anchored = re->anchored;
+
+	if (b.anchored)
+		program = program->generic.next;
+
+	DfaElem accept;
+	memset(&accept, 0, sizeof(DfaElem));
+	accept.kind = DFA_ACCEPT;
+	dfa_add_elem(&b, &accept);
+	b.root = dfa_chain(&b, program, 0);
+
+	Dfa *dfa = NULL;
+
+	if (!b.unsupported && dfa_index_elems(&b)) {
+		dfa_index_bytes(&b, re);
+		dfa = (Dfa *)mem_alloc(&re->alloc, sizeof(Dfa));
+
+		if (dfa != NULL) {
+			memset(dfa, 0, sizeof(Dfa));
+
+			if (!dfa_construct(&b, dfa)) {
+				mem_free(&re->alloc, dfa, sizeof(Dfa));
+				dfa = NULL;
+			}
+		}
+	}
+
+	dfa_builder_free(&b);
+	re->dfa = dfa;
+}
+
+/* feed the first len bytes of s to the dfa in state and return the
+ * state reached. stops early in the dead or the accepting state. the
+ * bytes fed are added to *fed */
+static inline uint32_t dfa_run(const Dfa *dfa, uint32_t state,
+				const char *s, size_t len, size_t *fed)
+{
+	const uint8_t *p = (const uint8_t *)s;
+	const uint32_t *table = dfa->table;
+	// the dead and the accepting state are the only ones
+	// below two rows and never leave themselves
+	const uint32_t last = 2 * dfa->classes_len;
+	const uint8_t *classes = dfa->classes;
+	size_t i = 0;
+
+	// both never leave themselves, so they only have to
+	// be checked for every few bytes
+	for (; len - i >= 4; i += 4) {
+		state = table[state + classes[p[i]]];
+		state = table[state + classes[p[i + 1]]];
+		state = table[state + classes[p[i + 2]]];
+		state = table[state + classes[p[i + 3]]];
+
+		if (state < last) {
+			*fed += i + 4;
+			return state;
+		}
+	}
+
+	for (; i < len; ++i)
+		state = table[state + classes[p[i]]];
+
+	*fed += len;
+	return state;
+}
+
+/* check whether the dfa found a match once it reached state at the end
+ * of the subject */
+static inline bool dfa_accepts(const Dfa *dfa, uint32_t state)
+{
+	if (state < 2 * dfa->classes_len)
+		return state == dfa->classes_len;
+
+	const uint32_t id = state / dfa->classes_len;
+	return (dfa->eoi[id >> 6] >> (id & 63)) & 1;
+}
+
+/* check whether the first len bytes of s contain a match */
+static bool dfa_is_match(const Dfa *dfa, const char *s, size_t len,
+			 size_t *fed)
+{
+	return dfa_accepts(dfa, dfa_run(dfa, dfa->start, s, len, fed));
+}
+
+/* fnv-1a hash of the first len bytes of p */
+static uint64_t fnv1a(const void *p, size_t len)
+{
+	const uint8_t *bytes = (const uint8_t *)p;
+	uint64_t h = 14695981039346656037ULL;
+
+	for (size_t i = 0; i < len; ++i)
+		h = (h ^ bytes[i]) * 1099511628211ULL;
+
+	return h;
+}
+
+/* identifies the pattern a saved dfa belongs to */
+static uint64_t hash_pattern(const char *pattern)
+{
+	return fnv1a(pattern, strlen(pattern));
+}
+
+MRegexp *mregexp_compile(const char *re)
+{
+	return mregexp_compile_opts(re, NULL);
+}
+
+MRegexp *mregexp_compile_opts(const char *re, const MRegexpOptions *opts)
+{
+	clear_compile_exception();
+	if (re == NULL) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return NULL;
+	}
+
+	if (!utf8_valid(re)) {
+		CompileException.err = MREGEXP_INVALID_UTF8;
+		CompileException.s = NULL;
+		return NULL;
+	}
+
+	const MRegexpAllocator *alloc = &default_allocator;
+
+	if (opts != NULL && opts->allocator != NULL)
+		alloc = opts->allocator;
+
+	MRegexp *ret = (MRegexp *)mem_alloc(alloc, sizeof(MRegexp));
+
+	if (ret == NULL) {
+		CompileException.err = MREGEXP_FAILED_ALLOC;
+		CompileException.s = NULL;
+		return NULL;
+	}
+
+	memset(ret, 0, sizeof(MRegexp));
+	ret->alloc = *alloc;
+
+	if (setjmp(CompileException.buf)) {
+		// Error callback
+		mregexp_free(ret);
+
+		return NULL;
+	}
+
+	// both passes over re are linear, so is the amount of nodes and
+	// the time spent on them by the analyses and the optimizer
+	size_t groups = 0;
+	const size_t compile_len = calc_compiled_len(re, &groups) + 1;
+	RegexNode *nodes = (RegexNode *)mem_alloc(
+		alloc, compile_len * sizeof(RegexNode));
+
+	if (nodes == NULL)
+		throw_compile_exception(MREGEXP_FAILED_ALLOC, re);
+
+	memset(nodes, 0, compile_len * sizeof(RegexNode));
+	ret->nodes = nodes;
+	ret->nodes_len = compile_len;
+
+	ret->frames_len = groups + 1;
+	ret->frames = (ParseFrame *)mem_alloc(
+		alloc, ret->frames_len * sizeof(ParseFrame));
+
+	if (ret->frames == NULL)
+		throw_compile_exception(MREGEXP_FAILED_ALLOC, re);
+
+	ret->unicode = opts != NULL && opts->unicode;
+	ret->program = compile(ret, re);
+	mem_free(alloc, ret->frames, ret->frames_len * sizeof(ParseFrame));
+	ret->frames = NULL;
+
+	pack_ranges(ret);
+	alloc_captures(ret);
+
+	if (opts != NULL && opts->icase) {
+		ret->icase = true;
+		fold_case(ret);
+	}
+
+	index_classes(ret);
+	find_required_literal(ret);
+	find_start_positions(ret);
+	optimize(ret, strlen(re));
+
+	if (opts != NULL && opts->compact)
+		compact(ret);
+
+	index_tails(ret);
+	index_bytes(ret);
+
+	ret->pattern_hash = hash_pattern(re);
+
+	// the same pattern ignoring case or in unicode
+	// mode is a different language
+	if (ret->icase)
+		ret->pattern_hash = (ret->pattern_hash ^ 'i') * 1099511628211ULL;
+
+	if (ret->unicode)
+		ret->pattern_hash = (ret->pattern_hash ^ 'u') * 1099511628211ULL;
+
+	if (opts != NULL && opts->dfa)
+		build_dfa(ret, opts->dfa_max_states);
+
+	return ret;
+}
+
+MRegexpError mregexp_error(void)
+{
+	return CompileException.err;
+}
+
+/* check if any of the eight bytes at s may be c0 followed by c1 at offset
+ * second, after setting bits set0 and set1 in them */
+static inline bool fold_candidates(const char *s, size_t second, uint8_t c0,
+				   uint64_t set0, uint8_t c1, uint64_t set1)
+{
+	const uint64_t ones = 0x0101010101010101ULL;
+	uint64_t w0, w1;
+	memcpy(&w0, s, 8);
+	memcpy(&w1, s + second, 8);
+
+	const uint64_t x0 = (w0 | set0) ^ (ones * c0);
+	const uint64_t x1 = (w1 | set1) ^ (ones * c1);
+
+	// high bits are set for bytes which are zero in
+	// both, and maybe for some above them
+	return ((x0 - ones) & ~x0 & (x1 - ones) & ~x1 & (ones * 0x80)) != 0;
+}
+
+/* get offset of the first occurrence of literal, which is in lower case,
+ * at or after offset from ignoring case. returns __SIZE_MAX__ if there
+ * is none */
+static size_t find_literal_fold(const MatchContext *ctx, size_t from,
+				const char *literal, size_t literal_len)
+{
+	const char *s = ctx->subject;
+
+	if (literal_len > ctx->len)
+		return __SIZE_MAX__;
+
+	// candidates are positions of the first two bytes of literal,
+	// which are looked for eight at a time. setting bit 5 turns upper
+	// case letters into lower case ones and no other byte into a
+	// letter, so it is set in all bytes compared with letters
+	const size_t end = ctx->len - literal_len + 1;
+	const size_t second = literal_len > 1;
+	const uint8_t c0 = (uint8_t)literal[0], c1 = (uint8_t)literal[second];
+	const uint64_t ones = 0x0101010101010101ULL;
+	const uint64_t set0 = (uint8_t)(c0 - 'a') < 26 ? ones * 0x20 : 0;
+	const uint64_t set1 = (uint8_t)(c1 - 'a') < 26 ? ones * 0x20 : 0;
+
+	while (from < end) {
+		if (end - from >= 8 && !fold_candidates(s + from, second, c0,
+							 set0, c1, set1)) {
+			from += 8;
+			continue;
+		}
+
+		const size_t stop = end - from >= 8 ? from + 8 : end;
+
+		for (; from < stop; ++from)
+			if (fold_memeq(s + from, literal, literal_len))
+				return from;
+	}
+
+	return __SIZE_MAX__;
+}
+
+/* get offset of the first occurrence of the required literal of re at or
+ * after offset from. returns __SIZE_MAX__ if there is none */
+static size_t find_literal(const MRegexp *re, const MatchContext *ctx,
+			   size_t from)
+{
+	const char *s = ctx->subject;
+	const char *literal = re->literal;
+	const size_t literal_len = re->literal_len;
+
+	if (re->icase)
+		return find_literal_fold(ctx, from, literal, literal_len);
+
+	while (from < ctx->len && ctx->len - from >= literal_len) {
+		const char *hit = (const char *)memchr(
+			s + from, literal[0], ctx->len - from - literal_len + 1);
+
+		if (hit == NULL)
+			return __SIZE_MAX__;
+
+		if (memcmp(hit + 1, literal + 1, literal_len - 1) == 0)
+			return hit - s;
+
+		from = hit - s + 1;
+	}
+
+	return __SIZE_MAX__;
+}
+
+/* check with the dfa of re whether the subject of ctx contains a match */
+static bool dfa_check(const MRegexp *re, MatchContext *ctx)
+{
+	size_t from = 0;
+
+	if (re->literal_len > 0) {
+		// memchr rules out subjects without the literal faster
+		const size_t pos = find_literal(re, ctx, 0);
+
+		if (pos == __SIZE_MAX__)
+			return false;
+
+		// no match begins further in front of its first occurrence
+		if (!re->anchored && re->literal_dist < pos)
+			from = subject_boundary(ctx, 0, pos - re->literal_dist);
+	}
+
+	return dfa_is_match(re->dfa, ctx->subject + from, ctx->len - from,
+			    &ctx->stats.dfa_transitions);
+}
+
+/* get the first offset at or after pos which may begin a match */
+static inline size_t prefilter_next(const Prefilter *pf,
+				    const MatchContext *ctx, size_t pos)
+{
+	const uint8_t *s = (const uint8_t *)ctx->subject;
+
+	if (pos >= ctx->len)
+		return ctx->len;
+
+	if (pf->first_bytes_len == 1) {
+		const uint8_t *hit = (const uint8_t *)memchr(
+			s + pos, pf->first_byte, ctx->len - pos);
+		return hit != NULL ? (size_t)(hit - s) : ctx->len;
+	}
+
+	while (pos < ctx->len && !pf->first_bytes[s[pos]])
+		pos++;
+
+	return pos;
+}
+
+/* check if one of the prefixes of pf begins at pos */
+static inline bool prefilter_check(const Prefilter *pf,
+				   const MatchContext *ctx, size_t pos)
+{
+	if (pf->prefixes_len == 0)
+		return true;
+
+	const uint8_t c = (uint8_t)ctx->subject[pos];
+	const size_t left = ctx->len - pos;
+
+	for (size_t i = pf->first_bytes[c] - 1; i < pf->prefixes_len; ++i) {
+		const char *prefix = pf->prefix_data + pf->prefix_offsets[i];
+		const size_t len = pf->prefix_offsets[i + 1] - pf->prefix_offsets[i];
+
+		if ((uint8_t)prefix[0] != c)
+			break;
+
+		if (len <= left && memcmp(ctx->subject + pos, prefix, len) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+/* find the first match in the subject of ctx which begins at
+ * or after offset start */
+static bool search_from(MRegexp *re, MatchContext *ctx, size_t start,
+			MRegexpMatch *m)
+{
+	m->match_begin = __SIZE_MAX__;
+	m->match_end = __SIZE_MAX__;
+
+	size_t literal_pos = 0;
+	bool have_literal_pos = false;
+
+	if (re->anchored && (start > 0 || ctx->base > 0))
+		return false;
+
+	// the dfa rules out subjects without a match in a single pass
+	if (start == 0 && re->dfa != NULL &&
+	    !dfa_check(re, ctx))
+		return false;
+
+	// the end of the subject is a position as well, where only
+	// empty matches begin
+	for (size_t pos = start; pos <= ctx->len;) {
+		size_t next = 0;
+
+		if (re->literal_len > 0) {
+			// a match beginning at pos contains the literal
+			// somewhere at or after pos
+			if (!have_literal_pos || literal_pos < pos) {
+				literal_pos = find_literal(re, ctx, pos);
+				have_literal_pos = true;
+
+				if (literal_pos == __SIZE_MAX__)
+					return false;
+			}
+
+			if (re->literal_dist != __SIZE_MAX__ &&
+			    literal_pos - pos > re->literal_dist)
+				pos = subject_boundary(
+					ctx, pos,
+					literal_pos - re->literal_dist);
+		}
+
+		if (re->prefilter != NULL) {
+			// first bytes are never continuation bytes, so
+			// this stays on character boundaries
+			pos = prefilter_next(re->prefilter, ctx, pos);
+
+			if (pos >= ctx->len)
+				return false;
+
+			if (!prefilter_check(re->prefilter, ctx, pos)) {
+				ctx->stats.prefilter_rejects++;
+				subject_peek(ctx, pos, &pos);
+				continue;
+			}
+		}
+
+		if (re->literal_len > 0 || re->prefilter != NULL)
+			ctx->stats.prefilter_candidates++;
+
+		ctx->stats.positions++;
+		const size_t writes = ctx->cap_writes;
+		bool found = false;
+
+		if (re->head_loop) {
+			ctx->stats.node_visits++;
+
+			if (!re->program->generic.match(re->program, ctx, pos,
+							&next)) {
+				// a loop which can't repeat often enough at pos
+				// can't from any position up to where it stopped
+				ctx->stats.backtracks++;
+
+				if (next >= ctx->len)
+					return false;
+
+				subject_peek(ctx, next, &pos);
+				continue;
+			}
+
+			found = is_match(re->program->generic.next, ctx, next,
+					 &next);
+		} else {
+			found = is_match(re->program, ctx, pos, &next);
+		}
+
+		if (found) {
+			m->match_begin = pos;
+			m->match_end = next;
+			return true;
+		}
+
+		// groups of a failed attempt didn't take part in the match
+		if (ctx->cap_writes != writes)
+			clear_captures(ctx, 0, ctx->caps_len);
+
+		if (re->anchored || pos == ctx->len)
+			break;
+
+		subject_peek(ctx, pos, &pos);
+	}
+
+	return false;
+}
+
+static bool search(MRegexp *re, MatchContext *ctx, size_t start,
+		   MRegexpMatch *m)
+{
+	// groups which don't take part in the match report SIZE_MAX
+	clear_captures(ctx, 0, ctx->caps_len);
+
+	const bool ret = search_from(re, ctx, start, m);
+
+	ctx->stats.calls++;
+	ctx->stats.matches += ret;
+	ctx->stats.bytes_scanned += (ret ? m->match_end : ctx->len) - start;
+
+	return ret;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ATOMIC_ADD(p, v) __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+#define ATOMIC_LOAD(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#define ATOMIC_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#else
+#define ATOMIC_ADD(p, v) (*(p) += (v))
+#define ATOMIC_LOAD(p) (*(p))
+#define ATOMIC_STORE(p, v) (*(p) = (v))
+#endif
+
+/* add counters of a finished call to the statistics of re */
+static void publish_stats(MRegexp *re, const MatchContext *ctx)
+{
+	if (!re->stats_enabled)
+		return;
+
+	ATOMIC_ADD(&re->stats.calls, ctx->stats.calls);
+	ATOMIC_ADD(&re->stats.matches, ctx->stats.matches);
+	ATOMIC_ADD(&re->stats.bytes_scanned, ctx->stats.bytes_scanned);
+	ATOMIC_ADD(&re->stats.positions, ctx->stats.positions);
+	ATOMIC_ADD(&re->stats.node_visits, ctx->stats.node_visits);
+	ATOMIC_ADD(&re->stats.backtracks, ctx->stats.backtracks);
+	ATOMIC_ADD(&re->stats.prefilter_candidates,
+		   ctx->stats.prefilter_candidates);
+	ATOMIC_ADD(&re->stats.prefilter_rejects, ctx->stats.prefilter_rejects);
+	ATOMIC_ADD(&re->stats.dfa_transitions, ctx->stats.dfa_transitions);
+}
+
+void mregexp_enable_stats(MRegexp *re, bool enable)
+{
+	if (re == NULL) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return;
+	}
+
+	re->stats_enabled = enable;
+}
+
+void mregexp_stats(MRegexp *re, MRegexpStats *out)
+{
+	if (re == NULL || out == NULL) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return;
+	}
+
+	out->calls = ATOMIC_LOAD(&re->stats.calls);
+	out->matches = ATOMIC_LOAD(&re->stats.matches);
+	out->bytes_scanned = ATOMIC_LOAD(&re->stats.bytes_scanned);
+	out->positions = ATOMIC_LOAD(&re->stats.positions);
+	out->node_visits = ATOMIC_LOAD(&re->stats.node_visits);
+	out->backtracks = ATOMIC_LOAD(&re->stats.backtracks);
+	out->prefilter_candidates =
+		ATOMIC_LOAD(&re->stats.prefilter_candidates);
+	out->prefilter_rejects = ATOMIC_LOAD(&re->stats.prefilter_rejects);
+	out->dfa_transitions = ATOMIC_LOAD(&re->stats.dfa_transitions);
+}
+
+void mregexp_reset_stats(MRegexp *re)
+{
+	if (re == NULL) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return;
+	}
+
+	ATOMIC_STORE(&re->stats.calls, 0);
+	ATOMIC_STORE(&re->stats.matches, 0);
+	ATOMIC_STORE(&re->stats.bytes_scanned, 0);
+	ATOMIC_STORE(&re->stats.positions, 0);
+	ATOMIC_STORE(&re->stats.node_visits, 0);
+	ATOMIC_STORE(&re->stats.backtracks, 0);
+	ATOMIC_STORE(&re->stats.prefilter_candidates, 0);
+	ATOMIC_STORE(&re->stats.prefilter_rejects, 0);
+	ATOMIC_STORE(&re->stats.dfa_transitions, 0);
+}
+
+bool mregexp_match(MRegexp *re, const char *s, MRegexpMatch *m)
+{
+	clear_compile_exception();
+
+	if (re == NULL || s == NULL || m == NULL) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return false;
+	}
+
+	MatchContext ctx;
+	init_context(&ctx, re->caps, re->caps_len, s, strlen(s));
+	const bool ret = search(re, &ctx, 0, m);
+	publish_stats(re, &ctx);
+
+	return ret;
+}
+
+bool mregexp_is_match(MRegexp *re, const char *s, size_t len)
+{
+	clear_compile_exception();
+
+	if (re == NULL || (s == NULL && len > 0)) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return false;
+	}
+
+	MatchContext ctx;
+	init_context(&ctx, NULL, 0, s, len);
+	ctx.tails = re->tails;
+	ctx.nodes = re->nodes;
+
+	MRegexpMatch m;
+	bool ret = false;
+
+	if (re->dfa != NULL) {
+		ret = dfa_check(re, &ctx);
+		ctx.stats.calls++;
+		ctx.stats.matches += ret;
+		ctx.stats.bytes_scanned += len;
+	} else {
+		ret = search(re, &ctx, 0, &m);
+	}
+
+	publish_stats(re, &ctx);
+
+	return ret;
+}
+
+bool mregexp_match_n(MRegexp *re, const char *s, size_t len, MRegexpMatch *m)
+{
+	return mregexp_match_from(re, s, len, 0, m);
+}
+
+bool mregexp_match_from(MRegexp *re, const char *s, size_t len, size_t start,
+			MRegexpMatch *m)
+{
+	return mregexp_match_captures(re, s, len, start, m,
+				      re != NULL ? re->caps : NULL,
+				      re != NULL ? re->caps_len : 0);
+}
+
+bool mregexp_match_captures(MRegexp *re, const char *s, size_t len,
+			    size_t start, MRegexpMatch *m, MRegexpMatch *caps,
+			    size_t caps_len)
+{
+	clear_compile_exception();
+
+	if (re == NULL || (s == NULL && len > 0) || start > len || m == NULL ||
+	    (caps == NULL && caps_len > 0)) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return false;
+	}
+
+	MatchContext ctx;
+	init_context(&ctx, caps, caps_len, s, len);
+
+	// a character is at most 4 bytes wide, so the one containing start
+	// begins no further back than that
+	if (start < len)
+		start = subject_boundary(&ctx, start >= 3 ? start - 3 : 0,
+					 start);
+
+	const bool ret = search(re, &ctx, start, m);
+	publish_stats(re, &ctx);
+
+	return ret;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PREFETCH(p) __builtin_prefetch(p)
+#else
+#define PREFETCH(p) ((void)(p))
+#endif
+
+size_t mregexp_match_batch(MRegexp *re, const char *const *subjects,
+			   const size_t *lens, size_t n,
+			   MRegexpMatch *results)
+{
+	clear_compile_exception();
+
+	if (re == NULL || (n > 0 && (subjects == NULL || results == NULL))) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return 0;
+	}
+
+	size_t matched = 0;
+	MatchContext ctx;
+	init_context(&ctx, re->caps, re->caps_len, NULL, 0);
+
+	for (size_t i = 0; i < n; ++i) {
+		// subjects are short, so pulling in the start of the next one
+		// while matching this one hides most of its load latency
+		if (i + 1 < n && subjects[i + 1] != NULL)
+			PREFETCH(subjects[i + 1]);
+
+		ctx.subject = subjects[i];
+
+		if (ctx.subject == NULL) {
+			CompileException.err = MREGEXP_INVALID_PARAMS;
+			results[i].match_begin = __SIZE_MAX__;
+			results[i].match_end = __SIZE_MAX__;
+			continue;
+		}
+
+		ctx.len = lens != NULL ? lens[i] : strlen(ctx.subject);
+		matched += search(re, &ctx, 0, &results[i]);
+	}
+
+	publish_stats(re, &ctx);
+	return matched;
+}
+
+void mregexp_free(MRegexp *re)
+{
+	if (re == NULL) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return;
+	}
+
+	const MRegexpAllocator alloc = re->alloc;
+	mem_free(&alloc, re->nodes, re->nodes_len * sizeof(RegexNode));
+	mem_free(&alloc, re->literal, re->literal_len);
+	mem_free(&alloc, re->prefilter, re->prefilter_size);
+	mem_free(&alloc, re->strings, re->strings_len);
+	mem_free(&alloc, re->caps, re->caps_len * sizeof(MRegexpMatch));
+	mem_free(&alloc, re->ranges, re->ranges_len * sizeof(CharRange));
+	mem_free(&alloc, re->class_bits, re->classes_len * 2 * sizeof(uint64_t));
+	mem_free(&alloc, re->tails, re->tails_len * sizeof(uint64_t));
+	free_dfa(&alloc, re->dfa);
+	mem_free(&alloc, re->frames, re->frames_len * sizeof(ParseFrame));
+	mem_free(&alloc, re, sizeof(MRegexp));
+}
+
+/* identifies serialized dfas and their layout */
+#define DFA_MAGIC "MRDF"
+#define DFA_VERSION 2
+
+/* bytes of the fixed part of a serialized dfa */
+#define DFA_HEADER_SIZE (4 + 4 + 8 + 4 + 4 + 4 + 256)
+
+/* bytes of the fnv-1a checksum of all other bytes, which ends a
+ * serialized dfa. changing any single byte changes it */
+#define DFA_CHECKSUM_SIZE 8
+
+static void put_le(uint8_t *p, uint64_t v, unsigned bytes)
+{
+	for (unsigned i = 0; i < bytes; ++i)
+		p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint64_t get_le(const uint8_t *p, unsigned bytes)
+{
+	uint64_t ret = 0;
+
+	for (unsigned i = 0; i < bytes; ++i)
+		ret |= (uint64_t)p[i] << (8 * i);
+
+	return ret;
+}
+
+static size_t dfa_serialized_size(size_t states_len, size_t classes_len)
+{
+	return DFA_HEADER_SIZE + states_len * classes_len * 4 +
+	       (states_len + 63) / 64 * 8 + DFA_CHECKSUM_SIZE;
+}
+
+size_t mregexp_dfa_save(MRegexp *re, void *buf, size_t len)
+{
+	clear_compile_exception();
+
+	if (re == NULL || re->dfa == NULL || (buf == NULL && len > 0)) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return 0;
+	}
+
+	const Dfa *dfa = re->dfa;
+	const size_t cells = (size_t)dfa->states_len * dfa->classes_len;
+	const size_t size = dfa_serialized_size(dfa->states_len,
+						dfa->classes_len);
+
+	if (len < size)
+		return size;
+
+	uint8_t *p = (uint8_t *)buf;
+	memcpy(p, DFA_MAGIC, 4);
+	put_le(p + 4, DFA_VERSION, 4);
+	put_le(p + 8, re->pattern_hash, 8);
+	put_le(p + 16, dfa->classes_len, 4);
+	put_le(p + 20, dfa->states_len, 4);
+	put_le(p + 24, dfa->start, 4);
+	memcpy(p + 28, dfa->classes, 256);
+	p += DFA_HEADER_SIZE;
+
+	for (size_t i = 0; i < cells; ++i, p += 4)
+		put_le(p, dfa->table[i], 4);
+
+	for (size_t i = 0; i < (dfa->states_len + 63) / 64; ++i, p += 8)
+		put_le(p, dfa->eoi[i], 8);
+
+	put_le(p, fnv1a(buf, size - DFA_CHECKSUM_SIZE), DFA_CHECKSUM_SIZE);
+	return size;
+}
+
+bool mregexp_dfa_load(MRegexp *re, const void *buf, size_t len)
+{
+	clear_compile_exception();
+
+	const uint8_t *p = (const uint8_t *)buf;
+
+	if (re == NULL || buf == NULL || len < DFA_HEADER_SIZE ||
+	    memcmp(p, DFA_MAGIC, 4) != 0 ||
+	    get_le(p + 4, 4) != DFA_VERSION ||
+	    get_le(p + 8, 8) != re->pattern_hash) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return false;
+	}
+
+	const uint64_t classes_len = get_le(p + 16, 4);
+	const uint64_t states_len = get_le(p + 20, 4);
+	const uint64_t start = get_le(p + 24, 4);
+	const uint64_t cells = states_len * classes_len;
+
+	// states have to fit into the table and eoi into the buffer
+	if (classes_len == 0 || classes_len > 256 || states_len < 2 ||
+	    cells > UINT32_MAX || start >= cells || start % classes_len != 0 ||
+	    len != dfa_serialized_size(states_len, classes_len)) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return false;
+	}
+
+	// the bounds can't tell damaged classes, transitions or eoi bits
+	// from valid ones
+	if (get_le(p + len - DFA_CHECKSUM_SIZE, DFA_CHECKSUM_SIZE) !=
+	    fnv1a(p, len - DFA_CHECKSUM_SIZE)) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return false;
+	}
+
+	for (unsigned c = 0; c < 256; ++c) {
+		if (p[28 + c] >= classes_len) {
+			CompileException.err = MREGEXP_INVALID_PARAMS;
+			return false;
+		}
+	}
+
+	const uint8_t *cell = p + DFA_HEADER_SIZE;
+
+	for (uint64_t i = 0; i < cells; ++i) {
+		const uint64_t next = get_le(cell + 4 * i, 4);
+
+		// the dead and the accepting state never leave themselves
+		if (next >= cells || next % classes_len != 0 ||
+		    (i < 2 * classes_len && next != i / classes_len * classes_len)) {
+			CompileException.err = MREGEXP_INVALID_PARAMS;
+			return false;
+		}
+	}
+
+	// eoi has no bits beyond the last state
+	const size_t eoi_words = ((size_t)states_len + 63) / 64;
+	const unsigned used_bits = (unsigned)(states_len % 64);
+
+	if (used_bits != 0 &&
+	    get_le(cell + 4 * cells + 8 * (eoi_words - 1), 8) >> used_bits !=
+		    0) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return false;
+	}
+
+	Dfa *dfa = (Dfa *)mem_alloc(&re->alloc, sizeof(Dfa));
+
+	if (dfa == NULL) {
+		CompileException.err = MREGEXP_FAILED_ALLOC;
+		return false;
+	}
+
+	const size_t table_size = ((size_t)cells * 4 + 7) & ~(size_t)7;
+	memset(dfa, 0, sizeof(Dfa));
+	dfa->mem_size = table_size + eoi_words * 8 + 63;
+	dfa->mem = mem_alloc(&re->alloc, dfa->mem_size);
+
+	if (dfa->mem == NULL) {
+		mem_free(&re->alloc, dfa, sizeof(Dfa));
+		CompileException.err = MREGEXP_FAILED_ALLOC;
+		return false;
+	}
+
+	uint32_t *table = (uint32_t *)(((uintptr_t)dfa->mem + 63) &
+				       ~(uintptr_t)63);
+	uint64_t *eoi = (uint64_t *)((char *)table + table_size);
+
+	for (size_t i = 0; i < cells; ++i)
+		table[i] = (uint32_t)get_le(cell + 4 * i, 4);
+
+	for (size_t i = 0; i < eoi_words; ++i)
+		eoi[i] = get_le(cell + 4 * cells + 8 * i, 8);
+
+	memcpy(dfa->classes, p + 28, 256);
+	dfa->classes_len = (uint32_t)classes_len;
+	dfa->states_len = (uint32_t)states_len;
+	dfa->start = (uint32_t)start;
+	dfa->table = table;
+	dfa->eoi = eoi;
+
+	free_dfa(&re->alloc, re->dfa);
+	re->dfa = dfa;
+	return true;
+}
+
+MRegexpMatch *mregexp_all_matches(MRegexp *re, const char *s, size_t *sz)
+{
+	return mregexp_all_matches_alloc(re, s, sz, NULL);
+}
+
+MRegexpMatch *mregexp_all_matches_alloc(MRegexp *re, const char *s,
+					size_t *sz,
+					const MRegexpAllocator *alloc)
+{
+	if (alloc == NULL)
+		alloc = &default_allocator;
+
+	MRegexpMatch *matches = NULL;
+	size_t pos = 0, cap = 0;
+
+	clear_compile_exception();
+
+	if (re == NULL || s == NULL || sz == NULL) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return NULL;
+	}
+
+	*sz = 0;
+
+	MatchContext ctx;
+	init_context(&ctx, re->caps, re->caps_len, s, strlen(s));
+
+	while (pos <= ctx.len) {
+		MRegexpMatch tmp;
+		if (search(re, &ctx, pos, &tmp)) {
+			pos = tmp.match_end;
+
+			// never report the same empty match twice
+			if (tmp.match_end == tmp.match_begin)
+				pos = skip_empty_match(&ctx, pos);
+
+			if (*sz == cap) {
+				const size_t new_cap = cap ? cap * 2 : 4;
+				MRegexpMatch *tmp_matches =
+					(MRegexpMatch *)mem_realloc(
+						alloc, matches,
+						cap * sizeof(MRegexpMatch),
+						new_cap * sizeof(MRegexpMatch));
+
+				if (tmp_matches == NULL) {
+					mem_free(alloc, matches,
+						 cap * sizeof(MRegexpMatch));
+					CompileException.err =
+						MREGEXP_FAILED_ALLOC;
+					*sz = 0;
+					return NULL;
+				}
+
+				matches = tmp_matches;
+				cap = new_cap;
+			}
+
+			matches[(*sz)++] = tmp;
+		} else {
+			break;
+		}
+	}
+
+	publish_stats(re, &ctx);
+
+	// shrink to fit, so callers can release exactly *sz elements
+	if (matches != NULL && cap != *sz) {
+		MRegexpMatch *tmp_matches = (MRegexpMatch *)mem_realloc(
+			alloc, matches, cap * sizeof(MRegexpMatch),
+			*sz * sizeof(MRegexpMatch));
+
+		if (tmp_matches != NULL)
+			matches = tmp_matches;
+	}
+
+	return matches;
+}
+
+/* get the index of the first of n sorted matches beginning at or
+ * after pos */
+static size_t matches_lower_bound(const MRegexpMatch *matches, size_t n,
+				  size_t pos)
+{
+	size_t lo = 0;
+
+	while (lo < n) {
+		const size_t mid = lo + (n - lo) / 2;
+
+		if (matches[mid].match_begin < pos)
+			lo = mid + 1;
+		else
+			n = mid;
+	}
+
+	return lo;
+}
+
+/* get the set of ascii characters which no node of re consumes. an
+ * attempt to match never gets past one of them */
+static void stop_chars(const MRegexp *re, uint64_t stops[2])
+{
+	stops[0] = stops[1] = ~(uint64_t)0;
+
+	for (size_t i = 0; i < re->nodes_len; ++i) {
+		const RegexNode *node = &re->nodes[i];
+		const MatchFunc match = node->generic.match;
+
+		for (unsigned c = 0; c < 128; ++c) {
+			bool consumed = false;
+
+			if (match == char_is_match)
+				consumed = node->chr.chr == c;
+			else if (match == char_fold_is_match)
+				consumed = node->chr.chr == ascii_upper(c);
+			else if (match == class_is_match)
+				consumed = class_contains(&node->cls, c);
+			else if (match == any_is_match)
+				consumed = true;
+			else if (match == string_is_match)
+				consumed = memchr(node->str.str, (int)c,
+						  node->str.len) != NULL;
+			else if (match == string_fold_is_match)
+				consumed = memchr(node->str.str, ascii_lower(c),
+						  node->str.len) != NULL;
+
+			if (consumed)
+				stops[c >> 6] &= ~((uint64_t)1 << (c & 63));
+		}
+	}
+}
+
+/* append m to the array at *dst holding *len of *cap matches */
+static bool push_match(MRegexpMatch **dst, size_t *len, size_t *cap,
+		       const MRegexpMatch *m)
+{
+	if (*len == *cap) {
+		const size_t new_cap = *cap ? *cap * 2 : 4;
+		MRegexpMatch *tmp = (MRegexpMatch *)mem_realloc(
+			&default_allocator, *dst, *cap * sizeof(MRegexpMatch),
+			new_cap * sizeof(MRegexpMatch));
+
+		if (tmp == NULL)
+			return false;
+
+		*dst = tmp;
+		*cap = new_cap;
+	}
+
+	(*dst)[(*len)++] = *m;
+	return true;
+}
+
+MRegexpMatch *mregexp_update_matches(MRegexp *re, const char *s, size_t len,
+				     const MRegexpMatch *matches,
+				     size_t matches_len, size_t offset,
+				     size_t removed, size_t inserted,
+				     size_t *sz)
+{
+	clear_compile_exception();
+
+	if (re == NULL || (s == NULL && len > 0) ||
+	    (matches == NULL && matches_len > 0) || sz == NULL ||
+	    offset > len || inserted > len - offset) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return NULL;
+	}
+
+	*sz = 0;
+
+	// characters are peeked at up to width bytes behind the beginning of
+	// an attempt, so none depends on bytes 4 or more bytes further. no
+	// attempt gets past a character which isn't consumed by any node
+	// either. matches found by attempts in front of the edit stay
+	const size_t width = chain_max_width(re->program);
+	size_t limit = 0;
+	uint64_t stops[2];
+
+	if (offset >= 4 && width <= offset - 4)
+		limit = offset - width - 3;
+
+	stop_chars(re, stops);
+
+	for (size_t i = offset; i > limit; --i) {
+		const uint8_t c = (uint8_t)s[i - 1];
+
+		if (c < 128 && ((stops[c >> 6] >> (c & 63)) & 1)) {
+			limit = i;
+			break;
+		}
+	}
+
+	const size_t kept = matches_lower_bound(matches, matches_len, limit);
+
+	MatchContext ctx;
+	init_context(&ctx, re->caps, re->caps_len, s, len);
+
+	// matches found again are collected separately, so the result is
+	// allocated and filled once
+	MRegexpMatch *found = NULL;
+	size_t found_len = 0, cap = 0, pos = 0, tail = matches_len;
+
+	if (kept > 0) {
+		pos = matches[kept - 1].match_end;
+
+		if (matches[kept - 1].match_begin == pos)
+			pos = skip_empty_match(&ctx, pos);
+	}
+
+	while (pos <= len) {
+		// behind the edit, an attempt gives the same result as one
+		// at the same character of the old subject. so once the
+		// search reaches a position the old search tried as well,
+		// the old matches from there on follow. those are character
+		// boundaries outside of old matches. none is in front of a
+		// continuation byte and ^ only matches at 0
+		size_t sync = __SIZE_MAX__, i = matches_len;
+		size_t old = pos + removed - inserted;
+
+		if (pos >= offset + inserted && pos > 0 && old > 0) {
+			i = matches_lower_bound(matches, matches_len, old);
+
+			for (;;) {
+				const size_t cur = old + inserted - removed;
+
+				if (i > 0 && matches[i - 1].match_end > old)
+					old = matches[i - 1].match_end;
+				else if (cur < len && (s[cur] & 0xc0) == 0x80)
+					old++;
+				else
+					break;
+
+				i = matches_lower_bound(matches, matches_len,
+							old);
+			}
+
+			sync = old + inserted - removed;
+
+			if (sync == pos) {
+				tail = i;
+				break;
+			}
+		}
+
+		MRegexpMatch m;
+
+		if (!search(re, &ctx, pos, &m))
+			break;
+
+		// sync was tried by both searches if nothing matched in
+		// front of it
+		if (m.match_begin >= sync) {
+			tail = i;
+			break;
+		}
+
+		if (!push_match(&found, &found_len, &cap, &m))
+			goto failed_alloc;
+
+		pos = m.match_end;
+
+		// never report the same empty match twice
+		if (m.match_end == m.match_begin)
+			pos = skip_empty_match(&ctx, pos);
+	}
+
+	publish_stats(re, &ctx);
+
+	const size_t total = kept + found_len + (matches_len - tail);
+	MRegexpMatch *ret = NULL;
+
+	if (total > 0) {
+		ret = (MRegexpMatch *)mem_alloc(&default_allocator,
+						total * sizeof(MRegexpMatch));
+
+		if (ret == NULL)
+			goto failed_alloc;
+
+		if (kept > 0)
+			memcpy(ret, matches, kept * sizeof(MRegexpMatch));
+
+		if (found_len > 0)
+			memcpy(ret + kept, found,
+			       found_len * sizeof(MRegexpMatch));
+
+		*sz = total;
+
+		// the old matches behind the edit move with it
+		for (size_t i = tail, j = kept + found_len; i < matches_len;
+		     ++i, ++j) {
+			ret[j].match_begin =
+				matches[i].match_begin - removed + inserted;
+			ret[j].match_end = matches[i].match_end - removed + inserted;
+		}
+	}
+
+	mem_free(&default_allocator, found, cap * sizeof(MRegexpMatch));
+	return ret;
+
+failed_alloc:
+	mem_free(&default_allocator, found, cap * sizeof(MRegexpMatch));
+	CompileException.err = MREGEXP_FAILED_ALLOC;
+	return NULL;
+}
+
+/* search of a subject made of segments. attempts which only depend on
+ * bytes of one segment are made in place, the others on a window of
+ * bytes copied from around a segment boundary */
+typedef struct {
+	const MRegexpSegment *segs;
+	/* length of the whole subject */
+	size_t len;
+	/* segment containing the position searched from and its offset */
+	size_t seg, seg_begin;
+	/* attempts in the segment beginning before this offset depend on
+	 * its bytes only. __SIZE_MAX__ until known */
+	size_t seg_limit;
+	/* the dfa found the segment or the window may contain a match */
+	bool seg_checked, win_checked;
+	/* bytes an attempt depends on at most, __SIZE_MAX__ if unbounded */
+	size_t reach;
+	/* ascii characters no attempt gets past, see stop_chars */
+	uint64_t stops[2];
+	/* copy of the subject from win_begin on. attempts in front of
+	 * win_limit depend on its bytes only */
+	char *win;
+	size_t win_cap, win_len, win_begin, win_limit;
+	/* allocator of the expression, which holds the window */
+	const MRegexpAllocator *alloc;
+	MatchContext ctx;
+} SegmentSearch;
+
+static bool init_segment_search(SegmentSearch *ss, MRegexp *re,
+				const MRegexpSegment *segs, size_t n)
+{
+	memset(ss, 0, sizeof(SegmentSearch));
+
+	if (re == NULL || (segs == NULL && n > 0))
+		return false;
+
+	for (size_t i = 0; i < n; ++i) {
+		if (segs[i].base == NULL && segs[i].len > 0)
+			return false;
+
+		ss->len += segs[i].len;
+	}
+
+	ss->segs = segs;
+	ss->alloc = &re->alloc;
+	ss->seg_limit = __SIZE_MAX__;
+	ss->reach = saturating_add(chain_max_width(re->program), 4);
+	stop_chars(re, ss->stops);
+	init_context(&ss->ctx, re->caps, re->caps_len, NULL, 0);
+
+	return true;
+}
+
+/* get the offset of the len bytes at s in front of which attempts don't
+ * depend on bytes behind them. at_end tells if they end the subject */
+static size_t exact_limit(const SegmentSearch *ss, const char *s, size_t len,
+			  bool at_end)
+{
+	if (at_end)
+		return len;
+
+	// stop characters and the width of the pattern both bound
+	// the bytes an attempt reads, see mregexp_update_matches
+	const size_t limit = ss->reach <= len ? len - ss->reach + 1 : 0;
+
+	for (size_t i = len; i > limit; --i) {
+		const uint8_t c = (uint8_t)s[i - 1];
+
+		if (c < 128 && ((ss->stops[c >> 6] >> (c & 63)) & 1))
+			return i;
+	}
+
+	return limit;
+}
+
+/* copy the subject from pos, which lies in the current segment, up to
+ * where all attempts beginning in front of the next segment are decided
+ * into the window */
+static bool fill_window(SegmentSearch *ss, size_t pos)
+{
+	const size_t next = ss->seg_begin + ss->segs[ss->seg].len;
+	size_t end = saturating_add(next, ss->reach);
+	end = end < ss->len ? end : ss->len;
+
+	// no attempt gets past a stop character behind the boundary
+	for (size_t i = ss->seg + 1, begin = next; begin < end; ++i) {
+		const uint8_t *s = (const uint8_t *)ss->segs[i].base;
+		const size_t n = ss->segs[i].len < end - begin
+					 ? ss->segs[i].len
+					 : end - begin;
+
+		for (size_t j = 0; j < n; ++j) {
+			if (s[j] < 128 &&
+			    ((ss->stops[s[j] >> 6] >> (s[j] & 63)) & 1)) {
+				end = begin + j + 1;
+				break;
+			}
+		}
+
+		begin += ss->segs[i].len;
+	}
+
+	if (end - pos > ss->win_cap) {
+		char *win = (char *)mem_realloc(ss->alloc, ss->win,
+						ss->win_cap, end - pos);
+
+		if (win == NULL) {
+			CompileException.err = MREGEXP_FAILED_ALLOC;
+			return false;
+		}
+
+		ss->win = win;
+		ss->win_cap = end - pos;
+	}
+
+	ss->win_begin = pos;
+	ss->win_len = end - pos;
+
+	for (size_t i = ss->seg, begin = ss->seg_begin, copied = 0;
+	     copied < ss->win_len; begin += ss->segs[i++].len) {
+		const size_t from = pos + copied - begin;
+
+		if (from >= ss->segs[i].len)
+			continue;
+
+		size_t n = ss->segs[i].len - from;
+		n = n < ss->win_len - copied ? n : ss->win_len - copied;
+		memcpy(ss->win + copied, (const char *)ss->segs[i].base + from,
+		       n);
+		copied += n;
+	}
+
+	ss->win_limit = pos + exact_limit(ss, ss->win, ss->win_len,
+					  end == ss->len);
+	ss->win_checked = false;
+	return true;
+}
+
+/* move a match found in a part of the subject beginning at base and
+ * its captures to offsets into the whole subject */
+static void shift_match(MatchContext *ctx, MRegexpMatch *m, size_t base)
+{
+	m->match_begin += base;
+	m->match_end += base;
+
+	for (size_t i = 0; i < ctx->caps_len; ++i) {
+		if (ctx->caps[i].match_begin != __SIZE_MAX__) {
+			ctx->caps[i].match_begin += base;
+			ctx->caps[i].match_end += base;
+		}
+	}
+}
+
+/* find the first match of the subject of ss beginning at or after the
+ * character boundary pos and store the offset to continue searching
+ * from in resume */
+static bool search_segments(MRegexp *re, SegmentSearch *ss, size_t pos,
+			    MRegexpMatch *m, size_t *resume)
+{
+	MatchContext *ctx = &ss->ctx;
+
+	while (pos < ss->len) {
+		while (ss->seg_begin + ss->segs[ss->seg].len <= pos) {
+			ss->seg_begin += ss->segs[ss->seg++].len;
+			ss->seg_limit = __SIZE_MAX__;
+			ss->seg_checked = false;
+		}
+
+		const MRegexpSegment *seg = &ss->segs[ss->seg];
+
+		if (ss->seg_limit == __SIZE_MAX__)
+			ss->seg_limit =
+				ss->seg_begin +
+				exact_limit(ss, (const char *)seg->base,
+					    seg->len,
+					    ss->seg_begin + seg->len == ss->len);
+
+		size_t limit = 0;
+		bool *checked = NULL;
+
+		if (pos < ss->seg_limit) {
+			ctx->subject = (const char *)seg->base;
+			ctx->len = seg->len;
+			ctx->base = ss->seg_begin;
+			limit = ss->seg_limit;
+			checked = &ss->seg_checked;
+		} else {
+			if ((ss->win_len == 0 || pos < ss->win_begin ||
+			     pos >= ss->win_limit) &&
+			    !fill_window(ss, pos))
+				return false;
+
+			ctx->subject = ss->win;
+			ctx->len = ss->win_len;
+			ctx->base = ss->win_begin;
+			limit = ss->win_limit;
+			checked = &ss->win_checked;
+		}
+
+		const size_t base = ctx->base;
+
+		// search checks with the dfa when beginning at 0 only, as
+		// it would scan the rest for every match. here the rest of
+		// a segment or window is scanned once
+		if (re->dfa != NULL && !re->anchored && !*checked &&
+		    pos > base) {
+			MatchContext rest = *ctx;
+			rest.subject += pos - base;
+			rest.len -= pos - base;
+
+			const bool found = dfa_check(re, &rest);
+			ctx->stats.dfa_transitions =
+				rest.stats.dfa_transitions;
+
+			if (!found) {
+				pos = limit - base < ctx->len
+					      ? base + subject_boundary(
+							       ctx, pos - base,
+							       limit - base)
+					      : base + ctx->len;
+				continue;
+			}
+		}
+
+		*checked = true;
+
+		if (search(re, ctx, pos - base, m) &&
+		    m->match_begin + base < limit) {
+			*resume = m->match_end;
+
+			// never report the same empty match twice
+			if (m->match_end == m->match_begin)
+				subject_peek(ctx, *resume, resume);
+
+			*resume += base;
+			shift_match(ctx, m, base);
+			return true;
+		}
+
+		// all attempts in front of limit failed
+		pos = limit - base < ctx->len
+			      ? base + subject_boundary(ctx, pos - base,
+						       limit - base)
+			      : base + ctx->len;
+	}
+
+	// only empty matches begin at the end, which needs no bytes
+	if (pos == ss->len) {
+		ctx->subject = "";
+		ctx->len = 0;
+		ctx->base = ss->len;
+
+		if (search(re, ctx, 0, m)) {
+			*resume = ss->len + 1;
+			shift_match(ctx, m, ss->len);
+			return true;
+		}
+	}
+
+	m->match_begin = __SIZE_MAX__;
+	m->match_end = __SIZE_MAX__;
+	return false;
+}
+
+static void free_segment_search(SegmentSearch *ss)
+{
+	mem_free(ss->alloc, ss->win, ss->win_cap);
+}
+
+bool mregexp_match_segments(MRegexp *re, const MRegexpSegment *segs,
+			    size_t n, MRegexpMatch *m)
+{
+	clear_compile_exception();
+
+	SegmentSearch ss;
+
+	if (m == NULL || !init_segment_search(&ss, re, segs, n)) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return false;
+	}
+
+	size_t resume = 0;
+	const bool ret = search_segments(re, &ss, 0, m, &resume);
+	publish_stats(re, &ss.ctx);
+	free_segment_search(&ss);
+
+	return ret;
+}
+
+bool mregexp_is_match_segments(MRegexp *re, const MRegexpSegment *segs,
+			       size_t n)
+{
+	clear_compile_exception();
+
+	SegmentSearch ss;
+
+	if (!init_segment_search(&ss, re, segs, n)) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return false;
+	}
+
+	bool ret = false;
+
+	// the literal rules out segments faster than the dfa reads them
+	if (re->dfa != NULL && re->literal_len == 0) {
+		// the state of the dfa carries over from one segment
+		// to the next, so nothing has to be copied
+		uint32_t state = re->dfa->start;
+
+		// the dead and the accepting state never leave themselves
+		for (size_t i = 0; i < n && state >= 2 * re->dfa->classes_len;
+		     ++i)
+			state = dfa_run(re->dfa, state,
+					(const char *)segs[i].base, segs[i].len,
+					&ss.ctx.stats.dfa_transitions);
+
+		ret = dfa_accepts(re->dfa, state);
+		ss.ctx.stats.calls++;
+		ss.ctx.stats.matches += ret;
+		ss.ctx.stats.bytes_scanned += ss.len;
+	} else {
+		MRegexpMatch m;
+		size_t resume = 0;
+		ss.ctx.caps = NULL;
+		ss.ctx.caps_len = 0;
+		ss.ctx.tails = re->tails;
+		ss.ctx.nodes = re->nodes;
+		ret = search_segments(re, &ss, 0, &m, &resume);
+	}
+
+	publish_stats(re, &ss.ctx);
+	free_segment_search(&ss);
+
+	return ret;
+}
+
+MRegexpMatch *mregexp_all_matches_segments(MRegexp *re,
+					   const MRegexpSegment *segs,
+					   size_t n, size_t *sz)
+{
+	clear_compile_exception();
+
+	SegmentSearch ss;
+
+	if (sz == NULL || !init_segment_search(&ss, re, segs, n)) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return NULL;
+	}
+
+	MRegexpMatch *matches = NULL, m;
+	size_t cap = 0, pos = 0;
+	*sz = 0;
+
+	while (search_segments(re, &ss, pos, &m, &pos)) {
+		if (!push_match(&matches, sz, &cap, &m)) {
+			CompileException.err = MREGEXP_FAILED_ALLOC;
+			break;
+		}
+	}
+
+	publish_stats(re, &ss.ctx);
+	free_segment_search(&ss);
+
+	if (CompileException.err != MREGEXP_OK) {
+		mem_free(&default_allocator, matches,
+			 cap * sizeof(MRegexpMatch));
+		*sz = 0;
+		return NULL;
+	}
+
+	// shrink to fit, so callers can release exactly *sz elements
+	if (matches != NULL && cap != *sz) {
+		MRegexpMatch *tmp = (MRegexpMatch *)mem_realloc(
+			&default_allocator, matches,
+			cap * sizeof(MRegexpMatch), *sz * sizeof(MRegexpMatch));
+
+		if (tmp != NULL)
+			matches = tmp;
+	}
+
+	return matches;
+}
+
+size_t mregexp_split_cb(MRegexp *re, const char *s, size_t len,
+			size_t max_fields, MRegexpSplitFunc fn, void *user)
+{
+	clear_compile_exception();
+
+	if (re == NULL || (s == NULL && len > 0)) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return 0;
+	}
+
+	// all delimiters are searched for with one context, each search
+	// resuming where the last delimiter ended
+	MatchContext ctx;
+	init_context(&ctx, re->caps, re->caps_len, s, len);
+
+	size_t n = 0, field = 0, pos = 0;
+	MRegexpMatch m;
+
+	while ((max_fields == 0 || n + 1 < max_fields) && pos < len &&
+	       search(re, &ctx, pos, &m)) {
+		// empty delimiters don't split
+		if (m.match_end == m.match_begin) {
+			pos = skip_empty_match(&ctx, m.match_end);
+			continue;
+		}
+
+		n++;
+
+		if (fn != NULL && !fn(field, m.match_begin - field, user)) {
+			publish_stats(re, &ctx);
+			return n;
+		}
+
+		pos = field = m.match_end;
+	}
+
+	publish_stats(re, &ctx);
+
+	if (fn != NULL)
+		fn(field, len - field, user);
+
+	return n + 1;
+}
+
+static bool split_store(size_t offset, size_t len, void *user)
+{
+	MRegexpMatch **field = (MRegexpMatch **)user;
+
+	(*field)->match_begin = offset;
+	(*field)->match_end = offset + len;
+	(*field)++;
+
+	return true;
+}
+
+size_t mregexp_split(MRegexp *re, const char *s, size_t len,
+		     MRegexpMatch *fields, size_t max_fields)
+{
+	if (fields == NULL && max_fields > 0) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return 0;
+	}
+
+	MRegexpMatch *next = fields;
+	return mregexp_split_cb(re, s, len, max_fields,
+				max_fields > 0 ? split_store : NULL, &next);
+}
+
+/* destination of mregexp_replace. output beyond cap is counted only */
+typedef struct {
+	char *buf;
+	size_t cap;
+	size_t pos;
+} ReplaceWriter;
+
+static void replace_write(ReplaceWriter *w, const char *s, size_t len)
+{
+	// the last byte of buf is kept for the terminating NUL
+	if (w->pos + 1 < w->cap) {
+		const size_t left = w->cap - 1 - w->pos;
+		memcpy(w->buf + w->pos, s, len < left ? len : left);
+	}
+
+	w->pos += len;
+}
+
+/* parse a reference to a group like 1 or {1} at the beginning of s,
+ * following a $. returns its length or 0 if s doesn't begin with one */
+static size_t parse_reference(const char *s, size_t *group)
+{
+	const bool braced = *s == '{';
+	const char *p = s + braced;
+	size_t n = 0;
+
+	if (*p < '0' || *p > '9')
+		return 0;
+
+	for (; *p >= '0' && *p <= '9'; ++p)
+		n = saturating_add(n > __SIZE_MAX__ / 10 ? __SIZE_MAX__ : n * 10,
+				   (size_t)(*p - '0'));
+
+	if (braced && *p++ != '}')
+		return 0;
+
+	*group = n;
+	return (size_t)(p - s);
+}
+
+/* part of a parsed replacement: literal bytes followed by a reference
+ * to a group, which is __SIZE_MAX__ if there is none */
+typedef struct {
+	const char *str;
+	size_t len;
+	size_t group;
+} ReplacePart;
+
+static ReplacePart *add_part(ReplacePart *part, const char *str, size_t len,
+			     size_t group)
+{
+	part->str = str;
+	part->len = len;
+	part->group = group;
+	return part + 1;
+}
+
+/* split repl into parts. parts has room for one more of them than repl
+ * has $ characters. returns the amount of parts */
+static size_t parse_replacement(const char *repl, ReplacePart *parts)
+{
+	ReplacePart *end = parts;
+	const char *lit = repl;
+
+	for (const char *p = repl; (p = strchr(p, '$')) != NULL;) {
+		size_t group = 0;
+		const size_t ref = parse_reference(p + 1, &group);
+
+		if (ref > 0) {
+			end = add_part(end, lit, (size_t)(p - lit), group);
+			lit = p += 1 + ref;
+		} else if (p[1] == '$') {
+			// $$ is a single $
+			end = add_part(end, lit, (size_t)(p + 1 - lit),
+				       __SIZE_MAX__);
+			lit = p += 2;
+		} else {
+			// a $ without a reference is kept
+			p++;
+		}
+	}
+
+	end = add_part(end, lit, strlen(lit), __SIZE_MAX__);
+	return (size_t)(end - parts);
+}
+
+/* write the replacement of match m */
+static void replace_expand(ReplaceWriter *w, const MatchContext *ctx,
+			   const MRegexpMatch *m, const ReplacePart *parts,
+			   size_t parts_len)
+{
+	for (size_t i = 0; i < parts_len; ++i) {
+		const ReplacePart *part = &parts[i];
+		replace_write(w, part->str, part->len);
 
-	if (setjmp(CompileException.buf)) {
-		// Error callback
-		free(ret);
-		free(nodes);
+		if (part->group == __SIZE_MAX__)
+			continue;
 
-		return NULL;
+		const MRegexpMatch *cap =
+			part->group == 0 ? m : &ctx->caps[part->group - 1];
+
+		// groups which didn't take part in the match are left out
+		if (cap->match_begin != __SIZE_MAX__)
+			replace_write(w, ctx->subject + cap->match_begin,
+				      cap->match_end - cap->match_begin);
 	}
+}
 
-	const size_t compile_len = calc_compiled_len(re);
-	nodes = (RegexNode *)calloc(compile_len, sizeof(RegexNode));
-	compile(re, re + strlen(re), nodes);
-	ret->nodes = nodes;
+size_t mregexp_replace(MRegexp *re, const char *s, size_t len,
+		       const char *repl, char *out, size_t out_cap)
+{
+	clear_compile_exception();
 
-	return ret;
+	if (re == NULL || (s == NULL && len > 0) || repl == NULL ||
+	    (out == NULL && out_cap > 0)) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return 0;
+	}
+
+	// repl is parsed once, so each match only copies its parts
+	size_t parts_cap = 1;
+
+	for (const char *p = repl; (p = strchr(p, '$')) != NULL; ++p)
+		parts_cap++;
+
+	ReplacePart *parts = (ReplacePart *)mem_alloc(
+		&re->alloc, parts_cap * sizeof(ReplacePart));
+
+	if (parts == NULL) {
+		CompileException.err = MREGEXP_FAILED_ALLOC;
+		return 0;
+	}
+
+	const size_t parts_len = parse_replacement(repl, parts);
+
+	// check all references before writing anything
+	for (size_t i = 0; i < parts_len; ++i) {
+		if (parts[i].group != __SIZE_MAX__ &&
+		    parts[i].group > re->caps_len) {
+			mem_free(&re->alloc, parts,
+				 parts_cap * sizeof(ReplacePart));
+			CompileException.err = MREGEXP_INVALID_PARAMS;
+			return 0;
+		}
+	}
+
+	ReplaceWriter w = {out, out_cap, 0};
+	MatchContext ctx;
+	init_context(&ctx, re->caps, re->caps_len, s, len);
+
+	size_t pos = 0, copied = 0;
+	MRegexpMatch m;
+
+	while (pos <= len && search(re, &ctx, pos, &m)) {
+		replace_write(&w, s + copied, m.match_begin - copied);
+		replace_expand(&w, &ctx, &m, parts, parts_len);
+		pos = copied = m.match_end;
+
+		// never replace the same empty match twice
+		if (m.match_end == m.match_begin)
+			pos = skip_empty_match(&ctx, pos);
+	}
+
+	replace_write(&w, s + copied, len - copied);
+	publish_stats(re, &ctx);
+	mem_free(&re->alloc, parts, parts_cap * sizeof(ReplacePart));
+
+	if (out_cap > 0)
+		out[w.pos < out_cap ? w.pos : out_cap - 1] = 0;
+
+	return w.pos;
 }
 
-MRegexpError mregexp_error(void)
+/* destination of mregexp_explain. output beyond len is counted only */
+typedef struct {
+	char *buf;
+	size_t len;
+	size_t pos;
+} ExplainWriter;
+
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((format(printf, 2, 3)))
+#endif
+static void explain_printf(ExplainWriter *w, const char *fmt, ...)
 {
-	return CompileException.err;
+	va_list ap;
+	va_start(ap, fmt);
+
+	char *dst = w->pos < w->len ? w->buf + w->pos : NULL;
+	const size_t left = w->pos < w->len ? w->len - w->pos : 0;
+	const int written = vsnprintf(dst, left, fmt, ap);
+
+	va_end(ap);
+
+	if (written > 0)
+		w->pos += (size_t)written;
 }
 
-bool mregexp_match(MRegexp *re, const char *s, MRegexpMatch *m)
+static void explain_indent(ExplainWriter *w, unsigned depth)
 {
-	clear_compile_exception();
+	for (unsigned i = 0; i < depth; ++i)
+		explain_printf(w, "  ");
+}
 
-	if (re == NULL || s == NULL || m == NULL) {
-		CompileException.err = MREGEXP_INVALID_PARAMS;
-		return false;
+/* print a character the way it would be written in a pattern */
+static void explain_char(ExplainWriter *w, uint32_t chr)
+{
+	char buf[5] = {0};
+
+	switch (chr) {
+	case '\n':
+		explain_printf(w, "\\n");
+		break;
+	case '\t':
+		explain_printf(w, "\\t");
+		break;
+	case '\r':
+		explain_printf(w, "\\r");
+		break;
+	case '\\':
+	case '"':
+	case ']':
+	case '-':
+	case '^':
+		explain_printf(w, "\\%c", (char)chr);
+		break;
+	default:
+		if (chr < 32 || chr == 127)
+			explain_printf(w, "\\x%02x", (unsigned)chr);
+		else
+			explain_printf(w, "%.*s", (int)utf8_encode(chr, buf),
+				       buf);
+		break;
 	}
+}
 
-	m->match_begin = __SIZE_MAX__;
-	m->match_end = __SIZE_MAX__;
+static void explain_bytes(ExplainWriter *w, const char *s, size_t len)
+{
+	explain_printf(w, "\"");
 
-	for (const char *tmp_s = s; *tmp_s; tmp_s = utf8_next(tmp_s)) {
-		const char *next = NULL;
-		if (is_match(re->nodes, s, tmp_s, &next)) {
-			m->match_begin = tmp_s - s;
-			m->match_end = next - s;
-			return true;
+	for (size_t i = 0; i < len;) {
+		const uint8_t c = (uint8_t)s[i];
+		const unsigned width = c < 128 ? 1 : utf8_char_width(c);
+
+		if (c < 128) {
+			explain_char(w, c);
+		} else if (width == 0 || width > len - i) {
+			explain_printf(w, "\\x%02x", c);
+		} else {
+			explain_printf(w, "%.*s", (int)width, s + i);
+			i += width;
+			continue;
 		}
+
+		i++;
 	}
 
-	return false;
+	explain_printf(w, "\"");
 }
 
-void mregexp_free(MRegexp *re)
+static void explain_property(ExplainWriter *w, const CharRange *range)
 {
-	if (re == NULL) {
-		CompileException.err = MREGEXP_INVALID_PARAMS;
+	if (range->property != PROPERTY_CATEGORIES) {
+		explain_printf(w, "\\%c{%s}",
+			       range->property == PROPERTY_SCRIPT ? 'p' : 'P',
+			       script_names[range->first]);
 		return;
 	}
-	free(re->nodes);
-	free(re);
+
+	// categories sharing their first letter are printed
+	// as that letter if all of them are members
+	for (unsigned i = 0; i < CATEGORIES_LEN;) {
+		unsigned end = i;
+
+		while (end < CATEGORIES_LEN &&
+		       category_names[end][0] == category_names[i][0])
+			end++;
+
+		const uint32_t group = CATEGORY(end) - CATEGORY(i);
+
+		if ((range->first & group) == group) {
+			explain_printf(w, "\\p{%c}", category_names[i][0]);
+		} else {
+			for (unsigned j = i; j < end; ++j)
+				if ((range->first >> j) & 1)
+					explain_printf(w, "\\p{%s}",
+						       category_names[j]);
+		}
+
+		i = end;
+	}
 }
 
-MRegexpMatch *mregexp_all_matches(MRegexp *re, const char *s, size_t *sz)
+static void explain_class(ExplainWriter *w, const ClassNode *cls)
 {
-	MRegexpMatch *matches = NULL;
-	size_t offset = 0;
-	*sz = 0;
+	explain_printf(w, "[%s", cls->negate ? "^" : "");
 
-	const char *end = s + strlen(s);
-	while (s < end) {
-		MRegexpMatch tmp;
-		if (mregexp_match(re, s, &tmp)) {
-			size_t end = tmp.match_end;
-			s = s + end;
+	for (uint32_t i = 0; i < cls->ranges_len; ++i) {
+		const CharRange *range = &cls->ranges[i];
 
-			matches = (MRegexpMatch *)realloc(
-				matches, (++(*sz)) * sizeof(MRegexpMatch));
+		if (range->property != PROPERTY_NONE) {
+			explain_property(w, range);
+			continue;
+		}
 
-			if (matches == NULL)
-				return NULL;
+		explain_char(w, range->first);
 
-			tmp.match_begin += offset;
-			tmp.match_end += offset;
+		if (range->last != range->first) {
+			explain_printf(w, "-");
+			explain_char(w, range->last);
+		}
+	}
 
-			offset += end;
-			matches[(*sz) - 1] = tmp;
-		} else {
-			break;
+	explain_printf(w, "]");
+}
+
+static void explain_chain(ExplainWriter *w, RegexNode *node, unsigned depth);
+
+static void explain_node(ExplainWriter *w, RegexNode *node, unsigned depth)
+{
+	const MatchFunc match = node->generic.match;
+	explain_indent(w, depth);
+
+	if (match == char_is_match || match == char_fold_is_match) {
+		explain_printf(w, "char '");
+		explain_char(w, node->chr.chr);
+		explain_printf(w, "'%s\n",
+			       match == char_fold_is_match ? " ignoring case"
+							   : "");
+	} else if (match == string_is_match || match == string_fold_is_match) {
+		explain_printf(w, "string ");
+		explain_bytes(w, node->str.str, node->str.len);
+		explain_printf(w, "%s\n",
+			       match == string_fold_is_match ? " ignoring case"
+							     : "");
+	} else if (match == class_is_match) {
+		explain_printf(w, "class ");
+		explain_class(w, &node->cls);
+		explain_printf(w, "%s\n", node->cls.fold ? " ignoring case" : "");
+	} else if (match == any_is_match) {
+		explain_printf(w, "any\n");
+	} else if (match == start_is_match) {
+		explain_printf(w, "empty\n");
+	} else if (match == anchor_begin_is_match) {
+		explain_printf(w, "assert begin\n");
+	} else if (match == anchor_end_is_match) {
+		explain_printf(w, "assert end\n");
+	} else if (match == quant_is_match || match == quant_char_is_match ||
+		   match == quant_class_is_match ||
+		   match == quant_any_is_match) {
+		const char *kind = match == quant_char_is_match	 ? " char loop"
+				   : match == quant_class_is_match ? " class loop"
+				   : match == quant_any_is_match   ? " any loop"
+								   : "";
+
+		explain_printf(w, "repeat{%zu,", node->quant.min);
+
+		if (node->quant.max == __SIZE_MAX__)
+			explain_printf(w, "inf}");
+		else
+			explain_printf(w, "%zu}", node->quant.max);
+
+		explain_printf(w, "%s\n", kind);
+		explain_chain(w, node->quant.subexp, depth + 1);
+	} else if (match == cap_is_match) {
+		explain_printf(w, "capture\n");
+		explain_chain(w, node->cap.subexp, depth + 1);
+	} else if (match == or_is_match) {
+		explain_printf(w, "alternative\n");
+
+		for (; node != NULL; node = or_rest(node)) {
+			explain_chain(w, node->orn.left, depth + 1);
+			explain_indent(w, depth);
+			explain_printf(w, "or\n");
+
+			if (or_rest(node) == NULL)
+				explain_chain(w, node->orn.right, depth + 1);
 		}
+	} else {
+		explain_printf(w, "unknown\n");
+	}
+}
+
+static void explain_chain(ExplainWriter *w, RegexNode *node, unsigned depth)
+{
+	if (node == NULL) {
+		explain_indent(w, depth);
+		explain_printf(w, "nothing\n");
 	}
 
-	return matches;
+	for (; node != NULL; node = node->generic.next)
+		explain_node(w, node, depth);
+}
+
+/* bytes of memory owned by re */
+static void memory_usage(const MRegexp *re, MRegexpMemory *usage)
+{
+	usage->header = sizeof(MRegexp);
+	usage->nodes = re->nodes_len * sizeof(RegexNode);
+	usage->classes = re->ranges_len * sizeof(CharRange) +
+			 re->classes_len * 2 * sizeof(uint64_t);
+	usage->strings = re->strings_len;
+	usage->prefilters = re->literal_len + re->prefilter_size;
+	usage->captures = re->caps_len * sizeof(MRegexpMatch);
+	usage->tails = re->tails_len * sizeof(uint64_t);
+	usage->dfa = re->dfa != NULL ? sizeof(Dfa) + re->dfa->mem_size : 0;
+	usage->total = usage->header + usage->nodes + usage->classes +
+		       usage->strings + usage->prefilters + usage->captures +
+		       usage->tails + usage->dfa;
+}
+
+size_t mregexp_memory_usage(MRegexp *re, MRegexpMemory *usage)
+{
+	if (re == NULL) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return 0;
+	}
+
+	MRegexpMemory tmp;
+	memory_usage(re, &tmp);
+
+	if (usage != NULL)
+		*usage = tmp;
+
+	return tmp.total;
 }
 
-/* calculate amount of capture groups
- * inside a regular expression */
-static size_t cap_node_count(RegexNode *nodes)
+size_t mregexp_explain(MRegexp *re, char *buf, size_t len)
 {
-	if (nodes == NULL) {
+	if (re == NULL || (buf == NULL && len > 0)) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
 		return 0;
-	} else if (nodes->generic.match == quant_is_match) {
-		return cap_node_count(nodes->quant.subexp) +
-		       cap_node_count(nodes->generic.next);
-	} else if (nodes->generic.match == cap_is_match) {
-		return cap_node_count(nodes->quant.subexp) +
-		       cap_node_count(nodes->generic.next) + 1;
+	}
+
+	ExplainWriter w = {buf, len, 0};
+
+	explain_printf(&w, "program:\n");
+	explain_chain(&w, re->program, 1);
+
+	explain_printf(&w, "anchored: %s\n", re->anchored ? "yes" : "no");
+
+	if (re->literal_len > 0) {
+		explain_printf(&w, "required literal: ");
+		explain_bytes(&w, re->literal, re->literal_len);
+
+		if (re->icase)
+			explain_printf(&w, " ignoring case");
+
+		if (re->literal_dist == __SIZE_MAX__)
+			explain_printf(&w, " at unbounded offset\n");
+		else
+			explain_printf(&w, " at offset <= %zu\n",
+				       re->literal_dist);
+	} else {
+		explain_printf(&w, "required literal: none\n");
+	}
+
+	const Prefilter *pf = re->prefilter;
+
+	if (pf != NULL) {
+		explain_printf(&w, "first bytes: %zu of 256\n",
+			       pf->first_bytes_len);
+
+		if (pf->prefixes_len > 0) {
+			explain_printf(&w, "prefixes: %zu\n", pf->prefixes_len);
+
+			for (size_t i = 0; i < pf->prefixes_len; ++i) {
+				explain_indent(&w, 1);
+				explain_bytes(&w,
+					      pf->prefix_data +
+						      pf->prefix_offsets[i],
+					      pf->prefix_offsets[i + 1] -
+						      pf->prefix_offsets[i]);
+				explain_printf(&w, "\n");
+			}
+		}
 	} else {
-		return cap_node_count(nodes->generic.next);
+		explain_printf(&w, "first bytes: any\n");
 	}
+
+	explain_printf(&w, "byte classes: %zu\n", re->byte_classes_len);
+
+	if (re->dfa != NULL)
+		explain_printf(&w,
+			       "engine: dfa with %u states and %u byte "
+			       "classes, backtracking for positions\n",
+			       (unsigned)re->dfa->states_len,
+			       (unsigned)re->dfa->classes_len);
+	else
+		explain_printf(&w, "engine: backtracking\n");
+
+	MRegexpMemory usage;
+	memory_usage(re, &usage);
+	explain_printf(&w,
+		       "memory: %zu bytes (nodes %zu, classes %zu, strings "
+		       "%zu, prefilters %zu, captures %zu, tails %zu, dfa "
+		       "%zu)\n",
+		       usage.total, usage.nodes, usage.classes, usage.strings,
+		       usage.prefilters, usage.captures, usage.tails,
+		       usage.dfa);
+
+	return w.pos;
 }
 
 size_t mregexp_captures_len(MRegexp *re)
 {
-	return cap_node_count(re->nodes);
+	if (re == NULL) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return 0;
+	}
+
+	return re->caps_len;
 }
 
-static RegexNode *find_capture_node(RegexNode *node, size_t index)
+const MRegexpMatch *mregexp_capture(MRegexp *re, size_t index)
 {
-	if (node == NULL) {
+	if (re == NULL) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
 		return NULL;
-	} else if (node->generic.match == cap_is_match) {
-		if (index == 0) {
-			return node;
-		} else {
-			const size_t subexp_len =
-				cap_node_count(node->cap.subexp);
-			if (index <= subexp_len) {
-				return find_capture_node(node->cap.subexp,
-							 index - subexp_len);
-			} else {
-				return find_capture_node(node->generic.next,
-							 index - 1 -
-								 subexp_len);
-			}
+	}
+
+	if (index >= re->caps_len)
+		return NULL;
+
+	return &re->caps[index];
+}
+
+size_t mregexp_captures(MRegexp *re, MRegexpMatch *out, size_t n)
+{
+	if (re == NULL || (out == NULL && n > 0)) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return 0;
+	}
+
+	if (n > re->caps_len)
+		n = re->caps_len;
+
+	if (n > 0)
+		memcpy(out, re->caps, n * sizeof(MRegexpMatch));
+
+	return n;
+}
+
+struct MRegexpLexer {
+	MRegexpAllocator alloc;
+	MRegexp **rules;
+	size_t rules_len;
+	/* maximum length of a match of each rule, __SIZE_MAX__ if unbounded */
+	size_t *widths;
+	/* class of each byte. matches of the same rules may begin
+	 * with all bytes of a class */
+	uint8_t classes[256];
+	size_t classes_len;
+	/* rules whose matches may begin with a byte of class c are
+	 * candidates[offsets[c]] up to candidates[offsets[c + 1]], in the
+	 * order of the rules */
+	size_t *offsets;
+	size_t *candidates;
+	size_t candidates_len;
+};
+
+/* check if a match of re may begin with byte c */
+static inline bool may_begin_with(const MRegexp *re, uint8_t c)
+{
+	return re->prefilter == NULL || re->prefilter->first_bytes[c] != 0;
+}
+
+MRegexpLexer *mregexp_lexer_compile(const char *const *rules, size_t n,
+				    const MRegexpOptions *opts)
+{
+	clear_compile_exception();
+
+	if (rules == NULL || n == 0) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return NULL;
+	}
+
+	const MRegexpAllocator *alloc = &default_allocator;
+
+	if (opts != NULL && opts->allocator != NULL)
+		alloc = opts->allocator;
+
+	MRegexpLexer *lex =
+		(MRegexpLexer *)mem_alloc(alloc, sizeof(MRegexpLexer));
+
+	if (lex == NULL) {
+		CompileException.err = MREGEXP_FAILED_ALLOC;
+		return NULL;
+	}
+
+	memset(lex, 0, sizeof(MRegexpLexer));
+	lex->alloc = *alloc;
+	lex->rules = (MRegexp **)mem_alloc(alloc, n * sizeof(MRegexp *));
+	lex->widths = (size_t *)mem_alloc(alloc, n * sizeof(size_t));
+	lex->rules_len = n;
+
+	if (lex->rules == NULL || lex->widths == NULL) {
+		mregexp_lexer_free(lex);
+		CompileException.err = MREGEXP_FAILED_ALLOC;
+		return NULL;
+	}
+
+	memset(lex->rules, 0, n * sizeof(MRegexp *));
+
+	for (size_t i = 0; i < n; ++i) {
+		lex->rules[i] = mregexp_compile_opts(rules[i], opts);
+
+		if (lex->rules[i] == NULL) {
+			const MRegexpError err = CompileException.err;
+			mregexp_lexer_free(lex);
+			CompileException.err = err;
+			return NULL;
 		}
-	} else if (node->generic.match == quant_is_match) {
-		const size_t subexp_len = cap_node_count(node->quant.subexp);
-		if (index < subexp_len) {
-			return find_capture_node(node->quant.subexp, index);
-		} else {
-			return find_capture_node(node->generic.next, index);
+
+		lex->widths[i] = chain_max_width(lex->rules[i]->program);
+	}
+
+	// index the rules by the bytes their matches may begin with, so
+	// only a few of them have to be tried at every position. bytes
+	// beginning matches of the same rules share their list
+	lex->classes_len = 1;
+
+	for (size_t i = 0; i < n; ++i) {
+		const Prefilter *pf = lex->rules[i]->prefilter;
+		uint64_t members[4] = {0, 0, 0, 0};
+
+		if (pf == NULL)
+			continue;
+
+		for (unsigned c = 0; c < 256; ++c)
+			members[c >> 6] |= (uint64_t)(pf->first_bytes[c] != 0)
+					   << (c & 63);
+
+		refine_byte_classes(lex->classes, &lex->classes_len, members);
+	}
+
+	uint8_t class_bytes[256];
+
+	for (unsigned c = 256; c-- > 0;)
+		class_bytes[lex->classes[c]] = (uint8_t)c;
+
+	lex->offsets = (size_t *)mem_alloc(
+		alloc, (lex->classes_len + 1) * sizeof(size_t));
+
+	if (lex->offsets == NULL) {
+		mregexp_lexer_free(lex);
+		CompileException.err = MREGEXP_FAILED_ALLOC;
+		return NULL;
+	}
+
+	lex->offsets[0] = 0;
+
+	for (size_t c = 0; c < lex->classes_len; ++c) {
+		lex->offsets[c + 1] = lex->offsets[c];
+
+		for (size_t i = 0; i < n; ++i)
+			lex->offsets[c + 1] +=
+				may_begin_with(lex->rules[i], class_bytes[c]);
+	}
+
+	lex->candidates_len = lex->offsets[lex->classes_len];
+
+	if (lex->candidates_len == 0)
+		return lex;
+
+	lex->candidates = (size_t *)mem_alloc(
+		alloc, lex->candidates_len * sizeof(size_t));
+
+	if (lex->candidates == NULL) {
+		mregexp_lexer_free(lex);
+		CompileException.err = MREGEXP_FAILED_ALLOC;
+		return NULL;
+	}
+
+	size_t *cand = lex->candidates;
+
+	for (size_t c = 0; c < lex->classes_len; ++c)
+		for (size_t i = 0; i < n; ++i)
+			if (may_begin_with(lex->rules[i], class_bytes[c]))
+				*cand++ = i;
+
+	return lex;
+}
+
+bool mregexp_lexer_next(MRegexpLexer *lex, const char *s, size_t len,
+			size_t *pos, MRegexpToken *tok)
+{
+	clear_compile_exception();
+
+	if (lex == NULL || (s == NULL && len > 0) || pos == NULL ||
+	    *pos > len || tok == NULL) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return false;
+	}
+
+	if (*pos == len)
+		return false;
+
+	MatchContext ctx;
+	init_context(&ctx, NULL, 0, s, len);
+
+	const uint8_t c = lex->classes[(uint8_t)s[*pos]];
+	size_t best = 0;
+
+	for (size_t i = lex->offsets[c]; i < lex->offsets[c + 1]; ++i) {
+		const size_t rule = lex->candidates[i];
+		size_t end = 0;
+
+		// later rules only win with longer matches
+		if (lex->widths[rule] <= best)
+			continue;
+
+		if (is_match(lex->rules[rule]->program, &ctx, *pos, &end) &&
+		    end - *pos > best) {
+			best = end - *pos;
+			tok->rule = rule;
 		}
-	} else {
-		return find_capture_node(node->generic.next, index);
 	}
+
+	if (best == 0)
+		return false;
+
+	tok->len = best;
+	*pos += best;
+	return true;
 }
 
-const MRegexpMatch *mregexp_capture(MRegexp *re, size_t index)
+size_t mregexp_lexer_memory_usage(MRegexpLexer *lex)
 {
-	CapNode *cap = (CapNode *)find_capture_node(re->nodes, index);
+	if (lex == NULL) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return 0;
+	}
 
-	if (cap == NULL) {
-		return NULL;
+	size_t ret = sizeof(MRegexpLexer);
+	ret += lex->rules_len * (sizeof(MRegexp *) + sizeof(size_t));
+	ret += (lex->classes_len + 1) * sizeof(size_t);
+	ret += lex->candidates_len * sizeof(size_t);
+
+	for (size_t i = 0; i < lex->rules_len; ++i) {
+		MRegexpMemory usage;
+		memory_usage(lex->rules[i], &usage);
+		ret += usage.total;
+	}
+
+	return ret;
+}
+
+void mregexp_lexer_free(MRegexpLexer *lex)
+{
+	if (lex == NULL) {
+		CompileException.err = MREGEXP_INVALID_PARAMS;
+		return;
 	}
 
-	return &cap->cap;
+	const MRegexpAllocator alloc = lex->alloc;
+
+	for (size_t i = 0; lex->rules != NULL && i < lex->rules_len; ++i)
+		if (lex->rules[i] != NULL)
+			mregexp_free(lex->rules[i]);
+
+	mem_free(&alloc, lex->rules, lex->rules_len * sizeof(MRegexp *));
+	mem_free(&alloc, lex->widths, lex->rules_len * sizeof(size_t));
+	mem_free(&alloc, lex->offsets, (lex->classes_len + 1) * sizeof(size_t));
+
+	mem_free(&alloc, lex->candidates, lex->candidates_len * sizeof(size_t));
+	mem_free(&alloc, lex, sizeof(MRegexpLexer));
 }
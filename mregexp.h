@@ -32,11 +32,116 @@ extern "C" {
 
 typedef struct MRegexp MRegexp;
 
+/* memory allocator used for everything owned by the library. reallocate
+ * and deallocate are passed the size of the block they operate on, so
+ * simple allocators don't have to keep track of sizes themselves */
+typedef struct {
+	void *(*allocate)(size_t size, void *user);
+	void *(*reallocate)(void *ptr, size_t old_size, size_t new_size,
+			    void *user);
+	void (*deallocate)(void *ptr, size_t size, void *user);
+	void *user;
+} MRegexpAllocator;
+
+/* counters collected by matching calls, see mregexp_enable_stats */
+typedef struct {
+	/* searches for a single match */
+	size_t calls;
+	/* searches which found a match */
+	size_t matches;
+	/* subject bytes covered by searches */
+	size_t bytes_scanned;
+	/* start positions handed to the matcher */
+	size_t positions;
+	/* nodes evaluated by the matcher */
+	size_t node_visits;
+	/* nodes which failed to match, making the matcher fall
+	 * back to another alternative or give up on a position */
+	size_t backtracks;
+	/* positions accepted by literal and first byte prefilters */
+	size_t prefilter_candidates;
+	/* positions rejected by literals of alternations */
+	size_t prefilter_rejects;
+	/* subject bytes read by the dfa, one transition each. calls
+	 * answered by the dfa alone count no positions or node visits */
+	size_t dfa_transitions;
+} MRegexpStats;
+
+/* options for mregexp_compile_opts. zero initialize for the defaults */
+typedef struct {
+	/* allocator for the compiled expression. NULL uses malloc and free */
+	const MRegexpAllocator *allocator;
+	/* compare characters ignoring case, following the simple case
+	 * folding of unicode. classes match other cases of their members */
+	bool icase;
+	/* make \d, \s and \w cover all of unicode instead of ascii. \d
+	 * matches decimal numbers, \s white space and \w letters, marks,
+	 * decimal numbers, connector punctuation and join controls */
+	bool unicode;
+	/* build a dfa while compiling, which tells whether a subject contains
+	 * a match in a single pass over its bytes. used by mregexp_is_match
+	 * and to rule out subjects before searching them. patterns it doesn't
+	 * support and ones needing too many states are matched without one */
+	bool dfa;
+	/* maximum amount of dfa states. 0 for the default of 4096 */
+	size_t dfa_max_states;
+	/* store the compiled expression in as little memory as possible.
+	 * nodes left over by the optimizer are dropped, classes with the
+	 * same members share their ranges and bitmaps and merged strings
+	 * are stored without slack. compiling takes a little longer, matching
+	 * is unaffected */
+	bool compact;
+} MRegexpOptions;
+
+/* bytes of memory owned by a compiled expression by component, see
+ * mregexp_memory_usage */
+typedef struct {
+	/* the expression itself, which includes a table of 256 bytes */
+	size_t header;
+	/* nodes of the program */
+	size_t nodes;
+	/* ranges and ascii bitmaps of classes */
+	size_t classes;
+	/* runs of characters merged into strings */
+	size_t strings;
+	/* required literal and first bytes of matches */
+	size_t prefilters;
+	/* capture slots */
+	size_t captures;
+	/* loops ending matches, one bit per node */
+	size_t tails;
+	/* tables of the dfa, if there is one */
+	size_t dfa;
+	/* sum of all of the above */
+	size_t total;
+} MRegexpMemory;
+
+/* bump allocator which releases all of its allocations at once */
+typedef struct MRegexpArena MRegexpArena;
+
 typedef struct {
 	size_t match_begin;
 	size_t match_end;
 } MRegexpMatch;
 
+/* part of a subject made of several segments, laid out like struct iovec
+ * of posix so an array of those may be passed as well */
+typedef struct {
+	const void *base;
+	size_t len;
+} MRegexpSegment;
+
+/* set of rules matched at once, see mregexp_lexer_compile */
+typedef struct MRegexpLexer MRegexpLexer;
+
+/* token found by mregexp_lexer_next */
+typedef struct {
+	/* index of the rule which matched */
+	size_t rule;
+	/* length of the token in bytes */
+	size_t len;
+} MRegexpToken;
+
 typedef enum {
 	MREGEXP_OK = 0,
 	MREGEXP_FAILED_ALLOC,
@@ -47,34 +152,213 @@ typedef enum {
 	MREGEXP_UNEXPECTED_EOL,
 	MREGEXP_INVALID_COMPLEX_CLASS,
 	MREGEXP_UNCLOSED_SUBEXPRESSION,
+	MREGEXP_INVALID_PROPERTY,
+	MREGEXP_NESTING_TOO_DEEP,
 } MRegexpError;
 
 /* check if a given string is valid utf8 */
 bool mregexp_valid_utf8(const char *s);
 
-/* compile regular expression */
+/* compile regular expression. time and memory needed are linear in the
+ * length of re. only the nesting depth of groups and quantifiers adds to
+ * the call stack, while compiling as well as while matching, so it is
+ * limited to 1000 levels */
 MRegexp *mregexp_compile(const char *re);
 
-/* get error type if a function failed */
+/* compile regular expression with options. opts may be NULL */
+MRegexp *mregexp_compile_opts(const char *re, const MRegexpOptions *opts);
+
+/* get error type if a function failed. the error is kept per thread */
 MRegexpError mregexp_error(void);
 
-/* find the first matching substring in s */
+/* find the first matching substring in s. the end of s is tried as well,
+ * so empty matches like the one of ^$ in an empty string are found */
 bool mregexp_match(MRegexp *re, const char *s, MRegexpMatch *m);
 
+/* same as mregexp_match, but s is len bytes long and
+ * doesn't need to be NUL terminated */
+bool mregexp_match_n(MRegexp *re, const char *s, size_t len, MRegexpMatch *m);
+
+/* same as mregexp_match_from, but the captures of the match are stored
+ * in caps, which holds caps_len of them, instead of in re. caps may be
+ * NULL if caps_len is 0. groups which don't take part in the match get
+ * SIZE_MAX offsets. re isn't modified, so it may be shared by any number
+ * of threads matching at once */
+bool mregexp_match_captures(MRegexp *re, const char *s, size_t len,
+			    size_t start, MRegexpMatch *m, MRegexpMatch *caps,
+			    size_t caps_len);
+
+/* check if the first len bytes of s contain a match. stops as soon as
+ * a match is known to exist, without looking for its end. captures
+ * aren't recorded, so re may be used by multiple threads at once */
+bool mregexp_is_match(MRegexp *re, const char *s, size_t len);
+
+/* find the first match in the first len bytes of s which begins at or
+ * after offset start. a start inside of a character is moved to the next
+ * one. offsets in m are relative to s */
+bool mregexp_match_from(MRegexp *re, const char *s, size_t len, size_t start,
+			MRegexpMatch *m);
+
+/* match re against each of n subjects, storing the first match of
+ * subjects[i] in results[i]. lens may be NULL if all subjects are NUL
+ * terminated. subjects without a match get SIZE_MAX offsets. returns
+ * the amount of subjects which matched */
+size_t mregexp_match_batch(MRegexp *re, const char *const *subjects,
+			   const size_t *lens, size_t n,
+			   MRegexpMatch *results);
+
+/* same as mregexp_match_n, but the subject is the concatenation of n
+ * segments, which are matched in place. only bytes around segment
+ * boundaries which a match may cross are copied. offsets in m refer to
+ * the concatenated subject */
+bool mregexp_match_segments(MRegexp *re, const MRegexpSegment *segs,
+			    size_t n, MRegexpMatch *m);
+
+/* same as mregexp_is_match for a subject made of n segments. a dfa
+ * reads them without copying anything */
+bool mregexp_is_match_segments(MRegexp *re, const MRegexpSegment *segs,
+			       size_t n);
+
+/* same as mregexp_all_matches for a subject made of n segments */
+MRegexpMatch *mregexp_all_matches_segments(MRegexp *re,
+					   const MRegexpSegment *segs,
+					   size_t n, size_t *sz);
+
 /* get all non-overlapping matches in string s. returns NULL
  * if no matches are found. returned value must be freed */
 MRegexpMatch *mregexp_all_matches(MRegexp *re, const char *s, size_t *sz);
 
+/* same as mregexp_all_matches, but the returned array is allocated with
+ * alloc and must be released with alloc, passing *sz elements as size */
+MRegexpMatch *mregexp_all_matches_alloc(MRegexp *re, const char *s,
+					size_t *sz,
+					const MRegexpAllocator *alloc);
+
+/* update matches, the matches_len matches of re in a subject found by
+ * mregexp_all_matches, after removed bytes at offset were replaced with
+ * inserted ones. s holds the first len bytes of the edited subject. only
+ * the part around the edit is searched again, until the search continues
+ * like the old one did, so the work is proportional to the size of the
+ * edit for patterns matching a bounded amount of bytes. returns a new
+ * array of *sz matches like mregexp_all_matches, which must be freed */
+MRegexpMatch *mregexp_update_matches(MRegexp *re, const char *s, size_t len,
+				     const MRegexpMatch *matches,
+				     size_t matches_len, size_t offset,
+				     size_t removed, size_t inserted,
+				     size_t *sz);
+
+/* called by mregexp_split_cb with the byte offset and length of a field.
+ * returning false stops splitting */
+typedef bool (*MRegexpSplitFunc)(size_t offset, size_t len, void *user);
+
+/* split the first len bytes of s at matches of re and pass the fields
+ * between them to fn in order, which may be NULL to count them only.
+ * empty matches don't split. if max_fields isn't 0, at most max_fields
+ * fields are reported and the last one holds the rest of s. returns the
+ * amount of fields reported */
+size_t mregexp_split_cb(MRegexp *re, const char *s, size_t len,
+			size_t max_fields, MRegexpSplitFunc fn, void *user);
+
+/* same as mregexp_split_cb, but stores up to max_fields fields as slices
+ * of s in fields. with max_fields 0 nothing is stored and all fields are
+ * counted */
+size_t mregexp_split(MRegexp *re, const char *s, size_t len,
+		     MRegexpMatch *fields, size_t max_fields);
+
+/* replace all non-overlapping matches in the first len bytes of s with
+ * repl and write the result into out, which is always NUL terminated if
+ * out_cap is not zero. $n or ${n} in repl refers to capture group n,
+ * counting from 1, $0 to the whole match and $$ is a single $. groups
+ * which didn't take part in a match are left out. repl is parsed once
+ * per call. returns the length of the full result like snprintf, so a
+ * call with out_cap 0 gets the required size */
+size_t mregexp_replace(MRegexp *re, const char *s, size_t len,
+		       const char *repl, char *out, size_t out_cap);
+
 /* get amount of capture groups inside of
  * a regular expression */
 size_t mregexp_captures_len(MRegexp *re);
 
-/* get captured slice from capture group number index */
+/* get captured slice from capture group number index. groups which
+ * didn't take part in the last match have SIZE_MAX offsets */
 const MRegexpMatch *mregexp_capture(MRegexp *re, size_t index);
 
+/* copy the captured slices of the first n capture groups into out,
+ * indexed by group number. returns the amount of groups copied */
+size_t mregexp_captures(MRegexp *re, MRegexpMatch *out, size_t n);
+
+/* start or stop adding counters of matching calls on re to its
+ * statistics. disabled by default. counters are updated with relaxed
+ * atomics once per call, so re may be used from multiple threads */
+void mregexp_enable_stats(MRegexp *re, bool enable);
+
+/* copy statistics of re into out */
+void mregexp_stats(MRegexp *re, MRegexpStats *out);
+
+/* set all statistics of re to zero */
+void mregexp_reset_stats(MRegexp *re);
+
+/* get the bytes of memory owned by re and store them by component in
+ * usage, which may be NULL. returns the total */
+size_t mregexp_memory_usage(MRegexp *re, MRegexpMemory *usage);
+
+/* render the compiled program of re and the decisions made while
+ * compiling it as text into buf, which is always NUL terminated if len is
+ * not zero. returns the length of the full text like snprintf, so a
+ * call with len 0 gets the required size */
+size_t mregexp_explain(MRegexp *re, char *buf, size_t len);
+
+/* serialize the dfa of re into buf, which is left untouched if it holds
+ * fewer than len bytes. returns the size of the serialized dfa, so a call
+ * with len 0 gets the required size, or 0 if re has no dfa */
+size_t mregexp_dfa_save(MRegexp *re, void *buf, size_t len);
+
+/* replace the dfa of re with one saved by mregexp_dfa_save from an
+ * expression compiled from the same pattern. returns false if the data
+ * doesn't belong to the pattern of re or is damaged, which a checksum
+ * saved along with it tells */
+bool mregexp_dfa_load(MRegexp *re, const void *buf, size_t len);
+
 /* free regular expression */
 void mregexp_free(MRegexp *re);
 
+/* compile n regular expressions into a lexer, which finds the longest
+ * match of any of them. opts apply to all rules and may be NULL. returns
+ * NULL if a rule fails to compile */
+MRegexpLexer *mregexp_lexer_compile(const char *const *rules, size_t n,
+				    const MRegexpOptions *opts);
+
+/* find the longest non-empty match of any rule beginning exactly at
+ * offset *pos of the first len bytes of s. of equally long matches the
+ * one of the earliest rule wins. on success *pos is advanced past the
+ * token, so calling this again continues with the next one. returns
+ * false at the end of s or if no rule matches at *pos */
+bool mregexp_lexer_next(MRegexpLexer *lex, const char *s, size_t len,
+			size_t *pos, MRegexpToken *tok);
+
+/* get the bytes of memory owned by lex, including all of its rules */
+size_t mregexp_lexer_memory_usage(MRegexpLexer *lex);
+
+/* free lexer and all of its rules */
+void mregexp_lexer_free(MRegexpLexer *lex);
+
+/* create an arena which requests memory in blocks of at least block_size
+ * bytes from parent. parent may be NULL to use malloc and free */
+MRegexpArena *mregexp_arena_new(size_t block_size,
+				const MRegexpAllocator *parent);
+
+/* get an allocator which hands out memory from arena. regular expressions
+ * compiled with it may be freed with mregexp_free, which is a no-op for
+ * their memory. the allocator lives as long as the arena */
+const MRegexpAllocator *mregexp_arena_allocator(MRegexpArena *arena);
+
+/* release all allocations made from arena at once. everything compiled
+ * with the arena's allocator becomes invalid */
+void mregexp_arena_reset(MRegexpArena *arena);
+
+/* release arena and all of its allocations */
+void mregexp_arena_free(MRegexpArena *arena);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,949 @@
+/*
+ * Copyright (c) 2020 Fabian van Rissenbeck
+
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+/* header only C++17 interface of mregexp. link with mregexp.c */
+
+#ifndef _MREGEXP_HPP
+#define _MREGEXP_HPP 1
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "mregexp.h"
+
+namespace mregexp
+{
+
+/* thrown when a regular expression can't be compiled */
+class error : public std::runtime_error {
+    public:
+	explicit error(MRegexpError code)
+		: std::runtime_error(describe(code)), code_(code)
+	{
+	}
+
+	MRegexpError code() const noexcept
+	{
+		return code_;
+	}
+
+	static const char *describe(MRegexpError code) noexcept
+	{
+		switch (code) {
+		case MREGEXP_OK:
+			return "mregexp: no error";
+		case MREGEXP_FAILED_ALLOC:
+			return "mregexp: allocation failed";
+		case MREGEXP_INVALID_UTF8:
+			return "mregexp: invalid utf8";
+		case MREGEXP_INVALID_PARAMS:
+			return "mregexp: invalid parameters";
+		case MREGEXP_EARLY_QUANTIFIER:
+			return "mregexp: quantifier without preceding token";
+		case MREGEXP_INVALID_COMPLEX_QUANT:
+			return "mregexp: invalid {m,n} quantifier";
+		case MREGEXP_UNEXPECTED_EOL:
+			return "mregexp: unexpected end of expression";
+		case MREGEXP_INVALID_COMPLEX_CLASS:
+			return "mregexp: invalid character class";
+		case MREGEXP_UNCLOSED_SUBEXPRESSION:
+			return "mregexp: unclosed subexpression";
+		case MREGEXP_INVALID_PROPERTY:
+			return "mregexp: unknown unicode property";
+		case MREGEXP_NESTING_TOO_DEEP:
+			return "mregexp: groups or quantifiers nested too deeply";
+		}
+
+		return "mregexp: unknown error";
+	}
+
+    private:
+	MRegexpError code_;
+};
+
+/* a match inside of a subject. str views the subject, so it is only
+ * valid as long as the subject is */
+struct match {
+	std::size_t begin;
+	std::size_t end;
+	std::string_view str;
+};
+
+namespace detail
+{
+/* the C api needs NUL terminated patterns. the buffer is kept per
+ * thread, so compiling from string views doesn't allocate once it has
+ * grown to the longest pattern */
+inline const char *terminate(std::string_view s)
+{
+	thread_local std::string scratch;
+	scratch.assign(s.data(), s.size());
+	return scratch.c_str();
+}
+} // namespace detail
+
+class match_range;
+
+/* owning handle of a compiled regular expression. matching stores
+ * captures in the expression, so a regex shouldn't be used by multiple
+ * threads at once */
+class regex {
+    public:
+	/* compile pattern. throws mregexp::error if it is invalid */
+	explicit regex(std::string_view pattern,
+		       const MRegexpOptions *opts = nullptr)
+		: re_(mregexp_compile_opts(detail::terminate(pattern), opts))
+	{
+		if (re_ == nullptr)
+			throw error(mregexp_error());
+	}
+
+	/* take ownership of an already compiled expression */
+	explicit regex(MRegexp *re) noexcept : re_(re)
+	{
+	}
+
+	regex(const regex &) = delete;
+	regex &operator=(const regex &) = delete;
+
+	regex(regex &&other) noexcept : re_(std::exchange(other.re_, nullptr))
+	{
+	}
+
+	regex &operator=(regex &&other) noexcept
+	{
+		if (this != &other) {
+			if (re_ != nullptr)
+				mregexp_free(re_);
+			re_ = std::exchange(other.re_, nullptr);
+		}
+
+		return *this;
+	}
+
+	~regex()
+	{
+		// mregexp_free(NULL) would overwrite the error of the last call
+		if (re_ != nullptr)
+			mregexp_free(re_);
+	}
+
+	MRegexp *get() const noexcept
+	{
+		return re_;
+	}
+
+	/* give up ownership. the caller has to free the result */
+	MRegexp *release() noexcept
+	{
+		return std::exchange(re_, nullptr);
+	}
+
+	explicit operator bool() const noexcept
+	{
+		return re_ != nullptr;
+	}
+
+	/* find the first match in s which begins at or after start */
+	std::optional<match> find(std::string_view s,
+				  std::size_t start = 0) const noexcept
+	{
+		MRegexpMatch m;
+
+		if (!mregexp_match_from(re_, s.data(), s.size(), start, &m))
+			return std::nullopt;
+
+		return match{m.match_begin, m.match_end,
+			     s.substr(m.match_begin,
+				      m.match_end - m.match_begin)};
+	}
+
+	/* check if s contains a match */
+	bool contains(std::string_view s) const noexcept
+	{
+		return mregexp_is_match(re_, s.data(), s.size());
+	}
+
+	/* lazily iterate over all non-overlapping matches in s */
+	match_range find_all(std::string_view s) const noexcept;
+
+	/* replace all matches in s with repl, see mregexp_replace. throws
+	 * mregexp::error if repl refers to a group which doesn't exist */
+	std::string replace(std::string_view s, std::string_view repl) const
+	{
+		const char *r = detail::terminate(repl);
+		std::string out;
+		const std::size_t len =
+			mregexp_replace(re_, s.data(), s.size(), r, nullptr, 0);
+
+		if (mregexp_error() != MREGEXP_OK)
+			throw error(mregexp_error());
+
+		out.resize(len + 1);
+		mregexp_replace(re_, s.data(), s.size(), r, out.data(),
+				out.size());
+		out.resize(len);
+		return out;
+	}
+
+	std::size_t captures_len() const noexcept
+	{
+		return mregexp_captures_len(re_);
+	}
+
+	/* get the slice of capture group index from the last match on s */
+	std::optional<match> capture(std::string_view s,
+				     std::size_t index) const noexcept
+	{
+		const MRegexpMatch *m = mregexp_capture(re_, index);
+
+		if (m == nullptr || m->match_begin > m->match_end ||
+		    m->match_end > s.size())
+			return std::nullopt;
+
+		return match{m->match_begin, m->match_end,
+			     s.substr(m->match_begin,
+				      m->match_end - m->match_begin)};
+	}
+
+    private:
+	MRegexp *re_;
+};
+
+/* forward range over the matches of a regex in a subject. matches are
+ * searched for while iterating, nothing is collected up front */
+class match_range {
+    public:
+	class iterator {
+	    public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = match;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const match *;
+		using reference = const match &;
+
+		iterator() noexcept = default;
+
+		reference operator*() const noexcept
+		{
+			return *cur_;
+		}
+
+		pointer operator->() const noexcept
+		{
+			return &*cur_;
+		}
+
+		iterator &operator++() noexcept
+		{
+			// step past empty matches, so iteration terminates.
+			// the C api moves offsets inside of a character on
+			// to the next one
+			std::size_t next = cur_->end + (cur_->begin == cur_->end);
+
+			if (next > subject_.size())
+				cur_.reset();
+			else
+				cur_ = re_->find(subject_, next);
+
+			return *this;
+		}
+
+		iterator operator++(int) noexcept
+		{
+			iterator ret = *this;
+			++*this;
+			return ret;
+		}
+
+		bool operator==(const iterator &other) const noexcept
+		{
+			if (!cur_ || !other.cur_)
+				return !cur_ && !other.cur_;
+
+			return cur_->begin == other.cur_->begin &&
+			       cur_->end == other.cur_->end;
+		}
+
+		bool operator!=(const iterator &other) const noexcept
+		{
+			return !(*this == other);
+		}
+
+	    private:
+		friend class match_range;
+
+		iterator(const regex *re, std::string_view subject) noexcept
+			: re_(re), subject_(subject),
+			  cur_(re->find(subject))
+		{
+		}
+
+		const regex *re_ = nullptr;
+		std::string_view subject_;
+		std::optional<match> cur_;
+	};
+
+	match_range(const regex &re, std::string_view subject) noexcept
+		: re_(&re), subject_(subject)
+	{
+	}
+
+	iterator begin() const noexcept
+	{
+		return iterator(re_, subject_);
+	}
+
+	iterator end() const noexcept
+	{
+		return iterator();
+	}
+
+    private:
+	const regex *re_;
+	std::string_view subject_;
+};
+
+inline match_range regex::find_all(std::string_view s) const noexcept
+{
+	return match_range(*this, s);
+}
+
+namespace detail
+{
+constexpr std::uint32_t invalid_char = UINT32_MAX;
+constexpr std::size_t unbounded = SIZE_MAX;
+
+constexpr unsigned utf8_char_width(unsigned char c) noexcept
+{
+	return c < 0x80 ? 1
+	       : (c & 0xe0) == 0xc0 ? 2
+	       : (c & 0xf0) == 0xe0 ? 3
+	       : (c & 0xf8) == 0xf0 ? 4
+				    : 0;
+}
+
+/* same decoding as the C matcher: invalid, truncated and overlong
+ * sequences are a single INVALID_CHAR byte wide */
+constexpr std::uint32_t subject_peek(std::string_view s, std::size_t cur,
+				     std::size_t &next) noexcept
+{
+	constexpr std::uint32_t mods[] = {0, 127, 31, 15, 7};
+	constexpr std::uint32_t min_values[] = {0, 0, 0x80, 0x800, 0x10000};
+
+	const auto c = static_cast<unsigned char>(s[cur]);
+	next = cur + 1;
+
+	if (c < 0x80)
+		return c;
+
+	const unsigned width = utf8_char_width(c);
+
+	if (width == 0 || width > s.size() - cur)
+		return invalid_char;
+
+	std::uint32_t ret = c & mods[width];
+
+	for (unsigned i = 1; i < width; ++i) {
+		const auto cont = static_cast<unsigned char>(s[cur + i]);
+
+		if ((cont & 0xc0) != 0x80)
+			return invalid_char;
+
+		ret = (ret << 6) | (cont & 63);
+	}
+
+	if (ret < min_values[width])
+		return invalid_char;
+
+	next = cur + width;
+	return ret;
+}
+
+/* first character boundary at or after start */
+constexpr std::size_t subject_boundary(std::string_view s,
+				       std::size_t start) noexcept
+{
+	const std::size_t lo = start >= 3 ? start - 3 : 0;
+	std::size_t ret = start;
+
+	while (ret > lo && (static_cast<unsigned char>(s[ret]) & 0xc0) == 0x80)
+		ret--;
+
+	while (ret < start)
+		subject_peek(s, ret, ret);
+
+	return ret;
+}
+
+enum class op : unsigned char {
+	none,
+	chr,
+	any,
+	begin,
+	end,
+	cls,
+	range,
+	quant,
+	cap,
+	alt,
+};
+
+/* node of a program built at compile time. nodes link to each other by
+ * index, -1 ending a chain */
+struct static_node {
+	op kind = op::none;
+	bool negate = false;
+	/* following node of the chain */
+	int next = -1;
+	/* quant and cap: sub expression. alt: chain of this alternative,
+	 * never_matches if it is empty. cls: first range */
+	int sub = -1;
+	/* alt: next alternative. cls: one past the last range */
+	int other = -1;
+	/* chr: character. range: bounds */
+	std::uint32_t first = 0, last = 0;
+	std::size_t min = 0, max = 0;
+};
+
+/* empty alternatives never match */
+constexpr int never_matches = -2;
+
+template <std::size_t Capacity> struct static_program {
+	static_node nodes[Capacity] = {};
+	int len = 0;
+	int head = -1;
+};
+
+/* recursive descent parser for the syntax accepted by mregexp_compile.
+ * errors throw, which fails constant evaluation at the throw below */
+template <std::size_t Capacity> class static_parser {
+    public:
+	constexpr explicit static_parser(const char *re) : re_(re)
+	{
+	}
+
+	constexpr static_program<Capacity> parse()
+	{
+		check_utf8();
+		prog_.head = parse_alternation(0);
+		return prog_;
+	}
+
+    private:
+	[[noreturn]] static void fail(MRegexpError code)
+	{
+		// an invalid pattern in a constant expression ends up here
+		throw error(code);
+	}
+
+	constexpr unsigned char byte(std::size_t offset = 0) const
+	{
+		return static_cast<unsigned char>(re_[pos_ + offset]);
+	}
+
+	constexpr bool at_end() const
+	{
+		return byte() == 0;
+	}
+
+	/* decode the next pattern character. the pattern is valid utf8 */
+	constexpr std::uint32_t next_char()
+	{
+		constexpr std::uint32_t mods[] = {0, 127, 31, 15, 7};
+		const unsigned width = utf8_char_width(byte());
+		std::uint32_t ret = byte() & mods[width];
+
+		for (unsigned i = 1; i < width; ++i)
+			ret = (ret << 6) | (byte(i) & 63);
+
+		pos_ += width;
+		return ret;
+	}
+
+	constexpr void check_utf8() const
+	{
+		for (std::size_t i = 0; re_[i] != 0;) {
+			const unsigned width =
+				utf8_char_width(static_cast<unsigned char>(re_[i]));
+
+			if (width == 0)
+				fail(MREGEXP_INVALID_UTF8);
+
+			for (unsigned j = 1; j < width; ++j)
+				if ((static_cast<unsigned char>(re_[i + j]) &
+				     0xc0) != 0x80)
+					fail(MREGEXP_INVALID_UTF8);
+
+			i += width;
+		}
+	}
+
+	constexpr int add(op kind)
+	{
+		if (prog_.len == static_cast<int>(Capacity))
+			fail(MREGEXP_FAILED_ALLOC);
+
+		prog_.nodes[prog_.len].kind = kind;
+		return prog_.len++;
+	}
+
+	constexpr int add_range(std::uint32_t first, std::uint32_t last)
+	{
+		const int ret = add(op::range);
+		prog_.nodes[ret].first = first;
+		prog_.nodes[ret].last = last;
+		return ret;
+	}
+
+	constexpr int parse_alternation(int depth)
+	{
+		int head = parse_sequence(depth);
+
+		if (at_end() || byte() != '|')
+			return head;
+
+		const int ret = add(op::alt);
+		int alt = ret;
+		prog_.nodes[alt].sub = head < 0 ? never_matches : head;
+
+		while (!at_end() && byte() == '|') {
+			pos_++;
+			head = parse_sequence(depth);
+
+			const int next = add(op::alt);
+			prog_.nodes[next].sub = head < 0 ? never_matches : head;
+			prog_.nodes[alt].other = next;
+			alt = next;
+		}
+
+		return ret;
+	}
+
+	constexpr int parse_sequence(int depth)
+	{
+		int head = -1, tail = -1, before_tail = -1;
+
+		while (!at_end() && byte() != '|' &&
+		       !(byte() == ')' && depth > 0)) {
+			const std::uint32_t chr = next_char();
+			int node = -1;
+
+			switch (chr) {
+			case '*':
+			case '+':
+			case '?':
+			case '{': {
+				if (tail < 0)
+					fail(MREGEXP_EARLY_QUANTIFIER);
+
+				node = add(op::quant);
+				parse_quant(chr, prog_.nodes[node]);
+				prog_.nodes[node].sub = tail;
+
+				// the quantifier replaces the last node
+				if (before_tail < 0)
+					head = node;
+				else
+					prog_.nodes[before_tail].next = node;
+
+				tail = node;
+				continue;
+			}
+
+			case '^':
+				node = add(op::begin);
+				break;
+
+			case '$':
+				node = add(op::end);
+				break;
+
+			case '.':
+				node = add(op::any);
+				break;
+
+			case '[':
+				node = parse_class();
+				break;
+
+			case '(':
+				node = add(op::cap);
+				prog_.nodes[node].sub = parse_alternation(depth + 1);
+
+				if (at_end())
+					fail(MREGEXP_UNCLOSED_SUBEXPRESSION);
+
+				pos_++;
+				break;
+
+			case '\\':
+				node = parse_escaped();
+				break;
+
+			default:
+				node = add(op::chr);
+				prog_.nodes[node].first = chr;
+				break;
+			}
+
+			if (tail < 0)
+				head = node;
+			else
+				prog_.nodes[tail].next = node;
+
+			before_tail = tail;
+			tail = node;
+		}
+
+		return head;
+	}
+
+	constexpr std::size_t parse_number()
+	{
+		std::size_t ret = 0;
+
+		while (byte() >= '0' && byte() <= '9') {
+			const std::size_t digit = byte() - '0';
+
+			if (ret > (unbounded - 1 - digit) / 10)
+				fail(MREGEXP_INVALID_COMPLEX_QUANT);
+
+			ret = ret * 10 + digit;
+			pos_++;
+		}
+
+		return ret;
+	}
+
+	constexpr void parse_quant(std::uint32_t chr, static_node &node)
+	{
+		node.min = chr == '+' ? 1 : 0;
+		node.max = chr == '?' ? 1 : unbounded;
+
+		if (chr != '{')
+			return;
+
+		const bool has_min = byte() >= '0' && byte() <= '9';
+
+		if (!has_min && byte() != ',')
+			fail(MREGEXP_INVALID_COMPLEX_QUANT);
+
+		node.min = has_min ? parse_number() : 0;
+
+		if (byte() == ',') {
+			pos_++;
+			node.max = byte() >= '0' && byte() <= '9' ? parse_number()
+								 : unbounded;
+		} else {
+			node.max = node.min;
+		}
+
+		if (byte() != '}' || node.min > node.max)
+			fail(MREGEXP_INVALID_COMPLEX_QUANT);
+
+		pos_++;
+	}
+
+	constexpr std::uint32_t parse_class_char()
+	{
+		std::uint32_t ret = next_char();
+
+		if (ret == '\\') {
+			if (at_end())
+				fail(MREGEXP_INVALID_COMPLEX_CLASS);
+
+			ret = next_char();
+
+			if (ret == 'p' || ret == 'P')
+				fail(MREGEXP_INVALID_PROPERTY);
+		}
+
+		return ret;
+	}
+
+	constexpr int parse_class()
+	{
+		const int ret = add(op::cls);
+
+		if (byte() == '^') {
+			prog_.nodes[ret].negate = true;
+			pos_++;
+		}
+
+		prog_.nodes[ret].sub = prog_.len;
+
+		while (!at_end() && byte() != ']') {
+			const std::uint32_t first = parse_class_char();
+			std::uint32_t last = first;
+
+			if (byte() == '-' && byte(1) != ']' && byte(1) != 0) {
+				pos_++;
+				last = parse_class_char();
+			}
+
+			add_range(first, last);
+		}
+
+		if (at_end())
+			fail(MREGEXP_INVALID_COMPLEX_CLASS);
+
+		pos_++;
+		prog_.nodes[ret].other = prog_.len;
+		return ret;
+	}
+
+	constexpr int builtin_class(bool negate, const char *ranges)
+	{
+		const int ret = add(op::cls);
+		prog_.nodes[ret].negate = negate;
+		prog_.nodes[ret].sub = prog_.len;
+
+		for (; *ranges != 0; ranges += 2)
+			add_range(static_cast<unsigned char>(ranges[0]),
+				  static_cast<unsigned char>(ranges[1]));
+
+		prog_.nodes[ret].other = prog_.len;
+		return ret;
+	}
+
+	constexpr int parse_escaped()
+	{
+		if (at_end())
+			fail(MREGEXP_UNEXPECTED_EOL);
+
+		std::uint32_t chr = next_char();
+
+		switch (chr) {
+		case 'n':
+			chr = '\n';
+			break;
+		case 't':
+			chr = '\t';
+			break;
+		case 'r':
+			chr = '\r';
+			break;
+		case 's':
+		case 'S':
+			return builtin_class(chr == 'S', "  \t\t\r\r\n\n");
+		case 'w':
+		case 'W':
+			return builtin_class(chr == 'W', "azAZ09__");
+		case 'd':
+		case 'D':
+			return builtin_class(chr == 'D', "09");
+		case 'p':
+		case 'P':
+			// the tables of unicode properties aren't available
+			// at compile time
+			fail(MREGEXP_INVALID_PROPERTY);
+			break;
+		default:
+			break;
+		}
+
+		const int ret = add(op::chr);
+		prog_.nodes[ret].first = chr;
+		return ret;
+	}
+
+	const char *re_;
+	std::size_t pos_ = 0;
+	static_program<Capacity> prog_{};
+};
+} // namespace detail
+
+/* compile a pattern into a program at compile time. invalid patterns
+ * are a compile error when the result is declared constexpr */
+template <std::size_t N>
+constexpr auto static_compile(const char (&pattern)[N])
+{
+	// every byte of the pattern adds at most 2.5 nodes, as \w does
+	return detail::static_parser<N * 5 / 2 + 1>(pattern).parse();
+}
+
+/* matcher specialized for a program from static_compile at compile time,
+ * with the semantics of the runtime matcher. the program has to be a
+ * constexpr variable with static storage:
+ *
+ *   static constexpr auto digits = mregexp::static_compile("[0-9]+");
+ *   mregexp::static_regex<digits>::find(s);
+ *
+ * captures are not recorded */
+template <const auto &Program> class static_regex {
+    public:
+	/* find the first match in s which begins at or after start */
+	static constexpr std::optional<match> find(std::string_view s,
+						   std::size_t start = 0) noexcept
+	{
+		if (start > s.size())
+			return std::nullopt;
+
+		if (start < s.size())
+			start = detail::subject_boundary(s, start);
+
+		constexpr int head = Program.head;
+		constexpr bool anchored =
+			head >= 0 && Program.nodes[head].kind == detail::op::begin;
+
+		if (anchored && start > 0)
+			return std::nullopt;
+
+		// like in the C matcher, only empty matches begin at the end
+		for (std::size_t pos = start; pos <= s.size();) {
+			if constexpr (head >= 0 &&
+				      Program.nodes[head].kind == detail::op::chr &&
+				      Program.nodes[head].first < 0x80) {
+				pos = s.find(static_cast<char>(
+						     Program.nodes[head].first),
+					     pos);
+
+				if (pos == std::string_view::npos)
+					return std::nullopt;
+			}
+
+			std::size_t next = 0;
+
+			if (chain<head>(s, pos, next))
+				return match{pos, next, s.substr(pos, next - pos)};
+
+			if (anchored || pos == s.size())
+				break;
+
+			detail::subject_peek(s, pos, pos);
+		}
+
+		return std::nullopt;
+	}
+
+	/* check if s contains a match */
+	static constexpr bool contains(std::string_view s) noexcept
+	{
+		return find(s).has_value();
+	}
+
+    private:
+	template <int I>
+	static constexpr bool chain(std::string_view s, std::size_t cur,
+				    std::size_t &next) noexcept
+	{
+		if constexpr (I < 0) {
+			next = cur;
+			return true;
+		} else {
+			return node<I>(s, cur, next) &&
+			       chain<Program.nodes[I].next>(s, next, next);
+		}
+	}
+
+	template <int First, int... I>
+	static constexpr bool in_ranges(std::uint32_t chr,
+					std::integer_sequence<int, I...>) noexcept
+	{
+		return ((chr >= Program.nodes[First + I].first &&
+			 chr <= Program.nodes[First + I].last) ||
+			...);
+	}
+
+	template <int I>
+	static constexpr bool node(std::string_view s, std::size_t cur,
+				   std::size_t &next) noexcept
+	{
+		constexpr detail::static_node n = Program.nodes[I];
+
+		if constexpr (n.kind == detail::op::chr) {
+			if (cur >= s.size())
+				return false;
+
+			if constexpr (n.first < 0x80) {
+				next = cur + 1;
+				return static_cast<unsigned char>(s[cur]) == n.first;
+			} else {
+				return detail::subject_peek(s, cur, next) == n.first;
+			}
+		} else if constexpr (n.kind == detail::op::any) {
+			if (cur >= s.size())
+				return false;
+
+			detail::subject_peek(s, cur, next);
+			return true;
+		} else if constexpr (n.kind == detail::op::begin) {
+			next = cur;
+			return cur == 0;
+		} else if constexpr (n.kind == detail::op::end) {
+			next = cur;
+			return cur == s.size();
+		} else if constexpr (n.kind == detail::op::cls) {
+			if (cur >= s.size())
+				return false;
+
+			const std::uint32_t chr = detail::subject_peek(s, cur, next);
+			return in_ranges<n.sub>(
+				       chr, std::make_integer_sequence<
+						    int, n.other - n.sub>()) !=
+			       n.negate;
+		} else if constexpr (n.kind == detail::op::quant) {
+			std::size_t matches = 0;
+
+			while (matches < n.max && chain<n.sub>(s, cur, next)) {
+				// an empty iteration would repeat forever, so
+				// it may as well satisfy all required ones
+				if (next == cur) {
+					if (matches < n.min)
+						matches = n.min;
+					break;
+				}
+
+				matches++;
+				cur = next;
+			}
+
+			next = cur;
+			return matches >= n.min;
+		} else if constexpr (n.kind == detail::op::cap) {
+			return chain<n.sub>(s, cur, next);
+		} else if constexpr (n.kind == detail::op::alt) {
+			if constexpr (n.sub != detail::never_matches) {
+				if (chain<n.sub>(s, cur, next))
+					return true;
+			}
+
+			if constexpr (n.other < 0)
+				return false;
+			else
+				return node<n.other>(s, cur, next);
+		} else {
+			return false;
+		}
+	}
+};
+
+} // namespace mregexp
+
+#endif
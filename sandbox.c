@@ -1,5 +1,10 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "mregexp.h"
 
@@ -20,12 +25,62 @@ char *readline(const char *prompt)
 	return ret;
 }
 
-int main(void)
+static void explain(MRegexp *re)
 {
-	char *raw_re = readline("Enter regular expression > ");
-	char *text = readline("Enter text > ");
+	const size_t len = mregexp_explain(re, NULL, 0);
+	char *buf = (char *) malloc(len + 1);
+
+	mregexp_explain(re, buf, len + 1);
+	fputs(buf, stdout);
+	free(buf);
+}
 
-	MRegexp *re = mregexp_compile(raw_re);
+static int usage(void)
+{
+	fputs("usage: sandbox [-e] [-c] [-d] [-i] [-u] [regex [text]]\n",
+	      stderr);
+	return EXIT_FAILURE;
+}
+
+/* usage: sandbox [-e] [-c] [-d] [-i] [-u] [regex [text]]
+ * missing arguments are read from stdin. -e prints the compiled program
+ * and stops unless a text is given as well. -c, -d, -i and -u compile
+ * with the compact, dfa, icase and unicode options, so -e shows the
+ * program and prefilters chosen for them */
+int main(int argc, char **argv)
+{
+	MRegexpOptions opts;
+	memset(&opts, 0, sizeof(MRegexpOptions));
+	bool show_program = false;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "cdeiu")) != -1) {
+		switch (opt) {
+		case 'c':
+			opts.compact = true;
+			break;
+		case 'd':
+			opts.dfa = true;
+			break;
+		case 'e':
+			show_program = true;
+			break;
+		case 'i':
+			opts.icase = true;
+			break;
+		case 'u':
+			opts.unicode = true;
+			break;
+		default:
+			return usage();
+		}
+	}
+
+	int arg = optind;
+	char *raw_re = arg < argc ? argv[arg++] :
+				    readline("Enter regular expression > ");
+
+	MRegexp *re = mregexp_compile_opts(raw_re, &opts);
 
 	if (mregexp_error() || re == NULL) {
 		printf("Invalid regular expression: Compile failed with error %d\n",
@@ -33,6 +88,15 @@ int main(void)
         return EXIT_FAILURE;
 	}
 
+	if (show_program) {
+		explain(re);
+
+		if (arg == argc)
+			return 0;
+	}
+
+	char *text = arg < argc ? argv[arg] : readline("Enter text > ");
+
     MRegexpMatch m;
     if (mregexp_match(re, text, &m)) {
         fwrite(text, 1, m.match_begin, stdout);
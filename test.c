@@ -1,5 +1,7 @@
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <check.h>
 
 #include "mregexp.h"
@@ -132,6 +134,54 @@ START_TEST(compile_match_complex_quants)
 }
 END_TEST
 
+START_TEST(match_counted_loops)
+{
+	MRegexp *re = mregexp_compile("[0-9a-f]{4}");
+	MRegexpMatch m;
+
+	// runs which are too short are skipped as a whole
+	ck_assert(mregexp_match(re, "12 abc 01234x", &m));
+	ck_assert_uint_eq(m.match_begin, 7);
+	ck_assert_uint_eq(m.match_end, 11);
+	ck_assert(!mregexp_match(re, "abc abc", &m));
+	mregexp_free(re);
+
+	re = mregexp_compile("[^a-c]{2,3}d");
+	ck_assert(mregexp_match(re, "aäxaöü\xff" "dd", &m));
+	ck_assert_uint_eq(m.match_begin, 5);
+	ck_assert_uint_eq(m.match_end, 11);
+	mregexp_free(re);
+
+	ck_assert_ptr_eq(mregexp_compile("a{3,2}"), NULL);
+	ck_assert_int_eq(mregexp_error(), MREGEXP_INVALID_COMPLEX_QUANT);
+	ck_assert_ptr_eq(mregexp_compile("a{99999999999999999999999}"), NULL);
+	ck_assert_int_eq(mregexp_error(), MREGEXP_INVALID_COMPLEX_QUANT);
+}
+END_TEST
+
+START_TEST(compile_match_empty_quants)
+{
+	MRegexp *re1 = mregexp_compile("äb{0}c");
+	ck_assert_ptr_ne(re1, NULL);
+	MRegexp *re2 = mregexp_compile("(a*)*b");
+	ck_assert_ptr_ne(re2, NULL);
+
+	MRegexpMatch m;
+	ck_assert(mregexp_match(re1, "abcäc", &m));
+	ck_assert_uint_eq(m.match_begin, 3);
+	ck_assert_uint_eq(m.match_end, 6);
+	ck_assert(!mregexp_match(re1, "äbc", &m));
+
+	ck_assert(mregexp_match(re2, "xaab", &m));
+	ck_assert_uint_eq(m.match_begin, 1);
+	ck_assert_uint_eq(m.match_end, 4);
+	ck_assert(!mregexp_match(re2, "xaa", &m));
+
+	mregexp_free(re1);
+	mregexp_free(re2);
+}
+END_TEST
+
 START_TEST(compile_match_escaped_chars)
 {
 	MRegexp *re = mregexp_compile("\\n\\r\\t\\{");
@@ -241,7 +291,7 @@ START_TEST(compile_match_cap)
 	MRegexpMatch m;
 	ck_assert(mregexp_match(re, "abcd", &m));
 	ck_assert(mregexp_match(re, "llljabcdkk", &m));
-	ck_assert(!mregexp_match(re, "abc", &m));
+	ck_assert(!mregexp_match(re, "abdc", &m));
 
 	mregexp_free(re);
 }
@@ -251,6 +301,10 @@ START_TEST(invalid_quantifier)
 {
 	ck_assert_ptr_eq(mregexp_compile("+"), NULL);
 	ck_assert_int_eq(mregexp_error(), MREGEXP_EARLY_QUANTIFIER);
+	ck_assert_ptr_eq(mregexp_compile("a|*b"), NULL);
+	ck_assert_int_eq(mregexp_error(), MREGEXP_EARLY_QUANTIFIER);
+	ck_assert_ptr_eq(mregexp_compile("(?)"), NULL);
+	ck_assert_int_eq(mregexp_error(), MREGEXP_EARLY_QUANTIFIER);
 }
 END_TEST
 
@@ -299,6 +353,981 @@ START_TEST(match_all)
 }
 END_TEST
 
+START_TEST(match_all_empty)
+{
+	MRegexp *re = mregexp_compile("a*");
+	size_t matches_len = 0;
+
+	MRegexpMatch *matches = mregexp_all_matches(re, "baab", &matches_len);
+
+	ck_assert_uint_eq(matches_len, 4);
+	ck_assert_uint_eq(matches[0].match_begin, 0);
+	ck_assert_uint_eq(matches[0].match_end, 0);
+	ck_assert_uint_eq(matches[1].match_begin, 1);
+	ck_assert_uint_eq(matches[1].match_end, 3);
+	ck_assert_uint_eq(matches[2].match_begin, 3);
+	ck_assert_uint_eq(matches[2].match_end, 3);
+	ck_assert_uint_eq(matches[3].match_begin, 4);
+	ck_assert_uint_eq(matches[3].match_end, 4);
+
+	free(matches);
+	mregexp_free(re);
+}
+END_TEST
+
+START_TEST(match_all_update)
+{
+	MRegexp *re = mregexp_compile("\\w+");
+	size_t matches_len = 0, updated_len = 0;
+
+	MRegexpMatch *matches = mregexp_all_matches(re, "one two three four",
+						    &matches_len);
+	ck_assert_uint_eq(matches_len, 4);
+
+	// "two" is replaced with "2 2"
+	const char *s = "one 2 2 three four";
+	MRegexpMatch *updated = mregexp_update_matches(
+		re, s, strlen(s), matches, matches_len, 4, 3, 3, &updated_len);
+
+	ck_assert_uint_eq(updated_len, 5);
+	ck_assert_uint_eq(updated[1].match_begin, 4);
+	ck_assert_uint_eq(updated[1].match_end, 5);
+	ck_assert_uint_eq(updated[2].match_begin, 6);
+	ck_assert_uint_eq(updated[2].match_end, 7);
+	ck_assert_uint_eq(updated[4].match_begin, 14);
+	free(matches);
+
+	// the space in front of "three" is removed
+	s = "one 2 2three four";
+	matches = mregexp_update_matches(re, s, strlen(s), updated, updated_len,
+					 7, 1, 0, &matches_len);
+
+	ck_assert_uint_eq(matches_len, 4);
+	ck_assert_uint_eq(matches[2].match_begin, 6);
+	ck_assert_uint_eq(matches[2].match_end, 12);
+	ck_assert_uint_eq(matches[3].match_begin, 13);
+	ck_assert_uint_eq(matches[3].match_end, 17);
+	free(updated);
+	free(matches);
+	mregexp_free(re);
+
+	// edits may change matches in front of them
+	re = mregexp_compile("a[^b]*b");
+	ck_assert_ptr_null(mregexp_all_matches(re, "-a--", &matches_len));
+	s = "-a--b";
+	matches = mregexp_update_matches(re, s, strlen(s), NULL, 0, 4, 0, 1,
+					 &matches_len);
+	ck_assert_uint_eq(matches_len, 1);
+	ck_assert_uint_eq(matches[0].match_begin, 1);
+	ck_assert_uint_eq(matches[0].match_end, 5);
+	free(matches);
+
+	ck_assert_ptr_null(mregexp_update_matches(re, s, strlen(s), NULL, 0, 4,
+						  0, 2, &matches_len));
+	ck_assert_int_eq(mregexp_error(), MREGEXP_INVALID_PARAMS);
+	mregexp_free(re);
+}
+END_TEST
+
+START_TEST(match_batch)
+{
+	MRegexp *re = mregexp_compile("[0-9]+ms$");
+	const char *subjects[] = {"took 15ms", "took 15ms and more",
+				  "took 7ms!!", "\xff\xfe 3ms"};
+	const size_t lens[] = {9, 18, 8, 6};
+	MRegexpMatch results[4];
+
+	ck_assert_uint_eq(mregexp_match_batch(re, subjects, lens, 4, results),
+			  3);
+	ck_assert_uint_eq(results[0].match_begin, 5);
+	ck_assert_uint_eq(results[0].match_end, 9);
+	ck_assert_uint_eq(results[1].match_begin, __SIZE_MAX__);
+	ck_assert_uint_eq(results[2].match_begin, 5);
+	ck_assert_uint_eq(results[2].match_end, 8);
+	ck_assert_uint_eq(results[3].match_begin, 3);
+
+	ck_assert_uint_eq(mregexp_match_batch(re, subjects, NULL, 4, results),
+			  2);
+	ck_assert_uint_eq(results[2].match_begin, __SIZE_MAX__);
+
+	mregexp_free(re);
+}
+END_TEST
+
+START_TEST(match_inner_literal)
+{
+	MRegexp *re1 = mregexp_compile("\\w+@example\\.com");
+	ck_assert_ptr_ne(re1, NULL);
+	MRegexp *re2 = mregexp_compile("[0-9]{1,3}(ms)");
+	ck_assert_ptr_ne(re2, NULL);
+	MRegexp *re3 = mregexp_compile(".äö");
+	ck_assert_ptr_ne(re3, NULL);
+
+	MRegexpMatch m;
+	ck_assert(mregexp_match(re1, "mail bob@example.com now", &m));
+	ck_assert_uint_eq(m.match_begin, 5);
+	ck_assert_uint_eq(m.match_end, 20);
+	ck_assert(!mregexp_match(re1, "mail bob@example.org now", &m));
+	ck_assert(!mregexp_match(re1, "mail @example.com now", &m));
+
+	ck_assert(mregexp_match(re2, "1ms 2 3 4 5 6 7 8 9 1234ms", &m));
+	ck_assert_uint_eq(m.match_begin, 0);
+	ck_assert(mregexp_match(re2, "ms 2 3 4 5 6 7 8 9 1234ms", &m));
+	ck_assert_uint_eq(m.match_begin, 20);
+	ck_assert_uint_eq(m.match_end, 25);
+	ck_assert_uint_eq(mregexp_capture(re2, 0)->match_begin, 23);
+
+	ck_assert(mregexp_match(re3, "äääääöö", &m));
+	ck_assert_uint_eq(m.match_begin, 6);
+	ck_assert_uint_eq(m.match_end, 12);
+	ck_assert(mregexp_match(re3, "\xffäö", &m));
+	ck_assert_uint_eq(m.match_begin, 0);
+
+	mregexp_free(re1);
+	mregexp_free(re2);
+	mregexp_free(re3);
+}
+END_TEST
+
+START_TEST(match_alternation_prefilter)
+{
+	MRegexp *re1 = mregexp_compile("GET|POST|PUT|DELETE");
+	ck_assert_ptr_ne(re1, NULL);
+	MRegexp *re2 = mregexp_compile("(foo|bar|baz|äh)\\d+");
+	ck_assert_ptr_ne(re2, NULL);
+
+	MRegexpMatch m;
+	ck_assert(mregexp_match(re1, "PATCH /x PUSH /y PUT /z", &m));
+	ck_assert_uint_eq(m.match_begin, 17);
+	ck_assert_uint_eq(m.match_end, 20);
+	ck_assert(mregexp_match(re1, "DELETE", &m));
+	ck_assert(!mregexp_match(re1, "PATCH /x PUSH /y DEL", &m));
+
+	ck_assert(mregexp_match(re2, "fo1 ba2 baz bar42", &m));
+	ck_assert_uint_eq(m.match_begin, 12);
+	ck_assert_uint_eq(m.match_end, 17);
+	ck_assert(mregexp_match(re2, "ääh7", &m));
+	ck_assert_uint_eq(m.match_begin, 2);
+	ck_assert(!mregexp_match(re2, "foo bar baz", &m));
+
+	mregexp_free(re1);
+	mregexp_free(re2);
+}
+END_TEST
+
+START_TEST(match_optimized_programs)
+{
+	MRegexp *re1 = mregexp_compile("abc|abd|ab");
+	ck_assert_ptr_ne(re1, NULL);
+	MRegexp *re2 = mregexp_compile("(a|ab)(c|bcd)(d*)");
+	ck_assert_ptr_ne(re2, NULL);
+	MRegexp *re3 = mregexp_compile("x.{2,3}y|[a-z]+ä+");
+	ck_assert_ptr_ne(re3, NULL);
+
+	MRegexpMatch m;
+	ck_assert(mregexp_match(re1, "xabdx", &m));
+	ck_assert_uint_eq(m.match_begin, 1);
+	ck_assert_uint_eq(m.match_end, 4);
+	ck_assert(mregexp_match(re1, "xabx", &m));
+	ck_assert_uint_eq(m.match_end, 3);
+
+	// the first alternative which matches is taken
+	ck_assert(mregexp_match(re2, "abcd", &m));
+	ck_assert_uint_eq(m.match_begin, 0);
+	ck_assert_uint_eq(m.match_end, 4);
+	ck_assert_uint_eq(mregexp_capture(re2, 1)->match_begin, 1);
+	ck_assert_uint_eq(mregexp_capture(re2, 2)->match_begin, 4);
+
+	// quantifiers never give back what they matched
+	ck_assert(mregexp_match(re3, "x123y", &m));
+	ck_assert(!mregexp_match(re3, "x12y", &m));
+	ck_assert(mregexp_match(re3, "--abcää", &m));
+	ck_assert_uint_eq(m.match_begin, 2);
+	ck_assert_uint_eq(m.match_end, 9);
+
+	mregexp_free(re1);
+	mregexp_free(re2);
+	mregexp_free(re3);
+}
+END_TEST
+
+START_TEST(match_anchored)
+{
+	MRegexp *re = mregexp_compile("^ab");
+	size_t matches_len = 0;
+	MRegexpMatch m;
+
+	ck_assert(mregexp_match(re, "abab", &m));
+	ck_assert(!mregexp_match(re, "bab", &m));
+
+	MRegexpMatch *matches = mregexp_all_matches(re, "ababab", &matches_len);
+	ck_assert_uint_eq(matches_len, 1);
+
+	free(matches);
+	mregexp_free(re);
+}
+END_TEST
+
+START_TEST(match_stats)
+{
+	MRegexp *re = mregexp_compile("(foo|bar)\\d");
+	MRegexpStats stats;
+	MRegexpMatch m;
+
+	ck_assert(mregexp_match(re, "foo bar baz bar7", &m));
+	mregexp_stats(re, &stats);
+	ck_assert_uint_eq(stats.calls, 0);
+
+	mregexp_enable_stats(re, true);
+	ck_assert(mregexp_match(re, "foo bar baz bar7", &m));
+	ck_assert(!mregexp_match(re, "xyz", &m));
+
+	mregexp_stats(re, &stats);
+	ck_assert_uint_eq(stats.calls, 2);
+	ck_assert_uint_eq(stats.matches, 1);
+	ck_assert_uint_eq(stats.bytes_scanned, 19);
+	ck_assert_uint_eq(stats.positions, 3);
+	ck_assert_uint_eq(stats.prefilter_candidates, 3);
+	ck_assert_uint_eq(stats.prefilter_rejects, 1);
+	ck_assert_uint_gt(stats.node_visits, stats.positions);
+	ck_assert_uint_eq(stats.backtracks, 4);
+
+	mregexp_reset_stats(re);
+	mregexp_stats(re, &stats);
+	ck_assert_uint_eq(stats.calls, 0);
+	ck_assert_uint_eq(stats.node_visits, 0);
+
+	mregexp_free(re);
+
+	// calls answered by the dfa count its transitions only
+	MRegexpOptions opts = {.dfa = true};
+	re = mregexp_compile_opts("[a-c]+d$", &opts);
+	mregexp_enable_stats(re, true);
+	ck_assert(mregexp_is_match(re, "xxabcd", 6));
+	ck_assert(!mregexp_is_match(re, "abcdx", 5));
+
+	mregexp_stats(re, &stats);
+	ck_assert_uint_eq(stats.calls, 2);
+	ck_assert_uint_eq(stats.matches, 1);
+	ck_assert_uint_eq(stats.dfa_transitions, 11);
+	ck_assert_uint_eq(stats.positions, 0);
+	ck_assert_uint_eq(stats.node_visits, 0);
+
+	// searches ruled out by the dfa as well
+	ck_assert(!mregexp_match(re, "abdc", &m));
+	mregexp_stats(re, &stats);
+	ck_assert_uint_eq(stats.calls, 3);
+	ck_assert_uint_eq(stats.dfa_transitions, 15);
+	ck_assert_uint_eq(stats.positions, 0);
+
+	mregexp_free(re);
+}
+END_TEST
+
+START_TEST(match_length_aware)
+{
+	MRegexp *re = mregexp_compile("[a-z]+");
+	MRegexpMatch m;
+
+	// the subject contains NUL bytes and isn't terminated
+	const char subject[] = {'1', '\0', 'a', 'b', '\0', 'c', 'd', 'e'};
+	ck_assert(mregexp_match_n(re, subject, sizeof(subject), &m));
+	ck_assert_uint_eq(m.match_begin, 2);
+	ck_assert_uint_eq(m.match_end, 4);
+
+	ck_assert(mregexp_match_from(re, subject, sizeof(subject), 4, &m));
+	ck_assert_uint_eq(m.match_begin, 5);
+	ck_assert_uint_eq(m.match_end, 8);
+
+	ck_assert(!mregexp_match_n(re, subject, 2, &m));
+	ck_assert(!mregexp_match_from(re, subject, 8, 8, &m));
+	ck_assert(!mregexp_match_from(re, subject, 8, 9, &m));
+	ck_assert_int_eq(mregexp_error(), MREGEXP_INVALID_PARAMS);
+	mregexp_free(re);
+
+	// starting inside of a character moves on to the next one
+	re = mregexp_compile(".");
+	ck_assert(mregexp_match_from(re, "\xc3\xa4" "b", 3, 1, &m));
+	ck_assert_uint_eq(m.match_begin, 2);
+	ck_assert_uint_eq(m.match_end, 3);
+	mregexp_free(re);
+}
+END_TEST
+
+START_TEST(match_caller_captures)
+{
+	MRegexp *re = mregexp_compile("(\\d+)-(\\d+)|(x)");
+	MRegexpMatch m, caps[3];
+
+	ck_assert(mregexp_match(re, "x", &m));
+	ck_assert(mregexp_match_captures(re, "a 12-345", 8, 0, &m, caps, 3));
+	ck_assert_uint_eq(m.match_begin, 2);
+	ck_assert_uint_eq(caps[0].match_begin, 2);
+	ck_assert_uint_eq(caps[0].match_end, 4);
+	ck_assert_uint_eq(caps[1].match_begin, 5);
+	ck_assert_uint_eq(caps[1].match_end, 8);
+	ck_assert_uint_eq(caps[2].match_begin, __SIZE_MAX__);
+
+	// the captures of re are left alone
+	ck_assert_uint_eq(mregexp_capture(re, 2)->match_begin, 0);
+	ck_assert_uint_eq(mregexp_capture(re, 2)->match_end, 1);
+
+	// groups beyond caps_len aren't recorded
+	ck_assert(mregexp_match_captures(re, "1-2", 3, 0, &m, caps, 1));
+	ck_assert_uint_eq(caps[0].match_end, 1);
+	ck_assert_uint_eq(caps[1].match_begin, 5);
+	ck_assert(mregexp_match_captures(re, "1-2", 3, 0, &m, NULL, 0));
+
+	ck_assert(!mregexp_match_captures(re, "1-2", 3, 0, &m, NULL, 1));
+	ck_assert_int_eq(mregexp_error(), MREGEXP_INVALID_PARAMS);
+	mregexp_free(re);
+}
+END_TEST
+
+START_TEST(match_segments)
+{
+	// the literal and the euro sign are split between segments
+	MRegexpSegment segs[] = {
+		{"say hel", 7}, {"", 0}, {"lo 1\xe2\x82", 6}, {"\xac!", 2},
+	};
+	MRegexp *re = mregexp_compile("(hello) \\d\xe2\x82\xac");
+	MRegexpMatch m;
+
+	ck_assert(mregexp_match_segments(re, segs, 4, &m));
+	ck_assert_uint_eq(m.match_begin, 4);
+	ck_assert_uint_eq(m.match_end, 14);
+	ck_assert_uint_eq(mregexp_capture(re, 0)->match_begin, 4);
+	ck_assert_uint_eq(mregexp_capture(re, 0)->match_end, 9);
+	mregexp_free(re);
+
+	// ^ and $ refer to the whole subject
+	re = mregexp_compile("^\\w+|\\w+!$");
+	size_t matches_len = 0;
+	MRegexpMatch *matches =
+		mregexp_all_matches_segments(re, segs, 4, &matches_len);
+
+	ck_assert_uint_eq(matches_len, 1);
+	ck_assert_uint_eq(matches[0].match_begin, 0);
+	ck_assert_uint_eq(matches[0].match_end, 3);
+	free(matches);
+	mregexp_free(re);
+
+	re = mregexp_compile("[a-z]+");
+	matches = mregexp_all_matches_segments(re, segs, 4, &matches_len);
+	ck_assert_uint_eq(matches_len, 2);
+	ck_assert_uint_eq(matches[1].match_begin, 4);
+	ck_assert_uint_eq(matches[1].match_end, 9);
+	free(matches);
+	mregexp_free(re);
+
+	MRegexpOptions opts = {0};
+	opts.dfa = true;
+	re = mregexp_compile_opts("l{2}o \\d", &opts);
+	ck_assert(mregexp_is_match_segments(re, segs, 4));
+	ck_assert(!mregexp_is_match_segments(re, segs, 2));
+	mregexp_free(re);
+
+	ck_assert(!mregexp_match_segments(NULL, segs, 4, &m));
+	ck_assert_int_eq(mregexp_error(), MREGEXP_INVALID_PARAMS);
+}
+END_TEST
+
+START_TEST(match_is_match)
+{
+	MRegexp *re = mregexp_compile("a\\d+|b(c)*$");
+	ck_assert(mregexp_is_match(re, "xa1234", 6));
+	ck_assert(mregexp_is_match(re, "xbcc", 4));
+	ck_assert(!mregexp_is_match(re, "xbcd", 4));
+	ck_assert(!mregexp_is_match(re, "a1", 1));
+	ck_assert(!mregexp_is_match(re, NULL, 0));
+	ck_assert_int_eq(mregexp_error(), MREGEXP_OK);
+	ck_assert(!mregexp_is_match(NULL, "a1", 2));
+	ck_assert_int_eq(mregexp_error(), MREGEXP_INVALID_PARAMS);
+	mregexp_free(re);
+
+	// loops repeated by an outer loop still have to be extended
+	re = mregexp_compile("(a\\d+){2}");
+	ck_assert(mregexp_is_match(re, "a12a3", 5));
+	ck_assert(!mregexp_is_match(re, "a12b3", 5));
+	mregexp_free(re);
+
+	// captures of an earlier match are left alone
+	MRegexpMatch m;
+	re = mregexp_compile("(\\d)+");
+	ck_assert(mregexp_match(re, "1", &m));
+	ck_assert(mregexp_is_match(re, "x23", 3));
+	ck_assert_uint_eq(mregexp_capture(re, 0)->match_begin, 0);
+	ck_assert_uint_eq(mregexp_capture(re, 0)->match_end, 1);
+	mregexp_free(re);
+}
+END_TEST
+
+START_TEST(match_dfa)
+{
+	const char *patterns[] = {"\\d{2,3}-[a-z]+$", "a.c$|x\\w*y", "a*a"};
+	const char *subjects[] = {"12-ab", "1-ab", "123-ab ", "xay", "a\xff" "c",
+				  "abc", "\xe2\x82\xac" "1234-z", "aaa", "xy"};
+	MRegexpOptions opts = {0};
+	opts.dfa = true;
+
+	for (size_t i = 0; i < sizeof(patterns) / sizeof(*patterns); ++i) {
+		MRegexp *re = mregexp_compile(patterns[i]);
+		MRegexp *dfa = mregexp_compile_opts(patterns[i], &opts);
+		char buf[512];
+
+		mregexp_explain(dfa, buf, sizeof(buf));
+		ck_assert_ptr_nonnull(strstr(buf, "engine: dfa"));
+
+		for (size_t j = 0; j < sizeof(subjects) / sizeof(*subjects);
+		     ++j) {
+			const size_t len = strlen(subjects[j]);
+			ck_assert_int_eq(mregexp_is_match(dfa, subjects[j], len),
+					 mregexp_is_match(re, subjects[j], len));
+		}
+
+		mregexp_free(re);
+		mregexp_free(dfa);
+	}
+
+	MRegexp *re = mregexp_compile_opts("\\d{2,3}-[a-z]+$", &opts);
+	ck_assert(mregexp_is_match(re, "\xe2\x82\xac" "1234-z", 9));
+	ck_assert(!mregexp_is_match(re, "123-ab ", 7));
+
+	// saved dfas only load into expressions of the same pattern
+	const size_t size = mregexp_dfa_save(re, NULL, 0);
+	char *data = malloc(size);
+	ck_assert_uint_eq(mregexp_dfa_save(re, data, size), size);
+
+	MRegexp *other = mregexp_compile("\\d{2,3}-[a-z]+$");
+	ck_assert(mregexp_dfa_load(other, data, size));
+	ck_assert(mregexp_is_match(other, "12-ab", 5));
+	ck_assert(!mregexp_is_match(other, "1-ab", 4));
+	ck_assert(!mregexp_dfa_load(other, data, size - 1));
+	mregexp_free(other);
+
+	other = mregexp_compile("\\d{2,4}-[a-z]+$");
+	ck_assert(!mregexp_dfa_load(other, data, size));
+	ck_assert_int_eq(mregexp_error(), MREGEXP_INVALID_PARAMS);
+	mregexp_free(other);
+	free(data);
+	mregexp_free(re);
+
+	// any flipped bit of a saved dfa is noticed
+	re = mregexp_compile_opts("[a-z]+@[a-z]+\\.com$", &opts);
+	other = mregexp_compile("[a-z]+@[a-z]+\\.com$");
+	const size_t saved_size = mregexp_dfa_save(re, NULL, 0);
+	uint8_t *saved = malloc(saved_size);
+	mregexp_dfa_save(re, saved, saved_size);
+
+	for (size_t i = 0; i < saved_size * 8; ++i) {
+		saved[i / 8] ^= (uint8_t)(1 << (i % 8));
+		ck_assert(!mregexp_dfa_load(other, saved, saved_size));
+		ck_assert_int_eq(mregexp_error(), MREGEXP_INVALID_PARAMS);
+		saved[i / 8] ^= (uint8_t)(1 << (i % 8));
+	}
+
+	ck_assert(mregexp_dfa_load(other, saved, saved_size));
+	ck_assert(mregexp_is_match(other, "foo@bar.com", 11));
+
+	// as are bits of states beyond the last one with a valid checksum
+	saved[saved_size - 9] |= 0x80;
+	uint64_t sum = 14695981039346656037ULL;
+
+	for (size_t i = 0; i < saved_size - 8; ++i)
+		sum = (sum ^ saved[i]) * 1099511628211ULL;
+
+	for (size_t i = 0; i < 8; ++i)
+		saved[saved_size - 8 + i] = (uint8_t)(sum >> (8 * i));
+
+	ck_assert(!mregexp_dfa_load(other, saved, saved_size));
+	free(saved);
+	mregexp_free(other);
+	mregexp_free(re);
+
+	// loops over groups aren't supported and too many states are
+	// given up on, both leaving matching to the program
+	opts.dfa_max_states = 4;
+	const char *fallbacks[] = {"(ab)+c", "[a-z]{5}x"};
+
+	for (size_t i = 0; i < 2; ++i) {
+		char buf[512];
+		re = mregexp_compile_opts(fallbacks[i], &opts);
+		mregexp_explain(re, buf, sizeof(buf));
+		ck_assert_ptr_nonnull(strstr(buf, "engine: backtracking"));
+		ck_assert(mregexp_is_match(re, "xabababc", 8) == (i == 0));
+		ck_assert_uint_eq(mregexp_dfa_save(re, NULL, 0), 0);
+		mregexp_free(re);
+	}
+}
+END_TEST
+
+START_TEST(match_icase)
+{
+	MRegexpOptions opts = {0};
+	opts.icase = true;
+	MRegexpMatch m;
+	char buf[1024];
+
+	// the required literal is searched for ignoring case as well
+	MRegexp *re = mregexp_compile_opts("error: \\d+", &opts);
+	ck_assert(mregexp_match(re, "a line reporting an ErRoR: 42", &m));
+	ck_assert_uint_eq(m.match_begin, 20);
+	ck_assert_uint_eq(m.match_end, 29);
+	ck_assert(!mregexp_match(re, "an error 42", &m));
+	mregexp_explain(re, buf, sizeof(buf));
+	ck_assert_ptr_nonnull(
+		strstr(buf, "required literal: \"error: \" ignoring case"));
+	mregexp_free(re);
+
+	re = mregexp_compile("error");
+	ck_assert(!mregexp_match(re, "ERROR", &m));
+	mregexp_free(re);
+
+	// non-ascii characters and classes match other cases too
+	re = mregexp_compile_opts("[a-c]+ä|k", &opts);
+	ck_assert(mregexp_match(re, "xBcA\xc3\x84", &m));
+	ck_assert_uint_eq(m.match_begin, 1);
+	ck_assert_uint_eq(m.match_end, 6);
+	ck_assert(mregexp_match(re, "\xe2\x84\xaa", &m));
+	ck_assert_uint_eq(m.match_end, 3);
+	mregexp_free(re);
+
+	re = mregexp_compile_opts("s{3}[^a-z]", &opts);
+	ck_assert(mregexp_match(re, "S\xc5\xbfs-", &m));
+	ck_assert_uint_eq(m.match_end, 5);
+	ck_assert(!mregexp_match(re, "sssA", &m));
+	ck_assert(!mregexp_match(re, "sss\xe2\x84\xaa", &m));
+	mregexp_free(re);
+
+	// the dfa agrees with the program
+	opts.dfa = true;
+	re = mregexp_compile_opts("x[a-f]*yz$", &opts);
+	mregexp_explain(re, buf, sizeof(buf));
+	ck_assert_ptr_nonnull(strstr(buf, "engine: dfa"));
+	ck_assert(mregexp_is_match(re, "-XaBcyZ", 7));
+	ck_assert(!mregexp_is_match(re, "-XaBgyZ", 7));
+	mregexp_free(re);
+}
+END_TEST
+
+START_TEST(match_properties)
+{
+	MRegexpMatch m;
+	char buf[1024];
+
+	// categories by one or two letters and scripts by name
+	MRegexp *re = mregexp_compile("\\p{Greek}+\\P{L}[\\p{Lu}\\d]\\pN");
+	ck_assert(mregexp_match(re, "x\xce\xb1\xce\xb2-\xc3\x84\xc2\xbd", &m));
+	ck_assert_uint_eq(m.match_begin, 1);
+	ck_assert_uint_eq(m.match_end, 10);
+	ck_assert(!mregexp_match(re, "ab-C1", &m));
+	mregexp_explain(re, buf, sizeof(buf));
+	ck_assert_ptr_nonnull(strstr(buf, "class [\\p{Greek}]"));
+	ck_assert_ptr_nonnull(strstr(buf, "class [\\p{C}\\p{M}\\p{N}"));
+	mregexp_free(re);
+
+	re = mregexp_compile("^[^\\P{Latin}a-z]+$");
+	ck_assert(mregexp_match(re, "\xc3\x84\xc5\x93Z", &m));
+	ck_assert(!mregexp_match(re, "\xc3\x84z", &m));
+	ck_assert(!mregexp_match(re, "\xce\xb1", &m));
+	mregexp_free(re);
+
+	// lc covers all cased letters
+	re = mregexp_compile("^\\p{L&}$");
+	ck_assert(mregexp_match(re, "\xc7\x85", &m));
+	ck_assert(!mregexp_match(re, "\xe4\xb8\x80", &m));
+	mregexp_free(re);
+
+	// builtin classes stay ascii unless asked for unicode
+	re = mregexp_compile("\\w+\\s\\d");
+	ck_assert(!mregexp_match(re, "\xc3\xa9t\xc3\xa9\xe2\x80\x83\xd9\xa3", &m));
+	mregexp_free(re);
+
+	MRegexpOptions opts = {0};
+	opts.unicode = true;
+	re = mregexp_compile_opts("\\w+\\s\\d", &opts);
+	ck_assert(mregexp_match(re, "\xc3\xa9t\xc3\xa9\xe2\x80\x83\xd9\xa3", &m));
+	ck_assert_uint_eq(m.match_end, 10);
+	mregexp_free(re);
+
+	re = mregexp_compile_opts("^\\W\\S\\D$", &opts);
+	ck_assert(mregexp_match(re, "-\xce\xb1x", &m));
+	ck_assert(!mregexp_match(re, "-\xce\xb1\xd9\xa3", &m));
+	mregexp_free(re);
+
+	ck_assert_ptr_null(mregexp_compile("\\p{Foo}"));
+	ck_assert_int_eq(mregexp_error(), MREGEXP_INVALID_PROPERTY);
+	ck_assert_ptr_null(mregexp_compile("[\\p{L]"));
+	ck_assert_int_eq(mregexp_error(), MREGEXP_INVALID_PROPERTY);
+	ck_assert_ptr_null(mregexp_compile("\\p"));
+	ck_assert_int_eq(mregexp_error(), MREGEXP_UNEXPECTED_EOL);
+}
+END_TEST
+
+static bool stop_at_b(size_t offset, size_t len, void *user)
+{
+	const char *s = user;
+	return len == 0 || s[offset] != 'b';
+}
+
+START_TEST(split_fields)
+{
+	MRegexp *re = mregexp_compile("\\s*[,;]\\s*");
+	const char *s = "a , b;c,,d";
+	MRegexpMatch fields[5];
+
+	ck_assert_uint_eq(mregexp_split(re, s, strlen(s), NULL, 0), 5);
+	ck_assert_uint_eq(mregexp_split(re, s, strlen(s), fields, 5), 5);
+	ck_assert_uint_eq(fields[0].match_begin, 0);
+	ck_assert_uint_eq(fields[0].match_end, 1);
+	ck_assert_uint_eq(fields[1].match_begin, 4);
+	ck_assert_uint_eq(fields[1].match_end, 5);
+	ck_assert_uint_eq(fields[3].match_begin, 8);
+	ck_assert_uint_eq(fields[3].match_end, 8);
+	ck_assert_uint_eq(fields[4].match_begin, 9);
+	ck_assert_uint_eq(fields[4].match_end, 10);
+
+	// the last field holds the rest of the subject
+	ck_assert_uint_eq(mregexp_split(re, s, strlen(s), fields, 3), 3);
+	ck_assert_uint_eq(fields[2].match_begin, 6);
+	ck_assert_uint_eq(fields[2].match_end, 10);
+
+	ck_assert_uint_eq(mregexp_split(re, ";", 1, fields, 5), 2);
+	ck_assert_uint_eq(fields[0].match_end, 0);
+	ck_assert_uint_eq(fields[1].match_begin, 1);
+	ck_assert_uint_eq(mregexp_split(re, "", 0, fields, 5), 1);
+	ck_assert_uint_eq(fields[0].match_end, 0);
+
+	ck_assert_uint_eq(mregexp_split_cb(re, s, strlen(s), 0, stop_at_b,
+					   (void *)s),
+			  2);
+	ck_assert_uint_eq(mregexp_split(re, s, strlen(s), NULL, 2), 0);
+	ck_assert_int_eq(mregexp_error(), MREGEXP_INVALID_PARAMS);
+	mregexp_free(re);
+}
+END_TEST
+
+START_TEST(replace_captures)
+{
+	MRegexp *re = mregexp_compile("(\\w+)@(\\w+)\\.com");
+	const char *s = "mail bob@example.com or eve@test.com!";
+	char buf[64];
+
+	const size_t len = mregexp_replace(re, s, strlen(s), "<$2:${1}>$$",
+					   NULL, 0);
+	ck_assert_uint_eq(len, 35);
+	ck_assert_uint_eq(mregexp_replace(re, s, strlen(s), "<$2:${1}>$$",
+					  buf, sizeof(buf)), len);
+	ck_assert_str_eq(buf, "mail <example:bob>$ or <test:eve>$!");
+
+	// output is cut off, but the full length is reported
+	ck_assert_uint_eq(mregexp_replace(re, s, strlen(s), "[$0]", buf, 8),
+			  41);
+	ck_assert_str_eq(buf, "mail [b");
+
+	ck_assert_uint_eq(mregexp_replace(re, s, strlen(s), "$3", buf, 64),
+			  0);
+	ck_assert_int_eq(mregexp_error(), MREGEXP_INVALID_PARAMS);
+	mregexp_free(re);
+
+	// groups outside of the match are left out
+	re = mregexp_compile("a(x)|b");
+	ck_assert_uint_eq(mregexp_replace(re, "axb", 3, "$1.", buf, 64), 3);
+	ck_assert_str_eq(buf, "x..");
+	mregexp_free(re);
+
+	// as are groups of branches which failed later on
+	re = mregexp_compile("(a)x|ab");
+	ck_assert_uint_eq(mregexp_replace(re, "ab", 2, "[$1]", buf, 64), 2);
+	ck_assert_str_eq(buf, "[]");
+	mregexp_free(re);
+
+	// a $ without a reference is kept
+	re = mregexp_compile("(b)");
+	mregexp_replace(re, "abc", 3, "$ $x ${1 $$1 $1$", buf, 64);
+	ck_assert_str_eq(buf, "a$ $x ${1 $1 b$c");
+	mregexp_replace(re, "abcb", 4, "", buf, 64);
+	ck_assert_str_eq(buf, "ac");
+	mregexp_replace(re, "bb", 2, "$1$1$$", buf, 64);
+	ck_assert_str_eq(buf, "bb$bb$");
+	mregexp_free(re);
+}
+END_TEST
+
+START_TEST(lexer_longest_match)
+{
+	const char *rules[] = {"let|if", "[a-z_]\\w*", "\\d+", "\\s+",
+			       "[=+;]", "==", "\\d+\\.\\d+"};
+	MRegexpLexer *lex = mregexp_lexer_compile(rules, 7, NULL);
+	ck_assert_ptr_ne(lex, NULL);
+
+	const char *s = "let letter == 4.25+if;";
+	const size_t expected[][2] = {
+		{0, 3}, {3, 1}, {1, 6}, {3, 1}, {5, 2}, {3, 1},
+		{6, 4}, {4, 1}, {0, 2}, {4, 1},
+	};
+	size_t pos = 0, n = 0;
+	MRegexpToken tok;
+
+	while (mregexp_lexer_next(lex, s, strlen(s), &pos, &tok)) {
+		ck_assert_uint_lt(n, 10);
+		ck_assert_uint_eq(tok.rule, expected[n][0]);
+		ck_assert_uint_eq(tok.len, expected[n][1]);
+		n++;
+	}
+
+	ck_assert_uint_eq(n, 10);
+	ck_assert_uint_eq(pos, strlen(s));
+	ck_assert_int_eq(mregexp_error(), MREGEXP_OK);
+
+	// no rule matches at #
+	pos = 0;
+	ck_assert(!mregexp_lexer_next(lex, "#if", 3, &pos, &tok));
+	ck_assert_uint_eq(pos, 0);
+	ck_assert(!mregexp_lexer_next(lex, "if", 2, NULL, &tok));
+	ck_assert_int_eq(mregexp_error(), MREGEXP_INVALID_PARAMS);
+	mregexp_lexer_free(lex);
+
+	const char *invalid[] = {"a", "b{2"};
+	ck_assert_ptr_eq(mregexp_lexer_compile(invalid, 2, NULL), NULL);
+	ck_assert_int_eq(mregexp_error(), MREGEXP_INVALID_COMPLEX_QUANT);
+}
+END_TEST
+
+START_TEST(compile_large_patterns)
+{
+	const size_t n = 10000;
+	char *pattern = malloc(n * 16);
+	char *end = pattern;
+	MRegexpMatch m;
+
+	for (size_t i = 0; i < n; ++i)
+		end += sprintf(end, "%sword%zu;", i > 0 ? "|" : "", i);
+
+	MRegexp *re = mregexp_compile(pattern);
+	ck_assert_ptr_ne(re, NULL);
+	ck_assert(mregexp_match(re, "a word9999; b", &m));
+	ck_assert_uint_eq(m.match_begin, 2);
+	ck_assert_uint_eq(m.match_end, 11);
+	ck_assert(!mregexp_match(re, "word10000;", &m));
+	mregexp_free(re);
+
+	// groups nested deeper than alternatives are long
+	const size_t depth = 1000;
+	memset(pattern, '(', depth);
+	pattern[depth] = 'a';
+	memset(pattern + depth + 1, ')', depth);
+	pattern[2 * depth + 1] = 0;
+
+	re = mregexp_compile(pattern);
+	ck_assert_ptr_ne(re, NULL);
+	ck_assert_uint_eq(mregexp_captures_len(re), depth);
+	ck_assert(mregexp_match(re, "ba", &m));
+	ck_assert_uint_eq(mregexp_capture(re, depth - 1)->match_begin, 1);
+	mregexp_free(re);
+
+	free(pattern);
+}
+END_TEST
+
+START_TEST(captures_failed_branches)
+{
+	// the group matches before its branch fails
+	MRegexp *re = mregexp_compile("(a)x|b");
+	MRegexpMatch m;
+
+	ck_assert(mregexp_match(re, "ab", &m));
+	ck_assert_uint_eq(m.match_begin, 1);
+	ck_assert_uint_eq(mregexp_capture(re, 0)->match_begin, __SIZE_MAX__);
+	ck_assert_uint_eq(mregexp_capture(re, 0)->match_end, __SIZE_MAX__);
+	mregexp_free(re);
+
+	// or a whole attempt at an earlier position
+	re = mregexp_compile("(a)x");
+	ck_assert(mregexp_match(re, "a ax", &m));
+	ck_assert_uint_eq(mregexp_capture(re, 0)->match_begin, 2);
+	mregexp_free(re);
+
+	// failed iterations keep the groups of the last successful one
+	re = mregexp_compile("((a)b|c)*");
+	ck_assert(mregexp_match(re, "abca", &m));
+	ck_assert_uint_eq(m.match_end, 3);
+	ck_assert_uint_eq(mregexp_capture(re, 0)->match_begin, 2);
+	ck_assert_uint_eq(mregexp_capture(re, 1)->match_begin, __SIZE_MAX__);
+	ck_assert(mregexp_match(re, "aba", &m));
+	ck_assert_uint_eq(mregexp_capture(re, 0)->match_begin, 0);
+	ck_assert_uint_eq(mregexp_capture(re, 1)->match_begin, 0);
+	ck_assert_uint_eq(mregexp_capture(re, 1)->match_end, 1);
+	mregexp_free(re);
+}
+END_TEST
+
+START_TEST(captures_reset)
+{
+	MRegexp *re = mregexp_compile("(a)?b");
+	MRegexpMatch m;
+
+	ck_assert(mregexp_match(re, "ab", &m));
+	ck_assert_uint_eq(mregexp_capture(re, 0)->match_begin, 0);
+	ck_assert(mregexp_match(re, "b", &m));
+	ck_assert_uint_eq(mregexp_capture(re, 0)->match_begin, __SIZE_MAX__);
+
+	ck_assert(mregexp_match_from(re, "ab", 2, 0, &m));
+	ck_assert(mregexp_match_from(re, "ab", 2, 1, &m));
+	ck_assert_uint_eq(mregexp_capture(re, 0)->match_begin, __SIZE_MAX__);
+	mregexp_free(re);
+}
+END_TEST
+
+START_TEST(compile_nesting_limit)
+{
+	const size_t depth = 40000;
+	char *pattern = malloc(depth * 3 + 2);
+
+	// empty groups nested too deeply for the call stack
+	memset(pattern, '(', depth);
+	memset(pattern + depth, ')', depth);
+	pattern[2 * depth] = 0;
+	ck_assert_ptr_eq(mregexp_compile(pattern), NULL);
+	ck_assert_int_eq(mregexp_error(), MREGEXP_NESTING_TOO_DEEP);
+
+	// quantifiers count as a level as well
+	pattern[0] = 'a';
+	for (size_t i = 0; i < 1001; ++i)
+		memcpy(pattern + 1 + i * 3, "{1}", 3);
+	pattern[1 + 1001 * 3] = 0;
+	ck_assert_ptr_eq(mregexp_compile(pattern), NULL);
+	ck_assert_int_eq(mregexp_error(), MREGEXP_NESTING_TOO_DEEP);
+
+	// 500 groups holding 500 quantifiers are just deep enough
+	memset(pattern, '(', 500);
+	pattern[500] = 'a';
+	for (size_t i = 0; i < 500; ++i)
+		memcpy(pattern + 501 + i * 3, "{1}", 3);
+	memset(pattern + 2001, ')', 500);
+	pattern[2501] = 0;
+
+	MRegexp *re = mregexp_compile(pattern);
+	MRegexpMatch m;
+	ck_assert_ptr_ne(re, NULL);
+	ck_assert(mregexp_match(re, "ba", &m));
+	ck_assert_uint_eq(m.match_begin, 1);
+	mregexp_free(re);
+
+	pattern[2501] = '?';
+	pattern[2502] = 0;
+	ck_assert_ptr_eq(mregexp_compile(pattern), NULL);
+	ck_assert_int_eq(mregexp_error(), MREGEXP_NESTING_TOO_DEEP);
+
+	free(pattern);
+}
+END_TEST
+
+START_TEST(match_end_of_subject)
+{
+	MRegexp *re = mregexp_compile("^$");
+	MRegexpMatch m;
+
+	ck_assert(mregexp_match(re, "", &m));
+	ck_assert_uint_eq(m.match_begin, 0);
+	ck_assert_uint_eq(m.match_end, 0);
+	ck_assert(mregexp_is_match(re, "", 0));
+	ck_assert(!mregexp_match(re, "a", &m));
+	mregexp_free(re);
+
+	// only empty matches begin at the end
+	re = mregexp_compile("(x*)$");
+	ck_assert(mregexp_match(re, "ab", &m));
+	ck_assert_uint_eq(m.match_begin, 2);
+	ck_assert_uint_eq(mregexp_capture(re, 0)->match_begin, 2);
+
+	const MRegexpSegment segs[] = {{"a", 1}, {"b", 1}, {"", 0}};
+	ck_assert(mregexp_match_segments(re, segs, 3, &m));
+	ck_assert_uint_eq(m.match_begin, 2);
+	ck_assert(mregexp_match_segments(re, NULL, 0, &m));
+	ck_assert_uint_eq(m.match_begin, 0);
+
+	char buf[16];
+	ck_assert_uint_eq(mregexp_replace(re, "ab", 2, "!", buf, 16), 3);
+	ck_assert_str_eq(buf, "ab!");
+	mregexp_free(re);
+
+	// and the dfa accepts them
+	MRegexpOptions opts = {0};
+	opts.dfa = true;
+	re = mregexp_compile_opts("x*$", &opts);
+	ck_assert(mregexp_is_match(re, "ab", 2));
+	ck_assert(mregexp_is_match_segments(re, segs, 3));
+	mregexp_free(re);
+}
+END_TEST
+
+START_TEST(captures_order)
+{
+	MRegexp *re = mregexp_compile("((a)(b))|x(c)");
+	ck_assert_uint_eq(mregexp_captures_len(re), 4);
+
+	MRegexpMatch m;
+	ck_assert(mregexp_match(re, "-xc", &m));
+	ck_assert_uint_eq(mregexp_capture(re, 3)->match_begin, 2);
+	ck_assert_uint_eq(mregexp_capture(re, 3)->match_end, 3);
+
+	ck_assert(mregexp_match(re, "-ab", &m));
+	ck_assert_uint_eq(mregexp_capture(re, 0)->match_end, 3);
+	ck_assert_uint_eq(mregexp_capture(re, 1)->match_begin, 1);
+	ck_assert_uint_eq(mregexp_capture(re, 2)->match_begin, 2);
+	ck_assert_ptr_eq(mregexp_capture(re, 4), NULL);
+
+	mregexp_free(re);
+}
+END_TEST
+
+START_TEST(explain_program)
+{
+	MRegexp *re = mregexp_compile("^(GET|POST) [a-z]+\\.json");
+	const size_t len = mregexp_explain(re, NULL, 0);
+	ck_assert_uint_gt(len, 0);
+
+	char *buf = malloc(len + 1);
+	ck_assert_uint_eq(mregexp_explain(re, buf, len + 1), len);
+	ck_assert_uint_eq(strlen(buf), len);
+
+	ck_assert_ptr_ne(strstr(buf, "string \"GET\""), NULL);
+	ck_assert_ptr_ne(strstr(buf, "repeat{1,inf} class loop"), NULL);
+	ck_assert_ptr_ne(strstr(buf, "class [a-z]"), NULL);
+	ck_assert_ptr_ne(strstr(buf, "anchored: yes"), NULL);
+	ck_assert_ptr_ne(strstr(buf, "required literal: \" \" at offset <= 4"), NULL);
+	ck_assert_ptr_ne(strstr(buf, "engine: backtracking"), NULL);
+
+	// truncated output is terminated and reports the full length
+	char small[8];
+	ck_assert_uint_eq(mregexp_explain(re, small, sizeof(small)), len);
+	ck_assert_uint_eq(strlen(small), sizeof(small) - 1);
+	ck_assert(strncmp(small, buf, sizeof(small) - 1) == 0);
+
+	free(buf);
+	mregexp_free(re);
+}
+END_TEST
+
+START_TEST(explain_byte_classes)
+{
+	// ascii bytes split by what the nodes match, plus one class
+	// per kind of byte the utf8 decoder tells apart
+	const char *patterns[] = {".", "[a-c]x", "[a-c]|x[a-c]*", "[ä-ö]"};
+	const char *expected[] = {"byte classes: 11", "byte classes: 13",
+				  "byte classes: 13", "byte classes: 13"};
+
+	for (size_t i = 0; i < 4; ++i) {
+		char buf[512];
+		MRegexp *re = mregexp_compile(patterns[i]);
+		mregexp_explain(re, buf, sizeof(buf));
+		ck_assert_ptr_ne(strstr(buf, expected[i]), NULL);
+		mregexp_free(re);
+	}
+}
+END_TEST
+
 START_TEST(captures_len)
 {
 	MRegexp *re = mregexp_compile("(ab(cd))(ef)");
@@ -330,6 +1359,244 @@ START_TEST(captures_cap)
 }
 END_TEST
 
+START_TEST(captures_all)
+{
+	MRegexp *re = mregexp_compile("(ab)((cd)+)");
+	MRegexpMatch caps[4], tmp;
+	ck_assert(mregexp_match(re, "xabcdcd", &tmp));
+
+	ck_assert_uint_eq(mregexp_captures(re, caps, 4), 3);
+	ck_assert_uint_eq(caps[0].match_begin, 1);
+	ck_assert_uint_eq(caps[0].match_end, 3);
+	ck_assert_uint_eq(caps[1].match_begin, 3);
+	ck_assert_uint_eq(caps[1].match_end, 7);
+	ck_assert_uint_eq(caps[2].match_begin, 5);
+	ck_assert_uint_eq(caps[2].match_end, 7);
+
+	memset(caps, 0, sizeof(caps));
+	ck_assert_uint_eq(mregexp_captures(re, caps, 1), 1);
+	ck_assert_uint_eq(caps[0].match_end, 3);
+	ck_assert_uint_eq(caps[1].match_end, 0);
+
+	ck_assert_uint_eq(mregexp_captures(re, NULL, 0), 0);
+	ck_assert_uint_eq(mregexp_captures(NULL, caps, 4), 0);
+	ck_assert_int_eq(mregexp_error(), MREGEXP_INVALID_PARAMS);
+	mregexp_free(re);
+}
+END_TEST
+
+/* allocator which counts outstanding allocations and bytes */
+typedef struct {
+	size_t blocks;
+	size_t bytes;
+	size_t allocations;
+} AllocStats;
+
+static void *counting_allocate(size_t size, void *user)
+{
+	AllocStats *stats = user;
+	stats->blocks++;
+	stats->allocations++;
+	stats->bytes += size;
+	return malloc(size);
+}
+
+static void *counting_reallocate(void *ptr, size_t old_size, size_t new_size,
+				 void *user)
+{
+	AllocStats *stats = user;
+	if (ptr == NULL)
+		stats->blocks++;
+	stats->allocations++;
+	stats->bytes += new_size;
+	stats->bytes -= old_size;
+	return realloc(ptr, new_size);
+}
+
+static void counting_deallocate(void *ptr, size_t size, void *user)
+{
+	AllocStats *stats = user;
+	stats->blocks--;
+	stats->bytes -= size;
+	free(ptr);
+}
+
+START_TEST(custom_allocator)
+{
+	AllocStats stats = {0, 0, 0};
+	MRegexpAllocator alloc = {counting_allocate, counting_reallocate,
+				  counting_deallocate, &stats};
+	MRegexpOptions opts = {&alloc};
+
+	MRegexp *re = mregexp_compile_opts("a(b|c)", &opts);
+	ck_assert_ptr_ne(re, NULL);
+	ck_assert_uint_ne(stats.blocks, 0);
+
+	size_t matches_len = 0;
+	const size_t compiled_blocks = stats.blocks;
+	MRegexpMatch *matches =
+		mregexp_all_matches_alloc(re, "ab ac ab ab ac", &matches_len,
+					  &alloc);
+	ck_assert_uint_eq(matches_len, 5);
+	ck_assert_uint_eq(matches[4].match_begin, 12);
+	ck_assert_uint_eq(stats.blocks, compiled_blocks + 1);
+
+	counting_deallocate(matches, matches_len * sizeof(MRegexpMatch),
+			    &stats);
+
+	// matches across segments are copied into memory of re
+	const MRegexpSegment segs[] = {{"xa", 2}, {"c", 1}};
+	const size_t allocations = stats.allocations;
+	MRegexpMatch m;
+	ck_assert(mregexp_match_segments(re, segs, 2, &m));
+	ck_assert_uint_eq(m.match_begin, 1);
+	ck_assert_uint_gt(stats.allocations, allocations);
+	ck_assert_uint_eq(stats.blocks, compiled_blocks);
+	mregexp_free(re);
+	ck_assert_uint_eq(stats.blocks, 0);
+	ck_assert_uint_eq(stats.bytes, 0);
+
+	// failed compilations must not leak
+	ck_assert_ptr_eq(mregexp_compile_opts("(ab", &opts), NULL);
+	ck_assert_uint_eq(stats.blocks, 0);
+}
+END_TEST
+
+START_TEST(arena_allocator)
+{
+	AllocStats stats = {0, 0, 0};
+	MRegexpAllocator parent = {counting_allocate, counting_reallocate,
+				   counting_deallocate, &stats};
+
+	MRegexpArena *arena = mregexp_arena_new(256, &parent);
+	ck_assert_ptr_ne(arena, NULL);
+
+	MRegexpOptions opts = {mregexp_arena_allocator(arena)};
+	MRegexp *res[32];
+
+	for (size_t i = 0; i < 32; ++i) {
+		res[i] = mregexp_compile_opts("[0-9]+\\.[0-9]+", &opts);
+		ck_assert_ptr_ne(res[i], NULL);
+	}
+
+	MRegexpMatch m;
+	ck_assert(mregexp_match(res[31], "pi is 3.1415", &m));
+	ck_assert_uint_eq(m.match_begin, 6);
+	ck_assert_uint_eq(m.match_end, 12);
+
+	size_t matches_len = 0;
+	MRegexpMatch *matches = mregexp_all_matches_alloc(
+		res[0], "1.0 2.0 3.0 4.0 5.0 6.0", &matches_len, opts.allocator);
+	ck_assert_uint_eq(matches_len, 6);
+	ck_assert_uint_eq(matches[5].match_end, 23);
+
+	mregexp_arena_reset(arena);
+	ck_assert_uint_eq(stats.blocks, 2); // arena and one retained block
+
+	res[0] = mregexp_compile_opts("x", &opts);
+	ck_assert(mregexp_match(res[0], "abcx", &m));
+	ck_assert_uint_eq(m.match_begin, 3);
+
+	mregexp_arena_free(arena);
+	ck_assert_uint_eq(stats.blocks, 0);
+	ck_assert_uint_eq(stats.bytes, 0);
+}
+END_TEST
+
+START_TEST(arena_unaligned_blocks)
+{
+	// growing the last allocation to the end of a block whose size
+	// isn't a multiple of the alignment must not overrun it
+	MRegexpArena *arena = mregexp_arena_new(100, NULL);
+	const MRegexpAllocator *alloc = mregexp_arena_allocator(arena);
+
+	char *p = alloc->allocate(10, alloc->user);
+	ck_assert_ptr_ne(p, NULL);
+	p = alloc->reallocate(p, 10, 100, alloc->user);
+	ck_assert_ptr_ne(p, NULL);
+	memset(p, 'a', 100);
+
+	char *q = alloc->allocate(16, alloc->user);
+	ck_assert_ptr_ne(q, NULL);
+	memset(q, 'b', 16);
+	ck_assert(q >= p + 100 || q + 16 <= p);
+	ck_assert_int_eq(p[99], 'a');
+
+	mregexp_arena_free(arena);
+}
+END_TEST
+
+START_TEST(memory_usage)
+{
+	AllocStats stats = {0, 0, 0};
+	MRegexpAllocator alloc = {counting_allocate, counting_reallocate,
+				  counting_deallocate, &stats};
+	const char *patterns[] = {"\\w+\\s+\\w+\\s+(\\w+)",
+				  "\\d{1,3}\\.\\d{1,3}\\.\\d{1,3}",
+				  "(GET|POST) /[a-z]+/[a-z]+", "[^a]b|[^a]c"};
+	const char *s = "GET /api/users from 10.0.0.1 at 12.30.4 cb db ab";
+
+	for (size_t i = 0; i < 4; ++i) {
+		MRegexpOptions opts = {&alloc, .dfa = i == 3};
+		MRegexp *re = mregexp_compile_opts(patterns[i], &opts);
+		opts.compact = true;
+		MRegexp *compact = mregexp_compile_opts(patterns[i], &opts);
+		ck_assert_ptr_ne(re, NULL);
+		ck_assert_ptr_ne(compact, NULL);
+
+		// all memory held is accounted for
+		MRegexpMemory usage;
+		const size_t total = mregexp_memory_usage(re, &usage);
+		ck_assert_uint_eq(total, usage.total);
+		ck_assert_uint_eq(usage.header + usage.nodes + usage.classes +
+					  usage.strings + usage.prefilters +
+					  usage.captures + usage.tails +
+					  usage.dfa,
+				  total);
+		ck_assert_uint_eq(mregexp_memory_usage(compact, NULL) + total,
+				  stats.bytes);
+
+		// fewer nodes and shared classes, same matches
+		MRegexpMemory compact_usage;
+		mregexp_memory_usage(compact, &compact_usage);
+		ck_assert_uint_lt(compact_usage.nodes, usage.nodes);
+		ck_assert_uint_lt(compact_usage.total, usage.total);
+
+		size_t n0 = 0, n1 = 0;
+		MRegexpMatch *m0 = mregexp_all_matches(re, s, &n0);
+		MRegexpMatch *m1 = mregexp_all_matches(compact, s, &n1);
+		ck_assert_uint_eq(n0, n1);
+		ck_assert_uint_ne(n0, 0);
+		ck_assert(memcmp(m0, m1, n0 * sizeof(MRegexpMatch)) == 0);
+		free(m0);
+		free(m1);
+
+		mregexp_free(re);
+		mregexp_free(compact);
+		ck_assert_uint_eq(stats.bytes, 0);
+	}
+
+	// three \w and two \s of four ranges each are stored once each
+	MRegexpOptions opts = {.compact = true};
+	MRegexp *re = mregexp_compile(patterns[0]);
+	MRegexp *compact = mregexp_compile_opts(patterns[0], &opts);
+	MRegexpMemory usage, compact_usage;
+	mregexp_memory_usage(re, &usage);
+	mregexp_memory_usage(compact, &compact_usage);
+	ck_assert_uint_eq(compact_usage.classes * 5, usage.classes * 2);
+	mregexp_free(re);
+	mregexp_free(compact);
+
+	MRegexpOptions lexer_opts = {&alloc};
+	MRegexpLexer *lex = mregexp_lexer_compile(patterns, 4, &lexer_opts);
+	ck_assert_uint_eq(mregexp_lexer_memory_usage(lex), stats.bytes);
+	mregexp_lexer_free(lex);
+
+	ck_assert_uint_eq(mregexp_memory_usage(NULL, NULL), 0);
+	ck_assert_int_eq(mregexp_error(), MREGEXP_INVALID_PARAMS);
+}
+END_TEST
+
 Suite *mregexp_test_suite(void)
 {
 	Suite *ret = suite_create("mregexp");
@@ -342,15 +1609,48 @@ Suite *mregexp_test_suite(void)
 	tcase_add_test(tcase, compile_match_quantifiers);
 	tcase_add_test(tcase, invalid_quantifier);
 	tcase_add_test(tcase, compile_match_complex_quants);
+	tcase_add_test(tcase, compile_match_empty_quants);
+	tcase_add_test(tcase, match_counted_loops);
 	tcase_add_test(tcase, compile_match_escaped_chars);
 	tcase_add_test(tcase, compile_match_class_simple);
 	tcase_add_test(tcase, compile_match_class_complex_0);
 	tcase_add_test(tcase, compile_match_class_complex_1);
 	tcase_add_test(tcase, compile_match_cap);
 	tcase_add_test(tcase, match_all);
+	tcase_add_test(tcase, match_all_empty);
+	tcase_add_test(tcase, match_all_update);
+	tcase_add_test(tcase, match_batch);
+	tcase_add_test(tcase, match_inner_literal);
+	tcase_add_test(tcase, match_alternation_prefilter);
+	tcase_add_test(tcase, match_anchored);
+	tcase_add_test(tcase, match_optimized_programs);
+	tcase_add_test(tcase, match_stats);
+	tcase_add_test(tcase, match_length_aware);
+	tcase_add_test(tcase, match_caller_captures);
+	tcase_add_test(tcase, match_is_match);
+	tcase_add_test(tcase, match_segments);
+	tcase_add_test(tcase, match_dfa);
+	tcase_add_test(tcase, match_icase);
+	tcase_add_test(tcase, match_properties);
+	tcase_add_test(tcase, lexer_longest_match);
+	tcase_add_test(tcase, replace_captures);
+	tcase_add_test(tcase, split_fields);
+	tcase_add_test(tcase, explain_program);
+	tcase_add_test(tcase, explain_byte_classes);
+	tcase_add_test(tcase, compile_large_patterns);
+	tcase_add_test(tcase, captures_order);
 	tcase_add_test(tcase, captures_len);
 	tcase_add_test(tcase, captures_cap);
+	tcase_add_test(tcase, captures_all);
 	tcase_add_test(tcase, compile_match_or);
+	tcase_add_test(tcase, custom_allocator);
+	tcase_add_test(tcase, arena_allocator);
+	tcase_add_test(tcase, arena_unaligned_blocks);
+	tcase_add_test(tcase, memory_usage);
+	tcase_add_test(tcase, captures_reset);
+	tcase_add_test(tcase, captures_failed_branches);
+	tcase_add_test(tcase, compile_nesting_limit);
+	tcase_add_test(tcase, match_end_of_subject);
 
 	suite_add_tcase(ret, tcase);
 	return ret;
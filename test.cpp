@@ -0,0 +1,326 @@
+#include <cstdlib>
+#include <optional>
+#include <string_view>
+#include <check.h>
+
+#include "mregexp.hpp"
+
+/* programs have to be variables with static storage to be matched by
+ * static_regex */
+static constexpr auto digits = mregexp::static_compile("[0-9]+");
+static constexpr auto greeting =
+	mregexp::static_compile("^h(e|a)llo+ w.rld$");
+static constexpr auto umlauts = mregexp::static_compile("[ä-ü]{2,}");
+static constexpr auto words = mregexp::static_compile("\\w+\\s*=\\s*\\d");
+static constexpr auto empty_end = mregexp::static_compile("x*$");
+
+// the matcher is evaluated by the C++ compiler
+static_assert(mregexp::static_regex<digits>::find("ab 123 c")->begin == 3);
+static_assert(mregexp::static_regex<digits>::find("ab 123 c")->end == 6);
+static_assert(mregexp::static_regex<digits>::find("ab 123 c")->str == "123");
+static_assert(mregexp::static_regex<digits>::find("12 34", 2)->begin == 3);
+static_assert(!mregexp::static_regex<digits>::contains("no digits"));
+static_assert(mregexp::static_regex<greeting>::contains("hallooo world"));
+static_assert(mregexp::static_regex<greeting>::contains("hello w\xc3\xb6rld"));
+static_assert(!mregexp::static_regex<greeting>::contains(" hello world"));
+static_assert(mregexp::static_regex<umlauts>::find("aäöz")->begin == 1);
+static_assert(mregexp::static_regex<umlauts>::find("aäöz")->end == 5);
+static_assert(mregexp::static_regex<words>::find("x; key = 4")->begin == 3);
+static_assert(mregexp::static_regex<empty_end>::find("ab")->begin == 2);
+static_assert(mregexp::static_regex<empty_end>::find("")->end == 0);
+
+/* a pattern with its static matcher */
+struct StaticCase {
+	const char *pattern;
+	std::optional<mregexp::match> (*find)(std::string_view, std::size_t);
+};
+
+#define STATIC_CASE(pattern)                                               \
+	{                                                                  \
+		pattern, [](std::string_view s, std::size_t start) {       \
+			static constexpr auto prog =                       \
+				mregexp::static_compile(pattern);          \
+			return mregexp::static_regex<prog>::find(s, start); \
+		}                                                          \
+	}
+
+static const StaticCase static_cases[] = {
+	STATIC_CASE("a"),
+	STATIC_CASE("ab|b"),
+	STATIC_CASE("a|ab|"),
+	STATIC_CASE("(a|ab)(c|bcd)"),
+	STATIC_CASE("a*"),
+	STATIC_CASE("a+b"),
+	STATIC_CASE("a?b?c"),
+	STATIC_CASE("a{2}"),
+	STATIC_CASE("a{1,}b"),
+	STATIC_CASE("a{,2}b"),
+	STATIC_CASE("(ab)*c"),
+	STATIC_CASE("(a*)*b"),
+	STATIC_CASE("^a"),
+	STATIC_CASE("b$"),
+	STATIC_CASE("^$"),
+	STATIC_CASE("x*$"),
+	STATIC_CASE("."),
+	STATIC_CASE("h.llo"),
+	STATIC_CASE("[a-c]+"),
+	STATIC_CASE("[^a ]"),
+	STATIC_CASE("[-a]"),
+	STATIC_CASE("[a-]"),
+	STATIC_CASE("[\\]\\\\]"),
+	STATIC_CASE("\\d+"),
+	STATIC_CASE("\\D\\d"),
+	STATIC_CASE("\\w+\\s"),
+	STATIC_CASE("\\S+"),
+	STATIC_CASE("\\W"),
+	STATIC_CASE("\\.\\*\\n"),
+	STATIC_CASE("é"),
+	STATIC_CASE("[ä-ü€]"),
+	STATIC_CASE("€|\\d{2,3}"),
+	STATIC_CASE("a)"),
+};
+
+static const char *const static_subjects[] = {
+	"",
+	"a",
+	"b",
+	"ab",
+	"abc",
+	"aab",
+	"abcd",
+	"abab c",
+	"  12 ab",
+	"-1 123-4567",
+	"hello hallo",
+	"x\ny.*\n",
+	"a]\\b",
+	"-a b-",
+	"héllo wörld",
+	"ü€ 12",
+	"a)",
+	"\xff\xe2\x82 \xc3",
+	"\xc0\x80\xe2\x82\xac",
+};
+
+START_TEST(static_regex_runtime)
+{
+	for (const StaticCase &c : static_cases) {
+		mregexp::regex re(c.pattern);
+
+		for (const char *subject : static_subjects) {
+			const std::string_view s = subject;
+
+			for (std::size_t start = 0; start <= s.size(); ++start) {
+				const auto expected = re.find(s, start);
+				const auto m = c.find(s, start);
+
+				ck_assert_msg(m.has_value() == expected.has_value(),
+					      "/%s/ on \"%s\" from %zu", c.pattern,
+					      subject, start);
+
+				if (!m)
+					continue;
+
+				ck_assert_msg(m->begin == expected->begin &&
+						      m->end == expected->end,
+					      "/%s/ on \"%s\" from %zu", c.pattern,
+					      subject, start);
+				ck_assert(m->str == expected->str);
+			}
+		}
+	}
+}
+END_TEST
+
+START_TEST(static_parser_errors)
+{
+	const struct {
+		const char *pattern;
+		MRegexpError code;
+	} cases[] = {
+		{"(ab", MREGEXP_UNCLOSED_SUBEXPRESSION},
+		{"a{2,1}", MREGEXP_INVALID_COMPLEX_QUANT},
+		{"*a", MREGEXP_EARLY_QUANTIFIER},
+		{"[ab", MREGEXP_INVALID_COMPLEX_CLASS},
+		{"ab\\", MREGEXP_UNEXPECTED_EOL},
+		{"\xc3", MREGEXP_INVALID_UTF8},
+		// the tables of unicode properties are only known at runtime
+		{"\\pL", MREGEXP_INVALID_PROPERTY},
+	};
+
+	for (const auto &c : cases) {
+		MRegexpError code = MREGEXP_OK;
+
+		// outside of a constant expression the parser throws
+		try {
+			mregexp::detail::static_parser<64>(c.pattern).parse();
+		} catch (const mregexp::error &e) {
+			code = e.code();
+		}
+
+		ck_assert_int_eq(code, c.code);
+
+		if (c.code == MREGEXP_INVALID_PROPERTY)
+			continue;
+
+		ck_assert_ptr_eq(mregexp_compile(c.pattern), NULL);
+		ck_assert_int_eq(mregexp_error(), c.code);
+	}
+}
+END_TEST
+
+START_TEST(regex_errors)
+{
+	MRegexpError code = MREGEXP_OK;
+
+	try {
+		mregexp::regex re("a{2");
+	} catch (const mregexp::error &e) {
+		code = e.code();
+		ck_assert_str_eq(e.what(), "mregexp: invalid {m,n} quantifier");
+	}
+
+	ck_assert_int_eq(code, MREGEXP_INVALID_COMPLEX_QUANT);
+
+	// replacements referring to missing groups throw as well
+	mregexp::regex re("(a)b");
+	code = MREGEXP_OK;
+
+	try {
+		re.replace("ab", "$2");
+	} catch (const mregexp::error &e) {
+		code = e.code();
+	}
+
+	ck_assert_int_eq(code, MREGEXP_INVALID_PARAMS);
+	ck_assert(re.replace("xab ab", "<$1>") == "x<a> <a>");
+}
+END_TEST
+
+START_TEST(regex_move)
+{
+	mregexp::regex a("b+");
+	MRegexp *compiled = a.get();
+
+	mregexp::regex b(std::move(a));
+	ck_assert(!a);
+	ck_assert_ptr_eq(a.get(), NULL);
+	ck_assert_ptr_eq(b.get(), compiled);
+	ck_assert_uint_eq(b.find("abbc")->end, 3);
+
+	// assigning frees the expression held before
+	mregexp::regex c("c");
+	c = std::move(b);
+	ck_assert(!b);
+	ck_assert_ptr_eq(c.get(), compiled);
+
+	// and moving into itself keeps it
+	mregexp::regex &same = c;
+	c = std::move(same);
+	ck_assert_ptr_eq(c.get(), compiled);
+
+	// a moved from regex may be assigned to again
+	a = mregexp::regex("a");
+	ck_assert(a.contains("cba"));
+
+	MRegexp *released = c.release();
+	ck_assert_ptr_eq(released, compiled);
+	ck_assert(!c);
+
+	mregexp::regex owner(released);
+	ck_assert(owner.find("bb")->str == "bb");
+
+	// destroying moved from wrappers keeps the error of the last call
+	{
+		mregexp::regex moved("x");
+		mregexp::regex to(std::move(moved));
+		ck_assert_int_eq(mregexp_error(), MREGEXP_OK);
+		to = std::move(moved);
+	}
+
+	ck_assert_int_eq(mregexp_error(), MREGEXP_OK);
+}
+END_TEST
+
+START_TEST(regex_captures)
+{
+	mregexp::regex re("(a)x|(b)");
+	const std::string_view s = "ab";
+
+	ck_assert_uint_eq(re.captures_len(), 2);
+	ck_assert_uint_eq(re.find(s)->begin, 1);
+
+	// groups which didn't take part in the match have no slice
+	ck_assert(!re.capture(s, 0));
+	ck_assert(re.capture(s, 1)->str == "b");
+	ck_assert(!re.capture(s, 2));
+}
+END_TEST
+
+START_TEST(regex_find_all)
+{
+	mregexp::regex re("a*");
+	const std::string_view s = "baab";
+	std::size_t n = 0;
+	MRegexpMatch *expected = mregexp_all_matches(re.get(), "baab", &n);
+	std::size_t i = 0;
+
+	// empty matches are stepped over, up to the one at the end
+	for (const mregexp::match &m : re.find_all(s)) {
+		ck_assert_uint_lt(i, n);
+		ck_assert_uint_eq(m.begin, expected[i].match_begin);
+		ck_assert_uint_eq(m.end, expected[i].match_end);
+		ck_assert(m.str == s.substr(m.begin, m.end - m.begin));
+		i++;
+	}
+
+	ck_assert_uint_eq(i, 4);
+	ck_assert_uint_eq(n, 4);
+	free(expected);
+
+	// inside of a character the next search begins behind it
+	i = 0;
+	for (const mregexp::match &m : re.find_all("\xc3\xa4")) {
+		ck_assert_uint_eq(m.begin, i == 0 ? 0 : 2);
+		ck_assert_uint_eq(m.end, m.begin);
+		i++;
+	}
+
+	ck_assert_uint_eq(i, 2);
+
+	mregexp::regex none("x");
+	ck_assert(none.find_all("").begin() == none.find_all("").end());
+	ck_assert(none.find_all("aaa").begin() == none.find_all("aaa").end());
+
+	mregexp::regex empty("x*");
+	auto it = empty.find_all("").begin();
+	ck_assert(it != empty.find_all("").end());
+	ck_assert_uint_eq(it->begin, 0);
+	ck_assert(++it == empty.find_all("").end());
+}
+END_TEST
+
+Suite *mregexp_hpp_test_suite(void)
+{
+	Suite *ret = suite_create("mregexp.hpp");
+	TCase *tcase = tcase_create("mregexp.hpp");
+
+	tcase_add_test(tcase, static_regex_runtime);
+	tcase_add_test(tcase, static_parser_errors);
+	tcase_add_test(tcase, regex_errors);
+	tcase_add_test(tcase, regex_move);
+	tcase_add_test(tcase, regex_captures);
+	tcase_add_test(tcase, regex_find_all);
+
+	suite_add_tcase(ret, tcase);
+	return ret;
+}
+
+int main(void)
+{
+	SRunner *sr = srunner_create(mregexp_hpp_test_suite());
+	srunner_run_all(sr, CK_NORMAL);
+	int fails = srunner_ntests_failed(sr);
+	srunner_free(sr);
+	return fails ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+"""Generate the unicode tables of mregexp.c from the character database.
+
+Usage: unicode_tables.py UnicodeData.txt Scripts.txt CaseFolding.txt
+
+The files are found at https://www.unicode.org/Public/<version>/ucd/. The
+tables are written to stdout and replace fold_ranges, category_runs,
+script_names and script_runs in mregexp.c. Update the version noted next
+to them when regenerating.
+"""
+
+import sys
+
+MAX_CHR = 0x110000
+
+# order of category_names in mregexp.c
+CATEGORIES = [
+    "Cc", "Cf", "Cn", "Co", "Cs", "Ll", "Lm", "Lo", "Lt", "Lu",
+    "Mc", "Me", "Mn", "Nd", "Nl", "No", "Pc", "Pd", "Pe", "Pf",
+    "Pi", "Po", "Ps", "Sc", "Sk", "Sm", "So", "Zl", "Zp", "Zs",
+]
+
+
+def records(path):
+    """Yield the fields of all lines of a file without comments."""
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            line = line.split("#", 1)[0].strip()
+            if line:
+                yield [field.strip() for field in line.split(";")]
+
+
+def code_range(field):
+    """Parse 'XXXX' or 'XXXX..YYYY' into the first and last character."""
+    first, _, last = field.partition("..")
+    return int(first, 16), int(last or first, 16)
+
+
+def read_categories(path):
+    """General category of every character, Cn for unlisted ones."""
+    ret = ["Cn"] * MAX_CHR
+    first = None
+
+    for fields in records(path):
+        c, name, cat = int(fields[0], 16), fields[1], fields[2]
+
+        # large blocks are given by their first and last character
+        if name.endswith(", First>"):
+            first = c
+            continue
+
+        lo = first if name.endswith(", Last>") else c
+        ret[lo:c + 1] = [cat] * (c + 1 - lo)
+        first = None
+
+    return ret
+
+
+def read_scripts(path):
+    """Script of every character, Unknown for unlisted ones."""
+    ret = ["Unknown"] * MAX_CHR
+
+    for fields in records(path):
+        lo, hi = code_range(fields[0])
+        ret[lo:hi + 1] = [fields[1]] * (hi + 1 - lo)
+
+    return ret
+
+
+def read_orbits(path):
+    """Next member of the case orbit of every character with one."""
+    orbit = {}
+
+    # only the simple case folding, which maps single characters
+    for fields in records(path):
+        if fields[1] not in ("C", "S"):
+            continue
+
+        c, folded = int(fields[0], 16), int(fields[2], 16)
+        members = orbit.get(c, {c}) | orbit.get(folded, {folded})
+
+        for m in members:
+            orbit[m] = members
+
+    ret = {}
+    for members in orbit.values():
+        members = sorted(members)
+        for i, c in enumerate(members):
+            ret[c] = members[(i + 1) % len(members)]
+
+    return ret
+
+
+def runs(values):
+    """Entries of the first character of each run of equal values."""
+    ret = []
+    prev = None
+
+    for c, value in enumerate(values):
+        if value != prev:
+            ret.append("{0x%x, %d}" % (c, value))
+            prev = value
+
+    return ret
+
+
+def fold_ranges(orbits):
+    """Ranges of characters with the same delta to their next member,
+    or of pairs of an upper and a lower case character."""
+    delta = {c: n - c for c, n in orbits.items()}
+    chars = sorted(delta)
+    ret = []
+    i = 0
+
+    while i < len(chars):
+        lo = hi = chars[i]
+
+        if delta[lo] == 1 and delta.get(lo + 1) == -1:
+            hi = lo + 1
+            while delta.get(hi + 1) == 1 and delta.get(hi + 2) == -1:
+                hi += 2
+            d = "FOLD_ALTERNATE"
+        else:
+            while delta.get(hi + 1) == delta[lo]:
+                hi += 1
+            d = str(delta[lo])
+
+        ret.append("{0x%x, 0x%x, %s}" % (lo, hi, d))
+        i += hi + 1 - lo
+
+    return ret
+
+
+def table(decl, entries):
+    """Format a C array with as many entries per line as fit 79 columns."""
+    lines = []
+    line = ""
+
+    for e in entries:
+        e += ","
+        if line and 8 + len(line) + 1 + len(e) > 79:
+            lines.append("\t" + line)
+            line = ""
+        line += (" " if line else "") + e
+
+    lines.append("\t" + line)
+    return "%s = {\n%s\n};\n" % (decl, "\n".join(lines))
+
+
+def main(argv):
+    if len(argv) != 4:
+        sys.exit(__doc__.strip())
+
+    categories = read_categories(argv[1])
+    scripts = read_scripts(argv[2])
+    orbits = read_orbits(argv[3])
+
+    names = ["Unknown"] + sorted(set(scripts) - {"Unknown"})
+    index = {name: i for i, name in enumerate(names)}
+    cat_index = {cat: i for i, cat in enumerate(CATEGORIES)}
+
+    print(table("static const FoldRange fold_ranges[]",
+                fold_ranges(orbits)))
+    print(table("static const PropertyRun category_runs[]",
+                runs([cat_index[c] for c in categories])))
+    print(table("static const char *const script_names[]",
+                ['"%s"' % name for name in names]))
+    print(table("static const PropertyRun script_runs[]",
+                runs([index[s] for s in scripts])), end="")
+
+
+if __name__ == "__main__":
+    main(sys.argv)